@@ -0,0 +1,215 @@
+#include "AudioAnalysisCache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <cstring>
+
+
+namespace {
+
+// identifies cache files, also detects files written with a different byte order:
+const quint32 CACHE_MAGIC = 0x4C414348;  // "LACH"
+const quint16 CACHE_VERSION = 2;
+
+// suffix of the cache files of the previous format:
+const char* const LEGACY_FILE_SUFFIX = ".peaks";
+
+// number of bytes at the beginning of the audio file that are part of the key,
+// contains the format header and the first samples:
+const qint64 KEY_CONTENT_SIZE = 64 * 1024;
+const int KEY_SIZE = 20;  // SHA1
+
+// an upper bound to reject corrupted section tables early:
+const quint32 MAX_SECTION_COUNT = 256;
+
+// section data is aligned to this, the file itself is mapped page aligned:
+const quint64 SECTION_ALIGNMENT = 8;
+
+enum SectionType : quint32 {
+    WaveformLevelSection = 1,  // index = level, data = WaveformBucket[]
+};
+
+struct CacheHeader {
+    quint32 magic;
+    quint16 version;
+    quint16 headerSize;
+    char key[KEY_SIZE];
+    quint32 sectionCount;
+    qint64 frameCount;
+    qint32 sampleRate;
+    quint32 reserved;
+};
+static_assert(sizeof(CacheHeader) == 48, "unexpected cache header size");
+
+struct CacheSection {
+    quint32 type;
+    quint32 index;
+    quint64 offset;
+    quint64 size;
+};
+static_assert(sizeof(CacheSection) == 24, "unexpected cache section size");
+
+inline quint64 aligned(quint64 offset) {
+    return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+}  // namespace
+
+
+const char* const AudioAnalysisCache::FILE_SUFFIX = ".lac";
+
+QByteArray AudioAnalysisCache::keyFor(const QString& filename) {
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) return QByteArray();
+    const QFileInfo info(filename);
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(file.read(KEY_CONTENT_SIZE));
+    QByteArray metadata;
+    QDataStream stream(&metadata, QIODevice::WriteOnly);
+    stream << qint64(info.size()) << qint64(info.lastModified().toMSecsSinceEpoch());
+    hash.addData(metadata);
+    return hash.result();
+}
+
+QString AudioAnalysisCache::filenameFor(const QString& cacheDir, const QByteArray& key) {
+    return cacheDir + QString::fromLatin1(key.toHex()) + FILE_SUFFIX;
+}
+
+std::shared_ptr<WaveformPyramid> AudioAnalysisCache::load(const QString& filename, const QByteArray& key) {
+    if (key.size() != KEY_SIZE) return nullptr;
+    std::shared_ptr<QFile> file = std::make_shared<QFile>(filename);
+    if (!file->open(QIODevice::ReadOnly)) return nullptr;
+    const quint64 fileSize = quint64(file->size());
+    if (fileSize < sizeof(CacheHeader)) {
+        qWarning() << "AudioAnalysisCache: file too small:" << filename;
+        return nullptr;
+    }
+    const uchar* data = file->map(0, qint64(fileSize));
+    if (!data) {
+        qWarning() << "AudioAnalysisCache: couldn't map file:" << filename;
+        return nullptr;
+    }
+
+    // ------------- validate header:
+    CacheHeader header;
+    std::memcpy(&header, data, sizeof(CacheHeader));
+    if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION
+            || header.headerSize != sizeof(CacheHeader)) {
+        qWarning() << "AudioAnalysisCache: unknown format:" << filename;
+        return nullptr;
+    }
+    if (std::memcmp(header.key, key.constData(), KEY_SIZE) != 0) {
+        // i.e. hash collision of the filename or a file was copied into the cache dir
+        qWarning() << "AudioAnalysisCache: key mismatch:" << filename;
+        return nullptr;
+    }
+    if (header.frameCount <= 0 || header.sampleRate <= 0 || header.sectionCount > MAX_SECTION_COUNT
+            || sizeof(CacheHeader) + header.sectionCount * sizeof(CacheSection) > fileSize) {
+        qWarning() << "AudioAnalysisCache: invalid header:" << filename;
+        return nullptr;
+    }
+
+    // ------------- validate sections:
+    // the level sizes follow from the frame count, this also detects truncated files:
+    std::size_t expectedSize = std::size_t((header.frameCount + WaveformPyramid::BASE_BUCKET_FRAMES - 1)
+                                           / WaveformPyramid::BASE_BUCKET_FRAMES);
+    std::vector<WaveformPyramid::Level> levels;
+    for (quint32 i = 0; i < header.sectionCount; ++i) {
+        CacheSection section;
+        std::memcpy(&section, data + sizeof(CacheHeader) + i * sizeof(CacheSection), sizeof(CacheSection));
+        if (section.offset > fileSize || section.size > fileSize - section.offset
+                || section.offset % SECTION_ALIGNMENT != 0) {
+            qWarning() << "AudioAnalysisCache: section out of bounds:" << filename;
+            return nullptr;
+        }
+        if (section.type != WaveformLevelSection) continue;
+
+        if (section.index != levels.size() || section.size != expectedSize * sizeof(WaveformBucket)) {
+            qWarning() << "AudioAnalysisCache: invalid waveform level:" << filename;
+            return nullptr;
+        }
+        levels.push_back(WaveformPyramid::Level {
+                             reinterpret_cast<const WaveformBucket*>(data + section.offset), expectedSize});
+        if (expectedSize == 1) break;
+        expectedSize = (expectedSize + 1) / 2;
+    }
+    if (levels.empty() || levels.back().size != 1) {
+        qWarning() << "AudioAnalysisCache: incomplete waveform:" << filename;
+        return nullptr;
+    }
+
+    std::shared_ptr<WaveformPyramid> pyramid = std::make_shared<WaveformPyramid>();
+    pyramid->setMappedLevels(file, header.frameCount, header.sampleRate, levels);
+
+    // the modification time is the time of the last use, prune() removes the least recently used files:
+    QFile touchFile(filename);
+    if (!touchFile.open(QIODevice::ReadWrite)
+            || !touchFile.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime)) {
+        qWarning() << "AudioAnalysisCache: couldn't update time of last use:" << filename;
+    }
+    return pyramid;
+}
+
+bool AudioAnalysisCache::save(const QString& filename, const QByteArray& key, const WaveformPyramid& pyramid) {
+    if (key.size() != KEY_SIZE || pyramid.getLevels().empty()) return false;
+    const std::vector<WaveformPyramid::Level>& levels = pyramid.getLevels();
+
+    CacheHeader header;
+    std::memset(&header, 0, sizeof(CacheHeader));
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.headerSize = sizeof(CacheHeader);
+    std::memcpy(header.key, key.constData(), KEY_SIZE);
+    header.sectionCount = quint32(levels.size());
+    header.frameCount = pyramid.getFrameCount();
+    header.sampleRate = pyramid.getSampleRate();
+
+    std::vector<CacheSection> sections;
+    quint64 offset = aligned(sizeof(CacheHeader) + levels.size() * sizeof(CacheSection));
+    for (std::size_t i = 0; i < levels.size(); ++i) {
+        const quint64 size = levels[i].size * sizeof(WaveformBucket);
+        sections.push_back(CacheSection {WaveformLevelSection, quint32(i), offset, size});
+        offset = aligned(offset + size);
+    }
+
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "AudioAnalysisCache: couldn't write file:" << filename;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+    file.write(reinterpret_cast<const char*>(sections.data()), qint64(sections.size() * sizeof(CacheSection)));
+    const char padding[SECTION_ALIGNMENT] = {};
+    for (std::size_t i = 0; i < levels.size(); ++i) {
+        file.write(padding, qint64(sections[i].offset) - file.pos());
+        file.write(reinterpret_cast<const char*>(levels[i].buckets), qint64(sections[i].size));
+    }
+    return file.commit();
+}
+
+void AudioAnalysisCache::prune(const QString& cacheDir, qint64 maxSize) {
+    QDir dir(cacheDir);
+    // most recently used first (load() updates the modification time):
+    const QFileInfoList files = dir.entryInfoList(QDir::Files, QDir::Time);
+    qint64 size = 0;
+    for (const QFileInfo& info: files) {
+        if (info.fileName().endsWith(LEGACY_FILE_SUFFIX)) {
+            QFile::remove(info.absoluteFilePath());
+            continue;
+        }
+        // other files may be temporary files of a save() in another thread:
+        if (!info.fileName().endsWith(FILE_SUFFIX)) continue;
+        if (size + info.size() > maxSize) {
+            QFile::remove(info.absoluteFilePath());
+            continue;
+        }
+        size += info.size();
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef AUDIOANALYSISCACHE_H
+#define AUDIOANALYSISCACHE_H
+
+#include "WaveformPyramid.h"
+
+#include <QByteArray>
+#include <QString>
+
+#include <memory>
+
+
+/**
+ * @brief The AudioAnalysisCache class stores the analysis results of audio files on disk.
+ *
+ * Cache files are content-addressed: the key is a hash of the beginning of the audio file,
+ * its size and its modification time. A changed file gets a new key, so its outdated entry
+ * is simply not found anymore and the file is analyzed again the next time it is opened.
+ * Renamed or copied files (with preserved modification time) still use the same entry.
+ *
+ * A cache file consists of a fixed size header, a section table and the section data.
+ * Each level of a WaveformPyramid is stored in its own section in memory layout,
+ * so that loading is only mapping the file and validating the header and section table,
+ * the pages are read by the OS when they are accessed.
+ * Unknown section types are ignored, this allows to add further sections (i.e. onset or
+ * beat grids) without invalidating existing files.
+ *
+ * All methods are static and thread-safe, they are called from a WaveformAnalysisThread.
+ */
+class AudioAnalysisCache {
+
+public:
+    // file suffix of cache files:
+    static const char* const FILE_SUFFIX;
+
+    // the least recently used cache files are removed if all files together exceed this size:
+    static const qint64 MAX_CACHE_SIZE = 1024LL * 1024 * 1024;
+
+    /**
+     * @brief keyFor calculates the content-addressed key of an audio file,
+     * reads only the beginning of the file
+     * @param filename path to the audio file
+     * @return a 20 byte key or an empty QByteArray if the file can't be read
+     */
+    static QByteArray keyFor(const QString& filename);
+
+    /**
+     * @brief filenameFor returns the path of the cache file of a key
+     * @param cacheDir directory of the cache files, with trailing "/"
+     * @param key key returned by keyFor()
+     * @return path to the cache file (that may not exist)
+     */
+    static QString filenameFor(const QString& cacheDir, const QByteArray& key);
+
+    /**
+     * @brief load maps a cache file and returns the stored waveform,
+     * marks the file as recently used by updating its modification time
+     * @param filename path to the cache file
+     * @param key the expected key, files with a different key are rejected
+     * @return the pyramid that uses the mapped file or nullptr if the file is invalid
+     */
+    static std::shared_ptr<WaveformPyramid> load(const QString& filename, const QByteArray& key);
+
+    /**
+     * @brief save writes a waveform to a cache file, the file is replaced atomically
+     * @param filename path to the cache file, the directory must exist
+     * @param key the key of the audio file
+     * @param pyramid the waveform to store
+     * @return true if successful
+     */
+    static bool save(const QString& filename, const QByteArray& key, const WaveformPyramid& pyramid);
+
+    /**
+     * @brief prune removes the least recently used files in the cache directory until their size
+     * is below maxSize, also removes files of the previous format
+     * @param cacheDir directory of the cache files
+     * @param maxSize maximum size of all cache files in bytes
+     */
+    static void prune(const QString& cacheDir, qint64 maxSize = MAX_CACHE_SIZE);
+};
+
+#endif // AUDIOANALYSISCACHE_H
@@ -0,0 +1,58 @@
+#include "AudioAnalysisThread.h"
+
+#include "AudioInputAnalyzer.h"
+
+#include <vector>
+
+
+AudioAnalysisThread::AudioAnalysisThread(AudioInputAnalyzer* analyzer)
+    : QThread(analyzer)
+    , m_analyzer(analyzer)
+    , m_ring(AUDIO_SAMPLING_RATE)  // ~1.5s
+    , m_samplesAvailable(0)
+    , m_stopRequested(false)
+    , m_droppedSamples(0)
+{
+
+}
+
+AudioAnalysisThread::~AudioAnalysisThread() {
+    stopAnalysis();
+}
+
+void AudioAnalysisThread::startAnalysis() {
+    if (isRunning()) return;
+    m_ring.clear();
+    m_samplesAvailable.acquire(m_samplesAvailable.available());
+    m_stopRequested = false;
+    m_droppedSamples = 0;
+    start(QThread::HighPriority);
+}
+
+void AudioAnalysisThread::stopAnalysis() {
+    m_stopRequested = true;
+    m_samplesAvailable.release();
+    wait();
+}
+
+void AudioAnalysisThread::pushSamples(const float* samples, int count) {
+    const int written = int(m_ring.push(samples, std::size_t(count)));
+    if (written < count) {
+        m_droppedSamples += count - written;
+    }
+    m_samplesAvailable.release();
+}
+
+void AudioAnalysisThread::run() {
+    std::vector<float> hop(SAMPLES_BETWEEN_SPECTRUM_UPDATES);
+
+    while (!m_stopRequested) {
+        if (m_ring.available() < hop.size()) {
+            // wait for the next push, the timeout is only a safety net:
+            m_samplesAvailable.tryAcquire(1, 100);
+            continue;
+        }
+        m_ring.pop(hop.data(), hop.size());
+        m_analyzer->analyzeHop(hop.data());
+    }
+}
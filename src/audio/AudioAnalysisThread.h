@@ -0,0 +1,74 @@
+#ifndef AUDIOANALYSISTHREAD_H
+#define AUDIOANALYSISTHREAD_H
+
+#include "core/SpscRingBuffer.h"
+
+#include <QThread>
+#include <QSemaphore>
+
+#include <atomic>
+
+class AudioInputAnalyzer;  // forward declaration
+
+
+/**
+ * @brief The AudioAnalysisThread class runs the spectrum, onset and BPM analysis
+ * of an AudioInputAnalyzer independent from the GUI thread.
+ *
+ * The AudioCaptureDevice pushes the samples of the analyzed channel into a lock-free
+ * SpscRingBuffer. This thread waits until a full hop (SAMPLES_BETWEEN_SPECTRUM_UPDATES)
+ * is available and passes it to AudioInputAnalyzer::analyzeHop(), so the analysis always
+ * runs at the same fixed hop size, no matter in which chunks the audio backend delivers the data.
+ */
+class AudioAnalysisThread : public QThread {
+
+    Q_OBJECT
+
+public:
+    /**
+     * @brief AudioAnalysisThread creates the thread, it is not started
+     * @param analyzer the analyzer whose analyzeHop() method is called
+     */
+    explicit AudioAnalysisThread(AudioInputAnalyzer* analyzer);
+    ~AudioAnalysisThread() override;
+
+    /**
+     * @brief startAnalysis clears the ring buffer and starts the thread
+     */
+    void startAnalysis();
+
+    /**
+     * @brief stopAnalysis stops the thread and blocks until it finished
+     */
+    void stopAnalysis();
+
+    // ---------------- called from the capture thread:
+
+    /**
+     * @brief pushSamples passes new samples to the analysis without locking
+     * @param samples samples in the range [-1.0, 1.0]
+     * @param count number of samples
+     */
+    void pushSamples(const float* samples, int count);
+
+    // ---------------- statistics (thread-safe):
+
+    /**
+     * @brief getDroppedSampleCount returns the number of samples that were dropped
+     * because the analysis could not keep up
+     * @return number of samples since the last start
+     */
+    int getDroppedSampleCount() const { return m_droppedSamples.load(); }
+
+protected:
+    void run() override;
+
+protected:
+    AudioInputAnalyzer* const m_analyzer;  //!< the analyzer to call analyzeHop() of
+    SpscRingBuffer<float> m_ring;  //!< samples not yet analyzed
+    QSemaphore m_samplesAvailable;  //!< released after each push to wake up this thread
+    std::atomic<bool> m_stopRequested;
+    std::atomic<int> m_droppedSamples;
+};
+
+#endif // AUDIOANALYSISTHREAD_H
@@ -0,0 +1,148 @@
+#include "AudioCaptureDevice.h"
+
+#include "AudioAnalysisThread.h"
+
+#include <QDebug>
+#include <cstdint>
+
+
+namespace {
+
+// number of frames converted at once:
+const int CONVERSION_CHUNK_SIZE = 1024;
+
+// length of the generated clicks in seconds:
+const double CLICK_LENGTH = 0.005;
+
+// interval to generate the click track with in ms:
+const int CLICK_TRACK_GENERATOR_INTERVAL = 5;
+
+}  // namespace
+
+
+AudioCaptureDevice::AudioCaptureDevice(const QAudioDeviceInfo& deviceInfo, const QAudioFormat& format,
+                                       int channelIndex, AudioAnalysisThread* analysisThread)
+    : QIODevice()
+    , m_deviceInfo(deviceInfo)
+    , m_format(format)
+    , m_channelIndex(channelIndex)
+    , m_analysisThread(analysisThread)
+    , m_audioInput(nullptr)
+    , m_convertedSamples(CONVERSION_CHUNK_SIZE)
+    , m_clickIntervalSamples(0)
+    , m_clickTrackStart()
+    , m_generatedSamples(0)
+    , m_noiseState(1)
+    , m_clickTrackTimer(this)
+{
+    m_clickTrackTimer.setInterval(CLICK_TRACK_GENERATOR_INTERVAL);
+    m_clickTrackTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_clickTrackTimer, SIGNAL(timeout()), this, SLOT(generateClickTrack()));
+}
+
+void AudioCaptureDevice::setClickTrack(int clickIntervalSamples, Clock::time_point start) {
+    m_clickIntervalSamples = clickIntervalSamples;
+    m_clickTrackStart = start;
+    // enough space for 100ms of samples:
+    m_clickTrackData.resize(m_format.bytesForDuration(100000));
+}
+
+QAudioFormat AudioCaptureDevice::clickTrackFormat() {
+    QAudioFormat format;
+    format.setSampleRate(44100);
+    format.setChannelCount(1);
+    format.setSampleSize(16);
+    format.setCodec("audio/pcm");
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setSampleType(QAudioFormat::SignedInt);
+    return format;
+}
+
+bool AudioCaptureDevice::startCapture() {
+    if (!open(QIODevice::WriteOnly)) {
+        qCritical() << "Could not open audio capture device.";
+        return false;
+    }
+
+    if (m_clickIntervalSamples > 0) {
+        m_generatedSamples = 0;
+        m_clickTrackTimer.start();
+        return true;
+    }
+
+    m_audioInput = new QAudioInput(m_deviceInfo, m_format, this);
+    if (m_audioInput->volume() < 1.0) m_audioInput->setVolume(1.0);
+    // a small buffer means that the backend delivers smaller chunks more often:
+    m_audioInput->setBufferSize(m_format.bytesForDuration(40000));  // 40ms
+    m_audioInput->start(this);
+    if (m_audioInput->error() != QAudio::NoError) {
+        qCritical() << "Could not start audio capture.";
+        qCritical() << m_audioInput->error();
+        stopCapture();
+        return false;
+    }
+    return true;
+}
+
+void AudioCaptureDevice::stopCapture() {
+    m_clickTrackTimer.stop();
+    if (m_audioInput) {
+        m_audioInput->stop();
+        delete m_audioInput;
+    }
+    if (isOpen()) close();
+}
+
+qint64 AudioCaptureDevice::writeData(const char* data, qint64 len) {
+    // QAudioInput always writes complete frames:
+    const int bytesPerFrame = m_format.bytesPerFrame();
+    if (bytesPerFrame <= 0) return len;
+    const int frameCount = int(len / bytesPerFrame);
+    const char* ptr = data + m_format.sampleSize() * m_channelIndex / 8;
+    const bool is16Bit = m_format.sampleSize() <= 16;
+
+    for (int chunkStart = 0; chunkStart < frameCount; chunkStart += CONVERSION_CHUNK_SIZE) {
+        const int count = qMin(CONVERSION_CHUNK_SIZE, frameCount - chunkStart);
+        float* converted = m_convertedSamples.data();
+        if (is16Bit) {
+            for (int i=0; i<count; ++i) {
+                // interpret bytes as int16, convert to float and scale down to range [-1.0, 1.0]:
+                converted[i] = float(*reinterpret_cast<const int16_t*>(ptr)) / 32768;
+                ptr += bytesPerFrame;
+            }
+        } else {  // 24 bit
+            for (int i=0; i<count; ++i) {
+                // interpret bytes as int32, convert to float and scale down to range [-1.0, 1.0]:
+                converted[i] = float(*reinterpret_cast<const int32_t*>(ptr)) / 8388608;
+                ptr += bytesPerFrame;
+            }
+        }
+        m_analysisThread->pushSamples(converted, count);
+    }
+    return len;
+}
+
+void AudioCaptureDevice::generateClickTrack() {
+    const double elapsed = std::chrono::duration<double>(Clock::now() - m_clickTrackStart).count();
+    const qint64 dueSamples = qint64(elapsed * m_format.sampleRate());
+    const int maxSamples = m_clickTrackData.size() / int(sizeof(int16_t));
+    const int clickLength = int(CLICK_LENGTH * m_format.sampleRate());
+
+    while (m_generatedSamples < dueSamples) {
+        const int count = int(qMin(qint64(maxSamples), dueSamples - m_generatedSamples));
+        int16_t* pcm = reinterpret_cast<int16_t*>(m_clickTrackData.data());
+        for (int i=0; i<count; ++i) {
+            const int positionInInterval = int((m_generatedSamples + i) % m_clickIntervalSamples);
+            float value = 0.0f;
+            if (positionInInterval < clickLength) {
+                // short burst of decaying white noise (linear congruential generator):
+                m_noiseState = m_noiseState * 1664525u + 1013904223u;
+                const float noise = float(int32_t(m_noiseState)) / 2147483648.0f;
+                value = 0.8f * noise * (1.0f - float(positionInInterval) / clickLength);
+            }
+            pcm[i] = int16_t(value * 32767);
+        }
+        writeData(m_clickTrackData.constData(), count * qint64(sizeof(int16_t)));
+        m_generatedSamples += count;
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef AUDIOCAPTUREDEVICE_H
+#define AUDIOCAPTUREDEVICE_H
+
+#include <QIODevice>
+#include <QPointer>
+#include <QTimer>
+#include <QtMultimedia/QAudioInput>
+#include <QtMultimedia/QAudioFormat>
+
+#include <chrono>
+#include <vector>
+
+class AudioAnalysisThread;  // forward declaration
+
+
+/**
+ * @brief The AudioCaptureDevice class receives the raw audio data of a QAudioInput
+ * in its own thread and passes the samples of one channel to an AudioAnalysisThread.
+ *
+ * It is used as the target device of QAudioInput::start(QIODevice*), so the audio backend
+ * writes directly into it and the GUI thread is not involved. The samples are converted
+ * to float in a preallocated buffer and pushed into the lock-free ring buffer of the
+ * analysis thread.
+ *
+ * Instead of a QAudioInput, it can also generate a synthetic click track in real time
+ * to measure the latency of the onset detection (see setClickTrack()).
+ *
+ * The object must be moved to the capture thread and startCapture() and stopCapture()
+ * must be called in that thread.
+ */
+class AudioCaptureDevice : public QIODevice {
+
+    Q_OBJECT
+
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * @brief AudioCaptureDevice creates a capture device
+     * @param deviceInfo information about the audio input device
+     * @param format the format to record in
+     * @param channelIndex the index of the channel to analyze
+     * @param analysisThread the thread to pass the samples to
+     */
+    AudioCaptureDevice(const QAudioDeviceInfo& deviceInfo, const QAudioFormat& format,
+                       int channelIndex, AudioAnalysisThread* analysisThread);
+
+    /**
+     * @brief setClickTrack generates a click track instead of capturing the input device,
+     * must be called before startCapture()
+     * @param clickIntervalSamples samples between two clicks
+     * @param start the point in time the first sample belongs to
+     */
+    void setClickTrack(int clickIntervalSamples, Clock::time_point start);
+
+    /**
+     * @brief clickTrackFormat returns the format of the generated click track
+     * @return mono 16bit format
+     */
+    static QAudioFormat clickTrackFormat();
+
+public slots:
+    /**
+     * @brief startCapture starts the QAudioInput or the click track generator
+     * @return true if successful
+     */
+    bool startCapture();
+
+    /**
+     * @brief stopCapture stops and deletes the QAudioInput or the click track generator
+     */
+    void stopCapture();
+
+protected:
+    qint64 readData(char*, qint64) override { return -1; }
+    qint64 writeData(const char* data, qint64 len) override;
+
+private slots:
+    /**
+     * @brief generateClickTrack writes the click track samples that are due until now
+     */
+    void generateClickTrack();
+
+protected:
+    const QAudioDeviceInfo m_deviceInfo;  //!< the device to capture
+    const QAudioFormat m_format;  //!< the format to capture in
+    const int m_channelIndex;  //!< the index of the channel to analyze
+    AudioAnalysisThread* const m_analysisThread;  //!< the thread to pass the samples to
+    QPointer<QAudioInput> m_audioInput;  //!< the input created in startCapture()
+    std::vector<float> m_convertedSamples;  //!< preallocated buffer for the converted samples
+
+    int m_clickIntervalSamples;  //!< samples between two clicks or 0 if not generating a click track
+    Clock::time_point m_clickTrackStart;  //!< point in time of the first click track sample
+    qint64 m_generatedSamples;  //!< number of click track samples generated so far
+    quint32 m_noiseState;  //!< state of the random generator for the click sound
+    QByteArray m_clickTrackData;  //!< preallocated buffer for the generated PCM data
+    QTimer m_clickTrackTimer;  //!< timer to generate the click track in real time
+};
+
+#endif // AUDIOCAPTUREDEVICE_H
@@ -5,6 +5,7 @@
 #include "SpeechInputAnalyzer.h"
 
 #include <QDebug>
+#include <QTimer>
 
 
 AudioEngine::AudioEngine(MainController* controller)
@@ -91,7 +92,44 @@ double AudioEngine::getMaxLevelOfDevice(QString name) const {
     }
     AudioInputAnalyzer* inputAnalyzer = m_audioInputs[name];
     if (!inputAnalyzer) return 0.0;
-    return inputAnalyzer->getMaxLevel();
+    // (the peak level is available in all analysis tiers)
+    return inputAnalyzer->getPeakLevel();
+}
+
+QVariantMap AudioEngine::getAnalysisCost() const {
+    QVariantMap result;
+    double total = 0.0;
+    for (AudioInputAnalyzer* inputAnalyzer: m_audioInputs.values()) {
+        if (!inputAnalyzer) continue;
+        const double cost = inputAnalyzer->getAnalysisCost();
+        if (cost <= 0) continue;  // not analyzing
+        QVariantMap input;
+        input["tier"] = AudioInputAnalyzer::tierName(inputAnalyzer->getRequiredTier());
+        input["msPerSecond"] = cost;
+        QVariantMap tierCosts;
+        for (int tier = LevelTier; tier < AUDIO_ANALYSIS_TIER_COUNT; ++tier) {
+            tierCosts[AudioInputAnalyzer::tierName(tier)] = inputAnalyzer->getTierCost(tier);
+        }
+        input["tierMsPerSecond"] = tierCosts;
+        result[inputAnalyzer->getDeviceName()] = input;
+        total += cost;
+    }
+    result["totalMsPerSecond"] = total;
+    return result;
+}
+
+void AudioEngine::measureOnsetLatency() {
+    // a separate analyzer, so that the inputs used by blocks are not affected:
+    AudioInputAnalyzer* analyzer = new AudioInputAnalyzer(QAudioDeviceInfo(), 0, "Click Track", m_controller);
+    if (!analyzer->startClickTrack(120)) {
+        analyzer->deleteLater();
+        return;
+    }
+    qInfo() << "Measuring audio to onset latency with a 120 BPM click track for 10s...";
+    QTimer::singleShot(10000, analyzer, [analyzer]() {
+        analyzer->stopClickTrack();
+        analyzer->deleteLater();
+    });
 }
 
 QStringList AudioEngine::getOutputNameList() const {
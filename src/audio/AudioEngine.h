@@ -6,6 +6,7 @@
 #include <QObject>
 #include <QMap>
 #include <QPointer>
+#include <QVariant>
 
 // forward declarations:
 class MainController;
@@ -72,6 +73,19 @@ public slots:
      */
     double getMaxLevelOfDevice(QString name) const;
 
+    /**
+     * @brief getAnalysisCost returns the current processing time of all running
+     * AudioInputAnalyzers with the tier they run in and the cost of each tier
+     * @return a map with the analysis time per second of audio in ms for each input and in total
+     */
+    QVariantMap getAnalysisCost() const;
+
+    /**
+     * @brief measureOnsetLatency analyzes a generated click track for 10s
+     * and logs the latency between each click and its detected onset
+     */
+    void measureOnsetLatency();
+
     // --------------------- Outputs --------------------
 
     QStringList getOutputNameList() const;
@@ -1,8 +1,14 @@
 #include "AudioInputAnalyzer.h"
 
 #include "core/MainController.h"
+#include "AudioAnalysisThread.h"
+#include "AudioCaptureDevice.h"
+#include "AudioKernels.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
 
 // ------------------------------- Utility Functions for BPM Detection -------------------------------
 
@@ -30,18 +36,123 @@ constexpr int GLOBAL_MIN_BPM = 50;
 constexpr int GLOBAL_MAX_BPM = 300;
 
 
+// ------------------------------- Band Edges of the Simplified Spectrum -------------------------------
+
+/**
+ * @brief The SpectrumBand struct describes the range of FFT bins of one value of the simplified spectrum
+ */
+struct SpectrumBand {
+    bool useLongSpectrum;  //!< true for frequencies below 200 Hz
+    int startIndex;  //!< first bin in the raw spectrum
+    int count;  //!< number of bins (at least 1) or 0 if the band is not used
+};
+
+/**
+ * @brief createSpectrumBands calculates the bands of the simplified spectrum,
+ * logarithmically distributed between 10 Hz and 22050 Hz
+ * @param withLongSpectrum true to use the long spectrum for frequencies below 200 Hz
+ * @return a list of SIMPLIFIED_SPECTRUM_LENGTH bands
+ */
+static std::vector<SpectrumBand> createSpectrumBands(bool withLongSpectrum) {
+    const int beginFreq = 10;
+    const double factor = 1.061989883394314;  // pow(22050 / 10., 1/128.)
+    std::vector<SpectrumBand> result(SIMPLIFIED_SPECTRUM_LENGTH, SpectrumBand {false, 0, 0});
+    double freq = beginFreq;
+    for (std::size_t i=0; i<SIMPLIFIED_SPECTRUM_LENGTH; ++i) {
+        const double nextFreq = beginFreq * std::pow(factor, i+1);
+        const bool useLong = withLongSpectrum && freq < 200;
+        const std::size_t numSamples = useLong ? LONG_NUM_SAMPLES : SHORT_NUM_SAMPLES;
+        const std::size_t startIndex = freq / 22050 * (numSamples / 2);
+        const std::size_t endIndex = nextFreq / 22050 * (numSamples / 2);
+        if (endIndex < numSamples) {
+            // at least the bin at startIndex is used:
+            result[i] = SpectrumBand {useLong, int(startIndex), int(std::max(std::size_t(1), endIndex - startIndex))};
+        }
+        freq = nextFreq;
+    }
+    return result;
+}
+
+/**
+ * @brief simplifiedSpectrumBands returns the bands of the simplified spectrum, calculated on first use
+ * @param withLongSpectrum true for the bands of the SpectrumTier, false for the BandsTier
+ * that only uses the short spectrum
+ * @return a list of SIMPLIFIED_SPECTRUM_LENGTH bands
+ */
+static const std::vector<SpectrumBand>& simplifiedSpectrumBands(bool withLongSpectrum) {
+    static const std::vector<SpectrumBand> bandsWithLongSpectrum = createSpectrumBands(true);
+    static const std::vector<SpectrumBand> bandsWithShortSpectrum = createSpectrumBands(false);
+    return withLongSpectrum ? bandsWithLongSpectrum : bandsWithShortSpectrum;
+}
+
+/**
+ * @brief adjustedAgcGain changes a gain in small steps towards the gain required for a maximum value
+ * @param gain the current gain
+ * @param maxValue maximum of the last values
+ * @return the new gain
+ */
+static float adjustedAgcGain(float gain, float maxValue) {
+    // check if maxValue is below noise threshold:
+    if (maxValue < AGC_NOISE_THRESHOLD || maxValue <= 0) {
+        // do not change current gain
+        return gain;
+    }
+    // calculate required gain:
+    const float requiredGain = (1 - AGC_HEADROOM) / maxValue;
+    // adjust gain in small steps:
+    if (requiredGain < gain) {
+        return qMax(AGC_MIN_GAIN, qMax(requiredGain, gain - AGC_DECREMENT_STEPSIZE));
+    } else {
+        return qMin(AGC_MAX_GAIN, qMin(requiredGain, gain + AGC_INCREMENT_STEPSIZE));
+    }
+}
+
+
+// ---------------------------------- AudioAnalysisResult --------------------------------
+
+AudioAnalysisResult::AudioAnalysisResult()
+    : peakLevel(0.0)
+    , rmsLevel(0.0)
+    , levelAgcValue(1.0)
+    , simplifiedSpectrum(SIMPLIFIED_SPECTRUM_LENGTH)
+    , maxLevel(0.0)
+    , currentSpectralFlux(0.0)
+    , agcValue(1.0)
+    , spectralFluxAgcValue(1.0)
+    , spectralFluxHistory(SPECTRAL_FLUX_HISTORY_LENGTH)
+    , spectralColorHistory(SPECTRAL_FLUX_HISTORY_LENGTH, QColor(0, 0, 0))
+    , onsets(SPECTRAL_FLUX_HISTORY_LENGTH)
+    , detectedOnsets()
+    , bpm(120)
+    , lastBpmDetection()
+    , bpmEvaluationCount(0)
+    , hopCount(0)
+    , tier(LevelTier)
+    , stageTime()
+    , hopTime(0.0)
+{
+
+}
+
+
 // ---------------------------------- AudioInputAnalyzer --------------------------------
 
 AudioInputAnalyzer::AudioInputAnalyzer(QAudioDeviceInfo inputInfo, int channelIndex, QString name, MainController* controller)
     : QObject(controller)
     , m_controller(controller)
-    , m_referenceList()
+    , m_references()
     , m_audioInput(nullptr)
     , m_audioRecordDevice(nullptr)
     , m_deviceInfo(inputInfo)
     , m_deviceName(name)
     , m_channelIndex(channelIndex)
-    , m_analyzedTillIndex(0)
+    , m_captureThread()
+    , m_captureDevice(nullptr)
+    , m_analysisThread(new AudioAnalysisThread(this))
+    , m_results()
+    , m_lastFetchedHopCount(0)
+    , m_lastFetchedBpmEvaluationCount(0)
+    , m_newSpectrumCount(0)
     , m_circBuffer(CIRC_BUFFER_LENGTH)
     , m_longBuffer(LONG_NUM_SAMPLES)
     , m_longWindow(LONG_NUM_SAMPLES)
@@ -52,9 +163,11 @@ AudioInputAnalyzer::AudioInputAnalyzer(QAudioDeviceInfo inputInfo, int channelIn
     , m_lastShortFftOutput(SHORT_NUM_SAMPLES)
     , m_shortFftOutput(SHORT_NUM_SAMPLES)
     , m_shortSpectrum(SHORT_NUM_SAMPLES / 2)
-    , m_spectrumHistory(SPECTRUM_HISTORY_LENGTH)
-    , m_newSpectrumCount(0)
     , m_simplifiedSpectrum(SIMPLIFIED_SPECTRUM_LENGTH)
+    , m_peakLevel(0.0)
+    , m_rmsLevel(0.0)
+    , m_levelAgcValue(1.0)
+    , m_lastPeakLevels(AGC_AVERAGING_LENGTH)
     , m_maxLevel(0.0)
     , m_agcValue(1.0)
     , m_spectralFluxAgcValue(1.0)
@@ -63,25 +176,38 @@ AudioInputAnalyzer::AudioInputAnalyzer(QAudioDeviceInfo inputInfo, int channelIn
     , m_spectralFluxHistory(SPECTRAL_FLUX_HISTORY_LENGTH)
     , m_spectralColorHistory(SPECTRAL_FLUX_HISTORY_LENGTH)
     , m_spectralFluxNormalized(SPECTRAL_FLUX_HISTORY_LENGTH)
-    , m_currentSpectralFlux(0.0)
     , m_onsetBuffer(SPECTRAL_FLUX_HISTORY_LENGTH)
     , m_detectedOnsets()
     , m_bpm(120)
-    , m_callsSinceLastBpmUpdate(0)
+    , m_hopsSinceLastBpmUpdate(0)
     , m_lastBpmDetection()
-    , m_detectBpm(false)
+    , m_bpmEvaluationCount(0)
+    , m_hopCount(0)
+    , m_lastTier(LevelTier)
+    , m_requiredTier(LevelTier)
     , m_agents()
     , m_lastIntervals(INTERVALS_TO_STORE)
+    , m_clickTrackIntervalSamples(0)
+    , m_clickTrackStart()
+    , m_lastMeasuredOnsetHop(-1)
+    , m_measuredOnsetCount(0)
+    , m_falseOnsetCount(0)
+    , m_onsetLatencySum(0.0)
+    , m_onsetLatencyMax(0.0)
+    , m_detectionDelaySum(0.0)
+    , m_analysisTimeSum(0.0)
+    , m_analysisTimeMax(0.0)
+    , m_stageTimeSum()
+    , m_stageHopCount()
+    , m_recentHopTime(0.0)
     , m_isRecordingSpeech(false)
 {
-    m_circBuffer.fill(0.0, m_circBuffer.capacity());
-    m_spectralFluxHistory.fill(0.0, m_spectralFluxHistory.capacity());
-    m_spectralColorHistory.fill(0.0, m_spectralColorHistory.capacity());
     calculateWindows();
-    initAudio(inputInfo);
+    resetAnalysis();
 }
 
 AudioInputAnalyzer::~AudioInputAnalyzer() {
+    stopAnalysis();
     if (!m_audioInput.isNull()) {
         m_audioInput->stop();
         m_audioInput->deleteLater();
@@ -92,16 +218,24 @@ AudioInputAnalyzer::~AudioInputAnalyzer() {
 AudioInputAnalyzer::AudioInputAnalyzer(QString name, MainController* controller)
     : QObject(controller)
     , m_controller(controller)
-    , m_referenceList()
+    , m_references()
     , m_audioInput(nullptr)
     , m_audioRecordDevice(nullptr)
     , m_deviceName(name)
     , m_channelIndex(0)
-    , m_analyzedTillIndex(0)
-    , m_circBuffer(0)
-    , m_spectrumHistory(SPECTRUM_HISTORY_LENGTH)
+    , m_captureThread()
+    , m_captureDevice(nullptr)
+    , m_analysisThread(nullptr)
+    , m_results()
+    , m_lastFetchedHopCount(0)
+    , m_lastFetchedBpmEvaluationCount(0)
     , m_newSpectrumCount(0)
+    , m_circBuffer(0)
     , m_simplifiedSpectrum(SIMPLIFIED_SPECTRUM_LENGTH)
+    , m_peakLevel(0.0)
+    , m_rmsLevel(0.0)
+    , m_levelAgcValue(1.0)
+    , m_lastPeakLevels(AGC_AVERAGING_LENGTH)
     , m_maxLevel(0.0)
     , m_agcValue(1.0)
     , m_spectralFluxAgcValue(1.0)
@@ -110,86 +244,76 @@ AudioInputAnalyzer::AudioInputAnalyzer(QString name, MainController* controller)
     , m_spectralFluxHistory(SPECTRAL_FLUX_HISTORY_LENGTH)
     , m_spectralColorHistory(SPECTRAL_FLUX_HISTORY_LENGTH)
     , m_spectralFluxNormalized(SPECTRAL_FLUX_HISTORY_LENGTH)
-    , m_currentSpectralFlux(0.0)
     , m_onsetBuffer(SPECTRAL_FLUX_HISTORY_LENGTH)
     , m_detectedOnsets()
     , m_bpm(0)
-    , m_callsSinceLastBpmUpdate(0)
+    , m_hopsSinceLastBpmUpdate(0)
     , m_lastBpmDetection(HighResTime::now())
-    , m_detectBpm(false)
+    , m_bpmEvaluationCount(0)
+    , m_hopCount(0)
+    , m_lastTier(LevelTier)
+    , m_requiredTier(LevelTier)
     , m_agents()
     , m_lastIntervals(INTERVALS_TO_STORE)
+    , m_clickTrackIntervalSamples(0)
+    , m_clickTrackStart()
+    , m_lastMeasuredOnsetHop(-1)
+    , m_measuredOnsetCount(0)
+    , m_falseOnsetCount(0)
+    , m_onsetLatencySum(0.0)
+    , m_onsetLatencyMax(0.0)
+    , m_detectionDelaySum(0.0)
+    , m_analysisTimeSum(0.0)
+    , m_analysisTimeMax(0.0)
+    , m_stageTimeSum()
+    , m_stageHopCount()
+    , m_recentHopTime(0.0)
     , m_isRecordingSpeech(false)
 {
 
 }
 
-void AudioInputAnalyzer::addReference(void* ref) {
-    if (m_referenceList.isEmpty()) {
+void AudioInputAnalyzer::addReference(void* ref, AudioAnalysisTier tier) {
+    const bool isFirstReference = m_references.isEmpty();
+    m_references.insert(ref, tier);
+    // set before the analysis is started, the analysis thread
+    // picks up changes in the next hop:
+    updateRequiredTier();
+    if (isFirstReference) {
         // this is the first registered object
-        // start audio capture to m_audioRecordDevice:
-        m_circBuffer.fill(0.0, m_circBuffer.capacity());
-        m_spectralFluxHistory.fill(0.0, m_spectralFluxHistory.capacity());
-        m_spectralColorHistory.fill(0.0, m_spectralColorHistory.capacity());
-        createAudioInputForMusic();
-        if (!m_audioInput) return;
-        if (m_audioInput->volume() < 1.0) m_audioInput->setVolume(1.0);
-        m_audioRecordDevice = m_audioInput->start();
-        if (!m_audioRecordDevice) {
-            qCritical() << "Could not start audio capture.";
-            qCritical() << m_audioInput->error();
+        // start audio capture and analysis:
+        if (!startAnalysis()) {
+            m_references.remove(ref);
             return;
-        } else {
-            connect(m_audioRecordDevice, SIGNAL(readyRead()), this, SLOT(audioDataReady()));
-            connect(m_controller->engine(), SIGNAL(updateBlocks(double)), this, SLOT(updateSpectrum()));
         }
+        connect(m_controller->engine(), SIGNAL(updateBlocks(double)), this, SLOT(updateSpectrum()));
     }
-    m_referenceList.insert(ref);
 }
 
 void AudioInputAnalyzer::removeReference(void* ref) {
-    m_referenceList.remove(ref);
-    if (m_referenceList.isEmpty()) {
+    if (!m_references.contains(ref)) return;
+    m_references.remove(ref);
+    updateRequiredTier();
+    if (m_references.isEmpty()) {
         // this was the last registered object
-        if (m_audioRecordDevice) {
-            disconnect(m_audioRecordDevice, SIGNAL(readyRead()), this, SLOT(audioDataReady()));
-            disconnect(m_controller->engine(), SIGNAL(updateBlocks(double)), this, SLOT(updateSpectrum()));
-        }
-        if (m_audioInput) {
-            m_audioInput->stop();
-            m_audioInput->deleteLater();
-            m_audioInput = nullptr;
-            m_audioRecordDevice = nullptr;  // is deleted by QAudioInput
-        }
-    }
-}
-
-void AudioInputAnalyzer::addReferenceForBpm(void* ref) {
-    if (m_bpmReferenceList.isEmpty()) {
-        // this is the first registered object for BPM
-        m_detectBpm = true;
+        disconnect(m_controller->engine(), SIGNAL(updateBlocks(double)), this, SLOT(updateSpectrum()));
+        stopAnalysis();
     }
-    addReference(ref);
-    m_bpmReferenceList.insert(ref);
-    m_detectBpm = !m_bpmReferenceList.isEmpty();
 }
 
-void AudioInputAnalyzer::removeReferenceForBpm(void* ref) {
-    removeReference(ref);
-    m_bpmReferenceList.remove(ref);
-    if (m_bpmReferenceList.isEmpty()) {
-        // this was the last registered object for BPM
-        m_detectBpm = false;
-        m_spectralColorHistory.fill(QColor(0, 0, 0));
+void AudioInputAnalyzer::updateRequiredTier() {
+    int requiredTier = LevelTier;
+    for (AudioAnalysisTier tier: m_references) {
+        requiredTier = qMax(requiredTier, int(tier));
     }
-    m_detectBpm = !m_bpmReferenceList.isEmpty();
+    m_requiredTier = requiredTier;
 }
 
 void AudioInputAnalyzer::startSpeechRecording() {
     m_speechBuffer.clear();
     m_speechBufferPart.clear();
 
-    if (!m_referenceList.isEmpty()) {
+    if (!m_references.isEmpty() || m_captureDevice) {
         qWarning() << "Can't record speech using this input because it is used for auido analysis.";
         return;
     }
@@ -227,8 +351,126 @@ const QByteArray& AudioInputAnalyzer::stopSpeechRecording() {
     return m_speechBuffer;
 }
 
+bool AudioInputAnalyzer::startClickTrack(double bpm) {
+    if (!m_references.isEmpty() || m_isRecordingSpeech) {
+        qWarning() << "Can't analyze a click track using this input because it is in use.";
+        return false;
+    }
+    m_requiredTier = BpmTier;
+    const int clickIntervalSamples = int(AUDIO_SAMPLING_RATE * 60 / bpm);
+    if (!startAnalysis(clickIntervalSamples)) return false;
+    connect(m_controller->engine(), SIGNAL(updateBlocks(double)), this, SLOT(updateSpectrum()));
+    return true;
+}
+
+QVariantMap AudioInputAnalyzer::stopClickTrack() {
+    disconnect(m_controller->engine(), SIGNAL(updateBlocks(double)), this, SLOT(updateSpectrum()));
+    stopAnalysis();
+    m_requiredTier = LevelTier;
+
+    // the analysis thread is finished, so its statistics can be read here:
+    const double clicks = double(m_hopCount) * SAMPLES_BETWEEN_SPECTRUM_UPDATES / m_clickTrackIntervalSamples;
+    const int onsets = qMax(1, m_measuredOnsetCount);
+    QVariantMap result;
+    result["clicks"] = int(clicks);
+    result["detectedOnsets"] = m_measuredOnsetCount;
+    result["falseOnsets"] = m_falseOnsetCount;
+    result["latencyAvgMs"] = m_onsetLatencySum / onsets * 1000;
+    result["latencyMaxMs"] = m_onsetLatencyMax * 1000;
+    result["detectionDelayAvgMs"] = m_detectionDelaySum / onsets * 1000;
+    result["analysisTimeAvgMs"] = m_analysisTimeSum / qMax(quint64(1), m_hopCount) * 1000;
+    result["analysisTimeMaxMs"] = m_analysisTimeMax * 1000;
+    result["droppedSamples"] = m_analysisThread ? m_analysisThread->getDroppedSampleCount() : 0;
+    result["bpm"] = m_bpm;
+    m_clickTrackIntervalSamples = 0;
+
+    qInfo() << "Click track onset latency:" << result["detectedOnsets"].toInt() << "of" << result["clicks"].toInt()
+            << "clicks detected," << result["falseOnsets"].toInt() << "false onsets";
+    qInfo() << "Audio to onset: avg" << result["latencyAvgMs"].toDouble() << "ms, max"
+            << result["latencyMaxMs"].toDouble() << "ms (detection delay"
+            << result["detectionDelayAvgMs"].toDouble() << "ms)";
+    qInfo() << "Analysis per hop: avg" << result["analysisTimeAvgMs"].toDouble() << "ms, max"
+            << result["analysisTimeMaxMs"].toDouble() << "ms, detected BPM:" << m_bpm
+            << ", dropped samples:" << result["droppedSamples"].toInt();
+    return result;
+}
+
+QVariantMap AudioInputAnalyzer::benchmarkAnalysis(MainController* controller) {
+    const int seconds = 10;
+    const int hops = seconds * SPECTRUM_UPDATE_RATE;
+
+    // music-like test signal: two tones, noise and a kick every 500ms (120 BPM):
+    std::vector<float> samples(std::size_t(hops) * SAMPLES_BETWEEN_SPECTRUM_UPDATES);
+    for (std::size_t i=0; i<samples.size(); ++i) {
+        const double t = double(i) / AUDIO_SAMPLING_RATE;
+        const double kickPosition = std::fmod(t, 0.5);
+        const double kick = kickPosition < 0.05 ? std::sin(2 * M_PI * 60 * t) * (1 - kickPosition / 0.05) : 0.0;
+        const double noise = (qrand() % 2000 - 1000) / 1000.0;
+        samples[i] = float(0.2 * std::sin(2 * M_PI * 440 * t) + 0.1 * std::sin(2 * M_PI * 3000 * t)
+                           + 0.05 * noise + 0.6 * kick);
+    }
+
+    // an analyzer without a device, its analysis thread is not started
+    // and analyzeHop() is called directly:
+    AudioInputAnalyzer analyzer(QAudioDeviceInfo(), 0, "Benchmark", controller);
+    QVariantMap result;
+    for (int tier = LevelTier; tier < AUDIO_ANALYSIS_TIER_COUNT; ++tier) {
+        analyzer.resetAnalysis();
+        analyzer.m_requiredTier = tier;
+        QElapsedTimer timer;
+        timer.start();
+        for (int hop = 0; hop < hops; ++hop) {
+            analyzer.analyzeHop(samples.data() + std::size_t(hop) * SAMPLES_BETWEEN_SPECTRUM_UPDATES);
+        }
+        const double msPerSecond = double(timer.nsecsElapsed()) / 1000000.0 / seconds;
+        const QString key = tierName(tier).toLower();
+        result[key + "MsPerSecond"] = msPerSecond;
+        result[key + "MaxHopMs"] = analyzer.m_analysisTimeMax * 1000;
+        qInfo() << "Audio analysis tier" << tierName(tier) << ":" << msPerSecond
+                << "ms per second of audio (max" << analyzer.m_analysisTimeMax * 1000 << "ms per hop)";
+    }
+    qInfo() << "Detected BPM of test signal:" << analyzer.m_bpm;
+    result["kernels"] = AudioKernels::benchmark();
+    return result;
+}
+
 float AudioInputAnalyzer::getLevelAtBand(double band) const {
-    return m_simplifiedSpectrum[band * (m_simplifiedSpectrum.size() - 1)];
+    const std::vector<double>& spectrum = getSimplifiedSpectrum();
+    return spectrum[band * (spectrum.size() - 1)];
+}
+
+double AudioInputAnalyzer::getTierCost(int tier) const {
+    const AudioAnalysisResult& result = m_results.readBuffer();
+    // a tier includes all stages below it:
+    double time = 0.0;
+    for (int stage = LevelTier; stage <= tier && stage < AUDIO_ANALYSIS_TIER_COUNT; ++stage) {
+        time += result.stageTime[stage];
+    }
+    return time * SPECTRUM_UPDATE_RATE * 1000;
+}
+
+double AudioInputAnalyzer::getAnalysisCost() const {
+    return m_results.readBuffer().hopTime * SPECTRUM_UPDATE_RATE * 1000;
+}
+
+QString AudioInputAnalyzer::tierName(int tier) {
+    switch (tier) {
+    case LevelTier: return "Level";
+    case BandsTier: return "Bands";
+    case SpectrumTier: return "Spectrum";
+    case BpmTier: return "BPM";
+    default: return "Unknown";
+    }
+}
+
+double AudioInputAnalyzer::longSpectrumBoundary() {
+    const std::vector<SpectrumBand>& bands = simplifiedSpectrumBands(true);
+    for (std::size_t i=0; i<bands.size(); ++i) {
+        if (!bands[i].useLongSpectrum) {
+            return double(i) / SIMPLIFIED_SPECTRUM_LENGTH;
+        }
+    }
+    return 1.0;
 }
 
 void AudioInputAnalyzer::calculateWindows() {
@@ -241,20 +483,82 @@ void AudioInputAnalyzer::calculateWindows() {
     }
 }
 
-void AudioInputAnalyzer::initAudio(QAudioDeviceInfo info) {
-    // fill circular buffer with zeros:
-    for (int i=0; i < m_circBuffer.capacity(); ++i) {
-        m_circBuffer.push_back(0.0);
-    }
+void AudioInputAnalyzer::resetAnalysis() {
+    // fill circular buffers with zeros:
+    m_circBuffer.fill(0.0, m_circBuffer.capacity());
+    m_spectralFluxHistory.fill(0.0, m_spectralFluxHistory.capacity());
+    m_spectralColorHistory.fill(QColor(0, 0, 0), m_spectralColorHistory.capacity());
+    std::fill(m_lastShortFftOutput.begin(), m_lastShortFftOutput.end(), 0.0f);
+    std::fill(m_simplifiedSpectrum.begin(), m_simplifiedSpectrum.end(), 0.0);
+    m_onsetBuffer.fill(false);
+    m_detectedOnsets.clear();
+    m_peakLevel = 0.0;
+    m_rmsLevel = 0.0;
+    m_maxLevel = 0.0;
+    m_hopsSinceLastBpmUpdate = 0;
+    m_hopCount = 0;
+    m_lastTier = LevelTier;
+
+    m_lastMeasuredOnsetHop = -1;
+    m_measuredOnsetCount = 0;
+    m_falseOnsetCount = 0;
+    m_onsetLatencySum = 0.0;
+    m_onsetLatencyMax = 0.0;
+    m_detectionDelaySum = 0.0;
+    m_analysisTimeSum = 0.0;
+    m_analysisTimeMax = 0.0;
+
+    std::fill(m_stageTimeSum, m_stageTimeSum + AUDIO_ANALYSIS_TIER_COUNT, 0.0);
+    std::fill(m_stageHopCount, m_stageHopCount + AUDIO_ANALYSIS_TIER_COUNT, quint64(0));
+    m_recentHopTime = 0.0;
+}
+
+bool AudioInputAnalyzer::startAnalysis(int clickTrackIntervalSamples) {
+    if (!m_analysisThread || m_captureDevice) return false;
+
+    // the analysis thread is not running, so its state can be modified here:
+    resetAnalysis();
+    m_clickTrackIntervalSamples = clickTrackIntervalSamples;
+    m_clickTrackStart = std::chrono::steady_clock::now();
 
+    if (clickTrackIntervalSamples > 0) {
+        m_captureDevice = new AudioCaptureDevice(m_deviceInfo, AudioCaptureDevice::clickTrackFormat(), 0, m_analysisThread);
+        m_captureDevice->setClickTrack(clickTrackIntervalSamples, m_clickTrackStart);
+    } else {
+        m_audioFormat = createAudioFormatForMusic();
+        m_captureDevice = new AudioCaptureDevice(m_deviceInfo, m_audioFormat, m_channelIndex, m_analysisThread);
+    }
+    m_analysisThread->startAnalysis();
+
+    // the capture device lives in its own thread, so that the audio backend
+    // can write to it even if the GUI thread is busy:
+    m_captureDevice->moveToThread(&m_captureThread);
+    m_captureThread.start(QThread::TimeCriticalPriority);
+    bool started = false;
+    QMetaObject::invokeMethod(m_captureDevice, "startCapture", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(bool, started));
+    if (!started) {
+        stopAnalysis();
+        return false;
+    }
+    return true;
 }
 
-void AudioInputAnalyzer::createAudioInputForMusic() {
-    if (m_audioInput) {
-        m_audioInput->deleteLater();
-        m_audioInput = nullptr;
+void AudioInputAnalyzer::stopAnalysis() {
+    if (m_captureDevice) {
+        QMetaObject::invokeMethod(m_captureDevice, "stopCapture", Qt::BlockingQueuedConnection);
+        m_captureThread.quit();
+        m_captureThread.wait();
+        // the capture thread is finished, so the device can be deleted here:
+        delete m_captureDevice;
+        m_captureDevice = nullptr;
     }
+    if (m_analysisThread) {
+        m_analysisThread->stopAnalysis();
+    }
+}
 
+QAudioFormat AudioInputAnalyzer::createAudioFormatForMusic() const {
     // Set up the desired audio input format:
     QAudioFormat format;
     format.setSampleRate(AUDIO_SAMPLING_RATE);
@@ -270,14 +574,7 @@ void AudioInputAnalyzer::createAudioInputForMusic() {
         qWarning() << "Default audio format not supported, trying to use the nearest.";
         format = m_deviceInfo.nearestFormat(format);
     }
-    m_audioFormat = format;
-
-    // create a QAudioInput object:
-    m_audioInput = new QAudioInput(m_deviceInfo, format);
-    if (!m_audioInput) {
-        qCritical() << "Could not open audio device.";
-        return;
-    }
+    return format;
 }
 
 void AudioInputAnalyzer::createAudioInputForSpeech() {
@@ -314,7 +611,6 @@ void AudioInputAnalyzer::createAudioInputForSpeech() {
 void AudioInputAnalyzer::setBpm(float value) {
     m_bpm = value;
     m_lastBpmDetection = HighResTime::now();
-    emit bpmChanged();
 }
 
 float AudioInputAnalyzer::bpmInRange(float bpm, const int minBPM) {
@@ -338,54 +634,19 @@ float AudioInputAnalyzer::bpmInRange(float bpm, const int minBPM) {
 }
 
 void AudioInputAnalyzer::updateSpectrum() {
-    if (m_spectrumHistory.isEmpty()) return;
-    m_newSpectrumCount = qMax(0, m_newSpectrumCount - 1);
-    int currentIndex = qMax(0, m_spectrumHistory.size() - 1 - m_newSpectrumCount);
-    m_simplifiedSpectrum = m_spectrumHistory[currentIndex];
-    int fluxIndex = qMax(0, m_spectralFluxHistory.size() - 1 - m_newSpectrumCount);
-    m_currentSpectralFlux = m_spectralFluxHistory[fluxIndex];
+    if (!m_results.fetch()) return;
+    const AudioAnalysisResult& result = m_results.readBuffer();
+    // (hopCount starts at 0 again when the analysis is restarted)
+    m_newSpectrumCount = int(result.hopCount - qMin(result.hopCount, m_lastFetchedHopCount));
+    m_lastFetchedHopCount = result.hopCount;
     emit spectrumChanged();
-}
-
-void AudioInputAnalyzer::audioDataReady() {
-    if (!m_audioRecordDevice) return;
-    // read data from input as QByteArray:
-    QByteArray data = m_audioRecordDevice->readAll();
-    const int bytesPerSample = m_audioFormat.bytesPerFrame();
-    const int numSamples = data.size() / bytesPerSample;
-    const char *ptr = data.constData();
-    ptr += m_audioFormat.sampleSize() * m_channelIndex / 8;
-
-    if (m_audioFormat.sampleSize() <= 16) {  // 16 bit
-
-        // iterate over raw input data:
-        for (int i=0; i<numSamples; ++i) {
-            // interpret byte in QByteArray as int16:
-            const int16_t pcmSample = *reinterpret_cast<const int16_t*>(ptr);
-            // convert to float and scale down to range [-1.0, 1.0]:
-            const float scaled = float(pcmSample) / 32768;
-            // push to circular buffer:
-            m_circBuffer.push_back(scaled);
-            ptr += bytesPerSample;
-        }
-
-    } else { // 24 bit
-
-        // iterate over raw input data:
-        for (int i=0; i<numSamples; ++i) {
-            // interpret byte in QByteArray as int32:
-            const int32_t pcmSample = *reinterpret_cast<const int32_t*>(ptr);
-            // convert to float and scale down to range [-1.0, 1.0]:
-            const float scaled = float(pcmSample) / 8388608;
-            // push to circular buffer:
-            m_circBuffer.push_back(scaled);
-            ptr += bytesPerSample;
-        }
+    if (result.tier >= BpmTier) {
+        emit spectralFluxHistoryChanged();
+    }
+    if (result.bpmEvaluationCount != m_lastFetchedBpmEvaluationCount) {
+        m_lastFetchedBpmEvaluationCount = result.bpmEvaluationCount;
+        emit bpmChanged();
     }
-
-    m_analyzedTillIndex = qMax(0, m_analyzedTillIndex - numSamples);
-
-    analyzeNewSamples();
 }
 
 void AudioInputAnalyzer::speechDataReady() {
@@ -400,199 +661,273 @@ void AudioInputAnalyzer::speechDataReady() {
     }
 }
 
-void AudioInputAnalyzer::analyzeNewSamples() {
-    m_newSpectrumCount = 0;
-    while (CIRC_BUFFER_LENGTH - m_analyzedTillIndex >= SAMPLES_BETWEEN_SPECTRUM_UPDATES) {
-        createSpectrumTillIndex(m_analyzedTillIndex + SAMPLES_BETWEEN_SPECTRUM_UPDATES);
+void AudioInputAnalyzer::analyzeHop(const float* samples) {
+    typedef std::chrono::steady_clock Clock;
+    const auto startTime = Clock::now();
+
+    // append the new samples to the circular buffer, the oldest ones are overwritten:
+    for (int i=0; i<SAMPLES_BETWEEN_SPECTRUM_UPDATES; ++i) {
+        m_circBuffer.push_back(samples[i]);
+    }
+    ++m_hopCount;
+
+    const AudioAnalysisTier tier = AudioAnalysisTier(m_requiredTier.load());
+    if (tier != m_lastTier) {
+        changeTier(tier);
+    }
+
+    // each stage is timed separately to know the cost of each tier:
+    auto stageStart = startTime;
+    auto finishStage = [this, &stageStart](AudioAnalysisTier stage) {
+        const auto now = Clock::now();
+        m_stageTimeSum[stage] += std::chrono::duration<double>(now - stageStart).count();
+        ++m_stageHopCount[stage];
+        stageStart = now;
+    };
+
+    updateLevel(samples);
+    finishStage(LevelTier);
+
+    if (tier >= SpectrumTier) {
+        updateLongSpectrum();
+        finishStage(SpectrumTier);
+    }
 
-        m_analyzedTillIndex += SAMPLES_BETWEEN_SPECTRUM_UPDATES;
+    if (tier >= BandsTier) {
+        updateShortSpectrum();
+        createSimplifiedSpectrumFromRawSpectrums(tier >= SpectrumTier);
+        finishStage(BandsTier);
     }
 
     // ----------------- BPM Detection Steps --------------
 
-    if (!m_detectBpm) return;
+    if (tier >= BpmTier) {
+        updateSpectralColor();
+        updateOnsets();
+        if (m_clickTrackIntervalSamples > 0) {
+            measureOnsetLatency();
+        }
+
+        // Use a counter to only perform the tempo detection calculations every n hops, because they are expensive
+        m_hopsSinceLastBpmUpdate++;
+        if (m_hopsSinceLastBpmUpdate >= HOPS_TO_WAIT_FOR_BPM) {
+            m_hopsSinceLastBpmUpdate = 0;
+            // Retrieve a set of clusters that group similar and related inter offset intervals
+            updateAgents();
+
+            // Find the highest scored cluster and declare it the bpm
+            evaluateAgents();
+        }
+        finishStage(BpmTier);
+    }
+
+    const double analysisTime = std::chrono::duration<double>(Clock::now() - startTime).count();
+    m_analysisTimeSum += analysisTime;
+    m_analysisTimeMax = std::max(m_analysisTimeMax, analysisTime);
+    // moving average of about the last second:
+    m_recentHopTime += (analysisTime - m_recentHopTime) / SPECTRUM_UPDATE_RATE;
+
+    publishResults();
+}
+
+void AudioInputAnalyzer::publishResults() {
+    AudioAnalysisResult& result = m_results.writeBuffer();
+
+    result.peakLevel = m_peakLevel;
+    result.rmsLevel = m_rmsLevel;
+    result.levelAgcValue = m_levelAgcValue;
+
+    // the vectors have a fixed size, so copying the elements doesn't allocate:
+    std::copy(m_simplifiedSpectrum.begin(), m_simplifiedSpectrum.end(), result.simplifiedSpectrum.begin());
+    result.maxLevel = m_maxLevel;
+    result.currentSpectralFlux = m_spectralFluxHistory.last();
+    result.agcValue = m_agcValue;
+    result.spectralFluxAgcValue = m_spectralFluxAgcValue;
 
-    updateOnsets();
-    emit spectralFluxHistoryChanged();
+    for (int i=0; i < SPECTRAL_FLUX_HISTORY_LENGTH; ++i) {
+        result.spectralFluxHistory[i] = m_spectralFluxHistory[i];
+        result.spectralColorHistory[i] = m_spectralColorHistory[i];
+        result.onsets[i] = m_onsetBuffer[i];
+    }
+    result.detectedOnsets.resize(m_detectedOnsets.size());
+    std::copy(m_detectedOnsets.constBegin(), m_detectedOnsets.constEnd(), result.detectedOnsets.begin());
 
-    // Use a counter to only perform the tempo detection calculations every n times, because they are expensive
-    m_callsSinceLastBpmUpdate++;
-    if (m_callsSinceLastBpmUpdate >= CALLS_TO_WAIT_FOR_BPM) {
-        m_callsSinceLastBpmUpdate = 0;
-        // Retrieve a set of clusters that group similar and related inter offset intervals
-        updateAgents();
+    result.bpm = m_bpm;
+    result.lastBpmDetection = m_lastBpmDetection;
+    result.bpmEvaluationCount = m_bpmEvaluationCount;
+    result.hopCount = m_hopCount;
 
-        // Find the highest scored cluster and declare it the bpm
-        evaluateAgents();
+    result.tier = m_lastTier;
+    for (int stage = 0; stage < AUDIO_ANALYSIS_TIER_COUNT; ++stage) {
+        result.stageTime[stage] = m_stageTimeSum[stage] / qMax(quint64(1), m_stageHopCount[stage]);
     }
+    result.hopTime = m_recentHopTime;
+
+    m_results.publish();
 }
 
-void AudioInputAnalyzer::createSpectrumTillIndex(std::size_t endIndex) {
-    if (endIndex < LONG_NUM_SAMPLES) return;
-    updateRawSpectrumsTillIndex(endIndex);
-    createSimplifiedSpectrumFromRawSpectrums();
+void AudioInputAnalyzer::updateLevel(const float* samples) {
+    AudioKernels::level(samples, SAMPLES_BETWEEN_SPECTRUM_UPDATES, m_peakLevel, m_rmsLevel);
+    m_peakLevel = limit(0.0f, m_peakLevel, 1.0f);
+    m_rmsLevel = limit(0.0f, m_rmsLevel, 1.0f);
+
+    // ----- Automatic Gain Control:
+    m_lastPeakLevels.push_back(m_peakLevel);
+    float maxValue = 0.0;
+    for (int i=0; i<m_lastPeakLevels.size(); ++i) {
+        maxValue = qMax(maxValue, m_lastPeakLevels[i]);
+    }
+    m_levelAgcValue = adjustedAgcGain(m_levelAgcValue, maxValue);
 }
 
-void AudioInputAnalyzer::updateRawSpectrumsTillIndex(std::size_t endIndex) {
-    // -------- Long for low frequencies:
+void AudioInputAnalyzer::changeTier(AudioAnalysisTier tier) {
+    // the results of stages that are not run anymore would be outdated:
+    if (tier < BpmTier && m_lastTier >= BpmTier) {
+        m_spectralColorHistory.fill(QColor(0, 0, 0));
+        m_onsetBuffer.fill(false);
+        m_detectedOnsets.clear();
+    }
+    if (tier < BandsTier && m_lastTier >= BandsTier) {
+        std::fill(m_simplifiedSpectrum.begin(), m_simplifiedSpectrum.end(), 0.0);
+        std::fill(m_lastShortFftOutput.begin(), m_lastShortFftOutput.end(), 0.0f);
+        m_spectralFluxHistory.fill(0.0);
+        m_maxLevel = 0.0;
+    }
+    m_lastTier = tier;
+}
 
-    // copy data from circular buffer to m_longBuffer and apply window:
-    for (std::size_t i=0; i < LONG_NUM_SAMPLES; ++i) {
-        m_longBuffer[i] = m_circBuffer[(endIndex - LONG_NUM_SAMPLES) + i] * m_longWindow[i];
+void AudioInputAnalyzer::measureOnsetLatency() {
+    // find the newest onset:
+    int newestOnsetIndex = -1;
+    for (int i = SPECTRAL_FLUX_HISTORY_LENGTH - 1; i >= 0; --i) {
+        if (m_onsetBuffer[i]) {
+            newestOnsetIndex = i;
+            break;
+        }
     }
+    if (newestOnsetIndex < 0) return;
+
+    // the last value in the history belongs to the hop m_hopCount - 1:
+    const qint64 onsetHop = qint64(m_hopCount) - SPECTRAL_FLUX_HISTORY_LENGTH + newestOnsetIndex;
+    if (onsetHop <= m_lastMeasuredOnsetHop) return;
+    m_lastMeasuredOnsetHop = onsetHop;
+
+    // the spectral flux of a hop is calculated from the window that ends after this hop,
+    // find the click that is closest to this point:
+    const qint64 onsetEndSample = (onsetHop + 1) * SAMPLES_BETWEEN_SPECTRUM_UPDATES;
+    const qint64 clickIndex = (onsetEndSample - SAMPLES_BETWEEN_SPECTRUM_UPDATES / 2) / m_clickTrackIntervalSamples;
+    const qint64 clickSample = clickIndex * m_clickTrackIntervalSamples;
+    if (onsetEndSample - clickSample > m_clickTrackIntervalSamples / 4) {
+        ++m_falseOnsetCount;
+        return;
+    }
+
+    // the click track is generated in real time, so the click was captured at this time:
+    const auto clickTime = m_clickTrackStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(double(clickSample) / AUDIO_SAMPLING_RATE));
+    const double latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - clickTime).count();
+    // the audio after the click that had to be analyzed to detect the onset:
+    const double detectionDelay = double(qint64(m_hopCount) * SAMPLES_BETWEEN_SPECTRUM_UPDATES - clickSample) / AUDIO_SAMPLING_RATE;
+
+    ++m_measuredOnsetCount;
+    m_onsetLatencySum += latency;
+    m_onsetLatencyMax = std::max(m_onsetLatencyMax, latency);
+    m_detectionDelaySum += detectionDelay;
+}
+
+void AudioInputAnalyzer::copyWindowedSamples(const std::vector<float>& window, float* out) const {
+    const int count = int(window.size());
+    const auto first = m_circBuffer.constDataOne();
+    const auto second = m_circBuffer.constDataTwo();
+    // number of older samples that are not part of the window:
+    const int skip = first.second + second.second - count;
+    if (skip < first.second) {
+        const int firstCount = first.second - skip;
+        AudioKernels::multiply(first.first + skip, window.data(), out, firstCount);
+        AudioKernels::multiply(second.first, window.data() + firstCount, out + firstCount, count - firstCount);
+    } else {
+        AudioKernels::multiply(second.first + (skip - first.second), window.data(), out, count);
+    }
+}
+
+void AudioInputAnalyzer::updateLongSpectrum() {
+    // -------- Long for low frequencies:
+
+    // copy the last samples from circular buffer to m_longBuffer and apply window:
+    copyWindowedSamples(m_longWindow, m_longBuffer.data());
     // apply FFT to m_longBuffer and write result to m_longFftOutput:
     m_longFftreal.do_fft(m_longFftOutput.data(), m_longBuffer.data());
 
-    // iterate over FFT result:
-    for (std::size_t i=0; i < LONG_NUM_SAMPLES / 2; ++i) {
-        // calculate magnitude for each FFT bin:
-        const float real = m_longFftOutput[i];
-        const float img = m_longFftOutput[LONG_NUM_SAMPLES / 2 + i];
-        //const float magnitudeInDb = 4.342f * std::log10(real*real + img*img);  // simplified from 20*log10(sqrt(r*r+i*i)) -> dB of Magnitude
-        //const float magnitude = std::pow(real*real + img*img, 0.2) / 14;  // 14 is most of the time the max value
-        const float magnitude = std::pow(real*real + img*img, 0.3f) / 60;  // 40 is most of the time the max value
-        // write normalized magnitude to m_longSpectrum:
-        m_longSpectrum[i] = std::max(0.0f, std::min(magnitude, 1.0f));
-    }
+    // calculate normalized magnitude for each FFT bin and write it to m_longSpectrum
+    // (60 is most of the time the max value):
+    AudioKernels::compressedMagnitudes(m_longFftOutput.data(), m_longFftOutput.data() + LONG_NUM_SAMPLES / 2,
+                                       m_longSpectrum.data(), 1.0f / 60, LONG_NUM_SAMPLES / 2);
+}
 
+void AudioInputAnalyzer::updateShortSpectrum() {
     // -------- Short for high frequencies:
 
-    // copy data from circular buffer to m_shortBuffer and apply window:
-    for (std::size_t i=0; i < SHORT_NUM_SAMPLES; ++i) {
-        m_shortBuffer[i] = m_circBuffer[(endIndex - SHORT_NUM_SAMPLES) + i] * m_shortWindow[i];
-    }
+    // copy the last samples from circular buffer to m_shortBuffer and apply window:
+    copyWindowedSamples(m_shortWindow, m_shortBuffer.data());
     // apply FFT to m_shortBuffer and write result to m_shortFftOutput:
     m_shortFftreal.do_fft(m_shortFftOutput.data(), m_shortBuffer.data());
 
+    // calculate normalized magnitude for each FFT bin, write it to m_shortSpectrum
+    // and get the maximum value (32 is most of the time the max value):
+    const float max = AudioKernels::compressedMagnitudes(m_shortFftOutput.data(), m_shortFftOutput.data() + SHORT_NUM_SAMPLES / 2,
+                                                         m_shortSpectrum.data(), 1.0f / 32, SHORT_NUM_SAMPLES / 2);
+
     // Calculates the spectral flux for the samples from the given index
     // Spectral flux is the sum of only the *increases* in frequency.
     // See "Evaluation of the Audio Beat Tracking System BeatRoot" by Simon Dixon
     // (in Journal of New Music Research, 36, 2007/8) for further detail
-    float flux = 0.0;
-
-    float max = 0.0;
-
-    // iterate over FFT result:
-    for (std::size_t i=0; i < SHORT_NUM_SAMPLES / 2; ++i) {
-        // calculate magnitude for each FFT bin:
-        const float real = m_shortFftOutput[i];
-        const float img = m_shortFftOutput[SHORT_NUM_SAMPLES / 2 + i];
-        //const float magnitudeInDb = 4.342f * std::log10(real*real + img*img);  // simplified from 20*log10(sqrt(r*r+i*i)) -> dB of Magnitude
-        //const float magnitude = std::pow(real*real + img*img, 0.2) / 9;  // 9 is most of the time the max value
-        const float magnitude = std::pow(real*real + img*img, 0.3f) / 32;  // 32 is most of the time the max value
-        // check if this is the current maximum value:
-        max = std::max(max, magnitude);
-        // write normalized magnitude to m_shortSpectrum:
-        m_shortSpectrum[i] = std::max(0.0f, std::min(magnitude, 1.0f));
-
-        if (m_shortFftOutput[i] > m_lastShortFftOutput[i]) {
-            flux += m_shortFftOutput[i] - m_lastShortFftOutput[i];
-        }
-    }
+    const float flux = AudioKernels::positiveFlux(m_shortFftOutput.data(), m_lastShortFftOutput.data(), SHORT_NUM_SAMPLES / 2);
+
     m_maxLevel = limit(0.0f, max, 1.0f);
     m_spectralFluxHistory.push_back(flux);
-    m_lastShortFftOutput = m_shortFftOutput;
+    // ping-pong: the current output becomes the previous one, the next FFT overwrites the other buffer:
+    std::swap(m_shortFftOutput, m_lastShortFftOutput);
 
     // ----- Automatic Gain Control:
     m_lastMaxValues.push_back(max);
     updateAGC();
 }
 
-void AudioInputAnalyzer::createSimplifiedSpectrumFromRawSpectrums() {
-    const int beginFreq = 10;
-    const double factor = 1.061989883394314;  // pow(22050 / 10., 1/128.)
-    //const double factor = 1.0305289337977435;  // pow(22050 / 10., 1/256.)
-    //const float maxPossibleEnergy = (MAX_FFT_VALUE*qMax(std::size_t(1), valuesTillNext));
-    //const float longMaxPossibleEnergy = LONG_MAX_FFT_VALUE;
-    //const float shortMaxPossibleEnergy = SHORT_MAX_FFT_VALUE;
-
-    std::vector<double> simplifiedSpectrum(SIMPLIFIED_SPECTRUM_LENGTH);
-    double freq = beginFreq;
-
+void AudioInputAnalyzer::createSimplifiedSpectrumFromRawSpectrums(bool withLongSpectrum) {
+    const std::vector<SpectrumBand>& bands = simplifiedSpectrumBands(withLongSpectrum);
     for (std::size_t i=0; i<SIMPLIFIED_SPECTRUM_LENGTH; ++i) {
-        const double nextFreq = beginFreq * std::pow(factor, i+1);
-        if (freq < 200) {
-            const std::size_t startIndex = freq / 22050 * (LONG_NUM_SAMPLES / 2);
-            const std::size_t endIndex = nextFreq / 22050 * (LONG_NUM_SAMPLES / 2);
-            const std::size_t valuesTillNext = endIndex - startIndex;
-            if (endIndex >= LONG_NUM_SAMPLES) break;
-
-            // find max value in this range:
-            float max = m_longSpectrum[startIndex];
-            for (std::size_t j=1; j < valuesTillNext; ++j) {
-                max = std::max(max, m_longSpectrum[startIndex+j]);
-            }
-            simplifiedSpectrum[i] = max;
-
-//            // Sum up the energies of all FFT elements between the two frequencies:
-//            float sumEnergy = m_longSpectrum[startIndex];
-//            for (int j=1; j < valuesTillNext; ++j) {
-//                sumEnergy += m_longSpectrum[startIndex+j];
-//            }
-
-//            // Apply reasonable scale:
-//            sumEnergy /= longMaxPossibleEnergy;
-
-//            // Scale the value with factor and exponent:
-//            simplifiedSpectrum[i] = qPow(qMax(0.0f, qMin(sumEnergy, 1.0f)), (1 / m_compression));
-
-        } else {
-            const std::size_t startIndex = freq / 22050 * (SHORT_NUM_SAMPLES / 2);
-            const std::size_t endIndex = nextFreq / 22050 * (SHORT_NUM_SAMPLES / 2);
-            const std::size_t valuesTillNext = endIndex - startIndex;
-            if (endIndex >= SHORT_NUM_SAMPLES) continue;
-
-            // find max value in this range:
-            float max = m_shortSpectrum[startIndex];
-            for (std::size_t j=1; j < valuesTillNext; ++j) {
-                max = std::max(max, m_shortSpectrum[startIndex+j]);
-            }
-            simplifiedSpectrum[i] = max;
-
-//            // Sum up the energies of all FFT elements between the two frequencies:
-//            float sumEnergy = m_shortSpectrum[startIndex];
-//            for (int j=1; j < valuesTillNext; ++j) {
-//                sumEnergy += m_shortSpectrum[startIndex+j];
-//            }
-
-//            // Apply reasonable scale:
-//            sumEnergy /= shortMaxPossibleEnergy;
-
-//            // Scale the value with factor and exponent:
-//            simplifiedSpectrum[i] = qPow(qMax(0.0f, qMin(sumEnergy, 1.0f)), (1 / m_compression));
+        const SpectrumBand& band = bands[i];
+        if (band.count == 0) {
+            m_simplifiedSpectrum[i] = 0.0;
+            continue;
         }
-        freq = nextFreq;
+        // find max value in this range:
+        const float* values = (band.useLongSpectrum ? m_longSpectrum.data() : m_shortSpectrum.data()) + band.startIndex;
+        m_simplifiedSpectrum[i] = *std::max_element(values, values + band.count);
     }
-    //simplifiedSpectrum[50] = 1;  // point between long and short spectrum (200 Hz)
-
-    // ----------------------- Calculate Spectral Color -----------------------
+}
 
-    if (m_detectBpm) {
-        double redMax = 0;
-        double greenMax = 0;
-        double blueMax = 0;
-        for (std::size_t i=0; i < (SIMPLIFIED_SPECTRUM_LENGTH * 0.3); ++i) {
-            redMax = qMax(redMax, simplifiedSpectrum[i]);
-        }
-        for (std::size_t i=std::size_t(SIMPLIFIED_SPECTRUM_LENGTH * 0.3); i < (SIMPLIFIED_SPECTRUM_LENGTH * 0.6); ++i) {
-            greenMax = qMax(greenMax, simplifiedSpectrum[i]);
-        }
-        for (std::size_t i=std::size_t(SIMPLIFIED_SPECTRUM_LENGTH * 0.6); i < SIMPLIFIED_SPECTRUM_LENGTH; ++i) {
-            blueMax = qMax(blueMax, simplifiedSpectrum[i]);
-        }
-        const double maxComponent = qMax(redMax, qMax(greenMax, blueMax));
-        if (maxComponent == 0) {
-            m_spectralColorHistory.push_back(QColor::fromRgbF(1, 1, 1));
-        } else {
-            m_spectralColorHistory.push_back(
-                     QColor::fromRgbF(redMax / maxComponent, greenMax / maxComponent, blueMax / maxComponent));
-        }
+void AudioInputAnalyzer::updateSpectralColor() {
+    const std::vector<double>& simplifiedSpectrum = m_simplifiedSpectrum;
+    double redMax = 0;
+    double greenMax = 0;
+    double blueMax = 0;
+    for (std::size_t i=0; i < (SIMPLIFIED_SPECTRUM_LENGTH * 0.3); ++i) {
+        redMax = qMax(redMax, simplifiedSpectrum[i]);
+    }
+    for (std::size_t i=std::size_t(SIMPLIFIED_SPECTRUM_LENGTH * 0.3); i < (SIMPLIFIED_SPECTRUM_LENGTH * 0.6); ++i) {
+        greenMax = qMax(greenMax, simplifiedSpectrum[i]);
+    }
+    for (std::size_t i=std::size_t(SIMPLIFIED_SPECTRUM_LENGTH * 0.6); i < SIMPLIFIED_SPECTRUM_LENGTH; ++i) {
+        blueMax = qMax(blueMax, simplifiedSpectrum[i]);
+    }
+    const double maxComponent = qMax(redMax, qMax(greenMax, blueMax));
+    if (maxComponent == 0) {
+        m_spectralColorHistory.push_back(QColor::fromRgbF(1, 1, 1));
+    } else {
+        m_spectralColorHistory.push_back(
+                 QColor::fromRgbF(redMax / maxComponent, greenMax / maxComponent, blueMax / maxComponent));
     }
-
-    // push spectrum to spectrum history with move semantic:
-    m_spectrumHistory.push_back(move(simplifiedSpectrum));
-    // Attention: because of move semantic simplifiedSpectrum is now unusable!
-    ++m_newSpectrumCount;
 }
 
 
@@ -904,6 +1239,9 @@ static const float fractionsToCheck[] = {4.0f/3.0f,
 
 // evaluates the agents by using the highest scored agents interval to calculate the bpm
 void AudioInputAnalyzer::evaluateAgents() {
+    // counted even if no BPM value is detected, bpmChanged() is emitted in both cases:
+    ++m_bpmEvaluationCount;
+
     BeatAgent* maxAgent = 0;
     for (BeatAgent& cluster : m_agents) {
         if (!maxAgent || cluster.getScore() > maxAgent->getScore()) {
@@ -975,7 +1313,6 @@ void AudioInputAnalyzer::evaluateAgents() {
         }
     }
     // if this point is reached, no BPM value could be detected
-    emit bpmChanged();
 }
 
 void AudioInputAnalyzer::updateAGC() {
@@ -5,6 +5,7 @@
 #include "ffft/FFTRealFixLen.h"
 
 #include "core/QCircularBuffer.h"
+#include "core/TripleBuffer.h"
 #include <QObject>
 #include <QtMath>
 #include <QMap>
@@ -14,7 +15,11 @@
 #include <QtMultimedia/QAudioFormat>
 #include <QLinkedList>
 #include <QColor>
+#include <QThread>
+#include <QVariant>
 
+#include <atomic>
+#include <chrono>
 #include <vector>
 
 
@@ -58,18 +63,18 @@ static const int SPECTRUM_HISTORY_LENGTH = 10;
 // number of spectral flux values to keep in the history for Onset detection
 static const int SPECTRAL_FLUX_HISTORY_LENGTH = SPECTRUM_UPDATE_RATE * 5;  // 5s
 
-// Spectrums, Spectral Flux and Onsets will be updated when new input data is available
-// so this value is the approx. rate audioDataReady() is called
-static const int BPM_UPDATE_RATE = 20; // Hz
+// Spectrums, Spectral Flux and Onsets will be updated for every hop,
+// the BPM tempo detection is only run at this rate because it is expensive
+static const int BPM_UPDATE_RATE = 4; // Hz
 
-// BPM tempo detection will be only run every n-th call
-static const int CALLS_TO_WAIT_FOR_BPM = 5;
+// BPM tempo detection will be only run every n-th hop
+static const int HOPS_TO_WAIT_FOR_BPM = SPECTRUM_UPDATE_RATE / BPM_UPDATE_RATE;  // 12
 
 // the seconds of BPMs to store to allow smoothing of the output
 static const int SECONDS_OF_INTERVALS_TO_STORE = 4;
 
 // the actual number of BPMs to store to allow smoothing of the output
-static const int INTERVALS_TO_STORE = SECONDS_OF_INTERVALS_TO_STORE * BPM_UPDATE_RATE / CALLS_TO_WAIT_FOR_BPM;
+static const int INTERVALS_TO_STORE = SECONDS_OF_INTERVALS_TO_STORE * BPM_UPDATE_RATE;  // 16
 
 
 // maximum absolute value in the result of the FFT
@@ -105,15 +110,68 @@ static const float AGC_MIN_GAIN = 0.5;
 // maximum gain of AGC
 static const float AGC_MAX_GAIN = 5.0;
 
+// ----------------- Analysis Tiers -----------------
+
+/**
+ * @brief The AudioAnalysisTier enum lists the stages of the analysis.
+ *
+ * Each tier includes all tiers below it. The analyzer only runs the stages
+ * of the highest tier any of its references requires (see AudioInputAnalyzer::addReference()).
+ */
+enum AudioAnalysisTier {
+    LevelTier = 0,  //!< peak and RMS level of the samples, no FFT
+    BandsTier,  //!< short FFT: simplified spectrum with a coarse bass range, max level, spectral flux and AGC
+    SpectrumTier,  //!< additionally the long FFT for a high resolution of the bass frequencies
+    BpmTier  //!< additionally onset detection, spectral color and BPM detection
+};
+
+// number of values in AudioAnalysisTier
+static const int AUDIO_ANALYSIS_TIER_COUNT = 4;
+
 // ---------------------------------------------------
 
 class MainController;  // forward declaration
+class AudioAnalysisThread;
+class AudioCaptureDevice;
 
 // A class to modell a cluster of Inter Offset Intervalls (IOIs).
 // defined in .cpp file
 class BeatAgent;
 
 
+/**
+ * @brief The AudioAnalysisResult struct contains the results of the analysis
+ * published by the analysis thread after each hop.
+ */
+struct AudioAnalysisResult {
+    AudioAnalysisResult();
+
+    float peakLevel;  //!< absolute peak of the samples of the last hop [0...1]
+    float rmsLevel;  //!< RMS of the samples of the last hop [0...1]
+    float levelAgcValue;  //!< best amplification factor for peakLevel
+
+    std::vector<double> simplifiedSpectrum;  //!< spectrum with energy values between 0 and 1
+    float maxLevel;  //!< maximum level of all frequencies
+    double currentSpectralFlux;  //!< the last spectral flux value [0... ~8000]
+    float agcValue;  //!< best amplifictation factor of spectrum
+    float spectralFluxAgcValue;  //!< best amplifictation factor for spectral flux
+
+    QVector<float> spectralFluxHistory;  //!< the last spectral flux values, oldest first
+    QVector<QColor> spectralColorHistory;  //!< the spectral color values matching spectralFluxHistory
+    QVector<bool> onsets;  //!< true for each spectral flux value that is an onset
+    QVector<double> detectedOnsets;  //!< positions of the onsets relative to the history [0...1]
+
+    float bpm;  //!< last detected absolute BPM value
+    HighResTime::time_point_t lastBpmDetection;  //!< time of last successful BPM detection
+    quint64 bpmEvaluationCount;  //!< number of BPM evaluations, detected or not
+    quint64 hopCount;  //!< number of hops analyzed since the analysis was started
+
+    AudioAnalysisTier tier;  //!< the tier the last hop was analyzed with
+    double stageTime[AUDIO_ANALYSIS_TIER_COUNT];  //!< average processing time of each stage per hop in s
+    double hopTime;  //!< average processing time of the recent hops in s
+};
+
+
 // ---------------------------------- AudioInputAnalyzer --------------------------------
 
 /**
@@ -125,6 +183,17 @@ class BeatAgent;
  *
  * It also calculates the spectral flux and detects onsets in the input stream.
  * Based on the onsets it calculates a BPM tempo value.
+ *
+ * Each reference declares the AudioAnalysisTier it requires and only the stages
+ * up to the highest required tier are run, i.e. if only the level is needed,
+ * no FFT is calculated at all. The processing time of each stage is measured
+ * and can be read with getTierCost() and getAnalysisCost().
+ *
+ * The audio data is captured by an AudioCaptureDevice in a separate thread and passed through
+ * a lock-free ring buffer to an AudioAnalysisThread that runs the analysis at a fixed hop size.
+ * The results are published with a TripleBuffer and fetched once per Engine frame
+ * in updateSpectrum(), so the getters always return consistent values of the same hop
+ * and neither a stalled GUI thread delays the analysis nor the other way round.
  */
 class AudioInputAnalyzer : public QObject {
 
@@ -156,11 +225,12 @@ public:
      * @brief addReference registers an object as "interested in the results" of this analyzer
      *
      * This analyzer only starts analyzing when at least one object is registered
-     * (reference counting).
+     * (reference counting). If the object is already registered, only its tier is changed.
      *
      * @param ref a pointer to the interested object
+     * @param tier the results the object requires
      */
-    void addReference(void* ref);
+    void addReference(void* ref, AudioAnalysisTier tier = SpectrumTier);
 
     /**
      * @brief removeReference unregisters an interested object
@@ -169,24 +239,43 @@ public:
     void removeReference(void* ref);
 
     /**
-     * @brief addReferenceForBpm registers an object as "interested in the BPM value" of this analyzer
-     *
-     * This analyzer only starts analyzing when at least one object is registered
-     * (reference counting).
-     *
+     * @brief addReferenceForBpm registers an object as "interested in the BPM value" of this analyzer,
+     * same as addReference(ref, BpmTier)
      * @param ref a pointer to the interested object
      */
-    void addReferenceForBpm(void* ref);
+    void addReferenceForBpm(void* ref) { addReference(ref, BpmTier); }
 
     /**
      * @brief removeReferenceForBpm unregisters an interested object for BPM detection
      * @param ref a pointer to an object previously registered with addReferenceForBpm()
      */
-    void removeReferenceForBpm(void* ref);
+    void removeReferenceForBpm(void* ref) { removeReference(ref); }
 
     void startSpeechRecording();
     const QByteArray& stopSpeechRecording();
 
+    /**
+     * @brief startClickTrack analyzes a generated click track instead of the input device
+     * to measure the audio-to-onset latency, must not be used while this analyzer is referenced
+     * @param bpm tempo of the click track
+     * @return true if the analysis was started
+     */
+    bool startClickTrack(double bpm = 120);
+
+    /**
+     * @brief stopClickTrack stops the click track analysis and returns the latency statistics
+     * @return a map with the latencies in ms and the number of clicks and detected onsets
+     */
+    QVariantMap stopClickTrack();
+
+    /**
+     * @brief benchmarkAnalysis measures the processing time of each analysis tier
+     * for 10s of generated audio
+     * @param controller pointer to the MainController
+     * @return a map with the analysis time per second of audio in ms
+     */
+    static QVariantMap benchmarkAnalysis(MainController* controller);
+
 signals:
     void bpmChanged();  //!< is emitted when a new BPM value was detected
 
@@ -201,21 +290,21 @@ public slots:
      * @brief getSimplifiedSpectrum returns a simplified scaled frequency spectrum
      * @return spectrum with energy values between 0 and 1
      */
-    const std::vector<double>& getSimplifiedSpectrum() const { return m_simplifiedSpectrum; }
+    const std::vector<double>& getSimplifiedSpectrum() const { return m_results.readBuffer().simplifiedSpectrum; }
 
     /**
      * @brief getSpectralFluxHistory returns the history of the spectral flux values,
      * typically the last 5s
      * @return an array of spectral flux values [0... ~8000]
      */
-    const Qt3DCore::QCircularBuffer<float>& getSpectralFluxHistory() const { return m_spectralFluxHistory; }
+    const QVector<float>& getSpectralFluxHistory() const { return m_results.readBuffer().spectralFluxHistory; }
 
     /**
      * @brief getSpectralColorHistory returns the history of the spectral color values,
      * typically the last 5s, matching the values of getSpectralFluxHistory()
      * @return an array of spectral color values
      */
-    const Qt3DCore::QCircularBuffer<QColor>& getSpectralColorHistory() const { return m_spectralColorHistory; }
+    const QVector<QColor>& getSpectralColorHistory() const { return m_results.readBuffer().spectralColorHistory; }
 
     /**
      * @brief getOnsets returns the last detected onsets. The returned array matches the one
@@ -223,19 +312,19 @@ public slots:
      * true if an onset was detected or false if not.
      * @return array of bools whichs indexes match those of getSpectralFluxHistory()
      */
-    const QVector<bool>& getOnsets() const { return m_onsetBuffer; }
+    const QVector<bool>& getOnsets() const { return m_results.readBuffer().onsets; }
 
     /**
      * @brief getDetectedOnsets returns the detected onsets
      * @return an array with positions relative to the spectral flux history [0...1]
      */
-    const QVector<double>& getDetectedOnsets() const { return m_detectedOnsets; }
+    const QVector<double>& getDetectedOnsets() const { return m_results.readBuffer().detectedOnsets; }
 
     /**
      * @brief getMaxLevel returns maximum level of all frequencies
      * @return a level between 0 and 1
      */
-    float getMaxLevel() const { return m_maxLevel; }
+    float getMaxLevel() const { return m_results.readBuffer().maxLevel; }
 
     /**
      * @brief getLevelAtBand return the level of a certain frequency bin
@@ -255,16 +344,16 @@ public slots:
      * @param minBpm the minimum expected BPM [0=auto, 50, 75, 100, 150]
      * @return a BPM value [50...300]
      */
-    float getBpm(int minBpm=75) const { return bpmInRange(m_bpm, minBpm); }
+    float getBpm(int minBpm=75) const { return bpmInRange(m_results.readBuffer().bpm, minBpm); }
     /**
      * @brief getBpmIsValid returns if the BPM value is new and value or if it is too old
      * @return true if value was updated in the last 5s, false if it is too old or not valid
      */
-    bool getBpmIsValid() const { return HighResTime::elapsedSecSince(m_lastBpmDetection) < 5; }
+    bool getBpmIsValid() const { return HighResTime::elapsedSecSince(m_results.readBuffer().lastBpmDetection) < 5; }
 
     /**
-     * @brief getNewSpectrumCount returns the count of new, unused spectrums,
-     * will be modified by update updateSpectrum() calls
+     * @brief getNewSpectrumCount returns the count of spectrums calculated
+     * between the last two updateSpectrum() calls
      * @return count of new spectrums
      */
     int getNewSpectrumCount() const { return m_newSpectrumCount; }
@@ -273,35 +362,107 @@ public slots:
      * @brief getCurrentSpectralFlux returns the current spectral flux value
      * @return normalized spectral flux value [0...1]
      */
-    double getCurrentSpectralFlux() const { return limit(0, m_currentSpectralFlux / 8000.0, 1); }
+    double getCurrentSpectralFlux() const { return limit(0, m_results.readBuffer().currentSpectralFlux / 8000.0, 1); }
 
     /**
      * @brief getAgcValue returns the gain that the Automatic Gain Control evaluate would be best
      * @return a gain value [0.5...~5]
      */
-    double getAgcValue() const { return m_agcValue; }
+    double getAgcValue() const { return m_results.readBuffer().agcValue; }
 
     /**
      * @brief getSpectralFluxAgcValue returns the gain for spectral flux values
      * that the Automatic Gain Control evaluate would be best
      * @return a gain value [0.5...~5]
      */
-    double getSpectralFluxAgcValue() const { return m_spectralFluxAgcValue; }
+    double getSpectralFluxAgcValue() const { return m_results.readBuffer().spectralFluxAgcValue; }
+
+    /**
+     * @brief getPeakLevel returns the absolute peak of the samples of the last hop,
+     * available in all tiers
+     * @return a level between 0 and 1
+     */
+    float getPeakLevel() const { return m_results.readBuffer().peakLevel; }
+
+    /**
+     * @brief getRmsLevel returns the RMS of the samples of the last hop, available in all tiers
+     * @return a level between 0 and 1
+     */
+    float getRmsLevel() const { return m_results.readBuffer().rmsLevel; }
+
+    /**
+     * @brief getLevelAgcValue returns the gain that the Automatic Gain Control evaluated
+     * would be best for getPeakLevel()
+     * @return a gain value [0.5...~5]
+     */
+    double getLevelAgcValue() const { return m_results.readBuffer().levelAgcValue; }
+
+    /**
+     * @brief getRequiredTier returns the highest tier required by the references
+     * @return an AudioAnalysisTier value
+     */
+    int getRequiredTier() const { return m_requiredTier; }
+
+    /**
+     * @brief getTierCost returns the average processing time of a tier,
+     * tiers that were not run since the analysis was started are estimated with 0
+     * @param tier an AudioAnalysisTier value
+     * @return processing time per second of audio in ms
+     */
+    double getTierCost(int tier) const;
+
+    /**
+     * @brief getAnalysisCost returns the processing time of the recent hops
+     * @return processing time per second of audio in ms
+     */
+    double getAnalysisCost() const;
+
+    /**
+     * @brief tierName returns a human readable name of a tier
+     * @param tier an AudioAnalysisTier value
+     * @return name of the tier
+     */
+    static QString tierName(int tier);
+
+    /**
+     * @brief longSpectrumBoundary returns the position in the simplified spectrum
+     * below which the bands are calculated with the long FFT in the SpectrumTier
+     * (and with a lower resolution in the BandsTier)
+     * @return a relative position [0...1]
+     */
+    static double longSpectrumBoundary();
 
     const QByteArray& getSpeechBuffer() const { return m_speechBuffer; }
 
 private:
+    // AudioAnalysisThread calls analyzeHop():
+    friend class AudioAnalysisThread;
+
     /**
      * @brief calculateWindows intializes the arrays used for the windowing function before FFT
      */
     void calculateWindows();
+
     /**
-     * @brief initAudio initializes the audio device capture
-     * @param info information about the device to analyze
+     * @brief resetAnalysis clears the sample buffer and the history,
+     * must only be called while the analysis thread is not running
      */
-    void initAudio(QAudioDeviceInfo info);
+    void resetAnalysis();
 
-    void createAudioInputForMusic();
+    /**
+     * @brief startAnalysis starts the analysis thread and the capture thread
+     * @param clickTrackIntervalSamples samples between two clicks to analyze a generated click track
+     * or 0 to capture the input device
+     * @return true if successful
+     */
+    bool startAnalysis(int clickTrackIntervalSamples = 0);
+
+    /**
+     * @brief stopAnalysis stops the capture thread and the analysis thread
+     */
+    void stopAnalysis();
+
+    QAudioFormat createAudioFormatForMusic() const;
     void createAudioInputForSpeech();
 
     /**
@@ -312,21 +473,79 @@ private:
 
     static float bpmInRange(float bpm, const int minBPM);
 
+    /**
+     * @brief updateRequiredTier sets m_requiredTier to the highest tier of the references
+     */
+    void updateRequiredTier();
+
+    // ---------------- called in the analysis thread:
+
+    /**
+     * @brief analyzeHop analyzes the next hop of samples and publishes the results
+     * @param samples SAMPLES_BETWEEN_SPECTRUM_UPDATES new samples
+     */
+    void analyzeHop(const float* samples);
+
+    /**
+     * @brief publishResults copies the current results to the TripleBuffer
+     */
+    void publishResults();
+
+    /**
+     * @brief updateLevel calculates peak, RMS and the level AGC of the new samples
+     * @param samples SAMPLES_BETWEEN_SPECTRUM_UPDATES new samples
+     */
+    void updateLevel(const float* samples);
+
+    /**
+     * @brief changeTier resets the results of the stages that are not run anymore
+     * @param tier the new tier
+     */
+    void changeTier(AudioAnalysisTier tier);
+
+    /**
+     * @brief measureOnsetLatency updates the latency statistics when a new onset
+     * of the click track was detected
+     */
+    void measureOnsetLatency();
+
 private slots:
 
+    /**
+     * @brief updateSpectrum fetches the latest published results, called once per Engine frame
+     */
     void updateSpectrum();
 
-    void audioDataReady();
-
     void speechDataReady();
 
-    void analyzeNewSamples();
+    /**
+     * @brief copyWindowedSamples copies the last samples of the circular buffer
+     * (in at most two contiguous segments) and applies the window function
+     * @param window window function, defines the number of samples
+     * @param out output array
+     */
+    void copyWindowedSamples(const std::vector<float>& window, float* out) const;
 
-    void createSpectrumTillIndex(std::size_t endIndex);
+    /**
+     * @brief updateShortSpectrum calculates the short FFT, the max level, the spectral flux and the AGC
+     */
+    void updateShortSpectrum();
 
-    void updateRawSpectrumsTillIndex(std::size_t endIndex);
+    /**
+     * @brief updateLongSpectrum calculates the long FFT for the bass frequencies
+     */
+    void updateLongSpectrum();
 
-    void createSimplifiedSpectrumFromRawSpectrums();
+    /**
+     * @brief createSimplifiedSpectrumFromRawSpectrums calculates the simplified spectrum
+     * @param withLongSpectrum true to use the long spectrum for the bass frequencies
+     */
+    void createSimplifiedSpectrumFromRawSpectrums(bool withLongSpectrum);
+
+    /**
+     * @brief updateSpectralColor appends the color of the simplified spectrum to the history
+     */
+    void updateSpectralColor();
 
     void updateOnsets();
 
@@ -357,18 +576,29 @@ private slots:
 protected:
     MainController* const m_controller;  //!< a pointer to the main controller
 
-    QSet<void*> m_referenceList;  //!< list of registered objects
-    QSet<void*> m_bpmReferenceList;  //!< list of registered objects for BPM detection
+    QMap<void*, AudioAnalysisTier> m_references;  //!< registered objects and the tier they require
 
-    QPointer<QAudioInput> m_audioInput;  //!< audio input device
-    QPointer<QIODevice> m_audioRecordDevice;  //!< audio record device
+    QPointer<QAudioInput> m_audioInput;  //!< audio input device for speech
+    QPointer<QIODevice> m_audioRecordDevice;  //!< audio record device for speech
     QAudioFormat m_audioFormat;  //!< format to record audio in
     QAudioDeviceInfo m_deviceInfo;  //!< audio device info
     QString m_deviceName;  //!< name of input device
     int m_channelIndex;  //!< 0 for left channel, 1 for right channel
 
-    int m_analyzedTillIndex;  //!< the end index of the last analyzed FFT window in circular buffer
-    Qt3DCore::QCircularBuffer<float> m_circBuffer;  //!< ring buffer to store incoming audio samples
+    QThread m_captureThread;  //!< thread the AudioCaptureDevice lives in
+    AudioCaptureDevice* m_captureDevice;  //!< receives the audio data while analyzing, or null
+    AudioAnalysisThread* m_analysisThread;  //!< thread that calls analyzeHop(), null for dummy analyzers
+
+    // ---------------- results (accessed by the GUI thread):
+
+    TripleBuffer<AudioAnalysisResult> m_results;  //!< written by the analysis thread, read by the getters
+    quint64 m_lastFetchedHopCount;  //!< hopCount of the last fetched result
+    quint64 m_lastFetchedBpmEvaluationCount;  //!< bpmEvaluationCount of the last fetched result
+    int m_newSpectrumCount;  //!< count of spectrums calculated between the last two fetches
+
+    // ---------------- analysis state (only accessed by the analysis thread while it is running):
+
+    Qt3DCore::QCircularBuffer<float> m_circBuffer;  //!< ring buffer to store the last audio samples
 
     std::vector<float> m_longBuffer;  //!< buffer for long FFT
     std::vector<float> m_longWindow;  //!< window function array for long FFT
@@ -379,13 +609,16 @@ protected:
     std::vector<float> m_shortBuffer;  //!< buffer for short FFT
     std::vector<float> m_shortWindow;  //!< window function array for short FFT
     ffft::FFTRealFixLen<SHORT_NUM_SAMPLES_EXPONENT> m_shortFftreal;  //!< object for FFT calculations
-    std::vector<float> m_lastShortFftOutput;  //!< previous output buffer for short FFT
+    std::vector<float> m_lastShortFftOutput;  //!< previous output buffer for short FFT (swapped with m_shortFftOutput)
     std::vector<float> m_shortFftOutput;  //!< output buffer for short FFT
     std::vector<float> m_shortSpectrum;  //!< resulting spectrum of short FFT
 
-    Qt3DCore::QCircularBuffer<std::vector<double>> m_spectrumHistory;  //!< last spectrums
-    int m_newSpectrumCount;  //!< count of new, unused spectrums in spectrum history
-    std::vector<double> m_simplifiedSpectrum;  //!< the current simplified spectrum to display
+    std::vector<double> m_simplifiedSpectrum;  //!< the simplified spectrum of the last hop
+
+    float m_peakLevel;  //!< absolute peak of the last hop
+    float m_rmsLevel;  //!< RMS of the last hop
+    float m_levelAgcValue;  //!< best amplification factor for m_peakLevel
+    Qt3DCore::QCircularBuffer<float> m_lastPeakLevels;  //!< list of last peak levels used for the level AGC
 
     float m_maxLevel;  //!< maximum level of input device
 
@@ -397,18 +630,39 @@ protected:
     Qt3DCore::QCircularBuffer<float> m_spectralFluxHistory;
     Qt3DCore::QCircularBuffer<QColor> m_spectralColorHistory;
     QVector<float> m_spectralFluxNormalized;
-    double m_currentSpectralFlux;
     QVector<bool> m_onsetBuffer;
     QVector<double> m_detectedOnsets;
 
     float m_bpm;  //!< last detected absolute BPM value
-    int m_callsSinceLastBpmUpdate;  //!< calls of analyzeNewSamples() since last BPM update
+    int m_hopsSinceLastBpmUpdate;  //!< calls of analyzeHop() since last BPM update
     HighResTime::time_point_t m_lastBpmDetection;  //!< time of last successful BPM detection
-    bool m_detectBpm;  //!< true if BPM should be analyzed
+    quint64 m_bpmEvaluationCount;  //!< number of calls of evaluateAgents()
+    quint64 m_hopCount;  //!< number of hops analyzed since the analysis was started
+    AudioAnalysisTier m_lastTier;  //!< tier of the last hop
+    std::atomic<int> m_requiredTier;  //!< highest tier required by the references (set by the GUI thread)
 
     QLinkedList<BeatAgent> m_agents; //!< the IOI Clusters identified from the intervalls
     Qt3DCore::QCircularBuffer<float> m_lastIntervals; //!< the last bpm values stored as their interval, to achieve smoothing
 
+    // ---------------- click track latency measurement (written by the analysis thread):
+
+    int m_clickTrackIntervalSamples;  //!< samples between two clicks or 0 if analyzing the input device
+    std::chrono::steady_clock::time_point m_clickTrackStart;  //!< point in time of the first click track sample
+    qint64 m_lastMeasuredOnsetHop;  //!< hop of the last onset used for the latency statistics
+    int m_measuredOnsetCount;  //!< number of onsets that matched a click
+    int m_falseOnsetCount;  //!< number of onsets that didn't match a click
+    double m_onsetLatencySum;  //!< sum of the audio-to-onset latencies in s
+    double m_onsetLatencyMax;  //!< max audio-to-onset latency in s
+    double m_detectionDelaySum;  //!< sum of the audio duration analyzed after the click till the onset in s
+    double m_analysisTimeSum;  //!< sum of the processing time of analyzeHop() in s
+    double m_analysisTimeMax;  //!< max processing time of analyzeHop() in s
+
+    // ---------------- processing time per stage (written by the analysis thread):
+
+    double m_stageTimeSum[AUDIO_ANALYSIS_TIER_COUNT];  //!< sum of the processing time of each stage in s
+    quint64 m_stageHopCount[AUDIO_ANALYSIS_TIER_COUNT];  //!< number of hops each stage was run in
+    double m_recentHopTime;  //!< exponential moving average of the processing time per hop in s
+
     bool m_isRecordingSpeech;  //!< true if this input is currently used to record speech
     QByteArray m_speechBuffer;  //!< buffer storing the raw audio data while speech is recorded
     QByteArray m_speechBufferPart;  //!< buffer storing the latest raw audio data while speech is recorded for streaming recognition
@@ -0,0 +1,201 @@
+#include "AudioKernels.h"
+
+#include "core/SimdOps.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+namespace {
+
+// ------------------------ Fast Pow ---------------------
+// pow(x, e) = 2^(e * log2(x)), log2 and 2^x are approximated with rational functions
+// of the float mantissa (see "Fast Approximate Logarithm, Exponential, Power,
+// and Inverse Root" by Paul Mineiro).
+
+template<typename Ops>
+inline typename Ops::V fastLog2(typename Ops::V x) {
+    // the bit pattern interpreted as int is approximately (log2(x) + 127) * 2^23:
+    const typename Ops::V y = Ops::mul(Ops::bitsToFloat(x), Ops::set1(1.1920928955078125e-7f));
+    // the mantissa scaled to [0.5, 1) to correct the error:
+    const typename Ops::V m = Ops::orMask(Ops::andMask(x, 0x007FFFFF), 0x3f000000);
+    return Ops::sub(Ops::sub(Ops::sub(y, Ops::set1(124.22551499f)), Ops::mul(Ops::set1(1.498030302f), m)),
+                    Ops::div(Ops::set1(1.72587999f), Ops::add(Ops::set1(0.3520887068f), m)));
+}
+
+template<typename Ops>
+inline typename Ops::V fastPow2(typename Ops::V p) {
+    const typename Ops::V clipped = Ops::max(p, Ops::set1(-126.0f));
+    // fractional part, floor() is done on positive values:
+    const typename Ops::V z = Ops::sub(clipped, Ops::sub(Ops::floorPositive(Ops::add(clipped, Ops::set1(127.0f))),
+                                                          Ops::set1(127.0f)));
+    typename Ops::V bits = Ops::add(clipped, Ops::set1(121.2740575f));
+    bits = Ops::add(bits, Ops::div(Ops::set1(27.7280233f), Ops::sub(Ops::set1(4.84252568f), z)));
+    bits = Ops::sub(bits, Ops::mul(Ops::set1(1.49012907f), z));
+    return Ops::floatToBits(Ops::mul(bits, Ops::set1(float(1 << 23))));
+}
+
+// ------------------------ Kernels ---------------------
+// The templates process as many values as possible with the given instruction set
+// and return the number of processed values, the rest is done with ScalarOps.
+
+template<typename Ops>
+int multiplyKernel(const float* values, const float* factors, float* out, int count) {
+    int i = 0;
+    for (; i + Ops::width <= count; i += Ops::width) {
+        Ops::store(out + i, Ops::mul(Ops::load(values + i), Ops::load(factors + i)));
+    }
+    return i;
+}
+
+template<typename Ops>
+int levelKernel(const float* samples, int count, float& peak, float& sumOfSquares) {
+    typename Ops::V peaks = Ops::set1(peak);
+    typename Ops::V sums = Ops::set1(0.0f);
+    int i = 0;
+    for (; i + Ops::width <= count; i += Ops::width) {
+        const typename Ops::V x = Ops::load(samples + i);
+        // clearing the sign bit results in the absolute value:
+        peaks = Ops::max(peaks, Ops::andMask(x, 0x7FFFFFFF));
+        sums = Ops::add(sums, Ops::mul(x, x));
+    }
+    float lanes[Ops::width];
+    Ops::store(lanes, peaks);
+    peak = *std::max_element(lanes, lanes + Ops::width);
+    Ops::store(lanes, sums);
+    for (int lane = 0; lane < Ops::width; ++lane) {
+        sumOfSquares += lanes[lane];
+    }
+    return i;
+}
+
+template<typename Ops>
+int magnitudeKernel(const float* real, const float* imag, float* out, float scale, int count, float& max) {
+    const typename Ops::V exponent = Ops::set1(0.3f);
+    const typename Ops::V s = Ops::set1(scale);
+    const typename Ops::V zero = Ops::set1(0.0f);
+    const typename Ops::V one = Ops::set1(1.0f);
+    typename Ops::V maxValues = Ops::set1(max);
+    int i = 0;
+    for (; i + Ops::width <= count; i += Ops::width) {
+        const typename Ops::V re = Ops::load(real + i);
+        const typename Ops::V im = Ops::load(imag + i);
+        const typename Ops::V power = Ops::add(Ops::mul(re, re), Ops::mul(im, im));
+        const typename Ops::V magnitude = Ops::mul(fastPow2<Ops>(Ops::mul(exponent, fastLog2<Ops>(power))), s);
+        maxValues = Ops::max(maxValues, magnitude);
+        Ops::store(out + i, Ops::max(zero, Ops::min(magnitude, one)));
+    }
+    float lanes[Ops::width];
+    Ops::store(lanes, maxValues);
+    max = *std::max_element(lanes, lanes + Ops::width);
+    return i;
+}
+
+template<typename Ops>
+int fluxKernel(const float* current, const float* last, int count, float& sum) {
+    const typename Ops::V zero = Ops::set1(0.0f);
+    typename Ops::V sums = zero;
+    int i = 0;
+    for (; i + Ops::width <= count; i += Ops::width) {
+        sums = Ops::add(sums, Ops::max(zero, Ops::sub(Ops::load(current + i), Ops::load(last + i))));
+    }
+    float lanes[Ops::width];
+    Ops::store(lanes, sums);
+    for (int lane = 0; lane < Ops::width; ++lane) {
+        sum += lanes[lane];
+    }
+    return i;
+}
+
+}  // namespace
+
+
+namespace AudioKernels {
+
+void multiply(const float* values, const float* factors, float* out, int count) {
+    const int done = multiplyKernel<SimdOps>(values, factors, out, count);
+    multiplyKernel<ScalarOps>(values + done, factors + done, out + done, count - done);
+}
+
+void level(const float* samples, int count, float& peak, float& rms) {
+    peak = 0.0f;
+    float sumOfSquares = 0.0f;
+    const int done = levelKernel<SimdOps>(samples, count, peak, sumOfSquares);
+    levelKernel<ScalarOps>(samples + done, count - done, peak, sumOfSquares);
+    rms = std::sqrt(sumOfSquares / count);
+}
+
+float compressedMagnitudes(const float* real, const float* imag, float* out, float scale, int count) {
+    float max = 0.0f;
+    const int done = magnitudeKernel<SimdOps>(real, imag, out, scale, count, max);
+    magnitudeKernel<ScalarOps>(real + done, imag + done, out + done, scale, count - done, max);
+    return max;
+}
+
+float positiveFlux(const float* current, const float* last, int count) {
+    float sum = 0.0f;
+    const int done = fluxKernel<SimdOps>(current, last, count, sum);
+    fluxKernel<ScalarOps>(current + done, last + done, count - done, sum);
+    return sum;
+}
+
+float fastPow(float x, float exponent) {
+    return fastPow2<ScalarOps>(exponent * fastLog2<ScalarOps>(x));
+}
+
+// ----------------- Benchmarks:
+
+QVariantMap benchmark() {
+    // like the short FFT of AudioInputAnalyzer:
+    const int bins = 1024;
+    const int iterations = 2000;
+    std::vector<float> fftOutput(2 * bins);
+    for (float& value: fftOutput) {
+        value = float(qrand() % 20000 - 10000) / 100.0f;
+    }
+    const float* real = fftOutput.data();
+    const float* imag = fftOutput.data() + bins;
+    std::vector<float> reference(bins);
+    std::vector<float> result(bins);
+
+    // previous loop with std::pow:
+    QElapsedTimer timer;
+    timer.start();
+    float referenceMax = 0.0f;
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        for (int i = 0; i < bins; ++i) {
+            const float magnitude = std::pow(real[i]*real[i] + imag[i]*imag[i], 0.3f) / 32;
+            referenceMax = std::max(referenceMax, magnitude);
+            reference[i] = std::max(0.0f, std::min(magnitude, 1.0f));
+        }
+    }
+    const double powNs = double(timer.nsecsElapsed()) / iterations;
+
+    timer.restart();
+    float kernelMax = 0.0f;
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        kernelMax = compressedMagnitudes(real, imag, result.data(), 1.0f / 32, bins);
+    }
+    const double kernelNs = double(timer.nsecsElapsed()) / iterations;
+
+    double maxError = 0.0;
+    for (int i = 0; i < bins; ++i) {
+        if (reference[i] <= 0.0f || reference[i] >= 1.0f) continue;
+        maxError = std::max(maxError, std::abs(double(result[i]) / reference[i] - 1.0));
+    }
+
+    qInfo() << "Audio magnitude kernel (" << SimdOps::name() << ") for" << bins << "bins: std::pow"
+            << powNs / 1000 << "us, kernel" << kernelNs / 1000 << "us, max rel. error" << maxError
+            << "(max" << referenceMax << "/" << kernelMax << ")";
+    QVariantMap results;
+    results["instructionSet"] = SimdOps::name();
+    results["powNs"] = powNs;
+    results["kernelNs"] = kernelNs;
+    results["maxRelativeError"] = maxError;
+    return results;
+}
+
+}  // namespace AudioKernels
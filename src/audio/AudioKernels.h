@@ -0,0 +1,72 @@
+#ifndef AUDIOKERNELS_H
+#define AUDIOKERNELS_H
+
+#include <QVariant>
+
+
+/**
+ * @brief The AudioKernels namespace contains the per-sample and per-bin loops
+ * of the spectrum analysis in AudioInputAnalyzer.
+ *
+ * Like MatrixKernels they use AVX, SSE2 or NEON depending on the target architecture
+ * with a scalar fallback. Output arrays must not overlap with input arrays.
+ */
+namespace AudioKernels {
+
+    /**
+     * @brief multiply multiplies two arrays element by element (i.e. applies a window function)
+     * @param values input values
+     * @param factors factors, i.e. the window function
+     * @param out output array
+     * @param count number of values
+     */
+    void multiply(const float* values, const float* factors, float* out, int count);
+
+    /**
+     * @brief level calculates the absolute peak and the RMS of audio samples
+     * @param samples the samples [-1...1]
+     * @param count number of samples (at least 1)
+     * @param peak output for the absolute peak
+     * @param rms output for the RMS
+     */
+    void level(const float* samples, int count, float& peak, float& rms);
+
+    /**
+     * @brief compressedMagnitudes calculates the compressed magnitude of FFT bins,
+     * out = clamp((real^2 + imag^2)^0.3 * scale, 0, 1), using a fast pow approximation
+     * (relative error below 0.1%)
+     * @param real real parts of the bins
+     * @param imag imaginary parts of the bins
+     * @param out output array for the magnitudes
+     * @param scale factor to normalize the magnitudes with
+     * @param count number of bins
+     * @return the maximum of the scaled magnitudes before clamping
+     */
+    float compressedMagnitudes(const float* real, const float* imag, float* out, float scale, int count);
+
+    /**
+     * @brief positiveFlux sums up only the increases between two arrays (spectral flux)
+     * @param current current values
+     * @param last previous values
+     * @param count number of values
+     * @return sum of max(0, current - last)
+     */
+    float positiveFlux(const float* current, const float* last, int count);
+
+    /**
+     * @brief fastPow approximates pow(x, exponent) for x >= 0 (scalar version of the kernel)
+     * @param x base
+     * @param exponent exponent
+     * @return x^exponent
+     */
+    float fastPow(float x, float exponent);
+
+    /**
+     * @brief benchmark compares compressedMagnitudes() with the previous std::pow loop
+     * @return a map with the time per FFT in ns for both and the max relative error
+     */
+    QVariantMap benchmark();
+
+}  // namespace AudioKernels
+
+#endif // AUDIOKERNELS_H
@@ -1,67 +1,124 @@
 #include "AudioWaveform.h"
 
-#include "core/MainController.h"
-#include "QWaveDecoder.h"
+#include "WaveformAnalysisThread.h"
+#include "WavFileReader.h"
 
-
-namespace AudioWaveformConstants {
-    // audio input sampling rate
-    static const int AUDIO_SAMPLING_RATE = 44100;  // Hz
-}
+#include <QDebug>
+#include <QFileInfo>
+#include <QtMath>
+#include <climits>
 
 
 AudioWaveform::AudioWaveform()
     : QObject(nullptr)
-    , m_decoder(nullptr)
+    , m_analysisThread(nullptr)
+    , m_pyramid(nullptr)
+    , m_cacheDir("")
     , m_points(1000)
     , m_available(false)
 {
 }
 
+AudioWaveform::~AudioWaveform() {
+    // the thread is a child of this object and waits in its destructor,
+    // abort it first so that this doesn't take long:
+    if (m_analysisThread) m_analysisThread->abort();
+}
+
+void AudioWaveform::getPeaks(double start, double end, int pixelCount, std::vector<WaveformBucket>& out) const {
+    if (!m_pyramid) {
+        out.assign(std::size_t(qMax(0, pixelCount)), WaveformBucket {0, 0, 0.0f});
+        return;
+    }
+    m_pyramid->query(start, end, pixelCount, out);
+}
+
 void AudioWaveform::analyze(QString filename) {
     // reset waveform:
+    m_pyramid = nullptr;
     m_points.fill(0);
     emit pointsChanged();
     m_available = false;
     emit availableChanged();
 
+    if (m_analysisThread) {
+        // the previous analysis is not needed anymore:
+        disconnect(m_analysisThread, SIGNAL(finished()), this, SLOT(onAnalysisFinished()));
+        connect(m_analysisThread, SIGNAL(finished()), m_analysisThread, SLOT(deleteLater()));
+        m_analysisThread->abort();
+        m_analysisThread = nullptr;
+    }
+
     if (!filename.toLower().endsWith(".wav")) {
         qInfo() << "AudioWaveform: file is not a .wav file";
         return;
     }
-#ifdef Q_OS_WIN
-    if (filename.startsWith("file:///")) {
-        filename = filename.remove("file:///");
+    filename = localFilename(filename);
+    if (!QFileInfo::exists(filename)) {
+        qInfo() << "AudioWaveform: file doesn't exist: " << filename;
+        return;
     }
-#else
-    if (filename.startsWith("file://")) {
-        filename = filename.remove("file://");
+
+    m_analysisThread = new WaveformAnalysisThread(filename, m_cacheDir, this);
+    connect(m_analysisThread, SIGNAL(finished()), this, SLOT(onAnalysisFinished()));
+    m_analysisThread->start(QThread::LowPriority);
+}
+
+void AudioWaveform::loadContent(QString filename) {
+    if (!filename.toLower().endsWith(".wav")) {
+        qInfo() << "AudioWaveform: file is not a .wav file";
+        return;
     }
-#endif
-    QFile* file = new QFile(filename);
-    if (!file->exists()) {
+    filename = localFilename(filename);
+    if (!QFileInfo::exists(filename)) {
         qInfo() << "AudioWaveform: file doesn't exist: " << filename;
         return;
     }
-    file->open(QIODevice::ReadOnly);
-    if (!file->isReadable()) {
-        qInfo() << "AudioWaveform: couldn't read file: " << filename;
+
+    m_rawData.clear();
+    m_contentReader.reset(new WavFileReader(filename));
+    if (!m_contentReader->open()) return;
+    const char* data = m_contentReader->mapData();
+    if (!data) {
+        qWarning() << "AudioWaveform: couldn't map file: " << filename;
         return;
     }
+    // the pages are loaded by the OS when they are accessed:
+    m_rawData = QByteArray::fromRawData(data, int(qMin(m_contentReader->getDataSize(), qint64(INT_MAX))));
+    emit contentLoaded();
+}
 
-    // decoder can't be reused,
-    // delete old decoder and create a new one:
-    delete m_decoder;
-    m_decoder = nullptr;
-    m_decoder = new QWaveDecoder(file);
-    connect(m_decoder, SIGNAL(formatKnown()), this, SLOT(analyzeBuffer()));
+QVector<double> AudioWaveform::getEnvelope(double start, double end, int pixelCount) const {
+    std::vector<WaveformBucket> buckets;
+    getPeaks(start, end, pixelCount, buckets);
+    QVector<double> envelope(int(buckets.size()));
+    for (int i = 0; i < envelope.size(); ++i) {
+        // RMS with some compression to make quiet parts visible:
+        envelope[i] = qPow(double(buckets[std::size_t(i)].meanSquare), 0.4);
+    }
+    return envelope;
 }
 
-void AudioWaveform::loadContent(QString filename) {
-    if (!filename.toLower().endsWith(".wav")) {
-        qInfo() << "AudioWaveform: file is not a .wav file";
+void AudioWaveform::onAnalysisFinished() {
+    if (!m_analysisThread) return;
+    WaveformAnalysisThread* thread = m_analysisThread;
+    m_analysisThread = nullptr;
+    m_pyramid = thread->getResult();
+    qDebug() << "Time to" << (thread->getWasCached() ? "map cached" : "analyze") << "wav:" << thread->getDuration()
+             << "s, waveform size:" << (m_pyramid ? m_pyramid->getMemorySize() / 1024 : 0) << "KB";
+    thread->deleteLater();
+
+    if (!m_pyramid) {
+        qInfo() << "AudioWaveform: Wav file could not be analyzed.";
         return;
     }
+    m_points = getEnvelope(0.0, 1.0, m_points.size());
+    m_available = true;
+    emit pointsChanged();
+    emit availableChanged();
+}
+
+QString AudioWaveform::localFilename(QString filename) {
 #ifdef Q_OS_WIN
     if (filename.startsWith("file:///")) {
         filename = filename.remove("file:///");
@@ -74,111 +131,5 @@ void AudioWaveform::loadContent(QString filename) {
     if (filename.startsWith("qrc:")) {
         filename = filename.remove("qrc");
     }
-    QFile* file = new QFile(filename);
-    if (!file->exists()) {
-        qInfo() << "AudioWaveform: file doesn't exist: " << filename;
-        return;
-    }
-    file->open(QIODevice::ReadOnly);
-    if (!file->isReadable()) {
-        qInfo() << "AudioWaveform: couldn't read file: " << filename;
-        return;
-    }
-
-    // decoder can't be reused,
-    // delete old decoder and create a new one:
-    delete m_decoder;
-    m_decoder = nullptr;
-    m_decoder = new QWaveDecoder(file);
-    connect(m_decoder, SIGNAL(formatKnown()), this, SLOT(storeBuffer()));
-}
-
-void AudioWaveform::analyzeBuffer() {
-    HighResTime::time_point_t begin = HighResTime::now();
-
-    QByteArray data = m_decoder->readAll();
-    if (data.isEmpty()) {
-        qInfo() << "Wav data is empty";
-        return;
-    }
-    if (data.size() < 1000) {
-        qInfo() << "AudioWaveform: Wav file is too short";
-        return;
-    }
-
-    QAudioFormat format = m_decoder->audioFormat();
-
-    if (format.sampleSize() == 16 && format.sampleType() == QAudioFormat::SignedInt && format.channelCount() == 2) {
-
-        const int16_t* ptr = reinterpret_cast<const int16_t*>(data.constData());
-
-        const int bytesPerFrame = m_decoder->audioFormat().bytesPerFrame();
-        const int frames = data.size() / bytesPerFrame;
-        const int pointCount = m_points.size();
-        const double pointCountD = double(m_points.size() + 1);  // is double for divison
-
-        for (int i=0; i < pointCount; ++i) {
-            double startPos = i / pointCountD;
-            double endPos = (i+1) / pointCountD;
-            int startIndex = int((frames - 1) * startPos) * 2;
-            int endIndex = int((frames - 1) * endPos) * 2;
-            double rms = 0.0;
-            if (endIndex - startIndex < 2) {
-                rms = double(*(ptr + startIndex) / 32768);
-            } else {
-                double sum = 0.0;
-                for (int x=startIndex; x<=endIndex; ++x) {
-                    const double mono = double(*(ptr + x)) / 32768 + double(*(ptr + x)) / 32768;
-                    sum += qPow(mono / 2, 2);
-                }
-                rms = qPow(sum / (endIndex - startIndex), 0.4);
-            }
-            m_points[i] = rms;
-        }
-
-        m_available = true;
-        emit pointsChanged();
-        emit availableChanged();
-
-    } else if (format.sampleSize() == 16 && format.sampleType() == QAudioFormat::SignedInt && format.channelCount() == 1) {
-
-        const int16_t* ptr = reinterpret_cast<const int16_t*>(data.constData());
-
-        const int bytesPerFrame = m_decoder->audioFormat().bytesPerFrame();
-        const int frames = data.size() / bytesPerFrame;
-        const int pointCount = m_points.size();
-        const double pointCountD = double(m_points.size() + 1);  // is double for divison
-
-        for (int i=0; i < pointCount; ++i) {
-            double startPos = i / pointCountD;
-            double endPos = (i+1) / pointCountD;
-            int startIndex = int((frames - 1) * startPos);
-            int endIndex = int((frames - 1) * endPos);
-            double rms = 0.0;
-            if (endIndex - startIndex < 2) {
-                rms = double(*(ptr + startIndex) / 32768);
-            } else {
-                double sum = 0.0;
-                for (int x=startIndex; x<=endIndex; ++x) {
-                    sum += qPow(double(*(ptr + x)) / 32768, 2);
-                }
-                rms = qPow(sum / (endIndex - startIndex), 0.4);
-            }
-            m_points[i] = rms;
-        }
-
-        m_available = true;
-        emit pointsChanged();
-        emit availableChanged();
-
-    } else {
-        qInfo() << "AudioWaveform: Wav file is not saved as signed 16bit mono / stereo.";
-    }
-
-    qDebug() << "Time to analyze wav: " << HighResTime::elapsedSecSince(begin);
-}
-
-void AudioWaveform::storeBuffer() {
-    m_rawData = m_decoder->readAll();
-    emit contentLoaded();
+    return filename;
 }
@@ -1,19 +1,50 @@
 #ifndef AUDIOWAVEFORM_H
 #define AUDIOWAVEFORM_H
 
+#include "WaveformPyramid.h"
+
 #include <QObject>
+#include <QPointer>
 #include <QVector>
 
-class MainController;  // forward declaration
-class QWaveDecoder;
-
+#include <memory>
 
+class MainController;  // forward declaration
+class WaveformAnalysisThread;
+class WavFileReader;
+
+
+/**
+ * @brief The AudioWaveform class provides the waveform of a .wav file.
+ *
+ * The file is analyzed in a WaveformAnalysisThread that creates a WaveformPyramid
+ * without loading the whole file into memory. The pyramid is stored in an AudioAnalysisCache,
+ * so that reopening a project only maps the cache file and shows the waveform immediately.
+ * getPoints() returns an overview of the whole file, getEnvelope() and getPeaks()
+ * can be used for any time range and zoom level.
+ */
 class AudioWaveform : public QObject
 {
     Q_OBJECT
 
 public:
     explicit AudioWaveform();
+    ~AudioWaveform();
+
+    /**
+     * @brief setCacheDir sets the directory to store the cached waveforms in
+     * @param path path to the directory or an empty string to not use a cache
+     */
+    void setCacheDir(QString path) { m_cacheDir = path; }
+
+    /**
+     * @brief getPeaks returns the min / max / RMS summary of a time range
+     * @param start begin of the range relative to the file length [0...1]
+     * @param end end of the range relative to the file length [0...1]
+     * @param pixelCount number of values (i.e. the visible pixels)
+     * @param out output for pixelCount buckets, all zero if no waveform is available
+     */
+    void getPeaks(double start, double end, int pixelCount, std::vector<WaveformBucket>& out) const;
 
 signals:
     void pointsChanged();
@@ -26,22 +57,41 @@ public slots:
 
     const QVector<double>& getPoints() const { return m_points; }
 
+    /**
+     * @brief getEnvelope returns the waveform of a time range in the same scale as getPoints()
+     * @param start begin of the range relative to the file length [0...1]
+     * @param end end of the range relative to the file length [0...1]
+     * @param pixelCount number of values (i.e. the visible pixels)
+     * @return pixelCount values between 0 and 1
+     */
+    QVector<double> getEnvelope(double start, double end, int pixelCount) const;
+
     bool isAvailable() const { return m_available; }
 
+    /**
+     * @brief content returns the sample data of the file loaded with loadContent(),
+     * the data is memory-mapped and not copied
+     * @return the raw sample data
+     */
     const QByteArray& content() const { return m_rawData; }
 
 private slots:
-    void analyzeBuffer();
-    void storeBuffer();
+    void onAnalysisFinished();
+
+private:
+    static QString localFilename(QString filename);
 
 protected:
-    QWaveDecoder* m_decoder;
+    QPointer<WaveformAnalysisThread> m_analysisThread;  //!< thread that analyzes the current file
+    std::shared_ptr<const WaveformPyramid> m_pyramid;  //!< the result of the analysis or null
+    QString m_cacheDir;  //!< directory for the cache files or empty
 
     QVector<double> m_points;
 
     bool m_available;
 
-    QByteArray m_rawData;
+    std::unique_ptr<WavFileReader> m_contentReader;  //!< keeps the file of content() mapped
+    QByteArray m_rawData;  //!< wraps the mapped data without copying it
 };
 
 #endif // AUDIOWAVEFORM_H
@@ -0,0 +1,194 @@
+#include "WavFileReader.h"
+
+#include <QDebug>
+#include <QtEndian>
+#include <cstdint>
+#include <cstring>
+
+
+namespace {
+
+// size of the parts of the file that are mapped at once:
+const qint64 MAP_WINDOW_SIZE = 16 * 1024 * 1024;  // 16 MB
+
+// WAVE_FORMAT_... values of the fmt chunk:
+const quint16 FORMAT_PCM = 0x0001;
+const quint16 FORMAT_IEEE_FLOAT = 0x0003;
+const quint16 FORMAT_EXTENSIBLE = 0xFFFE;
+
+}  // namespace
+
+
+WavFileReader::WavFileReader(const QString& filename)
+    : m_file(filename)
+    , m_channelCount(0)
+    , m_sampleRate(0)
+    , m_bitsPerSample(0)
+    , m_isFloat(false)
+    , m_bytesPerFrame(0)
+    , m_dataOffset(0)
+    , m_dataSize(0)
+    , m_frameCount(0)
+    , m_position(0)
+    , m_window(nullptr)
+    , m_windowOffset(0)
+    , m_windowSize(0)
+    , m_mapFailed(false)
+{
+
+}
+
+WavFileReader::~WavFileReader() {
+    if (m_window) m_file.unmap(m_window);
+}
+
+bool WavFileReader::open() {
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qInfo() << "WavFileReader: couldn't read file: " << m_file.fileName();
+        return false;
+    }
+    const QByteArray riffHeader = m_file.read(12);
+    if (riffHeader.size() < 12 || !riffHeader.startsWith("RIFF") || riffHeader.mid(8, 4) != "WAVE") {
+        qInfo() << "WavFileReader: not a RIFF WAVE file: " << m_file.fileName();
+        return false;
+    }
+
+    // iterate over the chunks until the data chunk is found:
+    bool formatKnown = false;
+    while (!m_file.atEnd()) {
+        const QByteArray chunkHeader = m_file.read(8);
+        if (chunkHeader.size() < 8) break;
+        const QByteArray chunkId = chunkHeader.left(4);
+        const quint32 chunkSize = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(chunkHeader.constData() + 4));
+        const qint64 chunkStart = m_file.pos();
+
+        if (chunkId == "fmt ") {
+            const QByteArray fmt = m_file.read(qMin(chunkSize, quint32(40)));
+            if (fmt.size() < 16) break;
+            const uchar* p = reinterpret_cast<const uchar*>(fmt.constData());
+            quint16 format = qFromLittleEndian<quint16>(p);
+            m_channelCount = qFromLittleEndian<quint16>(p + 2);
+            m_sampleRate = int(qFromLittleEndian<quint32>(p + 4));
+            m_bytesPerFrame = qFromLittleEndian<quint16>(p + 12);
+            m_bitsPerSample = qFromLittleEndian<quint16>(p + 14);
+            if (format == FORMAT_EXTENSIBLE && fmt.size() >= 26) {
+                // the first two bytes of the sub format GUID are the actual format:
+                format = qFromLittleEndian<quint16>(p + 24);
+            }
+            m_isFloat = format == FORMAT_IEEE_FLOAT;
+            if (format != FORMAT_PCM && format != FORMAT_IEEE_FLOAT) {
+                qInfo() << "WavFileReader: unsupported sample format" << format;
+                return false;
+            }
+            formatKnown = true;
+        } else if (chunkId == "data") {
+            m_dataOffset = m_file.pos();
+            // the size is 0 or too large in files of some recorders that were not finalized:
+            m_dataSize = qMin(qint64(chunkSize), m_file.size() - m_dataOffset);
+            if (chunkSize == 0) m_dataSize = m_file.size() - m_dataOffset;
+            break;
+        }
+        // chunks are padded to an even size:
+        if (!m_file.seek(chunkStart + chunkSize + (chunkSize & 1))) break;
+    }
+
+    if (!formatKnown || m_dataOffset == 0) {
+        qInfo() << "WavFileReader: format or data chunk missing: " << m_file.fileName();
+        return false;
+    }
+    const bool supportedSize = m_isFloat ? m_bitsPerSample == 32
+                                         : (m_bitsPerSample == 8 || m_bitsPerSample == 16
+                                            || m_bitsPerSample == 24 || m_bitsPerSample == 32);
+    if (!supportedSize || m_channelCount <= 0 || m_bytesPerFrame != m_channelCount * m_bitsPerSample / 8) {
+        qInfo() << "WavFileReader: unsupported sample size" << m_bitsPerSample << "with" << m_channelCount << "channels";
+        return false;
+    }
+    m_frameCount = m_dataSize / m_bytesPerFrame;
+    m_position = 0;
+    return true;
+}
+
+int WavFileReader::readMono(float* out, int maxFrames) {
+    const int frames = int(qMin(qint64(maxFrames), m_frameCount - m_position));
+    if (frames <= 0) return 0;
+    const char* data = frameData(m_position, frames);
+    if (!data) return 0;
+
+    const int channels = m_channelCount;
+    const float channelFactor = 1.0f / channels;
+    const int bytesPerSample = m_bitsPerSample / 8;
+    for (int frame = 0; frame < frames; ++frame) {
+        const char* ptr = data + qint64(frame) * m_bytesPerFrame;
+        float sum = 0.0f;
+        for (int channel = 0; channel < channels; ++channel) {
+            if (m_isFloat) {
+                float value;
+                std::memcpy(&value, ptr, 4);
+                sum += value;
+            } else if (bytesPerSample == 2) {
+                sum += float(qFromLittleEndian<qint16>(reinterpret_cast<const uchar*>(ptr))) / 32768;
+            } else if (bytesPerSample == 3) {
+                // sign extension by shifting the 24 bit into the upper bytes of an int32:
+                const qint32 value = qint32(quint32(uchar(ptr[0])) << 8 | quint32(uchar(ptr[1])) << 16
+                                            | quint32(uchar(ptr[2])) << 24) >> 8;
+                sum += float(value) / 8388608;
+            } else if (bytesPerSample == 4) {
+                sum += float(qFromLittleEndian<qint32>(reinterpret_cast<const uchar*>(ptr))) / 2147483648.0f;
+            } else {  // 8 bit is unsigned
+                sum += float(int(uchar(*ptr)) - 128) / 128;
+            }
+            ptr += bytesPerSample;
+        }
+        out[frame] = sum * channelFactor;
+    }
+    m_position += frames;
+    return frames;
+}
+
+const char* WavFileReader::mapData() {
+    if (m_dataSize <= 0) return nullptr;
+    if (m_window && m_windowOffset == m_dataOffset && m_windowSize == m_dataSize) {
+        return reinterpret_cast<const char*>(m_window);
+    }
+    if (m_window) {
+        m_file.unmap(m_window);
+        m_window = nullptr;
+    }
+    m_window = m_file.map(m_dataOffset, m_dataSize);
+    if (!m_window) return nullptr;
+    m_windowOffset = m_dataOffset;
+    m_windowSize = m_dataSize;
+    return reinterpret_cast<const char*>(m_window);
+}
+
+const char* WavFileReader::frameData(qint64 firstFrame, int frames) {
+    const qint64 offset = m_dataOffset + firstFrame * m_bytesPerFrame;
+    const qint64 length = qint64(frames) * m_bytesPerFrame;
+    if (m_window && offset >= m_windowOffset && offset + length <= m_windowOffset + m_windowSize) {
+        return reinterpret_cast<const char*>(m_window) + (offset - m_windowOffset);
+    }
+
+    // map the next window, the previous one is not needed anymore:
+    if (m_window) {
+        m_file.unmap(m_window);
+        m_window = nullptr;
+    }
+    if (!m_mapFailed) {
+        const qint64 size = qMax(length, qMin(MAP_WINDOW_SIZE, m_dataOffset + m_dataSize - offset));
+        m_window = m_file.map(offset, size);
+        if (m_window) {
+            m_windowOffset = offset;
+            m_windowSize = size;
+            return reinterpret_cast<const char*>(m_window);
+        }
+        m_mapFailed = true;
+    }
+
+    // fallback if the file can't be mapped:
+    m_readBuffer.resize(int(length));
+    if (!m_file.seek(offset) || m_file.read(m_readBuffer.data(), length) != length) {
+        qWarning() << "WavFileReader: couldn't read from file: " << m_file.fileName();
+        return nullptr;
+    }
+    return m_readBuffer.constData();
+}
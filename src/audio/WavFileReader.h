@@ -0,0 +1,87 @@
+#ifndef WAVFILEREADER_H
+#define WAVFILEREADER_H
+
+#include <QFile>
+#include <QString>
+
+
+/**
+ * @brief The WavFileReader class reads the samples of a .wav file sequentially
+ * without loading the whole file into memory.
+ *
+ * The sample data is memory-mapped in windows of a few MB that are unmapped
+ * when the next window is needed, so that even files of several GB only occupy
+ * a small part of the address space. If mapping is not possible, the data is read in chunks.
+ *
+ * Supported formats are 8, 16, 24 and 32 bit integer PCM and 32 bit float
+ * with any number of channels.
+ */
+class WavFileReader {
+
+public:
+    /**
+     * @brief WavFileReader creates a reader, open() has to be called before reading
+     * @param filename path to the .wav file
+     */
+    explicit WavFileReader(const QString& filename);
+    ~WavFileReader();
+
+    /**
+     * @brief open opens the file and parses the RIFF header
+     * @return true if the file is a supported .wav file
+     */
+    bool open();
+
+    /**
+     * @brief readMono converts the next frames to mono float samples
+     * @param out output array
+     * @param maxFrames maximum number of frames to read
+     * @return number of frames read, 0 at the end of the file or on error
+     */
+    int readMono(float* out, int maxFrames);
+
+    /**
+     * @brief mapData maps the whole sample data of the file into memory,
+     * the pointer is valid as long as this object exists
+     * @return pointer to the sample data (dataSize() bytes) or nullptr if mapping failed
+     */
+    const char* mapData();
+
+    int getChannelCount() const { return m_channelCount; }
+    int getSampleRate() const { return m_sampleRate; }
+    int getBitsPerSample() const { return m_bitsPerSample; }
+    bool isFloat() const { return m_isFloat; }
+    qint64 getFrameCount() const { return m_frameCount; }
+    qint64 getDataSize() const { return m_dataSize; }
+
+private:
+    /**
+     * @brief frameData returns a pointer to the data of some frames, either in the mapped window
+     * or in the read buffer
+     * @param firstFrame index of the first frame
+     * @param frames number of frames, must not exceed the end of the data
+     * @return pointer to the data or nullptr on error
+     */
+    const char* frameData(qint64 firstFrame, int frames);
+
+protected:
+    QFile m_file;  //!< the .wav file
+
+    int m_channelCount;  //!< number of channels
+    int m_sampleRate;  //!< sample rate in Hz
+    int m_bitsPerSample;  //!< 8, 16, 24 or 32
+    bool m_isFloat;  //!< true for IEEE float samples
+    int m_bytesPerFrame;  //!< size of one frame of all channels in bytes
+    qint64 m_dataOffset;  //!< position of the sample data in the file
+    qint64 m_dataSize;  //!< size of the sample data in bytes
+    qint64 m_frameCount;  //!< number of frames in the file
+
+    qint64 m_position;  //!< index of the next frame to read
+    uchar* m_window;  //!< currently mapped part of the file or nullptr
+    qint64 m_windowOffset;  //!< position of m_window in the file
+    qint64 m_windowSize;  //!< size of m_window in bytes
+    bool m_mapFailed;  //!< true if mapping is not possible and the data is read instead
+    QByteArray m_readBuffer;  //!< buffer for the data if mapping is not possible
+};
+
+#endif // WAVFILEREADER_H
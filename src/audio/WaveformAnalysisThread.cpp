@@ -0,0 +1,66 @@
+#include "WaveformAnalysisThread.h"
+
+#include "AudioAnalysisCache.h"
+#include "WavFileReader.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+
+
+WaveformAnalysisThread::WaveformAnalysisThread(const QString& filename, const QString& cacheDir, QObject* parent)
+    : QThread(parent)
+    , m_filename(filename)
+    , m_cacheDir(cacheDir)
+    , m_abort(false)
+    , m_result(nullptr)
+    , m_wasCached(false)
+    , m_duration(0.0)
+{
+
+}
+
+WaveformAnalysisThread::~WaveformAnalysisThread() {
+    abort();
+    wait();
+}
+
+void WaveformAnalysisThread::run() {
+    QElapsedTimer timer;
+    timer.start();
+
+    QString cacheFilename;
+    QByteArray key;
+    if (!m_cacheDir.isEmpty()) {
+        key = AudioAnalysisCache::keyFor(m_filename);
+        if (!key.isEmpty()) cacheFilename = AudioAnalysisCache::filenameFor(m_cacheDir, key);
+    }
+
+    if (!cacheFilename.isEmpty() && QFileInfo::exists(cacheFilename)) {
+        std::shared_ptr<WaveformPyramid> cached = AudioAnalysisCache::load(cacheFilename, key);
+        if (cached) {
+            m_wasCached = true;
+            m_result = cached;
+            m_duration = timer.nsecsElapsed() / 1000000000.0;
+            return;
+        }
+        qWarning() << "WaveformAnalysisThread: invalid cache file, analyzing again:" << cacheFilename;
+        QFile::remove(cacheFilename);
+    }
+
+    std::shared_ptr<WaveformPyramid> pyramid = std::make_shared<WaveformPyramid>();
+    WavFileReader reader(m_filename);
+    if (!reader.open()) return;
+    if (!pyramid->build(reader, m_abort)) return;
+    m_result = pyramid;
+    m_duration = timer.nsecsElapsed() / 1000000000.0;
+
+    if (!cacheFilename.isEmpty()) {
+        QDir().mkpath(m_cacheDir);
+        if (AudioAnalysisCache::save(cacheFilename, key, *pyramid)) {
+            AudioAnalysisCache::prune(m_cacheDir);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef WAVEFORMANALYSISTHREAD_H
+#define WAVEFORMANALYSISTHREAD_H
+
+#include "WaveformPyramid.h"
+
+#include <QThread>
+
+#include <atomic>
+#include <memory>
+
+
+/**
+ * @brief The WaveformAnalysisThread class creates the WaveformPyramid of a .wav file
+ * in the background.
+ *
+ * The cache entry is looked up by the content-addressed key of the file (see AudioAnalysisCache).
+ * If a valid entry exists, the pyramid is mapped from it. Otherwise the file is read
+ * with a WavFileReader and the result is written to the cache.
+ * The result can be retrieved with getResult() after the finished() signal was emitted.
+ */
+class WaveformAnalysisThread : public QThread {
+
+    Q_OBJECT
+
+public:
+    /**
+     * @brief WaveformAnalysisThread creates the thread, it is not started
+     * @param filename path to the .wav file
+     * @param cacheDir directory of the cache files or an empty string to not use a cache
+     * @param parent QObject parent
+     */
+    WaveformAnalysisThread(const QString& filename, const QString& cacheDir, QObject* parent);
+    ~WaveformAnalysisThread() override;
+
+    /**
+     * @brief abort requests the thread to stop as soon as possible, doesn't block
+     */
+    void abort() { m_abort = true; }
+
+    /**
+     * @brief getResult returns the created pyramid, must only be called after the thread finished
+     * @return the pyramid or nullptr if the file couldn't be analyzed
+     */
+    std::shared_ptr<const WaveformPyramid> getResult() const { return m_result; }
+
+    /**
+     * @brief getWasCached returns if the result was loaded from the cache file
+     * @return true if the cache was used
+     */
+    bool getWasCached() const { return m_wasCached; }
+
+    /**
+     * @brief getDuration returns the time it took to create the result
+     * @return duration in seconds
+     */
+    double getDuration() const { return m_duration; }
+
+protected:
+    void run() override;
+
+protected:
+    const QString m_filename;  //!< path to the .wav file
+    const QString m_cacheDir;  //!< directory of the cache files or empty
+    std::atomic<bool> m_abort;  //!< true if the thread should stop
+    std::shared_ptr<const WaveformPyramid> m_result;  //!< the result, written by the thread
+    bool m_wasCached;  //!< true if the result was loaded from the cache
+    double m_duration;  //!< time it took to create the result in s
+};
+
+#endif // WAVEFORMANALYSISTHREAD_H
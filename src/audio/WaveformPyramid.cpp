@@ -0,0 +1,131 @@
+#include "WaveformPyramid.h"
+
+#include "WavFileReader.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace {
+
+// number of first level buckets to read from the file at once:
+const int BUCKETS_PER_READ = 64;
+
+inline qint16 toInt16(float value) {
+    return qint16(std::max(-32768.0f, std::min(value * 32768.0f, 32767.0f)));
+}
+
+inline WaveformBucket combine(const WaveformBucket& a, const WaveformBucket& b) {
+    return WaveformBucket {std::min(a.min, b.min), std::max(a.max, b.max), (a.meanSquare + b.meanSquare) / 2};
+}
+
+}  // namespace
+
+
+WaveformPyramid::WaveformPyramid()
+    : m_frameCount(0)
+    , m_sampleRate(0)
+{
+
+}
+
+bool WaveformPyramid::build(WavFileReader& reader, const std::atomic<bool>& abort) {
+    m_frameCount = reader.getFrameCount();
+    m_sampleRate = reader.getSampleRate();
+    m_levels.clear();
+    m_ownedLevels.clear();
+    m_mappedFile = nullptr;
+    if (m_frameCount <= 0) return false;
+
+    // ------------- first level from the samples:
+    std::vector<WaveformBucket> base;
+    base.reserve(std::size_t(m_frameCount / BASE_BUCKET_FRAMES + 1));
+    std::vector<float> samples(BASE_BUCKET_FRAMES * BUCKETS_PER_READ);
+    while (true) {
+        if (abort) return false;
+        const int frames = reader.readMono(samples.data(), int(samples.size()));
+        if (frames <= 0) break;
+        for (int bucketStart = 0; bucketStart < frames; bucketStart += BASE_BUCKET_FRAMES) {
+            const int count = std::min(BASE_BUCKET_FRAMES, frames - bucketStart);
+            const float* values = samples.data() + bucketStart;
+            float min = values[0];
+            float max = values[0];
+            float sumOfSquares = 0.0f;
+            for (int i = 0; i < count; ++i) {
+                min = std::min(min, values[i]);
+                max = std::max(max, values[i]);
+                sumOfSquares += values[i] * values[i];
+            }
+            base.push_back(WaveformBucket {toInt16(min), toInt16(max), sumOfSquares / count});
+        }
+    }
+    if (base.empty()) return false;
+    m_ownedLevels.push_back(std::move(base));
+
+    // ------------- following levels from the level below:
+    while (m_ownedLevels.back().size() > 1) {
+        if (abort) return false;
+        const std::vector<WaveformBucket>& lower = m_ownedLevels.back();
+        std::vector<WaveformBucket> level((lower.size() + 1) / 2);
+        for (std::size_t i = 0; i < level.size(); ++i) {
+            const std::size_t first = 2 * i;
+            level[i] = first + 1 < lower.size() ? combine(lower[first], lower[first + 1]) : lower[first];
+        }
+        m_ownedLevels.push_back(std::move(level));
+    }
+
+    for (const std::vector<WaveformBucket>& level: m_ownedLevels) {
+        m_levels.push_back(Level {level.data(), level.size()});
+    }
+    return true;
+}
+
+void WaveformPyramid::setMappedLevels(std::shared_ptr<QFile> file, qint64 frameCount, int sampleRate, const std::vector<Level>& levels) {
+    m_ownedLevels.clear();
+    m_mappedFile = file;
+    m_frameCount = frameCount;
+    m_sampleRate = sampleRate;
+    m_levels = levels;
+}
+
+void WaveformPyramid::query(double start, double end, int pixelCount, std::vector<WaveformBucket>& out) const {
+    out.assign(std::size_t(std::max(0, pixelCount)), WaveformBucket {0, 0, 0.0f});
+    if (m_levels.empty() || pixelCount <= 0 || end <= start) return;
+
+    const double startFrame = std::max(0.0, start) * m_frameCount;
+    const double endFrame = std::min(1.0, end) * m_frameCount;
+    const double framesPerPixel = (endFrame - startFrame) / pixelCount;
+    if (framesPerPixel <= 0) return;
+
+    // the coarsest level that still has at least one bucket per pixel:
+    std::size_t level = 0;
+    while (level + 1 < m_levels.size() && double(qint64(BASE_BUCKET_FRAMES) << (level + 1)) <= framesPerPixel) {
+        ++level;
+    }
+    const WaveformBucket* buckets = m_levels[level].buckets;
+    const double bucketFrames = double(qint64(BASE_BUCKET_FRAMES) << level);
+    const qint64 bucketCount = qint64(m_levels[level].size);
+
+    // each pixel combines the (one to three) buckets its range overlaps:
+    for (int pixel = 0; pixel < pixelCount; ++pixel) {
+        const qint64 first = std::min(bucketCount - 1, qint64((startFrame + pixel * framesPerPixel) / bucketFrames));
+        const qint64 last = std::min(bucketCount, std::max(first + 1, qint64(std::ceil((startFrame + (pixel + 1) * framesPerPixel) / bucketFrames))));
+        WaveformBucket result = buckets[std::size_t(first)];
+        for (qint64 i = first + 1; i < last; ++i) {
+            const WaveformBucket& bucket = buckets[std::size_t(i)];
+            result.min = std::min(result.min, bucket.min);
+            result.max = std::max(result.max, bucket.max);
+            result.meanSquare += bucket.meanSquare;
+        }
+        result.meanSquare /= (last - first);
+        out[std::size_t(pixel)] = result;
+    }
+}
+
+qint64 WaveformPyramid::getMemorySize() const {
+    qint64 size = 0;
+    for (const Level& level: m_levels) {
+        size += qint64(level.size * sizeof(WaveformBucket));
+    }
+    return size;
+}
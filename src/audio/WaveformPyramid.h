@@ -0,0 +1,98 @@
+#ifndef WAVEFORMPYRAMID_H
+#define WAVEFORMPYRAMID_H
+
+#include <QFile>
+#include <QtGlobal>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class WavFileReader;  // forward declaration
+
+
+/**
+ * @brief The WaveformBucket struct contains the summary of a range of samples.
+ */
+struct WaveformBucket {
+    qint16 min;  //!< minimum sample value scaled to int16
+    qint16 max;  //!< maximum sample value scaled to int16
+    float meanSquare;  //!< mean of the squared samples [0...1]
+};
+
+
+/**
+ * @brief The WaveformPyramid class stores min / max / RMS summaries of an audio file
+ * in multiple resolutions.
+ *
+ * The first level summarizes BASE_BUCKET_FRAMES frames per bucket, each following level
+ * combines two buckets of the level below. A query for any time range and any number of pixels
+ * uses the coarsest level that still has at least one bucket per pixel,
+ * so it only touches O(pixelCount) buckets.
+ *
+ * The levels are either owned by the pyramid (after build()) or point into a memory-mapped
+ * cache file (see AudioAnalysisCache), in the latter case the pyramid keeps the file mapped.
+ * A pyramid for a 90 min 48 kHz file needs about 16 MB.
+ */
+class WaveformPyramid {
+
+public:
+    // number of frames summarized by one bucket of the first level:
+    static const int BASE_BUCKET_FRAMES = 256;
+
+    /**
+     * @brief The Level struct describes the buckets of one level.
+     */
+    struct Level {
+        const WaveformBucket* buckets;  //!< pointer to the first bucket
+        std::size_t size;  //!< number of buckets
+    };
+
+    WaveformPyramid();
+
+    /**
+     * @brief build reads the whole file and calculates all levels
+     * @param reader an opened reader positioned at the first frame
+     * @param abort is checked regularly, if it becomes true the build is canceled
+     * @return true if successful, false if the build was canceled or the file couldn't be read
+     */
+    bool build(WavFileReader& reader, const std::atomic<bool>& abort);
+
+    /**
+     * @brief setMappedLevels uses levels that are stored in a memory-mapped file
+     * @param file the mapped file, kept open as long as this pyramid exists
+     * @param frameCount number of frames in the audio file
+     * @param sampleRate sample rate of the audio file
+     * @param levels the levels from fine to coarse, pointing into the mapped memory
+     */
+    void setMappedLevels(std::shared_ptr<QFile> file, qint64 frameCount, int sampleRate, const std::vector<Level>& levels);
+
+    /**
+     * @brief query summarizes a time range of the file in pixelCount buckets
+     * @param start begin of the range relative to the file length [0...1]
+     * @param end end of the range relative to the file length [0...1]
+     * @param pixelCount number of buckets to return
+     * @param out output for pixelCount buckets
+     */
+    void query(double start, double end, int pixelCount, std::vector<WaveformBucket>& out) const;
+
+    qint64 getFrameCount() const { return m_frameCount; }
+    int getSampleRate() const { return m_sampleRate; }
+    const std::vector<Level>& getLevels() const { return m_levels; }
+    bool isMapped() const { return m_mappedFile != nullptr; }
+
+    /**
+     * @brief getMemorySize returns the size of all levels
+     * @return size in bytes
+     */
+    qint64 getMemorySize() const;
+
+protected:
+    qint64 m_frameCount;  //!< number of frames in the file
+    int m_sampleRate;  //!< sample rate of the file in Hz
+    std::vector<Level> m_levels;  //!< levels from fine to coarse
+    std::vector<std::vector<WaveformBucket>> m_ownedLevels;  //!< storage of the levels after build()
+    std::shared_ptr<QFile> m_mappedFile;  //!< the file the levels are mapped from or null
+};
+
+#endif // WAVEFORMPYRAMID_H
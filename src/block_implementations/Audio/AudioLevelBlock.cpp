@@ -41,6 +41,9 @@ AudioLevelBlock::AudioLevelBlock(MainController *controller, QString uid)
     , m_spectrogramPos(0)
 {
     m_widthIsResizable = true;
+    connect(this, SIGNAL(currentBandChanged()), this, SLOT(updateAnalysisTier()));
+    connect(this, SIGNAL(frequencyModeChanged()), this, SLOT(updateAnalysisTier()));
+    connect(&m_showSpectrogram, SIGNAL(valueChanged()), this, SLOT(updateAnalysisTier()));
 
     AudioInputAnalyzer* analyzer = controller->audioEngine()->getDefaultAnalyzer();
     if (analyzer) {
@@ -110,6 +113,11 @@ void AudioLevelBlock::updateOutput() {
 
 }
 
+void AudioLevelBlock::updateAnalysisTier() {
+    // (changes the tier of the already registered reference)
+    if (m_analyzer) m_analyzer->addReference(this, requiredTier());
+}
+
 QVector<double> AudioLevelBlock::getSpectrumPoints() {
     if (!m_analyzer) return QVector<double>();
     const auto spectrum = m_analyzer->getSimplifiedSpectrum();
@@ -125,7 +133,7 @@ void AudioLevelBlock::setInputByName(QString name) {
         m_analyzer->removeReference(this);
     }
     m_analyzer = newAnalyzer;
-    m_analyzer->addReference(this);
+    m_analyzer->addReference(this, requiredTier());
     connect(m_analyzer, SIGNAL(spectrumChanged()), this, SLOT(updateOutput()));
     emit inputChanged();
 }
@@ -192,6 +200,15 @@ void AudioLevelBlock::updateOutputLevel() {
     m_lastValue = value;
 }
 
+AudioAnalysisTier AudioLevelBlock::requiredTier() const {
+    // the long FFT is only required for an exact bass range,
+    // i.e. if the selection starts in it or the whole spectrum is displayed:
+    if (m_frequencyMode || m_showSpectrogram || m_currentBand < AudioInputAnalyzer::longSpectrumBoundary()) {
+        return SpectrumTier;
+    }
+    return BandsTier;
+}
+
 void AudioLevelBlock::updateOutputFrequency() {
     if (!m_analyzer) return;
     const std::vector<double>& spectrum = m_analyzer->getSimplifiedSpectrum();
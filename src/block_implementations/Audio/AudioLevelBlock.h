@@ -89,6 +89,11 @@ public slots:
 
     void updateOutput();
 
+    /**
+     * @brief updateAnalysisTier requests the long bass spectrum from the analyzer only if it is used
+     */
+    void updateAnalysisTier();
+
     QVector<double> getSpectrumPoints();
 
     QString getInputName() const;
@@ -126,6 +131,7 @@ public slots:
 private:
     void updateOutputLevel();
     void updateOutputFrequency();
+    AudioAnalysisTier requiredTier() const;
 
 protected:
     QPointer<AudioInputAnalyzer> m_analyzer;
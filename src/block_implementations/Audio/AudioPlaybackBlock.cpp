@@ -48,6 +48,8 @@ AudioPlaybackBlock::AudioPlaybackBlock(MainController* controller, QString uid)
     connect(&m_player, SIGNAL(positionChanged()), this, SLOT(onPlaybackPositionChanged()));
     connect(&m_player, SIGNAL(lengthChanged()), this, SIGNAL(lengthChanged()));
 
+    // the waveforms are cached next to the projects:
+    m_waveform.setCacheDir(controller->dao()->getDataDir("projects") + "waveforms/");
     connect(&m_waveform, SIGNAL(pointsChanged()), this, SIGNAL(waveformChanged()));
     connect(&m_waveform, SIGNAL(availableChanged()), this, SIGNAL(waveformChanged()));
 }
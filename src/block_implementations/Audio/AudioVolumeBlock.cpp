@@ -50,7 +50,8 @@ void AudioVolumeBlock::setInputByName(QString name) {
         m_analyzer->removeReference(this);
     }
     m_analyzer = newAnalyzer;
-    m_analyzer->addReference(this);
+    // the max level, its AGC and the spectral flux are calculated from the short FFT:
+    m_analyzer->addReference(this, BandsTier);
     connect(m_analyzer, SIGNAL(spectrumChanged()), this, SLOT(updateOutput()));
     emit inputChanged();
 }
@@ -54,7 +54,9 @@ Hog4FaderBlock::Hog4FaderBlock(MainController* controller, QString uid)
     connect(&m_flashButton, &BoolAttribute::valueChanged, this, &Hog4FaderBlock::sendFlashButton);
     connect(&m_faderValue, &DoubleAttribute::valueChanged, this, &Hog4FaderBlock::sendFaderValue);
 
-    connect(controller->lightingConsole(), SIGNAL(messageReceived(OSCMessage)), this, SLOT(onMessageReceived(OSCMessage)));
+    auto handler = [this](const OSCMessageView& view) { onMessageReceived(view.toMessage()); };
+    controller->lightingConsole()->dispatcher()->addHandler("/hog/status/led/{choose,flash}/*", this, handler);
+    controller->lightingConsole()->dispatcher()->addHandler("/hog/hardware/fader/*", this, handler);
 }
 
 void Hog4FaderBlock::onMessageReceived(OSCMessage msg) {
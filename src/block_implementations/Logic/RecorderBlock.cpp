@@ -40,22 +40,43 @@ RecorderBlock::RecorderBlock(MainController* controller, QString uid)
     connect(m_toggleNode, SIGNAL(impulseEnd()), this, SLOT(stopPlayback()));
 
     connect(m_controller->engine(), SIGNAL(updateBlocks(double)), this, SLOT(eachFrame()));
+
+    // m_data only changes while recording:
+    m_additionalStateIsTracked = true;
 }
 
 void RecorderBlock::getAdditionalState(QJsonObject& state) const {
-    state["data"] = serialize<QVector<double>>(m_data);
+    ProjectBlobStore* blobs = m_controller->projectManager()->blobs();
+    QJsonValue reference;
+    if (!m_pendingData.isNull()) {
+        // still in the little-endian format of the file, no need to decode it:
+        reference = blobs->write(m_pendingData.data(), m_pendingData.size());
+    } else {
+        reference = blobs->writeArray<double>(m_data.constData(), m_data.size());
+    }
+    // fall back to the inline format if no binary file is written:
+    state["data"] = reference.isUndefined() ? QJsonValue(serialize<QVector<double>>(data())) : reference;
 }
 
 void RecorderBlock::setAdditionalState(const QJsonObject& state) {
     readAttributesFrom(state);
-    m_data = deserialize<QVector<double>>(state["data"].toString());
+    if (ProjectBlobStore::isReference(state["data"])) {
+        // decoded when it is needed for the first time:
+        m_pendingData = m_controller->projectManager()->blobs()->read(state["data"]);
+        m_data.clear();
+    } else {
+        m_pendingData = ProjectBlob();
+        m_data = deserialize<QVector<double>>(state["data"].toString());
+    }
 }
 
 void RecorderBlock::startRecording() {
     if (m_playing) {
         stopPlayback();
     }
+    m_pendingData = ProjectBlob();
     m_data.clear();
+    markStateDirty();
     m_recording.setValue(true);
 }
 
@@ -106,8 +127,17 @@ double RecorderBlock::getBpm() const {
     return bpm;
 }
 
+const QVector<double>& RecorderBlock::data() const {
+    if (!m_pendingData.isNull()) {
+        m_data.resize(m_pendingData.count<double>());
+        m_pendingData.decode<double>(m_data.data());
+        m_pendingData = ProjectBlob();
+    }
+    return m_data;
+}
+
 void RecorderBlock::eachFrame() {
-    if (m_playing && !m_data.isEmpty()) {
+    if (m_playing && !data().isEmpty()) {
         // playing
         double value = m_data[m_playbackPosition % m_data.size()];
         m_outputNode->setValue(value);
@@ -133,6 +163,7 @@ void RecorderBlock::eachFrame() {
         // recording
         double value = m_inputNode->getValue();
         m_data.append(value);
+        markStateDirty();
         m_outputNode->setValue(value);
         emit dataChanged();
         emit durationChanged();
@@ -5,6 +5,7 @@
 #include "core/SmartAttribute.h"
 #include "core/Matrix.h"
 #include "core/Nodes.h"
+#include "core/manager/BinaryProjectFile.h"
 #include "utils.h"
 
 
@@ -58,11 +59,11 @@ public slots:
 
     // ------------ Getter + Setter --------------
 
-    QVector<double> getData() const { return m_data; }
+    QVector<double> getData() const { return data(); }
 
-    double getRelativePosition() const { return m_data.size() > 0 ? double(m_playbackPosition) / m_data.size() : 0.0; }
+    double getRelativePosition() const { return dataSize() > 0 ? double(m_playbackPosition) / dataSize() : 0.0; }
 
-    double getDuration() const { return m_data.size() / 50.0 /* 50 FPS */; }
+    double getDuration() const { return dataSize() / 50.0 /* 50 FPS */; }
 
     double getBpm() const;
 
@@ -70,6 +71,20 @@ public slots:
 private slots:
     void eachFrame();
 
+protected:
+    /**
+     * @brief data returns the recorded values, decodes them first if they were
+     * loaded from a binary project file and not used yet
+     * @return recorded values
+     */
+    const QVector<double>& data() const;
+
+    /**
+     * @brief dataSize returns the number of recorded values without decoding them
+     * @return number of values
+     */
+    int dataSize() const { return m_pendingData.isNull() ? m_data.size() : m_pendingData.count<double>(); }
+
 protected:
     QPointer<NodeBase> m_recordNode;
     QPointer<NodeBase> m_playNode;
@@ -87,7 +102,8 @@ protected:
 
     int m_playbackPosition;
 
-    QVector<double> m_data;
+    mutable QVector<double> m_data;
+    mutable ProjectBlob m_pendingData;  //!< loaded but not yet decoded values of m_data
 };
 
 #endif // RECORDERBLOCK_H
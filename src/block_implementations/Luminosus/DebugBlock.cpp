@@ -21,6 +21,14 @@
 #include "DebugBlock.h"
 
 #include "core/MainController.h"
+#include "core/MatrixKernels.h"
+#include "core/block_data/FixtureBlock.h"
+#include "core/manager/BinaryProjectFile.h"
+#include "block_implementations/Theater/CueListBlock.h"
+#include "audio/AudioEngine.h"
+#include "audio/AudioInputAnalyzer.h"
+#include "light/DmxRenderer.h"
+#include "sacn/sacnlistener.h"
 
 
 void DebugBlock::addAllBlockTypes() {
@@ -34,3 +42,70 @@ void DebugBlock::addAllBlockTypes() {
 void DebugBlock::deleteAllBlocks() {
 	m_controller->blockManager()->deleteAllBlocks();
 }
+
+void DebugBlock::benchmarkSAcnMerge() {
+    sACNListener::benchmarkMerge();
+}
+
+void DebugBlock::benchmarkOscDispatch() {
+    OSCAddressDispatcher::benchmark();
+}
+
+void DebugBlock::logStatistics() {
+    // the statistics of all subsystems in one place, to not need a button for each of them:
+    qInfo() << "sACN reception:" << sACNManager::getInstance()->getReceiveStatistics();
+#ifdef QT_NO_DEBUG
+    qInfo() << "ColorMatrix copies and allocations are only counted in debug builds.";
+#else
+    // log the difference to the last call to see the copies while the project is running:
+    static quint64 lastCopyCount = 0;
+    static quint64 lastAllocationCount = 0;
+    const quint64 copyCount = ColorMatrix::copyCount();
+    const quint64 allocationCount = ColorMatrix::allocationCount();
+    qInfo() << "ColorMatrix: copies:" << copyCount << "(+" << copyCount - lastCopyCount << ")"
+            << "allocations:" << allocationCount << "(+" << allocationCount - lastAllocationCount << ")";
+    lastCopyCount = copyCount;
+    lastAllocationCount = allocationCount;
+#endif
+    qInfo() << "Audio analysis cost:" << m_controller->audioEngine()->getAnalysisCost();
+    qInfo() << "Midi input events:" << m_controller->midi()->getInputStatistics();
+    qInfo() << "Last project save:" << m_controller->projectManager()->getSaveStatistics();
+    qInfo() << "Cue list fades:" << CueListBlock::getFadeStatistics();
+    qInfo() << "GUI notifications:" << m_controller->guiUpdateBatcher()->getStatistics();
+}
+
+void DebugBlock::resetStatistics() {
+    CueListBlock::resetFadeStatistics();
+}
+
+void DebugBlock::benchmarkMatrixKernels() {
+    MatrixKernels::benchmark();
+}
+
+void DebugBlock::benchmarkGraphEvaluation() {
+    m_controller->blockManager()->benchmarkGraphEvaluation();
+}
+
+void DebugBlock::measureAudioOnsetLatency() {
+    m_controller->audioEngine()->measureOnsetLatency();
+}
+
+void DebugBlock::benchmarkAudioAnalysis() {
+    AudioInputAnalyzer::benchmarkAnalysis(m_controller);
+}
+
+void DebugBlock::logProjectFormatBenchmark() {
+    BinaryProjectFile::benchmark();
+}
+
+void DebugBlock::benchmarkFixtureChain() {
+    FixtureBlock::benchmarkChain(m_controller);
+}
+
+void DebugBlock::benchmarkDmxRender() {
+    DmxRenderer::benchmark();
+}
+
+void DebugBlock::benchmarkCueTimeline() {
+    CueListBlock::benchmarkTimeline(m_controller);
+}
@@ -55,6 +55,32 @@ public slots:
 	void addAllBlockTypes();
 
 	void deleteAllBlocks();
+
+    // ----------------- Benchmarks:
+
+    void benchmarkSAcnMerge();
+
+    void benchmarkOscDispatch();
+
+    void logStatistics();
+
+    void resetStatistics();
+
+    void benchmarkMatrixKernels();
+
+    void benchmarkGraphEvaluation();
+
+    void measureAudioOnsetLatency();
+
+    void benchmarkAudioAnalysis();
+
+    void logProjectFormatBenchmark();
+
+    void benchmarkFixtureChain();
+
+    void benchmarkDmxRender();
+
+    void benchmarkCueTimeline();
 };
 
 #endif // DEBUGBLOCK_H
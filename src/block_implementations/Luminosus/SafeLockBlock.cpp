@@ -22,6 +22,10 @@ SafeLockBlock::SafeLockBlock(MainController* controller, QString uid)
     , m_otherDirection(0.0)
     , m_displayedItem(nullptr)
 {
+    // the lock is displayed on the OLED item of the DecisionEngine, not in the block GUI:
+    m_angle.setNotifiesGuiAlways(true);
+    m_valid.setNotifiesGuiAlways(true);
+
     m_inputNode->enableImpulseDetection();
     connect(m_inputNode, SIGNAL(impulseBegin()), this, SLOT(show()));
 }
@@ -31,11 +31,8 @@ OscInBlock::OscInBlock(MainController *controller, QString uid)
 	, m_maxValue(1)
 {
     connect(m_controller, SIGNAL(sendCustomOscToEosChanged()), this, SLOT(updateConnection()));
-    if (m_controller->getSendCustomOscToEos()) {
-        connect(controller->lightingConsole(), SIGNAL(messageReceived(OSCMessage)), this, SLOT(onMessageReceived(OSCMessage)));
-    } else {
-        connect(controller->customOsc(), SIGNAL(messageReceived(OSCMessage)), this, SLOT(onMessageReceived(OSCMessage)));
-    }
+    connect(this, SIGNAL(messageChanged()), this, SLOT(updateConnection()));
+    updateConnection();
 }
 
 void OscInBlock::getAdditionalState(QJsonObject& state) const {
@@ -50,17 +47,16 @@ void OscInBlock::setAdditionalState(const QJsonObject &state) {
 	setMaxValue(state["maxValue"].toDouble());
 }
 
-void OscInBlock::onMessageReceived(OSCMessage msg) {
-	if (msg.pathString() == m_message) {
-		emit validMessageReceived();
-		if (msg.arguments().size() == 0) {
-			m_outputNode->setValue(1.0);
-			QTimer::singleShot(100, this, SLOT(onEndOfPulse()));
-		} else {
-			double value = (msg.value() - m_minValue) / (m_maxValue - m_minValue);
-			value = limit(0, value, 1);
-			m_outputNode->setValue(value);
-		}
+void OscInBlock::onMessageReceived(const OSCMessageView& msg) {
+	// the dispatcher only passes messages matching m_message:
+	emit validMessageReceived();
+	if (msg.argumentCount() == 0) {
+		m_outputNode->setValue(1.0);
+		QTimer::singleShot(100, this, SLOT(onEndOfPulse()));
+	} else {
+		double value = (msg.value() - m_minValue) / (m_maxValue - m_minValue);
+		value = limit(0, value, 1);
+		m_outputNode->setValue(value);
 	}
 }
 
@@ -69,13 +65,15 @@ void OscInBlock::onEndOfPulse() {
 }
 
 void OscInBlock::updateConnection() {
-    if (m_controller->getSendCustomOscToEos()) {
-        disconnect(m_controller->customOsc(), SIGNAL(messageReceived(OSCMessage)), this, SLOT(onMessageReceived(OSCMessage)));
-        connect(m_controller->lightingConsole(), SIGNAL(messageReceived(OSCMessage)), this, SLOT(onMessageReceived(OSCMessage)));
-    } else {
-        disconnect(m_controller->lightingConsole(), SIGNAL(messageReceived(OSCMessage)), this, SLOT(onMessageReceived(OSCMessage)));
-        connect(m_controller->customOsc(), SIGNAL(messageReceived(OSCMessage)), this, SLOT(onMessageReceived(OSCMessage)));
-    }
+    m_controller->lightingConsole()->dispatcher()->removeHandlers(this);
+    m_controller->customOsc()->dispatcher()->removeHandlers(this);
+    if (!m_message.startsWith("/")) return;
+
+    OSCNetworkManager* osc = m_controller->getSendCustomOscToEos() ? m_controller->lightingConsole()
+                                                                   : m_controller->customOsc();
+    // the message is entered by the user and has to match exactly, wildcard characters are not special:
+    osc->dispatcher()->addHandler(m_message, this, [this](const OSCMessageView& msg) { onMessageReceived(msg); },
+                                  /*literal*/ true);
 }
 
 void OscInBlock::setMinValue(double value) {
@@ -22,7 +22,7 @@
 #define OSCINBLOCK_H
 
 #include "core/block_data/OneOutputBlock.h"
-#include "osc/OSCMessage.h"
+#include "osc/OSCMessageView.h"
 
 
 class OscInBlock : public OneOutputBlock
@@ -67,7 +67,7 @@ signals:
 public slots:
 	virtual BlockInfo getBlockInfo() const override { return info(); }
 
-	void onMessageReceived(OSCMessage msg);
+	void onMessageReceived(const OSCMessageView& msg);
 
 	void onEndOfPulse();
 
@@ -2,8 +2,12 @@
 
 #include "core/MainController.h"
 #include "core/Nodes.h"
+#include "core/block_data/FixtureBlock.h"
 #include "block_implementations/Theater/PresetBlock.h"
 
+#include <QElapsedTimer>
+
+CueListBlock::FadeStatistics CueListBlock::s_fadeStatistics;
 
 CueListBlock::CueListBlock(MainController* controller, QString uid)
     : BlockBase(controller, uid)
@@ -17,6 +21,9 @@ CueListBlock::CueListBlock(MainController* controller, QString uid)
     , m_holdPos(this, "holdPos", 0.0, 0.0, 1.0, /*persistent*/ false)
     , m_master(this, "master", 1.0)
     , m_manualFadeUp(true)
+    , m_timeline(this)
+    , m_clock(0.0)
+    , m_manualFadeIsActive(false)
 {
     m_widthIsResizable = true;
     m_heightIsResizable = true;
@@ -30,6 +37,15 @@ CueListBlock::CueListBlock(MainController* controller, QString uid)
 
     connect(m_controller->projectManager(), SIGNAL(projectLoadingFinished()), this, SLOT(convertPersistedCues()));
     connect(m_controller->engine(), SIGNAL(updateBlocks(double)), this, SLOT(eachFrame(double)));
+    connect(this, SIGNAL(cuesChanged()), this, SLOT(invalidateTimeline()));
+}
+
+CueListBlock::~CueListBlock() {
+    // remove the scene data of this cue list from the fixtures:
+    m_timeline.release();
+    for (Cue* cue: m_cues) {
+        if (cue) cue->deleteLater();
+    }
 }
 
 void CueListBlock::getAdditionalState(QJsonObject& state) const {
@@ -81,21 +97,22 @@ void CueListBlock::createCueFromMix() {
 }
 
 void CueListBlock::go() {
-    if (m_fadePos < 1.0 && m_activeCue) {
-        // cue fade is running, skip to end:
-        m_fadePos = 0.999;
-    } else if (m_holdPos < 1.0 && m_activeCue && m_activeCue->follow()) {
+    if (m_fadePos >= 1.0 && m_holdPos < 1.0 && m_activeCue && m_activeCue->follow()) {
         // hold is running, skip to end:
         m_holdPos = 0.999;
     } else {
-        // cue fade and hold is at the end, fire next cue:
+        // fire next cue, if a fade is running the tracks that don't change continue their fade:
+        if (m_manualFadeIsActive) {
+            // the tracks of a manual fade are not on the time base of m_clock:
+            m_timeline.finishFades();
+            m_manualFadeIsActive = false;
+        }
         m_lastCue = m_activeCue;
         if (!m_pendingCue) chooseNewPendingCue();
         m_activeCue = m_pendingCue;
         chooseNewPendingCue();
         emit cueStatesChanged();
-        m_fadePos = 0.0;
-        m_holdPos = 0.0;
+        startActiveCue(m_clock, m_activeCue ? m_activeCue->fadeIn() : 0.0);
     }
     m_running = true;
 }
@@ -117,16 +134,8 @@ void CueListBlock::removeCue(QObject* item) {
     if (!cue) return;
     if (!m_cues.contains(cue)) return;
     // remove scene data coming from this cue:
-    if (cue->sceneBlock()) {
-        QMap<QPointer<BlockInterface>, HsvMatrix>* scene = cue->sceneBlock()->getSceneData();
-        if (scene) {
-            auto end = scene->constEnd();
-            for (auto it = scene->constBegin(); it != end; ++it) {
-                const QPointer<BlockInterface>& block = it.key();
-                if (!block) continue;
-                block->removeSceneData(this);
-            }
-        }
+    if (cue == m_lastCue || cue == m_activeCue) {
+        m_timeline.release();
     }
     m_cues.removeAll(cue);
     if (m_lastCue == cue) {
@@ -216,28 +225,8 @@ void CueListBlock::moveBelow(QObject* cueToMoveO, QObject* anchorO) {
 
 void CueListBlock::pauseAndClear() {
     m_running = false;
-    if (m_lastCue && m_lastCue->sceneBlock()) {
-        QMap<QPointer<BlockInterface>, HsvMatrix>* scene = m_lastCue->sceneBlock()->getSceneData();
-        if (scene) {
-            auto end = scene->constEnd();
-            for (auto it = scene->constBegin(); it != end; ++it) {
-                const QPointer<BlockInterface>& block = it.key();
-                if (!block) continue;
-                block->removeSceneData(this);
-            }
-        }
-    }
-    if (m_activeCue && m_activeCue->sceneBlock()) {
-        QMap<QPointer<BlockInterface>, HsvMatrix>* scene = m_activeCue->sceneBlock()->getSceneData();
-        if (scene) {
-            auto end = scene->constEnd();
-            for (auto it = scene->constBegin(); it != end; ++it) {
-                const QPointer<BlockInterface>& block = it.key();
-                if (!block) continue;
-                block->removeSceneData(this);
-            }
-        }
-    }
+    m_manualFadeIsActive = false;
+    m_timeline.release();
     m_lastCue = nullptr;
     m_pendingCue = m_activeCue;
     m_activeCue = nullptr;
@@ -284,80 +273,40 @@ QList<QObject*> CueListBlock::getCues() {
 void CueListBlock::eachFrame(double timeSinceLastFrame) {
     // prerequirements:
     if (!m_running) return;
+    // the manual fade node drives the tracks:
+    if (m_manualFadeIsActive) return;
     Cue* activeCue = m_activeCue;
     if (!activeCue) {
         qWarning() << "CueListBlock::eachFrame(): active cue is not set";
         m_running = false;
         return;
     }
+    m_clock += timeSinceLastFrame;
+
+    // the tracks of the active cue and still running fades of previous cues:
+    if (m_timeline.isFading()) {
+        QElapsedTimer timer;
+        timer.start();
+        const qint64 allocationsBefore = BlockBase::sceneMixStatistics().allocations;
+
+        m_timeline.advance(m_clock);
+        m_timeline.send(m_master);
+
+        ++s_fadeStatistics.frames;
+        s_fadeStatistics.nanoseconds += timer.nsecsElapsed();
+        s_fadeStatistics.allocations += BlockBase::sceneMixStatistics().allocations - allocationsBefore;
+    } else {
+        // only sends something if the master changed:
+        m_timeline.send(m_master);
+    }
 
     if (m_fadePos < 1.0) {
         // is still in fade phase:
-
         double fadeIn = activeCue->fadeIn();
         if (fadeIn <= (1.0 / 50.0)) {
             m_fadePos = 1.0;
         } else {
-            m_fadePos = m_fadePos + timeSinceLastFrame / fadeIn;
-        }
-        if (m_fadePos < 1.0) {
-            // in fade:
-            Cue* lastCue = m_lastCue;
-            if (!lastCue) {
-                // last cue doesn't exist, fade from black:
-                QMap<QPointer<BlockInterface>, HsvMatrix>* activeScene = nullptr;
-                if (activeCue->sceneBlock()) {
-                    activeScene = activeCue->sceneBlock()->getSceneData();
-                }
-                if (!activeScene) {
-                    qWarning()<< "CueListBlock::eachFrame(): Scene data has been deleted 1.";
-                    return;
-                }
-                sendScene(*activeScene, m_fadePos);
-            } else {
-                // last cue exists, fade from there:
-                QMap<QPointer<BlockInterface>, HsvMatrix>* lastScene = nullptr;
-                QMap<QPointer<BlockInterface>, HsvMatrix>* activeScene = nullptr;
-                if (lastCue->sceneBlock()) {
-                    lastScene = lastCue->sceneBlock()->getSceneData();
-                }
-                if (activeCue->sceneBlock()) {
-                    activeScene = activeCue->sceneBlock()->getSceneData();
-                }
-                if (!lastScene || !activeScene) {
-                    qWarning() << "CueListBlock::eachFrame(): Scene data has been deleted 2.";
-                    return;
-                }
-                // real fading:
-                sendInbetweenResult(*lastScene, *activeScene, m_fadePos);
-            }
-        } else {
-            // end of fade
-            if (m_lastCue && m_lastCue->sceneBlock()) {
-                QMap<QPointer<BlockInterface>, HsvMatrix>* scene = m_lastCue->sceneBlock()->getSceneData();
-                if (scene) {
-                    auto end = scene->constEnd();
-                    for (auto it = scene->constBegin(); it != end; ++it) {
-                        const QPointer<BlockInterface>& block = it.key();
-                        if (!block) continue;
-                        block->removeSceneData(this);
-                    }
-                }
-            }
-            QMap<QPointer<BlockInterface>, HsvMatrix>* activeScene = nullptr;
-            if (activeCue->sceneBlock()) {
-                activeScene = activeCue->sceneBlock()->getSceneData();
-            }
-            if (!activeScene) {
-                qWarning()<< "CueListBlock::eachFrame(): Scene data has been deleted 1.";
-                return;
-            }
-            sendScene(*activeScene, 1.0);
-
-            if (!activeCue->follow()) {
-                m_running = false;
-            }  // else -> hold phase will start in the nexct call of this method
-            return;
+            m_fadePos = qMin(1.0, m_fadePos + timeSinceLastFrame / fadeIn);
         }
         return;
 
@@ -385,8 +334,128 @@ void CueListBlock::eachFrame(double timeSinceLastFrame) {
         }
         return;
     }
-    // m_running is true, but fades are complete
-    m_running = false;
+    // m_running is true, but the cue is complete, wait for overlapping fades of previous cues:
+    if (!m_timeline.isFading()) {
+        m_running = false;
+    }
+}
+
+QVariantMap CueListBlock::getFadeStatistics() {
+    const BlockBase::SceneMixStatistics& mix = BlockBase::sceneMixStatistics();
+    const double frames = qMax(qint64(1), s_fadeStatistics.frames);
+    QVariantMap result;
+    result["fadeFrames"] = s_fadeStatistics.frames;
+    result["msPerFadeFrame"] = s_fadeStatistics.nanoseconds / 1000000.0 / frames;
+    result["allocationsPerFadeFrame"] = s_fadeStatistics.allocations / frames;
+    result["sceneUpdates"] = mix.updates;
+    result["unchangedSceneUpdates"] = mix.unchanged;
+    result["mergedSceneMixes"] = mix.mergedMixes;
+    result["fullSceneMixes"] = mix.fullMixes;
+    result["sceneMixAllocations"] = mix.allocations;
+    return result;
+}
+
+void CueListBlock::resetFadeStatistics() {
+    s_fadeStatistics = FadeStatistics();
+    BlockBase::sceneMixStatistics() = BlockBase::SceneMixStatistics();
+}
+
+QVariantMap CueListBlock::benchmarkTimeline(MainController* controller) {
+    const int listCount = 20;
+    const int fixtureCount = 500;
+    const int cuesPerList = 4;
+    const int frames = 500;  // 10 seconds
+    const double frameTime = 1.0 / 50.0;
+    BlockManager* blockManager = controller->blockManager();
+    QVariantMap result;
+
+    // create the blocks without GUI items and with explicit uids,
+    // the fixtures don't reserve DMX addresses and don't output anything:
+    const QVector<FixtureBlock*> fixtures = FixtureBlock::createBenchmarkFixtures(controller, "RGB Light", fixtureCount, "benchmarkCueTimelineFixture");
+    QVector<CueListBlock*> cueLists;
+    QVector<PresetBlock*> presets;
+    bool complete = fixtures.size() == fixtureCount;
+    for (int list = 0; complete && list < listCount; ++list) {
+        BlockInterface* listBlock = blockManager->createBlockInstance(info().typeName, QString("benchmarkCueTimelineList%1").arg(list));
+        CueListBlock* cueList = qobject_cast<CueListBlock*>(listBlock);
+        if (!cueList) {
+            if (listBlock) blockManager->deleteBlock(listBlock, /*forced*/ true, /*noRestore*/ true, /*immediate*/ true);
+            complete = false;
+            break;
+        }
+        cueLists.append(cueList);
+        for (int c = 0; c < cuesPerList; ++c) {
+            BlockInterface* presetBlock = blockManager->createBlockInstance(PresetBlock::info().typeName, QString("benchmarkCueTimelinePreset%1_%2").arg(list).arg(c));
+            PresetBlock* preset = qobject_cast<PresetBlock*>(presetBlock);
+            if (!preset) {
+                if (presetBlock) blockManager->deleteBlock(presetBlock, /*forced*/ true, /*noRestore*/ true, /*immediate*/ true);
+                complete = false;
+                break;
+            }
+            presets.append(preset);
+            // every cue contains all fixtures with a different color:
+            for (int i = 0; i < fixtureCount; ++i) {
+                HsvMatrix matrix(1, 2);
+                matrix.at(0, 0).v = 1.0f;
+                // color is actually stored as RGB, so H is R, S is G and V is B:
+                matrix.at(0, 1) = HSV(((i + c) % 7) / 6.0, ((3 * i + list) % 5) / 4.0, double(c) / (cuesPerList - 1));
+                preset->m_sceneData[fixtures[i]] = matrix;
+            }
+            // a chain of follow cues with a different timing per list, so that their fades overlap:
+            Cue* cue = cueList->addSceneAsCue(preset);
+            cue->setFadeIn(0.5 + 0.05 * list);
+            cue->setFollow(true);
+            cue->setHold(0.1 * (c % 2));
+        }
+    }
+
+    if (complete) {
+        QElapsedTimer timer;
+        timer.start();
+        int tracks = 0;
+        for (CueListBlock* cueList: cueLists) {
+            cueList->ensureTimeline();
+            tracks += cueList->m_timeline.getTrackCount();
+        }
+        const double compileMs = timer.nsecsElapsed() / 1e6;
+
+        const BlockBase::SceneMixStatistics before = BlockBase::sceneMixStatistics();
+        for (CueListBlock* cueList: cueLists) {
+            cueList->go();
+        }
+        timer.restart();
+        for (int frame = 0; frame < frames; ++frame) {
+            for (CueListBlock* cueList: cueLists) {
+                cueList->eachFrame(frameTime);
+            }
+        }
+        const double msPerFrame = timer.nsecsElapsed() / 1e6 / frames;
+        const BlockBase::SceneMixStatistics& after = BlockBase::sceneMixStatistics();
+        const double updatesPerFrame = double(after.updates - before.updates) / frames;
+        const double allocationsPerFrame = double(after.allocations - before.allocations) / frames;
+
+        qInfo() << "Cue timeline:" << listCount << "cue lists over" << fixtureCount << "fixtures," << tracks
+                << "tracks compiled in" << compileMs << "ms," << msPerFrame << "ms," << updatesPerFrame
+                << "scene updates and" << allocationsPerFrame << "allocations per frame";
+        result["tracks"] = tracks;
+        result["compileMs"] = compileMs;
+        result["msPerFrame"] = msPerFrame;
+        result["sceneUpdatesPerFrame"] = updatesPerFrame;
+        result["allocationsPerFrame"] = allocationsPerFrame;
+    } else {
+        qWarning() << "Cue timeline benchmark: blocks could not be created.";
+    }
+
+    for (CueListBlock* cueList: cueLists) {
+        blockManager->deleteBlock(cueList, /*forced*/ true, /*noRestore*/ true, /*immediate*/ true);
+    }
+    for (PresetBlock* preset: presets) {
+        blockManager->deleteBlock(preset, /*forced*/ true, /*noRestore*/ true, /*immediate*/ true);
+    }
+    for (BlockInterface* fixture: fixtures) {
+        blockManager->deleteBlock(fixture, /*forced*/ true, /*noRestore*/ true, /*immediate*/ true);
+    }
+    return result;
 }
 
 void CueListBlock::resetActiveCue() {
@@ -425,49 +494,43 @@ void CueListBlock::chooseNewPendingCue() {
     }
 }
 
-void CueListBlock::sendInbetweenResult(const QMap<QPointer<BlockInterface>, HsvMatrix>& lastScene,
-                                       const QMap<QPointer<BlockInterface>, HsvMatrix>& activeScene,
-                                       double fadePos)
-{
-    double master = m_master;
-    auto end = lastScene.constEnd();
-    for (auto it = lastScene.constBegin(); it != end; ++it) {
-        if (activeScene.contains(it.key())) {
-            // block is in last and active scene, calculate inbetween result:
-            const QPointer<BlockInterface>& block = it.key();
-            if (!block) continue;
-            HsvMatrix lastMatCopy = it.value();
-            const HsvMatrix& activeMat = activeScene.value(it.key());
-            lastMatCopy.fadeTo(activeMat, fadePos);
-
-            block->setSceneData(this, master, lastMatCopy);
-
-        } else {
-            // block is not anymore in active scene, fade out:
-            const QPointer<BlockInterface>& block = it.key();
-            if (!block) continue;
-            block->setSceneData(this, (1 - fadePos) * master, it.value());
+void CueListBlock::ensureTimeline() {
+    if (m_timeline.isCompiled()) return;
+    QVector<const CueTimeline::Scene*> scenes;
+    for (Cue* cue: m_cues) {
+        if (!cue) {
+            scenes.append(nullptr);
+            continue;
         }
-    }
-    auto endActive = activeScene.constEnd();
-    for (auto it = activeScene.constBegin(); it != endActive; ++it) {
-        if (!lastScene.contains(it.key())) {
-            // block is new in active scene, fade in:
-            const QPointer<BlockInterface>& block = it.key();
-            if (!block) continue;
-            block->setSceneData(this, fadePos * master, it.value());
+        connect(cue, SIGNAL(sceneBlockChanged()), this, SLOT(invalidateTimeline()), Qt::UniqueConnection);
+        PresetBlock* preset = cue->sceneBlock();
+        if (!preset) {
+            // the preset has been deleted, the cue is empty:
+            scenes.append(nullptr);
+            continue;
         }
+        connect(preset, SIGNAL(sceneDataChanged()), this, SLOT(invalidateTimeline()), Qt::UniqueConnection);
+        scenes.append(preset->getSceneData());
     }
+    m_timeline.compile(scenes);
 }
 
-void CueListBlock::sendScene(const QMap<QPointer<BlockInterface>, HsvMatrix>& scene, double factor) {
-    double master = m_master;
-    auto end = scene.constEnd();
-    for (auto it = scene.constBegin(); it != end; ++it) {
-        const QPointer<BlockInterface>& block = it.key();
-        if (!block) continue;
-        block->setSceneData(this, factor * master, it.value());
-    }
+void CueListBlock::startActiveCue(double time, double fadeTime) {
+    m_fadePos = 0.0;
+    m_holdPos = 0.0;
+    Cue* activeCue = m_activeCue;
+    if (!activeCue) return;
+    ensureTimeline();
+    // very short fades are skipped:
+    m_timeline.trigger(m_cues.indexOf(activeCue), time, fadeTime <= (1.0 / 50.0) ? 0.0 : fadeTime);
+}
+
+void CueListBlock::startManualFade(double position) {
+    // running fades (e.g. of previous follow cues) are driven by the fader from now on,
+    // the cue list doesn't continue by itself:
+    m_timeline.retimeFades(position, qMax(0.0, 1.0 - position));
+    m_running = false;
+    m_manualFadeIsActive = true;
 }
 
 void CueListBlock::onEndOfHold() {
@@ -475,8 +538,7 @@ void CueListBlock::onEndOfHold() {
     if (!m_pendingCue) chooseNewPendingCue();
     m_activeCue = m_pendingCue;
     chooseNewPendingCue();
-    m_fadePos = 0.0;
-    m_holdPos = 0.0;
+    startActiveCue(m_clock, m_activeCue ? m_activeCue->fadeIn() : 0.0);
     m_running = true;
     emit cueStatesChanged();
 }
@@ -498,13 +560,13 @@ void CueListBlock::onManualFadeChanged() {
     if (!m_activeCue) {
         if (!m_pendingCue) chooseNewPendingCue();
         m_activeCue = m_pendingCue;
-        m_fadePos = 0.0;
-        m_holdPos = 0.0;
         chooseNewPendingCue();
+        startManualFade(0.0);
+        // the fade position is used as time, so the fade has a duration of 1:
+        startActiveCue(0.0, 1.0);
         emit cueStatesChanged();
     }
-    Cue* activeCue = m_activeCue;
-    if (!activeCue) return;
+    if (!m_activeCue) return;
     double val = m_manualFadeNode->getValue();
 
     // apply dead zone to fix problems with inaccruate MIDI controllers:
@@ -517,64 +579,20 @@ void CueListBlock::onManualFadeChanged() {
         if (!m_pendingCue) chooseNewPendingCue();
         m_activeCue = m_pendingCue;
         chooseNewPendingCue();
+        startManualFade(0.0);
+        startActiveCue(0.0, 1.0);
         emit cueStatesChanged();
+    } else if (!m_manualFadeIsActive) {
+        // take over the fade to the active cue that was started by GO:
+        startManualFade(m_manualFadeUp ? val : (1.0 - val));
     }
 
     m_fadePos = m_manualFadeUp ? val : (1.0 - val);
+    m_timeline.advance(m_fadePos);
+    m_timeline.send(m_master);
 
-    if (m_fadePos < 1.0) {
-        Cue* lastCue = m_lastCue;
-        if (!lastCue) {
-            // last cue doesn't exist, fade from black:
-            QMap<QPointer<BlockInterface>, HsvMatrix>* activeScene = nullptr;
-            if (activeCue->sceneBlock()) {
-                activeScene = activeCue->sceneBlock()->getSceneData();
-            }
-            if (!activeScene) {
-                qWarning()<< "CueListBlock::eachFrame(): Scene data has been deleted 1.";
-                return;
-            }
-            sendScene(*activeScene, m_fadePos);
-        } else {
-            // last cue exists, fade from there:
-            QMap<QPointer<BlockInterface>, HsvMatrix>* lastScene = nullptr;
-            QMap<QPointer<BlockInterface>, HsvMatrix>* activeScene = nullptr;
-            if (lastCue->sceneBlock()) {
-                lastScene = lastCue->sceneBlock()->getSceneData();
-            }
-            if (activeCue->sceneBlock()) {
-                activeScene = activeCue->sceneBlock()->getSceneData();
-            }
-            if (!lastScene || !activeScene) {
-                qWarning() << "CueListBlock::eachFrame(): Scene data has been deleted 2.";
-                return;
-            }
-            // real fading:
-            sendInbetweenResult(*lastScene, *activeScene, m_fadePos);
-        }
-    } else {
+    if (m_fadePos >= 1.0) {
         // end of fade
-        if (m_lastCue && m_lastCue->sceneBlock()) {
-            QMap<QPointer<BlockInterface>, HsvMatrix>* scene = m_lastCue->sceneBlock()->getSceneData();
-            if (scene) {
-                auto end = scene->constEnd();
-                for (auto it = scene->constBegin(); it != end; ++it) {
-                    const QPointer<BlockInterface>& block = it.key();
-                    if (!block) continue;
-                    block->removeSceneData(this);
-                }
-            }
-        }
-        QMap<QPointer<BlockInterface>, HsvMatrix>* activeScene = nullptr;
-        if (activeCue->sceneBlock()) {
-            activeScene = activeCue->sceneBlock()->getSceneData();
-        }
-        if (!activeScene) {
-            qWarning()<< "CueListBlock::eachFrame(): Scene data has been deleted 1.";
-            return;
-        }
-        sendScene(*activeScene, 1.0);
-
         m_manualFadeUp = !m_manualFadeUp;
     }
 }
@@ -3,6 +3,7 @@
 
 #include "core/block_data/BlockBase.h"
 #include "core/Cue.h"
+#include "core/CueTimeline.h"
 
 
 class CueListBlock : public BlockBase
@@ -28,6 +29,7 @@ public:
     }
 
     explicit CueListBlock(MainController* controller, QString uid);
+    virtual ~CueListBlock() override;
 
     virtual void getAdditionalState(QJsonObject& state) const override;
     virtual void setAdditionalState(const QJsonObject& state) override;
@@ -63,6 +65,26 @@ public slots:
 
     bool containsPreset(PresetBlock* sceneBlock) const;
 
+    /**
+     * @brief getFadeStatistics returns the time and allocations per frame of all
+     * timed fades of all cue lists and the scene mix counters since the last reset
+     * @return counters and averages
+     */
+    static QVariantMap getFadeStatistics();
+
+    /**
+     * @brief resetFadeStatistics resets the fade and scene mix counters
+     */
+    static void resetFadeStatistics();
+
+    /**
+     * @brief benchmarkTimeline plays 20 cue lists with follow cues over 500 RGB Lights
+     * at the same time and measures the compile time and the time per frame
+     * @param controller pointer to the MainController
+     * @return durations and counters
+     */
+    static QVariantMap benchmarkTimeline(MainController* controller);
+
 
     QList<QObject*> getCues();
 
@@ -77,15 +99,33 @@ private slots:
 
     void onManualFadeChanged();
 
+    /**
+     * @brief invalidateTimeline marks the timeline as outdated after the cues or presets changed
+     */
+    void invalidateTimeline() { m_timeline.invalidate(); }
+
 protected:
     void resetActiveCue();
     void chooseNewPendingCue();
 
-    void sendInbetweenResult(const QMap<QPointer<BlockInterface>, HsvMatrix>& lastScene,
-                             const QMap<QPointer<BlockInterface>, HsvMatrix>& activeScene,
-                             double fadePos);
-
-    void sendScene(const QMap<QPointer<BlockInterface>, HsvMatrix>& scene, double factor);
+    /**
+     * @brief ensureTimeline compiles the timeline if the cues or their presets changed
+     */
+    void ensureTimeline();
+
+    /**
+     * @brief startActiveCue triggers the fade of the tracks to the active cue
+     * @param time start time of the fade
+     * @param fadeTime duration of the fade
+     */
+    void startActiveCue(double time, double fadeTime);
+
+    /**
+     * @brief startManualFade switches to the position of the manual fade node as time base (0 to 1),
+     * running fades continue from their current values and end when the fader reaches 1
+     * @param position current position of the manual fade
+     */
+    void startManualFade(double position);
 
     void onEndOfHold();
 
@@ -107,6 +147,21 @@ protected:
     DoubleAttribute m_master;
 
     bool m_manualFadeUp;
+
+    CueTimeline m_timeline;  //!< compiled tracks of all cues
+    double m_clock;  //!< playback time in seconds, advanced while running
+    bool m_manualFadeIsActive;  //!< true if the tracks are driven by the manual fade node, its position is their time
+
+    /**
+     * @brief The FadeStatistics struct counts the frames of timed fades
+     */
+    struct FadeStatistics {
+        qint64 frames = 0;  //!< number of frames in a fade
+        qint64 nanoseconds = 0;  //!< time spent in these frames
+        qint64 allocations = 0;  //!< scene mix allocations in these frames
+    };
+
+    static FadeStatistics s_fadeStatistics;  //!< counters of all cue lists
 };
 
 #endif // CUELISTBLOCK_H
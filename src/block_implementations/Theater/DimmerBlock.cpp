@@ -29,26 +29,24 @@ void DimmerBlock::update() {
     // Color attribute:
     double effects = m_benchEffects;
     RGB color = m_benchColor;
-    for (const SceneData& data: m_sceneValues) {
-        double factor = data.factor;
-        effects = qMax(effects, data.values.at(0, 0).v * factor);
-        HSV c = data.values.at(0, 1);
-        // c is actually stored as RGB, so H is R, S is G and V is B:
-        color.mixHtp({c.h * factor, c.s * factor, c.v * factor});
-    }
-    RGB effectColor = m_inputNode->isConnected() ? m_inputNode->constData().getRgbAt(0, 0) : RGB(0, 0, 0);
+    // the scene mix is the HTP result of all contributions multiplied with their factors:
+    effects = qMax(effects, getSceneMix(0, 0).v);
+    const HSV c = getSceneMix(0, 1);
+    // c is actually stored as RGB, so H is R, S is G and V is B:
+    color.mixHtp({c.h, c.s, c.v});
+    RGB effectColor = m_inputNode->isConnected() ? getInputRgb(m_inputNode) : RGB(0, 0, 0);
     m_resultEffects = effects;
     color.mixHtp(effectColor * effects);
     m_resultColor = color;
 
     // send color:
-    m_controller->output()->setChannel(m_address, pow(m_resultColor.getValue().max(), m_gamma));
+    setChannelValue(0, m_resultColor.getValue().max());
 }
 
 void DimmerBlock::toggleBenchEffects() {
     if (m_benchEffects > LuminosusConstants::triggerThreshold) {
         m_benchEffects = 0.0;
-        RGB dynamicColor = m_inputNode->constData().getRgbAt(0, 0);
+        RGB dynamicColor = getInputRgb(m_inputNode);
         m_benchColor = dynamicColor;
     } else {
         m_benchEffects = 1.0;
@@ -94,12 +92,10 @@ HsvMatrix DimmerBlock::getMixData() const {
 
     // calculate result color without (!) input node (effect) color:
     RGB color = m_benchColor;
-    for (const SceneData& data: m_sceneValues) {
-        double factor = data.factor;
-        HSV c = data.values.at(0, 1);
-        // c is actually stored as RGB, so H is R, S is G and V is B:
-        color.mixHtp({c.h * factor, c.s * factor, c.v * factor});
-    }
+    // the scene mix is the HTP result of all contributions multiplied with their factors:
+    const HSV c = getSceneMix(0, 1);
+    // c is actually stored as RGB, so H is R, S is G and V is B:
+    color.mixHtp({c.h, c.s, c.v});
 
     // color is actually stored as RGB, so H is R, S is G and V is B:
     matrix.at(0, 1) = HSV(color.r, color.g, color.b);
@@ -11,6 +11,8 @@ MatrixBlock::MatrixBlock(MainController *controller, QString uid)
     , m_matrixHeight(this, "matrixHeight", 1, 1, 2000)
 {
     m_address = m_controller->output()->getUnusedAddress(m_footprint);
+    // the matrix shows the complete input, it can't read a single pixel of a chain:
+    m_canBeChainMember = false;
 
     //connect signals and slots:
     connect(m_inputNode, SIGNAL(dataChanged()), this, SLOT(onInputChanged()));
@@ -17,6 +17,9 @@ PresetBlock::PresetBlock(MainController* controller, QString uid)
     }
 
     connect(this, SIGNAL(guiIsHiddenChanged()), this, SLOT(releaseIfHidden()));
+
+    // m_sceneData only changes in saveFromMix() and saveFromBenches():
+    m_additionalStateIsTracked = true;
 }
 
 PresetBlock::~PresetBlock() {
@@ -30,6 +33,26 @@ PresetBlock::~PresetBlock() {
 }
 
 void PresetBlock::getAdditionalState(QJsonObject& state) const {
+    ProjectBlobStore* blobs = m_controller->projectManager()->blobs();
+    if (blobs->isWriting()) {
+        // binary file: the matrices are stored as raw arrays in the blob section
+        QJsonArray sceneData;
+        auto end = m_sceneData.constEnd();
+        for (auto it = m_sceneData.constBegin(); it != end; ++it) {
+            QPointer<BlockInterface> block = it.key();
+            if (!block) continue;
+            const HsvMatrix& matrix = it.value();
+            QJsonObject entry;
+            entry["uid"] = block->getUid();
+            entry["width"] = matrix.width();
+            entry["height"] = matrix.height();
+            entry["data"] = blobs->writeArray<float>(matrix.hue(), matrix.pixels() * 3);
+            sceneData.append(entry);
+        }
+        state["sceneData"] = sceneData;
+        return;
+    }
+
     QMap<QString, HsvMatrix> persistentSceneData;
     auto end = m_sceneData.constEnd();
     for (auto it = m_sceneData.constBegin(); it != end; ++it) {
@@ -42,7 +65,24 @@ void PresetBlock::getAdditionalState(QJsonObject& state) const {
 }
 
 void PresetBlock::setAdditionalState(const QJsonObject& state) {
-    m_persistentSceneData = deserialize<QMap<QString, HsvMatrix>>(state["sceneData"].toString());
+    if (state["sceneData"].isArray()) {
+        // binary file, the scene data is needed for the output, so it is decoded instantly:
+        const ProjectBlobStore* blobs = m_controller->projectManager()->blobs();
+        m_persistentSceneData.clear();
+        for (const QJsonValue& entryValue: state["sceneData"].toArray()) {
+            const QJsonObject entry = entryValue.toObject();
+            HsvMatrix matrix(entry["width"].toInt(), entry["height"].toInt());
+            const ProjectBlob blob = blobs->read(entry["data"]);
+            if (blob.count<float>() != matrix.pixels() * 3) {
+                qWarning() << "Preset: invalid scene data in project file.";
+                continue;
+            }
+            blob.decode<float>(matrix.hue());
+            m_persistentSceneData[entry["uid"].toString()] = matrix;
+        }
+    } else {
+        m_persistentSceneData = deserialize<QMap<QString, HsvMatrix>>(state["sceneData"].toString());
+    }
     if (!m_controller->projectManager()->isLoading()) {
         convertPersistentSceneData();
     }
@@ -69,6 +109,7 @@ bool PresetBlock::mayBeRemoved() {
 
 void PresetBlock::saveFromMix() {
     m_sceneData.clear();
+    markStateDirty();
     std::vector<QPointer<BlockInterface>> blocks = m_controller->blockManager()->getCurrentBlocks();
     for (QPointer<BlockInterface>& block: blocks) {
         if (!block) continue;
@@ -76,10 +117,12 @@ void PresetBlock::saveFromMix() {
             m_sceneData[block] = block->getMixData();
         }
     }
+    emit sceneDataChanged();
 }
 
 void PresetBlock::saveFromBenches() {
     m_sceneData.clear();
+    markStateDirty();
     std::vector<QPointer<BlockInterface>> blocks = m_controller->blockManager()->getCurrentBlocks();
     for (QPointer<BlockInterface>& block: blocks) {
         if (!block) continue;
@@ -88,6 +131,7 @@ void PresetBlock::saveFromBenches() {
             block->clearBench();
         }
     }
+    emit sceneDataChanged();
 
     if (m_value < 1.0) {
         m_value = 1.0;
@@ -157,5 +201,6 @@ void PresetBlock::convertPersistentSceneData() {
         if (!block) continue;
         m_sceneData[block] = it.value();
     }
+    emit sceneDataChanged();
     update();
 }
@@ -40,6 +40,11 @@ public:
 signals:
     void blockIsVisibleChanged();
 
+    /**
+     * @brief sceneDataChanged is emitted when the content of m_sceneData was replaced
+     */
+    void sceneDataChanged();
+
 public slots:
     virtual BlockInfo getBlockInfo() const override { return info(); }
 
@@ -80,20 +80,18 @@ void RgbWAUVLightBlock::update() {
     double white = m_benchWhite;
     double amber = m_benchAmber;
     double uv = m_benchUV;
-    for (const SceneData& data: m_sceneValues) {
-        double factor = data.factor;
-        effects = qMax(effects, data.values.at(0, 0).v * factor);
-        white = qMax(white, data.values.at(0, 2).v * factor);
-        amber = qMax(amber, data.values.at(0, 3).v * factor);
-        uv = qMax(uv, data.values.at(0, 4).v * factor);
-        HSV c = data.values.at(0, 1);
-        // c is actually stored as RGB, so H is R, S is G and V is B:
-        color.mixHtp({c.h * factor, c.s * factor, c.v * factor});
-    }
-    const RGB effectColor = m_inputNode->isConnected() ? m_inputNode->constData().getRgbAt(0, 0) : RGB(0, 0, 0);
-    const double effectWhite = m_inputNodeWhite->isConnected() ? m_inputNodeWhite->getValue() : 0.0;
-    const double effectAmber = m_inputNodeAmber->isConnected() ? m_inputNodeAmber->getValue() : 0.0;
-    const double effectUV = m_inputNodeUV->isConnected() ? m_inputNodeUV->getValue() : 0.0;
+    // the scene mix is the HTP result of all contributions multiplied with their factors:
+    effects = qMax(effects, getSceneMix(0, 0).v);
+    white = qMax(white, getSceneMix(0, 2).v);
+    amber = qMax(amber, getSceneMix(0, 3).v);
+    uv = qMax(uv, getSceneMix(0, 4).v);
+    const HSV c = getSceneMix(0, 1);
+    // c is actually stored as RGB, so H is R, S is G and V is B:
+    color.mixHtp({c.h, c.s, c.v});
+    const RGB effectColor = m_inputNode->isConnected() ? getInputRgb(m_inputNode) : RGB(0, 0, 0);
+    const double effectWhite = m_inputNodeWhite->isConnected() ? getInputValue(m_inputNodeWhite) : 0.0;
+    const double effectAmber = m_inputNodeAmber->isConnected() ? getInputValue(m_inputNodeAmber) : 0.0;
+    const double effectUV = m_inputNodeUV->isConnected() ? getInputValue(m_inputNodeUV) : 0.0;
     m_resultEffects = effects;
     m_resultWhite = qMax(white, effectWhite * effects);
     m_resultAmber = qMax(amber, effectAmber * effects);
@@ -102,28 +100,28 @@ void RgbWAUVLightBlock::update() {
     m_resultColor = color;
 
     // send color:
-    m_controller->output()->setChannel(m_address + 2, pow(m_resultColor.getValue().r, m_gamma));
-    m_controller->output()->setChannel(m_address + 3, pow(m_resultColor.getValue().g, m_gamma));
-    m_controller->output()->setChannel(m_address + 4, pow(m_resultColor.getValue().b, m_gamma));
-    m_controller->output()->setChannel(m_address + 5, pow(m_resultWhite, m_gamma));
-    m_controller->output()->setChannel(m_address + 6, pow(m_resultAmber, m_gamma));
-    m_controller->output()->setChannel(m_address + 7, pow(m_resultUV, m_gamma));
+    setChannelValue(2, m_resultColor.getValue().r);
+    setChannelValue(3, m_resultColor.getValue().g);
+    setChannelValue(4, m_resultColor.getValue().b);
+    setChannelValue(5, m_resultWhite);
+    setChannelValue(6, m_resultAmber);
+    setChannelValue(7, m_resultUV);
 }
 
 void RgbWAUVLightBlock::updateBrightnessChannel() {
-    m_controller->output()->setChannel(m_address, 1.0);
-    m_controller->output()->setChannel(m_address + 1, 0.0);
+    setChannelValue(0, 1.0);
+    setChannelValue(1, 0.0);
 }
 
 void RgbWAUVLightBlock::toggleBenchEffects() {
     m_pauseUpdate = true;
     if (m_benchEffects > LuminosusConstants::triggerThreshold) {
         m_benchEffects = 0.0;
-        RGB dynamicColor = m_inputNode->constData().getRgbAt(0, 0);
+        RGB dynamicColor = getInputRgb(m_inputNode);
         m_benchColor = dynamicColor;
-        m_benchWhite = m_inputNodeWhite->getValue();
-        m_benchAmber = m_inputNodeAmber->getValue();
-        m_benchUV = m_inputNodeUV->getValue();
+        m_benchWhite = getInputValue(m_inputNodeWhite);
+        m_benchAmber = getInputValue(m_inputNodeAmber);
+        m_benchUV = getInputValue(m_inputNodeUV);
     } else {
         m_benchEffects = 1.0;
         m_benchColor = {0.0, 0.0, 0.0};
@@ -188,15 +186,13 @@ HsvMatrix RgbWAUVLightBlock::getMixData() const {
     double white = m_benchWhite;
     double amber = m_benchAmber;
     double uv = m_benchUV;
-    for (const SceneData& data: m_sceneValues) {
-        double factor = data.factor;
-        white = qMax(white, data.values.at(0, 2).v * factor);
-        amber = qMax(amber, data.values.at(0, 3).v * factor);
-        uv = qMax(uv, data.values.at(0, 4).v * factor);
-        HSV c = data.values.at(0, 1);
-        // c is actually stored as RGB, so H is R, S is G and V is B:
-        color.mixHtp({c.h * factor, c.s * factor, c.v * factor});
-    }
+    // the scene mix is the HTP result of all contributions multiplied with their factors:
+    white = qMax(white, getSceneMix(0, 2).v);
+    amber = qMax(amber, getSceneMix(0, 3).v);
+    uv = qMax(uv, getSceneMix(0, 4).v);
+    const HSV c = getSceneMix(0, 1);
+    // c is actually stored as RGB, so H is R, S is G and V is B:
+    color.mixHtp({c.h, c.s, c.v});
 
     // color is actually stored as RGB, so H is R, S is G and V is B:
     matrix.at(0, 1) = HSV(color.r, color.g, color.b);
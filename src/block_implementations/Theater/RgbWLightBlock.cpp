@@ -5,7 +5,7 @@
 
 
 RgbWLightBlock::RgbWLightBlock(MainController *controller, QString uid)
-    : FixtureBlock(controller, uid, /*footprint*/ 3)
+    : FixtureBlock(controller, uid, /*footprint*/ 4)
     , m_inputNodeWhite(nullptr)
     , m_outputNodeWhite(nullptr)
     , m_benchColor(this, "benchColor", {0, 0, 0})
@@ -48,26 +48,24 @@ void RgbWLightBlock::update() {
     double effects = m_benchEffects;
     RGB color = m_benchColor;
     double white = m_benchWhite;
-    for (const SceneData& data: m_sceneValues) {
-        double factor = data.factor;
-        effects = qMax(effects, data.values.at(0, 0).v * factor);
-        white = qMax(white, data.values.at(0, 2).v * factor);
-        HSV c = data.values.at(0, 1);
-        // c is actually stored as RGB, so H is R, S is G and V is B:
-        color.mixHtp({c.h * factor, c.s * factor, c.v * factor});
-    }
-    const RGB effectColor = m_inputNode->isConnected() ? m_inputNode->constData().getRgbAt(0, 0) : RGB(0, 0, 0);
-    const double effectWhite = m_inputNodeWhite->isConnected() ? m_inputNodeWhite->getValue() : 0.0;
+    // the scene mix is the HTP result of all contributions multiplied with their factors:
+    effects = qMax(effects, getSceneMix(0, 0).v);
+    white = qMax(white, getSceneMix(0, 2).v);
+    const HSV c = getSceneMix(0, 1);
+    // c is actually stored as RGB, so H is R, S is G and V is B:
+    color.mixHtp({c.h, c.s, c.v});
+    const RGB effectColor = m_inputNode->isConnected() ? getInputRgb(m_inputNode) : RGB(0, 0, 0);
+    const double effectWhite = m_inputNodeWhite->isConnected() ? getInputValue(m_inputNodeWhite) : 0.0;
     m_resultEffects = effects;
     m_resultWhite = qMax(white, effectWhite * effects);
     color.mixHtp(effectColor * effects);
     m_resultColor = color;
 
     // send color:
-    m_controller->output()->setChannel(m_address, pow(m_resultColor.getValue().r, m_gamma));
-    m_controller->output()->setChannel(m_address + 1, pow(m_resultColor.getValue().g, m_gamma));
-    m_controller->output()->setChannel(m_address + 2, pow(m_resultColor.getValue().b, m_gamma));
-    m_controller->output()->setChannel(m_address + 3, pow(m_resultWhite, m_gamma));
+    setChannelValue(0, m_resultColor.getValue().r);
+    setChannelValue(1, m_resultColor.getValue().g);
+    setChannelValue(2, m_resultColor.getValue().b);
+    setChannelValue(3, m_resultWhite);
 }
 
 void RgbWLightBlock::updateBrightnessChannel() {
@@ -79,9 +77,9 @@ void RgbWLightBlock::toggleBenchEffects() {
     m_pauseUpdate = true;
     if (m_benchEffects > LuminosusConstants::triggerThreshold) {
         m_benchEffects = 0.0;
-        RGB dynamicColor = m_inputNode->constData().getRgbAt(0, 0);
+        RGB dynamicColor = getInputRgb(m_inputNode);
         m_benchColor = dynamicColor;
-        m_benchWhite = m_inputNodeWhite->getValue();
+        m_benchWhite = getInputValue(m_inputNodeWhite);
     } else {
         m_benchEffects = 1.0;
         m_benchColor = {0.0, 0.0, 0.0};
@@ -138,13 +136,11 @@ HsvMatrix RgbWLightBlock::getMixData() const {
     // calculate result colors without (!) input node (effect) colors:
     RGB color = m_benchColor;
     double white = m_benchWhite;
-    for (const SceneData& data: m_sceneValues) {
-        double factor = data.factor;
-        white = qMax(white, data.values.at(0, 2).v * factor);
-        HSV c = data.values.at(0, 1);
-        // c is actually stored as RGB, so H is R, S is G and V is B:
-        color.mixHtp({c.h * factor, c.s * factor, c.v * factor});
-    }
+    // the scene mix is the HTP result of all contributions multiplied with their factors:
+    white = qMax(white, getSceneMix(0, 2).v);
+    const HSV c = getSceneMix(0, 1);
+    // c is actually stored as RGB, so H is R, S is G and V is B:
+    color.mixHtp({c.h, c.s, c.v});
 
     // color is actually stored as RGB, so H is R, S is G and V is B:
     matrix.at(0, 1) = HSV(color.r, color.g, color.b);
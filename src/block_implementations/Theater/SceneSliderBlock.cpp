@@ -19,11 +19,8 @@ SceneSliderBlock::SceneSliderBlock(MainController* controller, QString uid)
 }
 
 void SceneSliderBlock::update() {
-    double val = m_benchValue;
-    for (const SceneData& data: m_sceneValues) {
-        double factor = data.factor;
-        val = qMax(val, data.values.at(0, 0).v * factor);
-    }
+    // the scene mix is the HTP result of all contributions multiplied with their factors:
+    const double val = qMax(m_benchValue.getValue(), getSceneMix(0, 0).v);
     m_resultValue = val;
 
     m_outputNode->setValue(m_resultValue);
@@ -41,8 +41,8 @@ X32ChannelBlock::X32ChannelBlock(MainController* controller, QString uid)
     connect(m_inputNode, &NodeBase::dataChanged, [this](){ m_faderPos.setValue(m_inputNode->getValue()); });
     connect(m_panNode, &NodeBase::dataChanged, [this](){ m_pan.setValue(m_panNode->getValue()); });
 
-    connect(controller->audioConsole(), SIGNAL(messageReceived(OSCMessage)), this, SLOT(onMessageReceived(OSCMessage)));
-
+    connect(&m_channelNumber, SIGNAL(valueChanged()), this, SLOT(updateMessageHandler()));
+    updateMessageHandler();
 }
 
 void X32ChannelBlock::setState(const QJsonObject& state) {
@@ -168,6 +168,16 @@ void X32ChannelBlock::updateSubscription() {
     m_controller->audioConsole()->sendMessage("/subscribe=" + message + ",10");
 }
 
+void X32ChannelBlock::updateMessageHandler() {
+    // only messages of this channel are passed to this block:
+    OSCAddressDispatcher* dispatcher = m_controller->audioConsole()->dispatcher();
+    dispatcher->removeHandlers(this);
+    QString pattern = "/ch/%1/**";
+    pattern = pattern.arg(m_channelNumber, 2, 10, QChar('0'));
+    dispatcher->addHandler(pattern, this,
+            [this](const OSCMessageView& view) { onMessageReceived(view.toMessage()); });
+}
+
 void X32ChannelBlock::onMessageReceived(OSCMessage msg) {
     QString channelMessageBegin = "/ch/%1/";
     channelMessageBegin = channelMessageBegin.arg(m_channelNumber, 2, 10, QChar('0'));
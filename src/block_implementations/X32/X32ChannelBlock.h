@@ -47,6 +47,7 @@ public slots:
 
     void retrieveStateFromConsole();
     void updateSubscription();
+    void updateMessageHandler();
 
     void onMessageReceived(OSCMessage msg);
 
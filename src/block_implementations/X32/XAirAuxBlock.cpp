@@ -41,7 +41,8 @@ XAirAuxBlock::XAirAuxBlock(MainController* controller, QString uid)
     connect(m_inputNode, &NodeBase::dataChanged, [this](){ m_faderPos.setValue(m_inputNode->getValue()); });
     connect(m_panNode, &NodeBase::dataChanged, [this](){ m_pan.setValue(m_panNode->getValue()); });
 
-    connect(controller->audioConsole(), SIGNAL(messageReceived(OSCMessage)), this, SLOT(onMessageReceived(OSCMessage)));
+    controller->audioConsole()->dispatcher()->addHandler("/rtn/aux/**", this,
+            [this](const OSCMessageView& view) { onMessageReceived(view.toMessage()); });
 
 }
 
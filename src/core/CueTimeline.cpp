@@ -0,0 +1,275 @@
+#include "CueTimeline.h"
+
+#include <QDebug>
+#include <QHash>
+
+#include <algorithm>
+
+
+CueTimeline::CueTimeline(const void* origin)
+    : m_origin(origin)
+    , m_isCompiled(false)
+    , m_cueCount(0)
+    , m_fadingTracks(0)
+    , m_sentMaster(-1.0)
+{
+
+}
+
+// ---------------------------- Compilation ----------------------------
+
+void CueTimeline::compile(const QVector<const Scene*>& scenes) {
+    // collect the fixtures of all cues in the order of their first appearance:
+    QVector<Fixture> fixtures;
+    QHash<const BlockInterface*, int> fixtureIndex;
+    for (const Scene* scene: scenes) {
+        if (!scene) continue;
+        auto end = scene->constEnd();
+        for (auto it = scene->constBegin(); it != end; ++it) {
+            const BlockInterface* block = it.key();
+            if (!block) continue;
+            const HsvMatrix& matrix = it.value();
+            const int index = fixtureIndex.value(block, -1);
+            if (index < 0) {
+                fixtureIndex[block] = fixtures.size();
+                Fixture fixture;
+                fixture.block = it.key();
+                fixture.width = matrix.width();
+                fixture.height = matrix.height();
+                fixtures.append(fixture);
+            } else {
+                Fixture& fixture = fixtures[index];
+                fixture.width = qMax(fixture.width, matrix.width());
+                fixture.height = qMax(fixture.height, matrix.height());
+            }
+        }
+    }
+
+    int tracks = 0;
+    QVector<int> trackFixture;
+    for (int i = 0; i < fixtures.size(); ++i) {
+        fixtures[i].firstTrack = tracks;
+        tracks += trackCount(fixtures[i]);
+        trackFixture.insert(trackFixture.size(), trackCount(fixtures[i]), i);
+    }
+
+    // values of each cue, smaller matrices are repeated like in HsvMatrix::at():
+    QVector<float> cueValues(scenes.size() * tracks, 0.0f);
+    for (int cue = 0; cue < scenes.size(); ++cue) {
+        const Scene* scene = scenes[cue];
+        if (!scene) continue;
+        float* values = cueValues.data() + cue * tracks;
+        auto end = scene->constEnd();
+        for (auto it = scene->constBegin(); it != end; ++it) {
+            if (!it.key()) continue;
+            const Fixture& fixture = fixtures[fixtureIndex.value(it.key())];
+            const HsvMatrix& matrix = it.value();
+            float* target = values + fixture.firstTrack;
+            if (matrix.width() == fixture.width && matrix.height() == fixture.height) {
+                std::copy(matrix.hue(), matrix.hue() + trackCount(fixture), target);
+                continue;
+            }
+            const int pixels = fixture.width * fixture.height;
+            for (int x = 0; x < fixture.width; ++x) {
+                for (int y = 0; y < fixture.height; ++y) {
+                    const HSV col = matrix.at(x, y);
+                    const int i = x * fixture.height + y;
+                    target[i] = float(col.h);
+                    target[pixels + i] = float(col.s);
+                    target[2 * pixels + i] = float(col.v);
+                }
+            }
+        }
+    }
+
+    // keep the state of fixtures that were already part of the timeline:
+    QVector<float> startValues(tracks, 0.0f);
+    QVector<float> targetValues(tracks, 0.0f);
+    QVector<float> currentValues(tracks, 0.0f);
+    QVector<double> startTimes(tracks, 0.0);
+    QVector<double> durations(tracks, 0.0);
+    for (Fixture& old: m_fixtures) {
+        const int index = old.block ? fixtureIndex.value(old.block.data(), -1) : -1;
+        if (index < 0) {
+            // the fixture is not part of any cue anymore:
+            if (old.isSent && old.block) old.block->removeSceneData(m_origin);
+            continue;
+        }
+        Fixture& fixture = fixtures[index];
+        fixture.isSent = old.isSent;
+        if (old.width != fixture.width || old.height != fixture.height) {
+            // the matrix size changed, the fixture starts at 0 and is sent again:
+            fixture.changed = true;
+            continue;
+        }
+        fixture.buffers[0] = old.buffers[0];
+        fixture.buffers[1] = old.buffers[1];
+        fixture.buffer = old.buffer;
+        fixture.changed = old.changed;
+        const int count = trackCount(fixture);
+        std::copy(m_startValues.constData() + old.firstTrack, m_startValues.constData() + old.firstTrack + count,
+                  startValues.data() + fixture.firstTrack);
+        std::copy(m_targetValues.constData() + old.firstTrack, m_targetValues.constData() + old.firstTrack + count,
+                  targetValues.data() + fixture.firstTrack);
+        std::copy(m_currentValues.constData() + old.firstTrack, m_currentValues.constData() + old.firstTrack + count,
+                  currentValues.data() + fixture.firstTrack);
+        std::copy(m_startTimes.constData() + old.firstTrack, m_startTimes.constData() + old.firstTrack + count,
+                  startTimes.data() + fixture.firstTrack);
+        std::copy(m_durations.constData() + old.firstTrack, m_durations.constData() + old.firstTrack + count,
+                  durations.data() + fixture.firstTrack);
+    }
+    for (Fixture& fixture: fixtures) {
+        if (fixture.buffers[0].width() != fixture.width || fixture.buffers[0].height() != fixture.height) {
+            fixture.buffers[0] = HsvMatrix(fixture.width, fixture.height);
+            fixture.buffers[1] = HsvMatrix(fixture.width, fixture.height);
+        }
+    }
+
+    m_fixtures = fixtures;
+    m_trackFixture = trackFixture;
+    m_cueValues = cueValues;
+    m_startValues = startValues;
+    m_targetValues = targetValues;
+    m_currentValues = currentValues;
+    m_startTimes = startTimes;
+    m_durations = durations;
+    m_cueCount = scenes.size();
+    m_fadingTracks = tracks;  // recounted by the next advance()
+    m_isCompiled = true;
+}
+
+// ---------------------------- Playback ----------------------------
+
+void CueTimeline::trigger(int cue, double time, double fadeTime) {
+    if (cue >= m_cueCount) {
+        qWarning() << "CueTimeline::trigger(): cue index out of range.";
+        return;
+    }
+    const int tracks = m_currentValues.size();
+    const float* cueValues = cue >= 0 ? m_cueValues.constData() + cue * tracks : nullptr;
+    float* start = m_startValues.data();
+    float* target = m_targetValues.data();
+    const float* current = m_currentValues.constData();
+    double* startTimes = m_startTimes.data();
+    double* durations = m_durations.data();
+    for (int i = 0; i < tracks; ++i) {
+        const float value = cueValues ? cueValues[i] : 0.0f;
+        // a track that already fades to this value continues its fade:
+        if (value == target[i]) continue;
+        start[i] = current[i];
+        target[i] = value;
+        startTimes[i] = time;
+        durations[i] = fadeTime;
+        ++m_fadingTracks;
+    }
+}
+
+bool CueTimeline::advance(double time) {
+    if (m_fadingTracks <= 0) return false;
+    const int tracks = m_currentValues.size();
+    float* start = m_startValues.data();
+    const float* target = m_targetValues.constData();
+    float* current = m_currentValues.data();
+    const double* startTimes = m_startTimes.constData();
+    const double* durations = m_durations.constData();
+    const int* trackFixture = m_trackFixture.constData();
+    Fixture* fixtures = m_fixtures.data();
+    int fading = 0;
+    for (int i = 0; i < tracks; ++i) {
+        // the start value is set to the target at the end of the fade:
+        if (start[i] == target[i] && current[i] == target[i]) continue;
+        float value;
+        const double progress = durations[i] > 0.0 ? (time - startTimes[i]) / durations[i] : 1.0;
+        if (progress >= 1.0) {
+            value = target[i];
+            start[i] = target[i];
+        } else {
+            value = start[i] + (target[i] - start[i]) * float(qMax(0.0, progress));
+            ++fading;
+        }
+        if (value != current[i]) {
+            current[i] = value;
+            fixtures[trackFixture[i]].changed = true;
+        }
+    }
+    m_fadingTracks = fading;
+    return fading > 0;
+}
+
+void CueTimeline::finishFades() {
+    if (m_fadingTracks <= 0) return;
+    const int tracks = m_currentValues.size();
+    float* start = m_startValues.data();
+    const float* target = m_targetValues.constData();
+    float* current = m_currentValues.data();
+    const int* trackFixture = m_trackFixture.constData();
+    Fixture* fixtures = m_fixtures.data();
+    for (int i = 0; i < tracks; ++i) {
+        start[i] = target[i];
+        if (current[i] != target[i]) {
+            current[i] = target[i];
+            fixtures[trackFixture[i]].changed = true;
+        }
+    }
+    m_fadingTracks = 0;
+}
+
+void CueTimeline::retimeFades(double time, double duration) {
+    if (m_fadingTracks <= 0) return;
+    const int tracks = m_currentValues.size();
+    float* start = m_startValues.data();
+    const float* target = m_targetValues.constData();
+    const float* current = m_currentValues.constData();
+    double* startTimes = m_startTimes.data();
+    double* durations = m_durations.data();
+    for (int i = 0; i < tracks; ++i) {
+        if (start[i] == target[i] && current[i] == target[i]) continue;
+        start[i] = current[i];
+        startTimes[i] = time;
+        durations[i] = duration;
+    }
+}
+
+void CueTimeline::send(double master) {
+    const bool masterChanged = master != m_sentMaster;
+    m_sentMaster = master;
+    const float* current = m_currentValues.constData();
+    for (Fixture& fixture: m_fixtures) {
+        if (!fixture.changed && !(masterChanged && fixture.isSent)) continue;
+        BlockInterface* block = fixture.block.data();
+        if (!block) {
+            fixture.changed = false;
+            fixture.isSent = false;
+            continue;
+        }
+        if (fixture.changed) {
+            fixture.changed = false;
+            const float* values = current + fixture.firstTrack;
+            const int count = trackCount(fixture);
+            if (std::all_of(values, values + count, [](float v) { return v == 0.0f; })) {
+                if (fixture.isSent) block->removeSceneData(m_origin);
+                fixture.isSent = false;
+                continue;
+            }
+            // the fixture keeps a reference to the last buffer, so the other one is written:
+            fixture.buffer = 1 - fixture.buffer;
+            std::copy(values, values + count, fixture.buffers[fixture.buffer].hue());
+        }
+        block->setSceneData(m_origin, master, fixture.buffers[fixture.buffer]);
+        fixture.isSent = true;
+    }
+}
+
+void CueTimeline::release() {
+    for (Fixture& fixture: m_fixtures) {
+        if (fixture.isSent && fixture.block) {
+            fixture.block->removeSceneData(m_origin);
+        }
+        fixture.isSent = false;
+        fixture.changed = false;
+    }
+    std::fill(m_startValues.begin(), m_startValues.end(), 0.0f);
+    std::fill(m_targetValues.begin(), m_targetValues.end(), 0.0f);
+    std::fill(m_currentValues.begin(), m_currentValues.end(), 0.0f);
+    m_fadingTracks = 0;
+}
@@ -0,0 +1,146 @@
+#ifndef CUETIMELINE_H
+#define CUETIMELINE_H
+
+#include "core/block_data/BlockInterface.h"
+
+#include <QMap>
+#include <QPointer>
+#include <QVector>
+
+
+/**
+ * @brief The CueTimeline class is the compiled playback state of a cue list.
+ *
+ * When the cues or their presets change, the scenes of all cues are compiled to a flat table
+ * with one track per fixture and parameter (each value of the scene matrix of a fixture).
+ * Each track fades from the value it had when a cue was triggered to the value in that cue,
+ * with its own start time and duration. Triggering a cue while a fade is still running only
+ * retargets the tracks whose value changes, the other tracks continue their fade.
+ *
+ * Playback is a linear pass over all tracks and only fixtures with changed values
+ * get new scene data. Absent fixtures are 0 in a cue, so they fade out.
+ */
+class CueTimeline {
+
+public:
+    typedef QMap<QPointer<BlockInterface>, HsvMatrix> Scene;
+
+    /**
+     * @brief CueTimeline creates an empty timeline
+     * @param origin the origin of the scene data sent to the fixtures (i.e. the cue list)
+     */
+    explicit CueTimeline(const void* origin);
+
+    // ---------------- Compilation:
+
+    /**
+     * @brief compile creates the track table from the scenes of all cues, the current values
+     * and running fades of fixtures that are still part of the cue list are kept
+     * @param scenes scene data of each cue in the order of the cue list (nullptr for empty cues)
+     */
+    void compile(const QVector<const Scene*>& scenes);
+
+    /**
+     * @brief isCompiled returns if the track table is valid
+     * @return false if the cues changed since the last compile()
+     */
+    bool isCompiled() const { return m_isCompiled; }
+
+    /**
+     * @brief invalidate marks the track table as outdated, it is compiled again before the next cue
+     */
+    void invalidate() { m_isCompiled = false; }
+
+    int getCueCount() const { return m_cueCount; }
+    int getTrackCount() const { return m_currentValues.size(); }
+    int getFixtureCount() const { return m_fixtures.size(); }
+
+    // ---------------- Playback:
+
+    /**
+     * @brief trigger starts the fade of all tracks whose value in a cue differs from their target
+     * @param cue index of the cue in the compiled scenes or -1 to fade to black
+     * @param time start time of the fade in seconds (same clock as advance())
+     * @param fadeTime duration of the fade in seconds
+     */
+    void trigger(int cue, double time, double fadeTime);
+
+    /**
+     * @brief advance calculates the values of all fading tracks
+     * @param time current time in seconds
+     * @return true if tracks are still fading
+     */
+    bool advance(double time);
+
+    /**
+     * @brief finishFades ends all running fades, each track jumps to its target
+     * (the changed fixtures are updated by the next send())
+     */
+    void finishFades();
+
+    /**
+     * @brief retimeFades restarts all running fades from their current values with a new time base,
+     * e.g. when a manual fader takes over fades started with a clock
+     * @param time start time of the fades on the new time base
+     * @param duration remaining duration of the fades on the new time base
+     */
+    void retimeFades(double time, double duration);
+
+    /**
+     * @brief isFading returns if a track has not reached its target yet
+     * @return true if advance() has to be called
+     */
+    bool isFading() const { return m_fadingTracks > 0; }
+
+    /**
+     * @brief send passes the values of all changed fixtures to the fixtures,
+     * fixtures with only zero values are removed
+     * @param master factor of all values
+     */
+    void send(double master);
+
+    /**
+     * @brief release removes the scene data from all fixtures and resets all tracks to 0
+     */
+    void release();
+
+protected:
+    /**
+     * @brief The Fixture struct describes the tracks of one fixture
+     */
+    struct Fixture {
+        QPointer<BlockInterface> block;  //!< the fixture
+        int width = 1;  //!< width of the largest scene matrix of this fixture
+        int height = 1;  //!< height of the largest scene matrix of this fixture
+        int firstTrack = 0;  //!< index of the first track, the tracks have the layout of a HsvMatrix
+        HsvMatrix buffers[2];  //!< alternately sent to the fixture, so that the other one is not shared
+        int buffer = 0;  //!< index of the buffer that was sent last
+        bool changed = false;  //!< true if a value changed since the last send()
+        bool isSent = false;  //!< true if the fixture has scene data of this timeline
+    };
+
+    /**
+     * @brief trackCount returns the number of tracks of a fixture
+     */
+    static int trackCount(const Fixture& fixture) { return 3 * fixture.width * fixture.height; }
+
+protected:
+    const void* const m_origin;  //!< origin of the scene data
+    bool m_isCompiled;  //!< false if the cues changed since the last compile()
+    int m_cueCount;  //!< number of compiled cues
+
+    QVector<Fixture> m_fixtures;  //!< all fixtures of the cue list
+    QVector<int> m_trackFixture;  //!< index of the fixture per track
+    QVector<float> m_cueValues;  //!< value of each track in each cue (index = cue * tracks + track)
+
+    QVector<float> m_startValues;  //!< value of each track when its fade started
+    QVector<float> m_targetValues;  //!< value each track fades to
+    QVector<float> m_currentValues;  //!< current value of each track
+    QVector<double> m_startTimes;  //!< start time of the fade of each track
+    QVector<double> m_durations;  //!< duration of the fade of each track
+
+    int m_fadingTracks;  //!< number of tracks that have not reached their target
+    double m_sentMaster;  //!< master factor of the last send()
+};
+
+#endif // CUETIMELINE_H
@@ -3,6 +3,7 @@
 #include "audio/AudioEngine.h"
 #include "core/manager/KeyboardEmulator.h"
 #include "eos_specific/HogOSCManager.h"
+#include "sacn/streamingacn.h"
 
 #include <QSysInfo>
 #include <QJsonObject>
@@ -22,7 +23,9 @@ MainController::MainController(QQmlApplicationEngine& qmlEngine, QString templat
     , m_engine(this)
     , m_audioEngine(new AudioEngine(this))
     , m_output(this)
+    , m_guiUpdateBatcher(this)
     , m_blockManager(this)
+    , m_graphEvaluator(this)
     , m_powermate()
 	, m_midi(this)
     , m_customOsc(this, { OscConnectionType::Custom, OscConnectionType::Eos, OscConnectionType::Hog4, OscConnectionType::X32, OscConnectionType::X_Air })
@@ -82,6 +85,8 @@ MainController::MainController(QQmlApplicationEngine& qmlEngine, QString templat
     QQmlEngine::setObjectOwnership(&m_output, QQmlEngine::CppOwnership);
 	QQmlEngine::setObjectOwnership(&m_dao, QQmlEngine::CppOwnership);
 	QQmlEngine::setObjectOwnership(&m_blockManager, QQmlEngine::CppOwnership);
+    QQmlEngine::setObjectOwnership(&m_graphEvaluator, QQmlEngine::CppOwnership);
+    QQmlEngine::setObjectOwnership(&m_guiUpdateBatcher, QQmlEngine::CppOwnership);
 	QQmlEngine::setObjectOwnership(&m_powermate, QQmlEngine::CppOwnership);
 	QQmlEngine::setObjectOwnership(&m_midi, QQmlEngine::CppOwnership);
 	QQmlEngine::setObjectOwnership(&m_customOsc, QQmlEngine::CppOwnership);
@@ -144,6 +149,8 @@ void MainController::saveAll() {
     appState["updateManager"] = m_updateManager.getState();
     appState["developerMode"] = getDeveloperMode();
     appState["clickSounds"] = getClickSounds();
+    appState["sAcnBatchedReception"] = getSAcnBatchedReception();
+    appState["engineCatchUpLateFrames"] = m_engine.getCatchUpLateFrames();
     appState["outputManager"] = m_output.getState();
     m_dao.saveFile("", "autosave.ats", appState);
 
@@ -178,6 +185,8 @@ void MainController::restoreApp() {
     m_updateManager.setState(appState["updateManager"].toObject());
     setDeveloperMode(appState["developerMode"].toBool());
     setClickSounds(appState["clickSounds"].toBool());
+    setSAcnBatchedReception(appState["sAcnBatchedReception"].toBool());
+    m_engine.setCatchUpLateFrames(appState["engineCatchUpLateFrames"].toBool());
     m_output.setState(appState["outputManager"].toObject());
 #ifndef Q_OS_ANDROID
     if (lockExisted && !m_forceImport) {
@@ -267,6 +276,16 @@ void MainController::onControllerReleased(double duration) {
     }
 }
 
+bool MainController::getSAcnBatchedReception() const {
+    return sACNManager::getInstance()->isBatchedReception();
+}
+
+void MainController::setSAcnBatchedReception(bool value) {
+    if (value == getSAcnBatchedReception()) return;
+    sACNManager::getInstance()->setBatchedReception(value);
+    emit sAcnBatchedReceptionChanged();
+}
+
 QString MainController::getTemplateFileBaseName() const {
     return QFileInfo(m_templateFileToImport).fileName();
 }
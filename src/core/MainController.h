@@ -9,6 +9,8 @@
 #include "core/manager/UpdateManager.h"
 #include "core/manager/AnchorManager.h"
 #include "core/manager/BlockManager.h"
+#include "core/manager/GraphEvaluator.h"
+#include "core/manager/GuiUpdateBatcher.h"
 #include "core/manager/HandoffManager.h"
 #include "core/block_data/BlockList.h"
 #include "light/OutputManager.h"
@@ -61,6 +63,7 @@ class MainController : public QObject
     Q_PROPERTY(bool sendCustomOscToEos READ getSendCustomOscToEos WRITE setSendCustomOscToEos NOTIFY sendCustomOscToEosChanged)
     Q_PROPERTY(bool developerMode READ getDeveloperMode WRITE setDeveloperMode NOTIFY developerModeChanged)
     Q_PROPERTY(bool clickSounds READ getClickSounds WRITE setClickSounds NOTIFY clickSoundsChanged)
+    Q_PROPERTY(bool sAcnBatchedReception READ getSAcnBatchedReception WRITE setSAcnBatchedReception NOTIFY sAcnBatchedReceptionChanged)
     Q_PROPERTY(QString templateFileToImport READ getTemplateFileBaseName NOTIFY templateFileToImportChanged)
     Q_PROPERTY(bool forceImport READ getForceImport NOTIFY forceImportChanged)
 
@@ -85,6 +88,8 @@ signals:
 
     void clickSoundsChanged();
 
+    void sAcnBatchedReceptionChanged();
+
     void templateFileToImportChanged();
 
     void forceImportChanged();
@@ -128,6 +133,16 @@ public slots:
      * @return a pointer to a BlockManager instance
      */
 	BlockManager* blockManager() { return &m_blockManager; }
+    /**
+     * @brief graphEvaluator is a Getter for the only GraphEvaluator instance to use in this application
+     * @return a pointer to a GraphEvaluator instance
+     */
+    GraphEvaluator* graphEvaluator() { return &m_graphEvaluator; }
+    /**
+     * @brief guiUpdateBatcher is a Getter for the only GuiUpdateBatcher instance to use in this application
+     * @return a pointer to a GuiUpdateBatcher instance
+     */
+    GuiUpdateBatcher* guiUpdateBatcher() { return &m_guiUpdateBatcher; }
     /**
      * @brief powermate is a Getter for the only PowermateListener instance to use in this application
      * @return a pointer to a PowermateListener instance
@@ -282,6 +297,18 @@ public slots:
     bool getClickSounds() const { return m_clickSounds; }
     void setClickSounds(bool value) { m_clickSounds = value; emit clickSoundsChanged(); }
 
+    /**
+     * @brief getSAcnBatchedReception returns if sACN input universes are received in a single thread
+     * @return true if batched reception is used
+     */
+    bool getSAcnBatchedReception() const;
+    /**
+     * @brief setSAcnBatchedReception sets if sACN input universes are received with one socket
+     * in a single thread instead of a thread per universe, applies to universes opened afterwards
+     * @param value true to use batched reception
+     */
+    void setSAcnBatchedReception(bool value);
+
     bool getForceImport() const { return m_forceImport; }
 
     QString getTemplateFileBaseName() const;
@@ -323,8 +350,10 @@ protected:
     Engine							m_engine;  //!< Engine instance
     AudioEngine*					m_audioEngine;  //!< AudioEngine instance
     OutputManager					m_output;  //!< OutputManager instance
+    GuiUpdateBatcher                m_guiUpdateBatcher;  //!< GuiUpdateBatcher instance, destroyed after the blocks
     FileSystemManager				m_dao;  //!< FileSystemManager instance
     BlockManager					m_blockManager;  //!< BlockManager instance
+    GraphEvaluator                  m_graphEvaluator;  //!< GraphEvaluator instance
     PowermateListener				m_powermate;  //!< PowermateListener instance
     MidiManager						m_midi;  //!< MidiManager instance
     OSCNetworkManager				m_customOsc;  //!< OSCNetworkManager instance for custom OSC commands
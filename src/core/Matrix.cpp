@@ -20,8 +20,57 @@
 
 #include "core/Matrix.h"
 
+#include "core/MatrixKernels.h"
+
 #include <QDebug>
 #include <cmath>
+#include <cstring>
+
+
+namespace {
+
+/**
+ * @brief rescalePlanes copies planar data to a new size, new elements are 0
+ * @param data the planes of the old size
+ * @param width old width
+ * @param height old height
+ * @param newWidth new width
+ * @param newHeight new height
+ * @param planes number of planes
+ * @return the planes with the new size
+ */
+QVector<float> rescalePlanes(const QVector<float>& data, int width, int height,
+                             int newWidth, int newHeight, int planes) {
+    QVector<float> result(newWidth * newHeight * planes, 0.0f);
+    const int minWidth = qMin(width, newWidth);
+    const int minHeight = qMin(height, newHeight);
+    for (int plane = 0; plane < planes; ++plane) {
+        const float* source = data.constData() + plane * width * height;
+        float* target = result.data() + plane * newWidth * newHeight;
+        for (int x = 0; x < minWidth; ++x) {
+            std::memcpy(target + x * newHeight, source + x * height, size_t(minHeight) * sizeof(float));
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief copyPlanes copies the values of the common area of two planar matrices
+ */
+void copyPlanes(float* target, int width, int height,
+                const float* source, int sourceWidth, int sourceHeight, int planes) {
+    const int minWidth = qMin(width, sourceWidth);
+    const int minHeight = qMin(height, sourceHeight);
+    for (int plane = 0; plane < planes; ++plane) {
+        for (int x = 0; x < minWidth; ++x) {
+            std::memcpy(target + plane * width * height + x * height,
+                        source + plane * sourceWidth * sourceHeight + x * sourceHeight,
+                        size_t(minHeight) * sizeof(float));
+        }
+    }
+}
+
+}  // namespace
 
 // ---------------------------- HSV ----------------------------
 
@@ -30,7 +79,7 @@ HsvMatrix::HsvMatrix()
 { }
 
 HsvMatrix::HsvMatrix(int width, int height)
-    : m_data(qMax(1, width), QVector<HSV>(qMax(1, height)))
+    : m_data(3 * qMax(1, width) * qMax(1, height), 0.0f)
     , m_width(qMax(1, width))
     , m_height(qMax(1, height))
 {
@@ -52,25 +101,9 @@ void HsvMatrix::rescale(int width, int height) {
     width = qMax(1, width);
     height = qMax(1, height);
 
-    // change width:
-    m_data.resize(width);
-
-    // for all columns:
-    for (int x = 0; x < width; ++x) {
-        // change height:
-        m_data[x].resize(height);
-    }
+    m_data = rescalePlanes(m_data, m_width, m_height, width, height, 3);
     m_width = width;
     m_height = height;
-
-    // postcondition check because this operation
-    if (m_width < 1 || m_height < 1 || m_data.size() != m_width || m_data[0].size() != m_height) {
-        if (m_data.size() < 1) {
-            qCritical() << "Matrix resize failed.";
-        }
-        qCritical() << "Matrix resize failed (target: " << width << "x" << height
-                    << ", actual:" << m_data.size() << "x" << m_data[0].size() << ")";
-    }
 }
 
 void HsvMatrix::rescale(const Size& s) {
@@ -86,23 +119,36 @@ void HsvMatrix::expandTo(const Size& s) {
 }
 
 void HsvMatrix::setFrom(const HsvMatrix& other) {
-    int minWidth = qMin(m_width, other.m_width);
-    int minHeight = qMin(m_height, other.m_height);
-    for (int x=0; x<minWidth; ++x) {
-        for (int y=0; y<minHeight; ++y) {
-            m_data[x][y] = other.m_data[x][y];
-        }
+    if (hasSameSizeAs(other)) {
+        m_data = other.m_data;  // implicitly shared
+        return;
     }
+    copyPlanes(m_data.data(), m_width, m_height, other.m_data.constData(), other.m_width, other.m_height, 3);
+}
+
+void HsvMatrix::fill(const HSV& col) {
+    MatrixKernels::fill(hue(), float(col.h), pixels());
+    MatrixKernels::fill(saturation(), float(col.s), pixels());
+    MatrixKernels::fill(value(), float(col.v), pixels());
+}
+
+void HsvMatrix::operator*=(double val) {
+    MatrixKernels::multiply(value(), float(val), pixels());
 }
 
 void HsvMatrix::fadeTo(const HsvMatrix& other, double pos) {
+    if (hasSameSizeAs(other)) {
+        MatrixKernels::mixInPlace(m_data.data(), other.m_data.constData(), float(pos), m_data.size());
+        return;
+    }
+    // other matrix is repeated if it is smaller:
     for (int x=0; x < m_width; ++x) {
         for (int y=0; y < m_height; ++y) {
-            HSV& col = m_data[x][y];
-            const HSV& colOther = other.at(x, y);
-            col.h = col.h * (1 - pos) + colOther.h * pos;
-            col.s = col.s * (1 - pos) + colOther.s * pos;
-            col.v = col.v * (1 - pos) + colOther.v * pos;
+            HsvReference col = at(x, y);
+            const HSV colOther = other.at(x, y);
+            col.h = float(col.h * (1 - pos) + colOther.h * pos);
+            col.s = float(col.s * (1 - pos) + colOther.s * pos);
+            col.v = float(col.v * (1 - pos) + colOther.v * pos);
         }
     }
 }
@@ -114,7 +160,7 @@ RgbMatrix::RgbMatrix()
 { }
 
 RgbMatrix::RgbMatrix(int width, int height)
-    : m_data(qMax(1, width), QVector<RGB>(qMax(1, height)))
+    : m_data(3 * qMax(1, width) * qMax(1, height), 0.0f)
     , m_width(qMax(1, width))
     , m_height(qMax(1, height))
 {
@@ -136,25 +182,9 @@ void RgbMatrix::rescale(int width, int height) {
     width = qMax(1, width);
     height = qMax(1, height);
 
-    // change width:
-    m_data.resize(width);
-
-    // for all columns:
-    for (int x = 0; x < width; ++x) {
-        // change height:
-        m_data[x].resize(height);
-    }
+    m_data = rescalePlanes(m_data, m_width, m_height, width, height, 3);
     m_width = width;
     m_height = height;
-
-    // postcondition check because this operation
-    if (m_width < 1 || m_height < 1 || m_data.size() != m_width || m_data[0].size() != m_height) {
-        if (m_data.size() < 1) {
-            qCritical() << "Matrix resize failed.";
-        }
-        qCritical() << "Matrix resize failed (target: " << width << "x" << height
-                    << ", actual:" << m_data.size() << "x" << m_data[0].size() << ")";
-    }
 }
 
 void RgbMatrix::rescale(const Size& s) {
@@ -170,50 +200,74 @@ void RgbMatrix::expandTo(const Size& s) {
 }
 
 void RgbMatrix::setFrom(const RgbMatrix& other) {
-    int minWidth = qMin(m_width, other.m_width);
-    int minHeight = qMin(m_height, other.m_height);
-    for (int x=0; x<minWidth; ++x) {
-        for (int y=0; y<minHeight; ++y) {
-            m_data[x][y] = other.m_data[x][y];
-        }
+    if (hasSameSizeAs(other)) {
+        m_data = other.m_data;  // implicitly shared
+        return;
     }
+    copyPlanes(m_data.data(), m_width, m_height, other.m_data.constData(), other.m_width, other.m_height, 3);
 }
 
 void RgbMatrix::addHtp(const RgbMatrix& other) {
-    int minWidth = qMin(m_width, other.m_width);
-    int minHeight = qMin(m_height, other.m_height);
-    for (int x=0; x<minWidth; ++x) {
-        for (int y=0; y<minHeight; ++y) {
-            m_data[x][y].mixHtp(other.m_data[x][y]);
+    if (hasSameSizeAs(other)) {
+        MatrixKernels::maxInPlace(m_data.data(), other.m_data.constData(), m_data.size());
+        return;
+    }
+    // only the common area, column by column:
+    const int minWidth = qMin(m_width, other.m_width);
+    const int minHeight = qMin(m_height, other.m_height);
+    float* target = m_data.data();
+    const float* source = other.m_data.constData();
+    for (int plane = 0; plane < 3; ++plane) {
+        for (int x=0; x<minWidth; ++x) {
+            MatrixKernels::maxInPlace(target + plane * pixels() + x * m_height,
+                                      source + plane * other.pixels() + x * other.m_height, minHeight);
         }
     }
 }
 
+void RgbMatrix::fill(const RGB& col) {
+    MatrixKernels::fill(red(), float(col.r), pixels());
+    MatrixKernels::fill(green(), float(col.g), pixels());
+    MatrixKernels::fill(blue(), float(col.b), pixels());
+}
+
+void RgbMatrix::operator*=(double val) {
+    MatrixKernels::multiply(m_data.data(), float(val), m_data.size());
+}
+
+// the stream format is the same as the one of the previous QVector<QVector<HSV>> storage
+// to be able to load existing projects:
+
 QDataStream& operator<<(QDataStream& out, const HsvMatrix& matrix) {
-    out << matrix.m_data;
+    out << quint32(matrix.m_width);
+    for (int x = 0; x < matrix.m_width; ++x) {
+        out << quint32(matrix.m_height);
+        for (int y = 0; y < matrix.m_height; ++y) {
+            out << matrix.at(x, y);
+        }
+    }
     out << matrix.m_width;
     out << matrix.m_height;
     return out;
 }
 
 QDataStream& operator>>(QDataStream& in, HsvMatrix& matrix) {
-    in >> matrix.m_data;
-    in >> matrix.m_width;
-    in >> matrix.m_height;
+    QVector<QVector<HSV>> columns;
+    in >> columns;
+    int width = 1;
+    int height = 1;
+    in >> width;
+    in >> height;
 
     // make sure matrix has correct size even if not restored correctly:
-    matrix.m_width = qMax(matrix.m_width, 1);
-    matrix.m_height = qMax(matrix.m_height, 1);
-
-    // change width:
-    matrix.m_data.resize(matrix.m_width);
-
-    // for all columns:
-    for (int x = 0; x < matrix.m_width; ++x) {
-        // change height:
-        matrix.m_data[x].resize(matrix.m_height);
+    matrix.m_width = qMax(width, 1);
+    matrix.m_height = qMax(height, 1);
+    matrix.m_data.fill(0.0f, 3 * matrix.pixels());
+    for (int x = 0; x < qMin(matrix.m_width, columns.size()); ++x) {
+        for (int y = 0; y < qMin(matrix.m_height, columns[x].size()); ++y) {
+            matrix.at(x, y) = columns[x][y];
+        }
     }
-
     return in;
 }
 
@@ -87,6 +87,58 @@ struct RGB {
     double b;
 };
 
+// ------------------------ References ---------------------
+
+/**
+ * @brief The HsvReference struct refers to a single element of a HsvMatrix.
+ * It is returned by HsvMatrix::at() instead of a HSV reference because the matrix
+ * stores the values in separate planes.
+ */
+struct HsvReference {
+    HsvReference(float& h_, float& s_, float& v_) : h(h_), s(s_), v(v_) {}
+    HsvReference(const HsvReference&) = default;
+
+    HsvReference& operator=(const HSV& col) {
+        h = float(col.h);
+        s = float(col.s);
+        v = float(col.v);
+        return *this;
+    }
+    // assigns the values, not the reference:
+    HsvReference& operator=(const HsvReference& other) { return operator=(HSV(other)); }
+
+    operator HSV() const { return HSV(h, s, v); }
+
+    float& h;
+    float& s;
+    float& v;
+};
+
+/**
+ * @brief The RgbReference struct refers to a single element of a RgbMatrix.
+ * It is returned by RgbMatrix::at() instead of a RGB reference because the matrix
+ * stores the values in separate planes.
+ */
+struct RgbReference {
+    RgbReference(float& r_, float& g_, float& b_) : r(r_), g(g_), b(b_) {}
+    RgbReference(const RgbReference&) = default;
+
+    RgbReference& operator=(const RGB& col) {
+        r = float(col.r);
+        g = float(col.g);
+        b = float(col.b);
+        return *this;
+    }
+    // assigns the values, not the reference:
+    RgbReference& operator=(const RgbReference& other) { return operator=(RGB(other)); }
+
+    operator RGB() const { return RGB(r, g, b); }
+
+    float& r;
+    float& g;
+    float& b;
+};
+
 struct Size {
     Size() : width(1), height(1) {}
     Size(int w, int h) : width(w), height(h) {}
@@ -101,6 +153,13 @@ struct Size {
 
 // ----------------------- HSV ------------------------
 
+/**
+ * @brief The HsvMatrix class stores a 2D matrix of HSV values.
+ *
+ * The values are stored as floats in three planes (all hue values, then all saturation values,
+ * then all brightness values), each in column-major order (index = x * height + y).
+ * This allows the per-pixel operations to use the vectorized MatrixKernels.
+ */
 class HsvMatrix {
 
 public:
@@ -128,28 +187,55 @@ public:
     void expandTo(int width, int height);
     void expandTo(const Size& s);
 
+    /**
+     * @brief isSharedWith returns if both matrices reference the same (implicitly shared) data
+     * @param other another matrix
+     * @return true if the data is shared, i.e. it is a copy that was not modified
+     */
+    bool isSharedWith(const HsvMatrix& other) const { return m_data.isSharedWith(other.m_data); }
+
     // ---- Getter + Setter:
 
-    HSV& at(int x, int y) { return m_data[abs(x % m_width)][abs(y % m_height)]; }
-    const HSV& at(int x, int y) const { return m_data[abs(x % m_width)][abs(y % m_height)]; }
+    HsvReference at(int x, int y) {
+        const int i = index(x, y);
+        float* d = m_data.data();
+        return HsvReference(d[i], d[pixels() + i], d[2 * pixels() + i]);
+    }
+    HSV at(int x, int y) const {
+        const int i = index(x, y);
+        const float* d = m_data.constData();
+        return HSV(d[i], d[pixels() + i], d[2 * pixels() + i]);
+    }
 
     void setFrom(const HsvMatrix& other);
 
-//    void setAll(const HSV& col);
-//    void setAll(double h, double s, double v);
-//    void setHue(double val);
-//    void setSat(double val);
-//    void setVal(double val);
+    void fill(const HSV& col);
+
+    // ---- Planes:
 
-//    // ---- operators:
+    int pixels() const { return m_width * m_height; }
+    float* hue() { return m_data.data(); }
+    const float* hue() const { return m_data.constData(); }
+    float* saturation() { return m_data.data() + pixels(); }
+    const float* saturation() const { return m_data.constData() + pixels(); }
+    float* value() { return m_data.data() + 2 * pixels(); }
+    const float* value() const { return m_data.constData() + 2 * pixels(); }
 
-//    void operator*=(double val);
+    // ---- operators:
+
+    /**
+     * @brief operator*= multiplies the brightness of all elements
+     * @param val factor
+     */
+    void operator*=(double val);
 
     void fadeTo(const HsvMatrix& other, double pos);
 
 
 protected:
-    QVector< QVector< HSV > > m_data;
+    int index(int x, int y) const { return abs(x % m_width) * m_height + abs(y % m_height); }
+
+    QVector<float> m_data;  //!< hue, saturation and value planes
     int m_width;
     int m_height;
 };
@@ -160,6 +246,12 @@ QDataStream& operator>>(QDataStream& in, HsvMatrix& matrix);
 
 // ----------------------- RGB ------------------------
 
+/**
+ * @brief The RgbMatrix class stores a 2D matrix of RGB values.
+ *
+ * The values are stored as floats in three planes (red, green, blue),
+ * each in column-major order (index = x * height + y), like in HsvMatrix.
+ */
 class RgbMatrix {
 
 public:
@@ -186,22 +278,45 @@ public:
 
     // ---- Getter + Setter:
 
-    RGB& at(int x, int y) { return m_data[abs(x % m_width)][abs(y % m_height)]; }
-    const RGB& at(int x, int y) const { return m_data[abs(x % m_width)][abs(y % m_height)]; }
+    RgbReference at(int x, int y) {
+        const int i = index(x, y);
+        float* d = m_data.data();
+        return RgbReference(d[i], d[pixels() + i], d[2 * pixels() + i]);
+    }
+    RGB at(int x, int y) const {
+        const int i = index(x, y);
+        const float* d = m_data.constData();
+        return RGB(d[i], d[pixels() + i], d[2 * pixels() + i]);
+    }
 
     void setFrom(const RgbMatrix& other);
     void addHtp(const RgbMatrix& other);
 
-//    void setAll(const RGB& col);
-//    void setAll(double r, double g, double b);
+    void fill(const RGB& col);
+
+    // ---- Planes:
 
-//    // ---- operators:
+    int pixels() const { return m_width * m_height; }
+    float* red() { return m_data.data(); }
+    const float* red() const { return m_data.constData(); }
+    float* green() { return m_data.data() + pixels(); }
+    const float* green() const { return m_data.constData() + pixels(); }
+    float* blue() { return m_data.data() + 2 * pixels(); }
+    const float* blue() const { return m_data.constData() + 2 * pixels(); }
 
-//    void operator*=(double val);
+    // ---- operators:
+
+    /**
+     * @brief operator*= multiplies all channels of all elements
+     * @param val factor
+     */
+    void operator*=(double val);
 
 
 protected:
-    QVector< QVector< RGB > > m_data;
+    int index(int x, int y) const { return abs(x % m_width) * m_height + abs(y % m_height); }
+
+    QVector<float> m_data;  //!< red, green and blue planes
     int m_width;
     int m_height;
 };
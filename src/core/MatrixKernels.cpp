@@ -0,0 +1,246 @@
+#include "MatrixKernels.h"
+
+#include "core/Matrix.h"
+#include "core/SimdOps.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QSize>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+namespace {
+
+// ------------------------ Kernels ---------------------
+// The templates process as many values as possible with the given instruction set
+// and return the number of processed values, the rest is done with ScalarOps.
+
+template<typename Ops>
+int fillKernel(float* data, float value, int count) {
+    const typename Ops::V x = Ops::set1(value);
+    int i = 0;
+    for (; i + Ops::width <= count; i += Ops::width) {
+        Ops::store(data + i, x);
+    }
+    return i;
+}
+
+template<typename Ops>
+int multiplyKernel(float* data, float factor, int count) {
+    const typename Ops::V f = Ops::set1(factor);
+    int i = 0;
+    for (; i + Ops::width <= count; i += Ops::width) {
+        Ops::store(data + i, Ops::mul(Ops::load(data + i), f));
+    }
+    return i;
+}
+
+template<typename Ops>
+int maxKernel(float* data, const float* other, int count) {
+    int i = 0;
+    for (; i + Ops::width <= count; i += Ops::width) {
+        Ops::store(data + i, Ops::max(Ops::load(data + i), Ops::load(other + i)));
+    }
+    return i;
+}
+
+template<typename Ops>
+int mixKernel(float* data, const float* other, float pos, int count) {
+    const typename Ops::V p = Ops::set1(pos);
+    const typename Ops::V invP = Ops::set1(1.0f - pos);
+    int i = 0;
+    for (; i + Ops::width <= count; i += Ops::width) {
+        Ops::store(data + i, Ops::add(Ops::mul(Ops::load(data + i), invP), Ops::mul(Ops::load(other + i), p)));
+    }
+    return i;
+}
+
+/**
+ * @brief hsvChannel calculates one RGB channel without branches:
+ * c = v - v * s * clamp(min(k, 4 - k), 0, 1) with k = (n + h * 6) mod 6
+ * and n = 5 for red, 3 for green and 1 for blue
+ */
+template<typename Ops>
+inline typename Ops::V hsvChannel(typename Ops::V h6, typename Ops::V vs, typename Ops::V v, float n) {
+    const typename Ops::V six = Ops::set1(6.0f);
+    typename Ops::V k = Ops::add(h6, Ops::set1(n));
+    k = Ops::sub(k, Ops::mul(six, Ops::floorPositive(Ops::mul(k, Ops::set1(1.0f / 6.0f)))));
+    typename Ops::V amount = Ops::min(k, Ops::sub(Ops::set1(4.0f), k));
+    amount = Ops::max(Ops::set1(0.0f), Ops::min(amount, Ops::set1(1.0f)));
+    return Ops::sub(v, Ops::mul(vs, amount));
+}
+
+template<typename Ops>
+int hsvToRgbKernel(const float* h, const float* s, const float* v, float* r, float* g, float* b, int count) {
+    int i = 0;
+    for (; i + Ops::width <= count; i += Ops::width) {
+        const typename Ops::V h6 = Ops::mul(Ops::load(h + i), Ops::set1(6.0f));
+        const typename Ops::V vv = Ops::load(v + i);
+        const typename Ops::V vs = Ops::mul(vv, Ops::load(s + i));
+        Ops::store(r + i, hsvChannel<Ops>(h6, vs, vv, 5.0f));
+        Ops::store(g + i, hsvChannel<Ops>(h6, vs, vv, 3.0f));
+        Ops::store(b + i, hsvChannel<Ops>(h6, vs, vv, 1.0f));
+    }
+    return i;
+}
+
+}  // namespace
+
+
+namespace MatrixKernels {
+
+const char* instructionSet() {
+    return SimdOps::name();
+}
+
+void fill(float* data, float value, int count) {
+    const int done = fillKernel<SimdOps>(data, value, count);
+    fillKernel<ScalarOps>(data + done, value, count - done);
+}
+
+void multiply(float* data, float factor, int count) {
+    const int done = multiplyKernel<SimdOps>(data, factor, count);
+    multiplyKernel<ScalarOps>(data + done, factor, count - done);
+}
+
+void maxInPlace(float* data, const float* other, int count) {
+    const int done = maxKernel<SimdOps>(data, other, count);
+    maxKernel<ScalarOps>(data + done, other + done, count - done);
+}
+
+void mixInPlace(float* data, const float* other, float pos, int count) {
+    const int done = mixKernel<SimdOps>(data, other, pos, count);
+    mixKernel<ScalarOps>(data + done, other + done, pos, count - done);
+}
+
+void hsvToRgb(const float* h, const float* s, const float* v, float* r, float* g, float* b, int count) {
+    const int done = hsvToRgbKernel<SimdOps>(h, s, v, r, g, b, count);
+    hsvToRgbKernel<ScalarOps>(h + done, s + done, v + done, r + done, g + done, b + done, count - done);
+}
+
+// ----------------- Benchmarks:
+
+namespace {
+
+/**
+ * @brief The BenchmarkData struct contains the same test data in the previous layout
+ * (vector of columns of HSV / RGB structs with doubles) and in the planar float layout
+ */
+struct BenchmarkData {
+    BenchmarkData(int width, int height)
+        : pixels(width * height)
+        , hsvStructs(width, std::vector<HSV>(height))
+        , rgbStructs(width, std::vector<RGB>(height))
+        , otherRgbStructs(width, std::vector<RGB>(height))
+        , hsv(3 * pixels)
+        , rgb(3 * pixels)
+        , otherRgb(3 * pixels)
+    {
+        for (int x = 0; x < width; ++x) {
+            for (int y = 0; y < height; ++y) {
+                const int i = x * height + y;
+                const HSV col((qrand() % 1000) / 1000.0, (qrand() % 1000) / 1000.0, (qrand() % 1000) / 1000.0);
+                const RGB other = RGB(HSV((qrand() % 1000) / 1000.0, 1.0, 1.0));
+                hsvStructs[x][y] = col;
+                otherRgbStructs[x][y] = other;
+                hsv[i] = float(col.h);
+                hsv[pixels + i] = float(col.s);
+                hsv[2 * pixels + i] = float(col.v);
+                otherRgb[i] = float(other.r);
+                otherRgb[pixels + i] = float(other.g);
+                otherRgb[2 * pixels + i] = float(other.b);
+            }
+        }
+    }
+
+    const int pixels;
+    std::vector<std::vector<HSV>> hsvStructs;
+    std::vector<std::vector<RGB>> rgbStructs;
+    std::vector<std::vector<RGB>> otherRgbStructs;
+    std::vector<float> hsv;
+    std::vector<float> rgb;
+    std::vector<float> otherRgb;
+};
+
+/**
+ * @brief measure returns the average duration of a function in ns
+ */
+template<typename F>
+double measure(int iterations, F function) {
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        function();
+    }
+    return double(timer.nsecsElapsed()) / iterations;
+}
+
+template<typename Ops>
+void runKernels(BenchmarkData& d, float factor) {
+    const int n = d.pixels;
+    float* h = d.hsv.data();
+    float* rgb = d.rgb.data();
+    hsvToRgbKernel<Ops>(h, h + n, h + 2 * n, rgb, rgb + n, rgb + 2 * n, n);
+    maxKernel<Ops>(rgb, d.otherRgb.data(), 3 * n);
+    multiplyKernel<Ops>(rgb, factor, 3 * n);
+    fillKernel<Ops>(h + 2 * n, factor, n);
+}
+
+}  // namespace
+
+QVariantList benchmark() {
+    QVariantList results;
+    const QVector<QSize> sizes = {QSize(1, 1), QSize(64, 1), QSize(128, 128)};
+    for (const QSize& size: sizes) {
+        BenchmarkData d(size.width(), size.height());
+        // run each variant for about the same number of pixels:
+        const int iterations = std::max(200, 4000000 / d.pixels);
+        // the factor is close to 1 to not end up with denormals:
+        const float factor = 0.999f;
+
+        // previous implementation: loops over the columns of HSV / RGB structs with doubles
+        const double legacyNs = measure(iterations, [&d, factor]() {
+            for (size_t x = 0; x < d.hsvStructs.size(); ++x) {
+                std::vector<HSV>& hsvColumn = d.hsvStructs[x];
+                std::vector<RGB>& rgbColumn = d.rgbStructs[x];
+                const std::vector<RGB>& otherColumn = d.otherRgbStructs[x];
+                for (size_t y = 0; y < hsvColumn.size(); ++y) {
+                    rgbColumn[y] = RGB(hsvColumn[y]);
+                    rgbColumn[y].mixHtp(otherColumn[y]);
+                    rgbColumn[y] *= factor;
+                    hsvColumn[y].v = factor;
+                }
+            }
+        });
+        const double scalarNs = measure(iterations, [&d, factor]() { runKernels<ScalarOps>(d, factor); });
+        const double simdNs = measure(iterations, [&d, factor]() { runKernels<SimdOps>(d, factor); });
+
+        // compare the results of the new and the previous implementation:
+        float maxDifference = 0;
+        for (int x = 0; x < size.width(); ++x) {
+            for (int y = 0; y < size.height(); ++y) {
+                const int i = x * size.height() + y;
+                maxDifference = std::max(maxDifference, std::abs(d.rgb[i] - float(d.rgbStructs[x][y].r)));
+            }
+        }
+        if (maxDifference > 0.01f) {
+            qWarning() << "Matrix kernel benchmark: results differ by" << maxDifference;
+        }
+
+        qInfo() << "Matrix kernels" << size.width() << "x" << size.height()
+                << "(HSV->RGB, HTP, multiply, fill): previous" << legacyNs << "ns, scalar"
+                << scalarNs << "ns," << instructionSet() << simdNs << "ns";
+        QVariantMap result;
+        result["width"] = size.width();
+        result["height"] = size.height();
+        result["legacyNs"] = legacyNs;
+        result["scalarNs"] = scalarNs;
+        result["simdNs"] = simdNs;
+        results.append(result);
+    }
+    return results;
+}
+
+}  // namespace MatrixKernels
@@ -0,0 +1,80 @@
+#ifndef MATRIXKERNELS_H
+#define MATRIXKERNELS_H
+
+#include <QVariant>
+
+
+/**
+ * @brief The MatrixKernels namespace contains the per-pixel loops of HsvMatrix and RgbMatrix.
+ *
+ * They work on the planar float data of the matrices (one array per channel) and use
+ * AVX, SSE2 or NEON depending on the target architecture with a scalar fallback.
+ * The arrays don't need to be aligned, but output arrays must not overlap with input arrays
+ * (except for the in-place operations).
+ */
+namespace MatrixKernels {
+
+    /**
+     * @brief instructionSet returns the name of the SIMD instruction set the kernels were compiled for
+     * @return "AVX", "SSE2", "NEON" or "Scalar"
+     */
+    const char* instructionSet();
+
+    /**
+     * @brief fill sets all values of an array to a single value
+     * @param data array to fill
+     * @param value the value
+     * @param count number of values
+     */
+    void fill(float* data, float value, int count);
+
+    /**
+     * @brief multiply multiplies all values of an array in place with a factor
+     * @param data array to modify
+     * @param factor factor to multiply with
+     * @param count number of values
+     */
+    void multiply(float* data, float factor, int count);
+
+    /**
+     * @brief maxInPlace sets each value of an array to the maximum of itself and
+     * the value in another array (HTP merge)
+     * @param data array to modify
+     * @param other other array
+     * @param count number of values
+     */
+    void maxInPlace(float* data, const float* other, int count);
+
+    /**
+     * @brief mixInPlace fades each value of an array to the value in another array
+     * (data = data * (1 - pos) + other * pos)
+     * @param data array to modify
+     * @param other other array
+     * @param pos fade position [0-1]
+     * @param count number of values
+     */
+    void mixInPlace(float* data, const float* other, float pos, int count);
+
+    /**
+     * @brief hsvToRgb converts planar HSV values to planar RGB values
+     * (same result as RGB(const HSV&) for hue values >= 0)
+     * @param h hue values [0-1]
+     * @param s saturation values [0-1]
+     * @param v brightness values [0-1]
+     * @param r output red values
+     * @param g output green values
+     * @param b output blue values
+     * @param count number of pixels
+     */
+    void hsvToRgb(const float* h, const float* s, const float* v, float* r, float* g, float* b, int count);
+
+    /**
+     * @brief benchmark compares the kernels with the scalar fallback and the previous
+     * per-pixel loops over HSV / RGB structs at different matrix sizes
+     * @return a list of maps with the results per size
+     */
+    QVariantList benchmark();
+
+}  // namespace MatrixKernels
+
+#endif // MATRIXKERNELS_H
@@ -1,201 +1,263 @@
 #include "NodeData.h"
 
+#include "core/MatrixKernels.h"
+
 #include <QDebug>
+#include <atomic>
 #include <cmath>
 
 
+namespace {
+
+// statistics about the data of all ColorMatrix objects (only counted in debug builds):
+std::atomic<quint64> s_copyCount(0);
+std::atomic<quint64> s_allocationCount(0);
+
+}  // namespace
+
+
+// ---------------------------- Data ----------------------------
+
+ColorMatrixData::ColorMatrixData()
+    : QSharedData()
+    , width(1)
+    , height(1)
+    , hsvData(1, 1)
+    , hsvIsValid(false)
+    , rgbData(1, 1)
+    , rgbIsValid(false)
+    , value(0)
+    , valueIsValid(true)
+    , absoluteMaximum(1)
+    , absoluteMaximumIsProvided(false)
+{
+#ifndef QT_NO_DEBUG
+    ++s_allocationCount;
+#endif
+}
+
+ColorMatrixData::ColorMatrixData(const ColorMatrixData& other)
+    : QSharedData(other)
+    , width(other.width)
+    , height(other.height)
+    , hsvData(other.hsvData)
+    , hsvIsValid(other.hsvIsValid)
+    , rgbData(other.rgbData)
+    , rgbIsValid(other.rgbIsValid)
+    , value(other.value)
+    , valueIsValid(other.valueIsValid)
+    , absoluteMaximum(other.absoluteMaximum)
+    , absoluteMaximumIsProvided(other.absoluteMaximumIsProvided)
+{
+#ifndef QT_NO_DEBUG
+    ++s_allocationCount;
+    ++s_copyCount;
+#endif
+}
+
+// ---------------------------- Matrix ----------------------------
+
 ColorMatrix::ColorMatrix()
-    : m_width(1)
-    , m_height(1)
-    , m_hsvData(1, 1)
-    , m_hsvIsValid(false)
-    , m_rgbData(1, 1)
-    , m_rgbIsValid(false)
-    , m_value(0)
-    , m_valueIsValid(true)
-    , m_absoluteMaximum(1)
-    , m_absoluteMaximumIsProvided(false)
-//    , m_offsetX(0)
-//    , m_offsetY(0)
+    : d(new ColorMatrixData())
 {}
 
 void ColorMatrix::addHtp(const ColorMatrix& other) {
+    if (isSharedWith(other)) {
+        // HTP with itself doesn't change anything:
+        return;
+    }
+    detach();
+
     // Special Case:
     // check if in both Matrices only the value attribute is valid:
-    if (!m_hsvIsValid && !m_rgbIsValid && !other.m_hsvIsValid && !other.m_rgbIsValid) {
-        m_value = std::max(m_value, other.m_value);
+    if (!d->hsvIsValid && !d->rgbIsValid && !other.d->hsvIsValid && !other.d->rgbIsValid) {
+        d->value = std::max(d->value, other.d->value);
         return;
     }
 
     // do normal RGB HTP mix:
-    if (!m_rgbIsValid) updateRgb();
-    if (!other.m_rgbIsValid) other.updateRgb();
-    m_rgbData.addHtp(other.m_rgbData);
-    m_hsvIsValid = false;
-    m_valueIsValid = false;
+    if (!d->rgbIsValid) updateRgb();
+    if (!other.d->rgbIsValid) other.updateRgb();
+    d->rgbData.addHtp(other.d.constData()->rgbData);
+    d->hsvIsValid = false;
+    d->valueIsValid = false;
 
     // absolute maximum:
-    if (other.m_absoluteMaximumIsProvided) {
-        if (m_absoluteMaximumIsProvided) {
-            m_absoluteMaximum = std::max(m_absoluteMaximum, other.m_absoluteMaximum);
+    if (other.d->absoluteMaximumIsProvided) {
+        if (d->absoluteMaximumIsProvided) {
+            d->absoluteMaximum = std::max(d->absoluteMaximum, other.d->absoluteMaximum);
         } else {
-            m_absoluteMaximum = other.m_absoluteMaximum;
-            m_absoluteMaximumIsProvided = true;
+            d->absoluteMaximum = other.d->absoluteMaximum;
+            d->absoluteMaximumIsProvided = true;
         }
     }
 }
 
 void ColorMatrix::rescaleTo(int sx, int sy) {
-    if (sx == m_width && sy == m_height) return;
+    if (sx == d->width && sy == d->height) return;
     if (sx < 1 || sy < 1) {
         // sx and sy must be at least 1, aborting:
         qWarning() << "Requested ColorMatrix size is invalid.";
         return;
     }
-    m_hsvData.rescale(sx, sy);
-    m_rgbData.rescale(sx, sy);
-    m_width = sx;
-    m_height = sy;
+    detach();
+    d->hsvData.rescale(sx, sy);
+    d->rgbData.rescale(sx, sy);
+    d->width = sx;
+    d->height = sy;
 
     // postcondition check:
-    if (m_hsvData.width() != m_width || m_hsvData.height() != m_height
-            || m_rgbData.width() != m_width || m_rgbData.height() != m_height) {
+    if (d->hsvData.width() != d->width || d->hsvData.height() != d->height
+            || d->rgbData.width() != d->width || d->rgbData.height() != d->height) {
         // -> size is not correct:
         qCritical() << "ColorMatrix resize failed.";
     }
 }
 
 void ColorMatrix::setHsv(double h, double s, double v) {
-    int sx = width();
-    int sy = height();
-    HSV newVal(h, s, v);
-    for (int x=0; x<sx; x++) {
-        for (int y=0; y<sy; y++) {
-            m_hsvData.at(x, y) = newVal;
-        }
-    }
-    m_hsvIsValid = true;
-    m_rgbIsValid = false;
-    m_valueIsValid = false;
+    detach();
+    fillHsv(*d, HSV(h, s, v));
+    d->hsvIsValid = true;
+    d->rgbIsValid = false;
+    d->valueIsValid = false;
 }
 
 void ColorMatrix::setHsvAt(int x, int y, double h, double s, double v) {
-    m_hsvData.at(x, y) = HSV(h, s, v);
-    m_hsvIsValid = true;
-    m_rgbIsValid = false;
-    m_valueIsValid = false;
+    detach();
+    d->hsvData.at(x, y) = HSV(h, s, v);
+    d->hsvIsValid = true;
+    d->rgbIsValid = false;
+    d->valueIsValid = false;
 }
 
 void ColorMatrix::setRgb(double r, double g, double b) {
-    int sx = width();
-    int sy = height();
-    RGB newVal(r, g, b);
-    for (int x=0; x<sx; x++) {
-        for (int y=0; y<sy; y++) {
-            m_rgbData.at(x, y) = newVal;
-        }
-    }
-    m_hsvIsValid = false;
-    m_rgbIsValid = true;
-    m_valueIsValid = false;
+    detach();
+    fillRgb(*d, RGB(r, g, b));
+    d->hsvIsValid = false;
+    d->rgbIsValid = true;
+    d->valueIsValid = false;
 }
 
 void ColorMatrix::setRgb(const RgbMatrix &newRgb) {
-    m_rgbData = newRgb;
-    m_hsvIsValid = false;
-    m_rgbIsValid = true;
-    m_valueIsValid = false;
+    detach();
+    d->rgbData = newRgb;
+    d->hsvIsValid = false;
+    d->rgbIsValid = true;
+    d->valueIsValid = false;
 }
 
 void ColorMatrix::setRgbAt(int x, int y, double r, double g, double b) {
-    m_rgbData.at(x, y) = RGB(r, g, b);
-    m_hsvIsValid = false;
-    m_rgbIsValid = true;
-    m_valueIsValid = false;
+    detach();
+    d->rgbData.at(x, y) = RGB(r, g, b);
+    d->hsvIsValid = false;
+    d->rgbIsValid = true;
+    d->valueIsValid = false;
 }
 
-//RGB ColorMatrix::getOffsetRgbValue() const {
-//    return getRgbAt(std::min(m_offsetX, getSX()), std::min(m_offsetY, getSY()));
-//}
 
 void ColorMatrix::setValue(double v) {
-    m_value = v;
-    m_hsvIsValid = false;
-    m_rgbIsValid = false;
-    m_valueIsValid = true;
+    detach();
+    d->value = v;
+    d->hsvIsValid = false;
+    d->rgbIsValid = false;
+    d->valueIsValid = true;
 }
 
 double ColorMatrix::getValue() const {
-    if (!m_valueIsValid) {
-        if (m_hsvIsValid) {
-            m_value = m_hsvData.at(0, 0).v;
+    if (!d->valueIsValid) {
+        // the value is a cache like the HSV and RGB data, it is updated in the shared data:
+        if (d->hsvIsValid) {
+            d->value = d.constData()->hsvData.at(0, 0).v;
         } else {
-            m_value = m_rgbData.at(0, 0).max();
+            d->value = d.constData()->rgbData.at(0, 0).max();
         }
-        m_valueIsValid = true;
+        d->valueIsValid = true;
     }
-    return m_value;
+    return d->value;
 }
 
-//double ColorMatrix::getOffsetValue() const {
-//    colorVector rgb = getRgbAt(std::min(m_offsetX, m_rgbData.size() - 1), std::min(m_offsetY, m_rgbData[0].size() - 1));
-//    return std::max(std::max(rgb[0], rgb[1]), rgb[2]);
-//}
 
 void ColorMatrix::setAbsoluteMaximum(double value) {
-    m_absoluteMaximum = value;
-    m_absoluteMaximumIsProvided = true;
+    detach();
+    d->absoluteMaximum = value;
+    d->absoluteMaximumIsProvided = true;
 }
 
 void ColorMatrix::setAbsoluteValue(double v) {
-    m_absoluteMaximum = v;
-    m_value = 1;
-    m_hsvIsValid = false;
-    m_rgbIsValid = false;
-    m_valueIsValid = true;
-    m_absoluteMaximumIsProvided = true;
+    detach();
+    d->absoluteMaximum = v;
+    d->value = 1;
+    d->hsvIsValid = false;
+    d->rgbIsValid = false;
+    d->valueIsValid = true;
+    d->absoluteMaximumIsProvided = true;
 }
 
 double ColorMatrix::getAbsoluteValue(double defaultMax) const {
-    if (m_absoluteMaximumIsProvided) {
-        return m_value * m_absoluteMaximum;
+    if (d->absoluteMaximumIsProvided) {
+        return d->value * d->absoluteMaximum;
     } else {
-        return m_value * defaultMax;
+        return d->value * defaultMax;
     }
 }
 
+quint64 ColorMatrix::copyCount() {
+    return s_copyCount;
+}
+
+quint64 ColorMatrix::allocationCount() {
+    return s_allocationCount;
+}
+
+void ColorMatrix::detach() {
+    // QExplicitlySharedDataPointer::detach() only copies the data if it is shared:
+    d.detach();
+}
+
 void ColorMatrix::updateHsv() const {
-    if (m_rgbIsValid) {
+    // the conversion only fills a cache, so it is done in the shared data
+    // and is then available to all copies:
+    if (d->rgbIsValid) {
         rgbToHsv();
     } else {
-        const_cast<ColorMatrix*>(this)->setHsv(0, 0, m_value);
+        fillHsv(*d, HSV(0, 0, d->value));
     }
-    m_hsvIsValid = true;
+    d->hsvIsValid = true;
 }
 
 void ColorMatrix::updateRgb() const {
-    if (m_hsvIsValid) {
+    if (d->hsvIsValid) {
         hsvToRgb();
     } else {
-        const_cast<ColorMatrix*>(this)->setRgb(m_value, m_value, m_value);
+        fillRgb(*d, RGB(d->value, d->value, d->value));
     }
-    m_rgbIsValid = true;
+    d->rgbIsValid = true;
+}
+
+void ColorMatrix::fillHsv(ColorMatrixData& data, const HSV& value) {
+    data.hsvData.fill(value);
+}
+
+void ColorMatrix::fillRgb(ColorMatrixData& data, const RGB& value) {
+    data.rgbData.fill(value);
 }
 
 void ColorMatrix::rgbToHsv() const {
     int sx = width();
     int sy = height();
+    const RgbMatrix& rgbData = d.constData()->rgbData;
+    HsvMatrix& hsvData = d->hsvData;
     for (int x=0; x<sx; ++x) {
         for (int y=0; y<sy; ++y) {
             double r, g, b, maxc, minc, h, s, delta;
-            const RGB& rgb = m_rgbData.at(x, y);
+            const RGB& rgb = rgbData.at(x, y);
             r = rgb.r;
             g = rgb.b;
             b = rgb.g;
             maxc = std::max(std::max(r, g), b);
             minc = std::min(std::min(r, g), b);
             if (minc == maxc) {
-                m_hsvData.at(x, y) = HSV(0, 0, maxc);
+                hsvData.at(x, y) = HSV(0, 0, maxc);
                 continue;
             }
             delta = maxc - minc;
@@ -211,42 +273,19 @@ void ColorMatrix::rgbToHsv() const {
             if (h < 0) {
                 h += 1;
             }
-            m_hsvData.at(x, y) = HSV(h, s, maxc);
+            hsvData.at(x, y) = HSV(h, s, maxc);
         }
     }
 }
 
 
 void ColorMatrix::hsvToRgb() const {
-    int sx = width();
-    int sy = height();
-    for (int x=0; x<sx; ++x) {
-        for (int y=0; y<sy; ++y) {
-            double h, s, v, f, p, q, t, r, g, b;
-            const HSV& hsv = m_hsvData.at(x, y);
-            h = hsv.h;
-            s = hsv.s;
-            v = hsv.v;
-            if (s == 0.0) {
-                m_rgbData.at(x, y) = RGB(v, v, v);
-                continue;
-            }
-            int i = int(h*6);
-            f = (h*6)-i;
-            p = v*(1-s);
-            q = v*(1-s*f);
-            t = v*(1-s*(1-f));
-            i = i % 6;
-            switch (i) {
-                case 0: r = v, g = t, b = p; break;
-                case 1: r = q, g = v, b = p; break;
-                case 2: r = p, g = v, b = t; break;
-                case 3: r = p, g = q, b = v; break;
-                case 4: r = t, g = p, b = v; break;
-                case 5: r = v, g = p, b = q; break;
-                default: r = 0, g = 0, b = 0; break;
-            }
-            m_rgbData.at(x, y) = RGB(r, g, b);
-        }
+    const HsvMatrix& hsvData = d.constData()->hsvData;
+    RgbMatrix& rgbData = d->rgbData;
+    // the planes are converted as a whole, setRgb(const RgbMatrix&) may have left a different size:
+    if (rgbData.width() != hsvData.width() || rgbData.height() != hsvData.height()) {
+        rgbData.rescale(hsvData.width(), hsvData.height());
     }
+    MatrixKernels::hsvToRgb(hsvData.hue(), hsvData.saturation(), hsvData.value(),
+                            rgbData.red(), rgbData.green(), rgbData.blue(), hsvData.pixels());
 }
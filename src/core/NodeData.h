@@ -4,9 +4,67 @@
 #include "core/Matrix.h"
 
 #include <QSize>
+#include <QSharedData>
 #include <vector>
 #include <cmath>
 
+/**
+ * @brief The ColorMatrixData struct contains the data of a ColorMatrix,
+ * it is shared between all copies of a ColorMatrix until one of them is modified.
+ */
+struct ColorMatrixData : public QSharedData {
+
+    ColorMatrixData();
+    ColorMatrixData(const ColorMatrixData& other);
+
+    /**
+     * @brief width is the width of the matrix [1...INT_MAX]
+     */
+    int width;
+    /**
+     * @brief height is the height of the matrix [1...INT_MAX]
+     */
+    int height;
+
+    /**
+     * @brief hsvData stores the data as HSV values (this is not always up to date)
+     */
+    HsvMatrix hsvData;
+    /**
+     * @brief hsvIsValid is true, if the HSV values are up to date
+     */
+    bool hsvIsValid;
+    /**
+     * @brief rgbData stores the data as RGB values (this is not always up to date)
+     */
+    RgbMatrix rgbData;
+    /**
+     * @brief rgbIsValid is true, if the RGB values are up to date
+     */
+    bool rgbIsValid;
+    /**
+     * @brief value stores the first value of the data (because it is very often used)
+     * (this is not always up to date)
+     */
+    double value;
+    /**
+     * @brief valueIsValid is true, if "value" is up to date
+     */
+    bool valueIsValid;
+
+    /**
+     * @brief absoluteMaximum stores the maximum absolute value to be multiplied with
+     * the relative values (it is only valid if absoluteMaximumIsProvided is true)
+     */
+    double absoluteMaximum;
+
+    /**
+     * @brief absoluteMaximumIsProvided is true, if the absoluteValue is set and valid
+     */
+    bool absoluteMaximumIsProvided;
+};
+
+
 /**
  * @brief The ColorMatrix struct can store a 2D matrix of color values.
  *
@@ -14,6 +72,11 @@
  * It can also be effeciently used to get and store a single 1D value,
  * that is only converted when necessary to RGB or HSV values.
  * The size of the matrix can be changed anytime.
+ *
+ * The data is implicitly shared: copying a ColorMatrix (i.e. from an output to an input node)
+ * only increases a reference count, the data is copied when one of the copies is modified.
+ * The cached RGB and HSV conversions are stored in the shared data, so they are only calculated
+ * once for all copies. Because of that a ColorMatrix must not be used from multiple threads.
  */
 struct ColorMatrix {
 
@@ -27,6 +90,13 @@ struct ColorMatrix {
     ColorMatrix& operator=(ColorMatrix&&) & = default;      // Move assignment operator
     ~ColorMatrix() = default;								// Destructor
 
+    /**
+     * @brief isSharedWith returns true if this matrix shares its data with another one
+     * @param other another ColorMatrix object
+     * @return true if both use the same data
+     */
+    bool isSharedWith(const ColorMatrix& other) const { return d == other.d; }
+
     /**
      * @brief mixHtp merges this marix with another one using HTP mode
      * @param other another ColorMatrix object
@@ -52,7 +122,7 @@ struct ColorMatrix {
      * @return width
      */
     int width() const {
-        return m_width;
+        return d->width;
     }
 
     /**
@@ -60,7 +130,7 @@ struct ColorMatrix {
      * @return height
      */
     int height() const {
-        return m_height;
+        return d->height;
     }
 
     QSize getSize() const {
@@ -106,10 +176,11 @@ struct ColorMatrix {
      * @param newHsv an array of HSV values  [0-1]
      */
     void setHsv(const HsvMatrix& newHsv) {
-        m_hsvData = newHsv;
-        m_hsvIsValid = true;
-        m_rgbIsValid = false;
-        m_valueIsValid = false;
+        detach();
+        d->hsvData = newHsv;
+        d->hsvIsValid = true;
+        d->rgbIsValid = false;
+        d->valueIsValid = false;
     }
 
     /**
@@ -128,8 +199,8 @@ struct ColorMatrix {
      * @return array of HSV values
      */
     const HsvMatrix& getHsv() const {
-        if (!m_hsvIsValid) updateHsv();
-        return m_hsvData;
+        if (!d->hsvIsValid) updateHsv();
+        return d.constData()->hsvData;
     }
 
     /**
@@ -139,8 +210,8 @@ struct ColorMatrix {
      * @return HSV values
      */
     HSV getHsvAt(int x, int y) const {
-        if (!m_hsvIsValid) updateHsv();
-        return m_hsvData.at(x, y);
+        if (!d->hsvIsValid) updateHsv();
+        return d.constData()->hsvData.at(x, y);
     }
 
     // ---------- RGB -------------
@@ -175,8 +246,8 @@ struct ColorMatrix {
      * @return array of HSV values
      */
     const RgbMatrix& getRgb() const {
-        if (!m_rgbIsValid) updateRgb();
-        return m_rgbData;
+        if (!d->rgbIsValid) updateRgb();
+        return d.constData()->rgbData;
     }
 
     /**
@@ -186,8 +257,8 @@ struct ColorMatrix {
      * @return RGB values
      */
     RGB getRgbAt(int x, int y) const {
-        if (!m_rgbIsValid) updateRgb();
-        return m_rgbData.at(x, y);
+        if (!d->rgbIsValid) updateRgb();
+        return d.constData()->rgbData.at(x, y);
     }
 
 //    /**
@@ -241,20 +312,48 @@ struct ColorMatrix {
      * @brief getAbsoluteMaximum returns the absolute maximum value
      * @return the maximal absolute value
      */
-    double getAbsoluteMaximum() const { return m_absoluteMaximum; }
+    double getAbsoluteMaximum() const { return d->absoluteMaximum; }
 
     /**
      * @brief absoluteMaximumIsProvided return if an absolute maximum value is provided
      * @return true if absolute maximum value is provided
      */
-    bool absoluteMaximumIsProvided() const { return m_absoluteMaximumIsProvided; }
+    bool absoluteMaximumIsProvided() const { return d->absoluteMaximumIsProvided; }
 
     /**
      * @brief resetAbsoluteMaximum resets absolute maximum value
      */
-    void resetAbsoluteMaximum() { m_absoluteMaximumIsProvided = false; }
+    void resetAbsoluteMaximum() { detach(); d->absoluteMaximumIsProvided = false; }
+
+    // ---------- Statistics -------------
+
+    /**
+     * @brief copyCount returns how often the data of a shared matrix had to be copied
+     * because it was modified (only counted in debug builds)
+     * @return number of copies since the start of the program
+     */
+    static quint64 copyCount();
+
+    /**
+     * @brief allocationCount returns how often data for a matrix was allocated,
+     * including the copies (only counted in debug builds)
+     * @return number of allocations since the start of the program
+     */
+    static quint64 allocationCount();
 
 protected:
+    /**
+     * @brief detach makes sure that the data is not shared before it is modified
+     */
+    void detach();
+
+    /**
+     * @brief writableData returns the detached data to be modified directly
+     * (used by HsvDataModifier and RgbDataModifier)
+     * @return the data of this matrix that is not shared with other matrices
+     */
+    ColorMatrixData& writableData() { detach(); return *d; }
+
     /**
      * @brief updateHsv sets the HSV values from RGB data or the value
      */
@@ -275,65 +374,24 @@ protected:
      */
     void hsvToRgb() const;
 
-    // -------------- member attributes ----------------
-
     /**
-     * @brief m_width is the width of the matrix [1...INT_MAX]
+     * @brief fillHsv sets all HSV values of the data to a single value without detaching it
+     * (used to fill the cache in a const context)
      */
-    int m_width;
-    /**
-     * @brief m_height is the height of the matrix [1...INT_MAX]
-     */
-    int m_height;
+    static void fillHsv(ColorMatrixData& data, const HSV& value);
 
     /**
-     * @brief m_hsvData stores the data as HSV values (this is not always up to date)
-     */
-    mutable HsvMatrix m_hsvData;
-    /**
-     * @brief m_hsvIsValid is true, if the HSV values are up to date
+     * @brief fillRgb sets all RGB values of the data to a single value without detaching it
+     * (used to fill the cache in a const context)
      */
-    mutable bool m_hsvIsValid;
-    /**
-     * @brief m_rgbData stores the data as RGB values (this is not always up to date)
-     */
-    mutable RgbMatrix m_rgbData;
-    /**
-     * @brief m_rgbIsValid is true, if the RGB values are up to date
-     */
-    mutable bool m_rgbIsValid;
-    /**
-     * @brief m_value stores the first value of the data (because it is very often used)
-     * (this is not always up to date)
-     */
-    mutable double m_value;
-    /**
-     * @brief m_valueIsValid is true, if "m_value" is up to date
-     */
-    mutable bool m_valueIsValid;
+    static void fillRgb(ColorMatrixData& data, const RGB& value);
 
-    /**
-     * @brief m_absoluteMaximum stores the maximum absolute value to be multiplied with
-     * the relative values (it is only valid if m_absoluteMaximumProvided is true)
-     */
-    mutable double m_absoluteMaximum;
+    // -------------- member attributes ----------------
 
     /**
-     * @brief m_absoluteMaximumIsProvided is true, if the absoluteValue is set and valid
+     * @brief d is the (possibly shared) data of this matrix
      */
-    mutable bool m_absoluteMaximumIsProvided;
-
-//    /**
-//     * @brief m_offsetX offset on x-axis to read from (i.e. because the values before that
-//     * were already used / displayed)
-//     */
-//    std::size_t m_offsetX;
-
-//    /**
-//     * @brief m_offsetY offset on y-axis to read from (i.e. because the values before that
-//     * were already used / displayed)
-//     */
-//    std::size_t m_offsetY;
+    QExplicitlySharedDataPointer<ColorMatrixData> d;
 };
 
 
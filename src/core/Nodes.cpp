@@ -1,6 +1,7 @@
 #include "core/Nodes.h"
 
 #include "core/block_data/BlockInterface.h"
+#include "core/manager/GraphEvaluator.h"
 #include "core/MainController.h"  // for LuminosusConstants
 
 // ------------------------ NodeBase -----------------------------------------------------------
@@ -8,7 +9,7 @@
 // initialize static member attributes:
 QPointer<NodeBase> NodeBase::s_focusedNode = nullptr;
 
-NodeBase::NodeBase(BlockInterface* block, int index, bool isOutput)
+NodeBase::NodeBase(BlockInterface* block, int index, bool isOutput, GraphEvaluator* graph)
     : QObject(block)
     , m_block(block)
     , m_index(index)
@@ -21,6 +22,10 @@ NodeBase::NodeBase(BlockInterface* block, int index, bool isOutput)
     , m_isActive(true)
     , m_htp(true)
     , m_impulseActive(false)
+    , m_graph(graph)
+    , m_evaluationRank(-1)
+    , m_dataIsDirty(false)
+    , m_dirtyLtpSource(nullptr)
     , m_requestedSize(1, 1)
     , m_data()
 {
@@ -97,6 +102,7 @@ void NodeBase::connectTo(NodeBase* otherNode) {
 
     outputNode->m_connectedNodes.append(inputNode);
     inputNode->m_connectedNodes.append(outputNode);
+    if (m_graph) m_graph->invalidateOrder();
     // TODO: create Bezier Curve
 
     outputNode->updateRequestedSize();
@@ -148,6 +154,7 @@ void NodeBase::disconnectFrom(NodeBase* otherNode) {
 
     outputNode->m_connectedNodes.removeOne(inputNode);
     inputNode->m_connectedNodes.removeOne(outputNode);
+    if (m_graph) m_graph->invalidateOrder();
 
     // check if requested Size changed in output node because of disconnect:
     outputNode->updateRequestedSize();
@@ -307,9 +314,14 @@ void NodeBase::dataWasModifiedByBlock() {
         qCritical() << "Method dataWasModifiedByBlock() is only available for output nodes.";
         return;
     }
+    const bool batched = m_graph && m_graph->isBatched();
     for (NodeBase* inputNode: m_connectedNodes) {
         if (!inputNode) continue;
-        inputNode->updateData(this);
+        if (batched) {
+            inputNode->markDataDirty(this);
+        } else {
+            inputNode->updateData(this);
+        }
     }
 }
 
@@ -432,7 +444,12 @@ void NodeBase::updateData(NodeBase* ltpSource) {
         qCritical() << "Method updateData() is only available for input nodes.";
         return;
     }
+    if (mergeData(ltpSource)) {
+        emit dataChanged();
+    }
+}
 
+bool NodeBase::mergeData(NodeBase* ltpSource) {
     if (m_htp || !ltpSource) {
         bool isFirst = true;
         for (NodeBase* outputNode: m_connectedNodes) {
@@ -445,6 +462,7 @@ void NodeBase::updateData(NodeBase* ltpSource) {
             }
 
             if (isFirst) {
+                // this only shares the data, it is copied by addHtp() if there are more sources:
                 m_data = data;
                 isFirst = false;
             } else {
@@ -458,12 +476,23 @@ void NodeBase::updateData(NodeBase* ltpSource) {
         if (data.width() < m_requestedSize.width
                 || data.height() < m_requestedSize.height) {
             qWarning() << "Data of output is too small for this input node.";
-            return;
+            return false;
         }
         m_data = data;
     }
+    return true;
+}
 
-    emit dataChanged();
+void NodeBase::markDataDirty(NodeBase* ltpSource) {
+    if (!m_graph) {
+        updateData(ltpSource);
+        return;
+    }
+    // the output that changed last is used for LTP merging:
+    m_dirtyLtpSource = ltpSource;
+    if (m_dataIsDirty) return;
+    m_dataIsDirty = true;
+    m_graph->addDirtyNode(this);
 }
 
 // ------ internal logic of Output Node:
@@ -16,6 +16,7 @@
 
 // Forward declaration to reduce dependencies
 class BlockInterface;
+class GraphEvaluator;
 
 
 /**
@@ -26,6 +27,8 @@ class NodeBase : public QObject
 {
     Q_OBJECT
 
+    friend class GraphEvaluator;
+
     Q_PROPERTY(bool htpMode READ getHtpMode WRITE setHtpMode NOTIFY htpModeChanged)
     Q_PROPERTY(bool focused READ isFocused NOTIFY focusedChanged)
     Q_PROPERTY(bool active READ isActive NOTIFY isActiveChanged)
@@ -37,8 +40,10 @@ public:
      * @param block a pointer to the block that contains this Node
      * @param index of this Node in the Block
      * @param isOutput defines if this is an Output Node
+     * @param graph the GraphEvaluator to use in batched mode or nullptr to always update
+     * connected nodes immediately
      */
-    explicit NodeBase(BlockInterface* block, int index, bool isOutput);
+    explicit NodeBase(BlockInterface* block, int index, bool isOutput, GraphEvaluator* graph = nullptr);
 
 signals:
     // ------------ signals for Block:
@@ -264,7 +269,9 @@ public slots:
     // ------------------------ Setter of Output Node --------------------------
     /**
      * @brief dataWasModifiedByBlock is to be called, after the data of data() was
-     * modified to notify the connected Nodes about the change (Output Node only)
+     * modified to notify the connected Nodes about the change (Output Node only);
+     * in batched mode of the GraphEvaluator they are only marked as dirty and updated
+     * in the next frame
      */
     void dataWasModifiedByBlock();
     /**
@@ -350,6 +357,20 @@ protected:
      * or a nullptr if this is unknown
      */
     void updateData(NodeBase* ltpSource = nullptr);
+    /**
+     * @brief mergeData merges the data of all connected nodes without emitting dataChanged();
+     * (Input Node only)
+     * @param ltpSource a pointer to the Node thats data was changed last (for LTP merging)
+     * or a nullptr if this is unknown
+     * @return true if the data was updated and dataChanged() should be emitted
+     */
+    bool mergeData(NodeBase* ltpSource);
+    /**
+     * @brief markDataDirty schedules this node to be updated by the GraphEvaluator
+     * in batched mode (Input Node only)
+     * @param ltpSource a pointer to the Node thats data was changed
+     */
+    void markDataDirty(NodeBase* ltpSource);
 
     // ------------------------ internal logic of Output Node:
     /**
@@ -382,6 +403,12 @@ protected:
     bool m_impulseActive;  //!< true if value is above threshold and impulseBegin was sent (only in impulse mode)
     QTimer m_impulseTimer;  //!< used for sendImpulse() to set the value back to 0.0 after a short time
 
+    // batched evaluation:
+    GraphEvaluator* const m_graph;  //!< the GraphEvaluator to schedule updates or nullptr
+    int m_evaluationRank;  //!< topological rank of the block, set by the GraphEvaluator (Input Node only)
+    bool m_dataIsDirty;  //!< true if this node is scheduled to be updated (Input Node only)
+    QPointer<NodeBase> m_dirtyLtpSource;  //!< the output that changed last while dirty (Input Node only)
+
     // data:
     Size m_requestedSize;  //!< requested matrix size
     ColorMatrix m_data;  //!< ColorMatrix data object
@@ -401,13 +428,13 @@ struct HsvDataModifier {
 
     explicit HsvDataModifier(NodeBase* node)
         : m_node(node)
-        , m_matrix(node->data())
-        , width(m_matrix.width())
-        , height(m_matrix.height())
+        , m_data(node->data().writableData())
+        , width(m_data.width)
+        , height(m_data.height)
     {
-        m_matrix.m_hsvIsValid = true;
-        m_matrix.m_rgbIsValid = false;
-        m_matrix.m_valueIsValid = false;
+        m_data.hsvIsValid = true;
+        m_data.rgbIsValid = false;
+        m_data.valueIsValid = false;
     }
 
     ~HsvDataModifier() {
@@ -415,24 +442,24 @@ struct HsvDataModifier {
     }
 
     void set(int x, int y, double h, double s, double v) {
-        m_matrix.m_hsvData.at(x, y) = HSV(h, s, v);
+        m_data.hsvData.at(x, y) = HSV(h, s, v);
     }
 
     void set(int x, int y, const HSV& val) {
-        m_matrix.m_hsvData.at(x, y) = val;
+        m_data.hsvData.at(x, y) = val;
     }
 
     HSV get(int x, int y) const {
-        return m_matrix.m_hsvData.at(x, y);
+        return m_data.hsvData.at(x, y);
     }
 
     void setFrom(const HsvMatrix& matrix) {
-        m_matrix.m_hsvData.setFrom(matrix);
+        m_data.hsvData.setFrom(matrix);
     }
 
 protected:
     NodeBase* const m_node;
-    ColorMatrix& m_matrix;
+    ColorMatrixData& m_data;  //!< data of the node, not shared during the lifetime of the modifier
 
 public:
     const int width;
@@ -450,13 +477,13 @@ struct RgbDataModifier {
 
     explicit RgbDataModifier(NodeBase* node)
         : m_node(node)
-        , m_matrix(node->data())
-        , width(m_matrix.width())
-        , height(m_matrix.height())
+        , m_data(node->data().writableData())
+        , width(m_data.width)
+        , height(m_data.height)
     {
-        m_matrix.m_hsvIsValid = false;
-        m_matrix.m_rgbIsValid = true;
-        m_matrix.m_valueIsValid = false;
+        m_data.hsvIsValid = false;
+        m_data.rgbIsValid = true;
+        m_data.valueIsValid = false;
     }
 
     ~RgbDataModifier() {
@@ -464,20 +491,20 @@ struct RgbDataModifier {
     }
 
     void set(int x, int y, double r, double g, double b) {
-        m_matrix.m_rgbData.at(x, y) = RGB(r, g, b);
+        m_data.rgbData.at(x, y) = RGB(r, g, b);
     }
 
     void set(int x, int y, const RGB& val) {
-        m_matrix.m_rgbData.at(x, y) = val;
+        m_data.rgbData.at(x, y) = val;
     }
 
     RGB get(int x, int y) const {
-        return m_matrix.m_rgbData.at(x, y);
+        return m_data.rgbData.at(x, y);
     }
 
 protected:
     NodeBase* const m_node;
-    ColorMatrix& m_matrix;
+    ColorMatrixData& m_data;  //!< data of the node, not shared during the lifetime of the modifier
 
 public:
     const int width;
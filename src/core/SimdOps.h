@@ -0,0 +1,128 @@
+#ifndef SIMDOPS_H
+#define SIMDOPS_H
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+
+// ------------------------ Instruction Sets ---------------------
+// Each struct provides the same operations on a vector of "width" floats,
+// kernels (see MatrixKernels and AudioKernels) are written once as templates using them.
+// SimdOps is the widest instruction set available for the target architecture.
+// This header is only meant to be included by the .cpp files of the kernels.
+
+struct ScalarOps {
+    typedef float V;
+    static const int width = 1;
+    static V load(const float* p) { return *p; }
+    static void store(float* p, V x) { *p = x; }
+    static V set1(float x) { return x; }
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+    static V div(V a, V b) { return a / b; }
+    static V min(V a, V b) { return a < b ? a : b; }
+    static V max(V a, V b) { return a > b ? a : b; }
+    // only for values >= 0:
+    static V floorPositive(V x) { return float(int(x)); }
+    // converts the bit pattern of a float to an int32 and that int to float:
+    static V bitsToFloat(V x) { int32_t i; std::memcpy(&i, &x, 4); return float(i); }
+    // converts a float to an int32 and returns that bit pattern as float:
+    static V floatToBits(V x) { const int32_t i = int32_t(x); float f; std::memcpy(&f, &i, 4); return f; }
+    // bitwise operations with a 32 bit mask:
+    static V andMask(V x, uint32_t mask) { uint32_t i; std::memcpy(&i, &x, 4); i &= mask; std::memcpy(&x, &i, 4); return x; }
+    static V orMask(V x, uint32_t mask) { uint32_t i; std::memcpy(&i, &x, 4); i |= mask; std::memcpy(&x, &i, 4); return x; }
+};
+
+#if defined(__AVX__)
+
+struct SimdOps {
+    typedef __m256 V;
+    static const int width = 8;
+    static const char* name() { return "AVX"; }
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, V x) { _mm256_storeu_ps(p, x); }
+    static V set1(float x) { return _mm256_set1_ps(x); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm256_div_ps(a, b); }
+    static V min(V a, V b) { return _mm256_min_ps(a, b); }
+    static V max(V a, V b) { return _mm256_max_ps(a, b); }
+    static V floorPositive(V x) { return _mm256_floor_ps(x); }
+    static V bitsToFloat(V x) { return _mm256_cvtepi32_ps(_mm256_castps_si256(x)); }
+    static V floatToBits(V x) { return _mm256_castsi256_ps(_mm256_cvttps_epi32(x)); }
+    static V andMask(V x, uint32_t mask) { return _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(int(mask)))); }
+    static V orMask(V x, uint32_t mask) { return _mm256_or_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(int(mask)))); }
+};
+
+#elif defined(__SSE2__) || defined(_M_X64)
+
+struct SimdOps {
+    typedef __m128 V;
+    static const int width = 4;
+    static const char* name() { return "SSE2"; }
+    static V load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, V x) { _mm_storeu_ps(p, x); }
+    static V set1(float x) { return _mm_set1_ps(x); }
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm_div_ps(a, b); }
+    static V min(V a, V b) { return _mm_min_ps(a, b); }
+    static V max(V a, V b) { return _mm_max_ps(a, b); }
+    // SSE2 has no floor instruction, truncation is the same for positive values:
+    static V floorPositive(V x) { return _mm_cvtepi32_ps(_mm_cvttps_epi32(x)); }
+    static V bitsToFloat(V x) { return _mm_cvtepi32_ps(_mm_castps_si128(x)); }
+    static V floatToBits(V x) { return _mm_castsi128_ps(_mm_cvttps_epi32(x)); }
+    static V andMask(V x, uint32_t mask) { return _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(int(mask)))); }
+    static V orMask(V x, uint32_t mask) { return _mm_or_ps(x, _mm_castsi128_ps(_mm_set1_epi32(int(mask)))); }
+};
+
+#elif defined(__ARM_NEON)
+
+struct SimdOps {
+    typedef float32x4_t V;
+    static const int width = 4;
+    static const char* name() { return "NEON"; }
+    static V load(const float* p) { return vld1q_f32(p); }
+    static void store(float* p, V x) { vst1q_f32(p, x); }
+    static V set1(float x) { return vdupq_n_f32(x); }
+    static V add(V a, V b) { return vaddq_f32(a, b); }
+    static V sub(V a, V b) { return vsubq_f32(a, b); }
+    static V mul(V a, V b) { return vmulq_f32(a, b); }
+#if defined(__aarch64__)
+    static V div(V a, V b) { return vdivq_f32(a, b); }
+#else
+    static V div(V a, V b) {
+        // reciprocal estimate refined with two Newton-Raphson steps:
+        V r = vrecpeq_f32(b);
+        r = vmulq_f32(vrecpsq_f32(b, r), r);
+        r = vmulq_f32(vrecpsq_f32(b, r), r);
+        return vmulq_f32(a, r);
+    }
+#endif
+    static V min(V a, V b) { return vminq_f32(a, b); }
+    static V max(V a, V b) { return vmaxq_f32(a, b); }
+    static V floorPositive(V x) { return vcvtq_f32_s32(vcvtq_s32_f32(x)); }
+    static V bitsToFloat(V x) { return vcvtq_f32_s32(vreinterpretq_s32_f32(x)); }
+    static V floatToBits(V x) { return vreinterpretq_f32_s32(vcvtq_s32_f32(x)); }
+    static V andMask(V x, uint32_t mask) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(x), vdupq_n_u32(mask))); }
+    static V orMask(V x, uint32_t mask) { return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(x), vdupq_n_u32(mask))); }
+};
+
+#else
+
+struct SimdOps : public ScalarOps {
+    static const char* name() { return "Scalar"; }
+};
+
+#endif
+
+#endif // SIMDOPS_H
@@ -8,6 +8,9 @@ SmartAttribute::SmartAttribute(BlockInterface* block, QString name, bool persist
     : QObject(block)
     , m_name(name)
     , m_persistent(persistent)
+    , m_block(block)
+    , m_guiIsDirty(false)
+    , m_notifiesGuiAlways(false)
 {
     block->registerAttribute(this);
 }
@@ -16,17 +19,34 @@ SmartAttribute::SmartAttribute(QObject* parent, QString name, bool persistent)
     : QObject(parent)
     , m_name(name)
     , m_persistent(persistent)
+    , m_block(nullptr)
+    , m_guiIsDirty(false)
+    , m_notifiesGuiAlways(false)
 {
 
 }
 
+void SmartAttribute::trackChanges() {
+    if (!m_persistent) return;
+    // the signal is declared by the subclasses, so this can't be done in the constructor above:
+    connect(this, SIGNAL(valueChanged()), parent(), SLOT(markStateDirty()));
+}
+
+void SmartAttribute::notifyGui() {
+    if (m_block) {
+        m_block->markGuiAttributeDirty(this);
+    } else {
+        emitGuiValueChanged();
+    }
+}
+
 DoubleAttribute::DoubleAttribute(BlockInterface* block, QString name, double initialValue, double min, double max, bool persistent)
     : SmartAttribute(block, name, persistent)
     , m_value(initialValue)
     , m_min(min)
     , m_max(max)
 {
-
+    trackChanges();
 }
 
 DoubleAttribute::DoubleAttribute(QObject* parent, QString name, double initialValue, double min, double max, bool persistent)
@@ -51,6 +71,7 @@ void DoubleAttribute::setValue(double value) {
     if (value == m_value) return;
     m_value = limit(m_min, value, m_max);
     emit valueChanged();
+    notifyGui();
 }
 
 
@@ -60,7 +81,7 @@ IntegerAttribute::IntegerAttribute(BlockInterface* block, QString name, int init
     , m_min(min)
     , m_max(max)
 {
-
+    trackChanges();
 }
 
 IntegerAttribute::IntegerAttribute(QObject* parent, QString name, int initialValue, int min, int max, bool persistent)
@@ -85,6 +106,7 @@ void IntegerAttribute::setValue(int value) {
     if (value == m_value) return;
     m_value = limit(m_min, value, m_max);
     emit valueChanged();
+    notifyGui();
 }
 
 
@@ -92,7 +114,7 @@ StringAttribute::StringAttribute(BlockInterface* block, QString name, QString in
     : SmartAttribute(block, name, persistent)
     , m_value(initialValue)
 {
-
+    trackChanges();
 }
 
 StringAttribute::StringAttribute(QObject* parent, QString name, QString initialValue, bool persistent)
@@ -115,7 +137,7 @@ BoolAttribute::BoolAttribute(BlockInterface* block, QString name, bool initialVa
     : SmartAttribute(block, name, persistent)
     , m_value(initialValue)
 {
-
+    trackChanges();
 }
 
 BoolAttribute::BoolAttribute(QObject* parent, QString name, bool initialValue, bool persistent)
@@ -137,7 +159,7 @@ RgbAttribute::RgbAttribute(BlockInterface* block, QString name, const RGB& initi
     : SmartAttribute(block, name, persistent)
     , m_value(initialValue)
 {
-
+    trackChanges();
 }
 
 RgbAttribute::RgbAttribute(QObject* parent, QString name, const RGB& initialValue, bool persistent)
@@ -174,6 +196,7 @@ void RgbAttribute::setHue(double value) {
     m_value = RGB(hsv);
     m_tempHsv.h = value;
     emit valueChanged();
+    notifyGui();
 }
 
 double RgbAttribute::sat() const {
@@ -193,6 +216,7 @@ void RgbAttribute::setSat(double value) {
     m_value = RGB(hsv);
     m_tempHsv.s = value;
     emit valueChanged();
+    notifyGui();
 }
 
 void RgbAttribute::setVal(double value) {
@@ -203,6 +227,7 @@ void RgbAttribute::setVal(double value) {
     hsv.v = value;
     m_value = RGB(hsv);
     emit valueChanged();
+    notifyGui();
 }
 
 void RgbAttribute::setQColor(QColor value) {
@@ -210,6 +235,7 @@ void RgbAttribute::setQColor(QColor value) {
     m_value.g = value.greenF();
     m_value.b = value.blueF();
     emit valueChanged();
+    notifyGui();
 }
 
 QColor RgbAttribute::getGlow() const {
@@ -225,7 +251,7 @@ HsvAttribute::HsvAttribute(BlockInterface* block, QString name, const HSV& initi
     : SmartAttribute(block, name, persistent)
     , m_value(initialValue)
 {
-
+    trackChanges();
 }
 
 HsvAttribute::HsvAttribute(QObject* parent, QString name, const HSV& initialValue, bool persistent)
@@ -254,6 +280,7 @@ void HsvAttribute::setQColor(QColor value) {
     m_value.s = value.saturationF();
     m_value.v = value.valueF();
     emit valueChanged();
+    notifyGui();
 }
 
 void HsvAttribute::mixHtp(const HSV& other) {
@@ -27,16 +27,50 @@ public slots:
     bool persistent() const { return m_persistent; }
     QObject* block() const { return parent(); }
 
+    /**
+     * @brief emitGuiValueChanged notifies the QML properties of this attribute,
+     * called by notifyGui() or by the block when the GuiUpdateBatcher flushes
+     */
+    virtual void emitGuiValueChanged() = 0;
+
+    bool guiIsDirty() const { return m_guiIsDirty; }
+    void setGuiIsDirty(bool value) { m_guiIsDirty = value; }
+
+    /**
+     * @brief setNotifiesGuiAlways has to be enabled for attributes that are bound by QML items
+     * outside of the GUI item of their block, they are notified once per frame even if
+     * the GUI item of the block doesn't exist or is hidden
+     * @param value true if the attribute is bound outside of the GUI item of its block
+     */
+    void setNotifiesGuiAlways(bool value) { m_notifiesGuiAlways = value; }
+    bool notifiesGuiAlways() const { return m_notifiesGuiAlways; }
+
+protected:
+    /**
+     * @brief trackChanges marks the state of the block as dirty whenever the value changes,
+     * has to be called by the constructors of the subclasses that take a block
+     */
+    void trackChanges();
+
+    /**
+     * @brief notifyGui has to be called after valueChanged(), the GUI of a block is notified
+     * once per frame by the GuiUpdateBatcher, other attributes notify it immediately
+     */
+    void notifyGui();
+
 protected:
     QString m_name;
     bool m_persistent;
+    BlockInterface* const m_block;  //!< the block of this attribute or nullptr
+    bool m_guiIsDirty;  //!< true if the GUI has not been notified about the last change
+    bool m_notifiesGuiAlways;  //!< true if the GUI is notified independent of the GUI item of the block
 };
 
 class DoubleAttribute : public SmartAttribute
 {
     Q_OBJECT
 
-    Q_PROPERTY(double val READ getValue WRITE setValue NOTIFY valueChanged)
+    Q_PROPERTY(double val READ getValue WRITE setValue NOTIFY guiValueChanged)
     Q_PROPERTY(double min READ getMin WRITE setMin NOTIFY minChanged)
     Q_PROPERTY(double max READ getMax WRITE setMax NOTIFY maxChanged)
 
@@ -48,12 +82,14 @@ public:
 
 signals:
     void valueChanged();
+    void guiValueChanged();
     void minChanged();
     void maxChanged();
 
 public slots:
     virtual void writeTo(QJsonObject& state) const override;
     virtual void readFrom(const QJsonObject& state) override;
+    virtual void emitGuiValueChanged() override { emit guiValueChanged(); }
 
     double getValue() const { return m_value; }
     void setValue(double value);
@@ -75,7 +111,7 @@ class IntegerAttribute : public SmartAttribute
 {
     Q_OBJECT
 
-    Q_PROPERTY(int val READ getValue WRITE setValue NOTIFY valueChanged)
+    Q_PROPERTY(int val READ getValue WRITE setValue NOTIFY guiValueChanged)
     Q_PROPERTY(int min READ getMin WRITE setMin NOTIFY minChanged)
     Q_PROPERTY(int max READ getMax WRITE setMax NOTIFY maxChanged)
 
@@ -87,12 +123,14 @@ public:
 
 signals:
     void valueChanged();
+    void guiValueChanged();
     void minChanged();
     void maxChanged();
 
 public slots:
     virtual void writeTo(QJsonObject& state) const override;
     virtual void readFrom(const QJsonObject& state) override;
+    virtual void emitGuiValueChanged() override { emit guiValueChanged(); }
 
     int getValue() const { return m_value; }
     void setValue(int value);
@@ -114,7 +152,7 @@ class StringAttribute : public SmartAttribute
 {
     Q_OBJECT
 
-    Q_PROPERTY(QString val READ getValue WRITE setValue NOTIFY valueChanged)
+    Q_PROPERTY(QString val READ getValue WRITE setValue NOTIFY guiValueChanged)
 
 public:
     explicit StringAttribute(BlockInterface* block, QString name, QString initialValue = "", bool persistent = true);
@@ -124,13 +162,15 @@ public:
 
 signals:
     void valueChanged();
+    void guiValueChanged();
 
 public slots:
     virtual void writeTo(QJsonObject& state) const override;
     virtual void readFrom(const QJsonObject& state) override;
+    virtual void emitGuiValueChanged() override { emit guiValueChanged(); }
 
     QString getValue() const { return m_value; }
-    void setValue(QString value) { m_value = value; emit valueChanged(); }  // TODO: check if equal
+    void setValue(QString value) { m_value = value; emit valueChanged(); notifyGui(); }  // TODO: check if equal
 
 protected:
     QString m_value;
@@ -141,7 +181,7 @@ class BoolAttribute : public SmartAttribute
 {
     Q_OBJECT
 
-    Q_PROPERTY(bool val READ getValue WRITE setValue NOTIFY valueChanged)
+    Q_PROPERTY(bool val READ getValue WRITE setValue NOTIFY guiValueChanged)
 
 public:
     explicit BoolAttribute(BlockInterface* block, QString name, bool initialValue = false, bool persistent = true);
@@ -151,13 +191,15 @@ public:
 
 signals:
     void valueChanged();
+    void guiValueChanged();
 
 public slots:
     virtual void writeTo(QJsonObject& state) const override;
     virtual void readFrom(const QJsonObject& state) override;
+    virtual void emitGuiValueChanged() override { emit guiValueChanged(); }
 
     bool getValue() const { return m_value; }
-    void setValue(bool value) { m_value = value; emit valueChanged(); }  // TODO: check if equal
+    void setValue(bool value) { m_value = value; emit valueChanged(); notifyGui(); }  // TODO: check if equal
 
 protected:
     bool m_value;
@@ -173,15 +215,15 @@ class RgbAttribute : public SmartAttribute
 {
     Q_OBJECT
 
-    Q_PROPERTY(double red READ red WRITE setRed NOTIFY valueChanged)
-    Q_PROPERTY(double green READ green WRITE setGreen NOTIFY valueChanged)
-    Q_PROPERTY(double blue READ blue WRITE setBlue NOTIFY valueChanged)
-    Q_PROPERTY(double hue READ hue WRITE setHue NOTIFY valueChanged)
-    Q_PROPERTY(double sat READ sat WRITE setSat NOTIFY valueChanged)
-    Q_PROPERTY(double val READ val WRITE setVal NOTIFY valueChanged)
-    Q_PROPERTY(QColor qcolor READ getQColor WRITE setQColor NOTIFY valueChanged)
-    Q_PROPERTY(double max READ max NOTIFY valueChanged)
-    Q_PROPERTY(QColor glow READ getGlow NOTIFY valueChanged)
+    Q_PROPERTY(double red READ red WRITE setRed NOTIFY guiValueChanged)
+    Q_PROPERTY(double green READ green WRITE setGreen NOTIFY guiValueChanged)
+    Q_PROPERTY(double blue READ blue WRITE setBlue NOTIFY guiValueChanged)
+    Q_PROPERTY(double hue READ hue WRITE setHue NOTIFY guiValueChanged)
+    Q_PROPERTY(double sat READ sat WRITE setSat NOTIFY guiValueChanged)
+    Q_PROPERTY(double val READ val WRITE setVal NOTIFY guiValueChanged)
+    Q_PROPERTY(QColor qcolor READ getQColor WRITE setQColor NOTIFY guiValueChanged)
+    Q_PROPERTY(double max READ max NOTIFY guiValueChanged)
+    Q_PROPERTY(QColor glow READ getGlow NOTIFY guiValueChanged)
 
 public:
     explicit RgbAttribute(BlockInterface* block, QString name, const RGB& initialValue = {0, 0, 0}, bool persistent = true);
@@ -191,20 +233,22 @@ public:
 
 signals:
     void valueChanged();
+    void guiValueChanged();
 
 public slots:
     virtual void writeTo(QJsonObject& state) const override;
     virtual void readFrom(const QJsonObject& state) override;
+    virtual void emitGuiValueChanged() override { emit guiValueChanged(); }
 
     const RGB& getValue() const { return m_value; }
-    void setValue(const RGB& value) { m_value = value; emit valueChanged(); }  // TODO: check if equal
+    void setValue(const RGB& value) { m_value = value; emit valueChanged(); notifyGui(); }  // TODO: check if equal
 
     double red() const { return m_value.r; }
-    void setRed(double value) { m_value.r = value; emit valueChanged(); }
+    void setRed(double value) { m_value.r = value; emit valueChanged(); notifyGui(); }
     double green() const { return m_value.g; }
-    void setGreen(double value) { m_value.g = value; emit valueChanged(); }
+    void setGreen(double value) { m_value.g = value; emit valueChanged(); notifyGui(); }
     double blue() const { return m_value.b; }
-    void setBlue(double value) { m_value.b = value; emit valueChanged(); }
+    void setBlue(double value) { m_value.b = value; emit valueChanged(); notifyGui(); }
 
     double hue() const;
     void setHue(double value);
@@ -220,7 +264,7 @@ public slots:
 
     double max() const { return m_value.max(); }
 
-    void mixHtp(const RGB& other) { m_value.mixHtp(other); emit valueChanged(); }
+    void mixHtp(const RGB& other) { m_value.mixHtp(other); emit valueChanged(); notifyGui(); }
 
 protected:
     RGB m_value;
@@ -232,10 +276,10 @@ class HsvAttribute : public SmartAttribute
 {
     Q_OBJECT
 
-    Q_PROPERTY(QColor qcolor READ getQColor WRITE setQColor NOTIFY valueChanged)
-    Q_PROPERTY(double hue READ hue WRITE setHue NOTIFY valueChanged)
-    Q_PROPERTY(double sat READ sat WRITE setSat NOTIFY valueChanged)
-    Q_PROPERTY(double val READ val WRITE setVal NOTIFY valueChanged)
+    Q_PROPERTY(QColor qcolor READ getQColor WRITE setQColor NOTIFY guiValueChanged)
+    Q_PROPERTY(double hue READ hue WRITE setHue NOTIFY guiValueChanged)
+    Q_PROPERTY(double sat READ sat WRITE setSat NOTIFY guiValueChanged)
+    Q_PROPERTY(double val READ val WRITE setVal NOTIFY guiValueChanged)
 
 public:
     explicit HsvAttribute(BlockInterface* block, QString name, const HSV& initialValue = {0, 0, 0}, bool persistent = true);
@@ -245,20 +289,22 @@ public:
 
 signals:
     void valueChanged();
+    void guiValueChanged();
 
 public slots:
     virtual void writeTo(QJsonObject& state) const override;
     virtual void readFrom(const QJsonObject& state) override;
+    virtual void emitGuiValueChanged() override { emit guiValueChanged(); }
 
     const HSV& getValue() const { return m_value; }
-    void setValue(const HSV& value) { m_value = value; emit valueChanged(); }  // TODO: check if equal
+    void setValue(const HSV& value) { m_value = value; emit valueChanged(); notifyGui(); }  // TODO: check if equal
 
     double hue() const { return m_value.h; }
-    void setHue(double value) { m_value.h = value; emit valueChanged(); }
+    void setHue(double value) { m_value.h = value; emit valueChanged(); notifyGui(); }
     double sat() const { return m_value.s; }
-    void setSat(double value) { m_value.s = value; emit valueChanged(); }
+    void setSat(double value) { m_value.s = value; emit valueChanged(); notifyGui(); }
     double val() const { return m_value.v; }
-    void setVal(double value) { m_value.v = value; emit valueChanged(); }
+    void setVal(double value) { m_value.v = value; emit valueChanged(); notifyGui(); }
 
     QColor getQColor() const { return QColor::fromHsvF(m_value.h, m_value.s, m_value.v); }
     void setQColor(QColor value);
@@ -0,0 +1,108 @@
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+
+/**
+ * @brief The SpscRingBuffer class passes a stream of values from exactly one producer thread
+ * to exactly one consumer thread without locks and without allocations.
+ *
+ * The capacity is rounded up to a power of two. The read and write positions are counters
+ * that only increase, so a full and an empty buffer can be distinguished without wasting a slot.
+ * If the consumer is too slow, push() only writes the values that fit and the rest is dropped.
+ */
+template<typename T>
+class SpscRingBuffer {
+
+public:
+    /**
+     * @brief SpscRingBuffer creates a ring buffer
+     * @param minCapacity minimum number of values the buffer can hold
+     */
+    explicit SpscRingBuffer(std::size_t minCapacity)
+        : m_buffer(roundUpToPowerOfTwo(minCapacity))
+        , m_mask(m_buffer.size() - 1)
+        , m_writePos(0)
+        , m_readPos(0)
+    {}
+
+    /**
+     * @brief capacity returns the maximum number of values in the buffer
+     * @return number of values
+     */
+    std::size_t capacity() const { return m_buffer.size(); }
+
+    /**
+     * @brief clear removes all values, must not be called while one of the threads uses the buffer
+     */
+    void clear() {
+        m_writePos.store(0);
+        m_readPos.store(0);
+    }
+
+    // ---------------- Producer:
+
+    /**
+     * @brief push appends values to the buffer
+     * @param values pointer to the first value
+     * @param count number of values
+     * @return number of values written, less than count if the buffer is full
+     */
+    std::size_t push(const T* values, std::size_t count) {
+        const std::size_t writePos = m_writePos.load(std::memory_order_relaxed);
+        const std::size_t readPos = m_readPos.load(std::memory_order_acquire);
+        count = std::min(count, m_buffer.size() - (writePos - readPos));
+        const std::size_t start = writePos & m_mask;
+        const std::size_t firstPart = std::min(count, m_buffer.size() - start);
+        std::copy(values, values + firstPart, m_buffer.begin() + start);
+        std::copy(values + firstPart, values + count, m_buffer.begin());
+        m_writePos.store(writePos + count, std::memory_order_release);
+        return count;
+    }
+
+    // ---------------- Consumer:
+
+    /**
+     * @brief available returns the number of values that can be read
+     * @return number of values
+     */
+    std::size_t available() const {
+        return m_writePos.load(std::memory_order_acquire) - m_readPos.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief pop removes values from the front of the buffer
+     * @param values pointer to an array to copy the values to
+     * @param count maximum number of values to read
+     * @return number of values read, less than count if not enough values are available
+     */
+    std::size_t pop(T* values, std::size_t count) {
+        const std::size_t readPos = m_readPos.load(std::memory_order_relaxed);
+        const std::size_t writePos = m_writePos.load(std::memory_order_acquire);
+        count = std::min(count, writePos - readPos);
+        const std::size_t start = readPos & m_mask;
+        const std::size_t firstPart = std::min(count, m_buffer.size() - start);
+        std::copy(m_buffer.begin() + start, m_buffer.begin() + start + firstPart, values);
+        std::copy(m_buffer.begin(), m_buffer.begin() + (count - firstPart), values + firstPart);
+        m_readPos.store(readPos + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    static std::size_t roundUpToPowerOfTwo(std::size_t value) {
+        std::size_t result = 1;
+        while (result < value) result <<= 1;
+        return result;
+    }
+
+    std::vector<T> m_buffer;
+    const std::size_t m_mask;
+    std::atomic<std::size_t> m_writePos;  //!< only modified by the producer
+    std::atomic<std::size_t> m_readPos;  //!< only modified by the consumer
+};
+
+#endif // SPSCRINGBUFFER_H
@@ -0,0 +1,72 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+
+/**
+ * @brief The TripleBuffer class passes the latest version of an object from exactly one
+ * producer thread to exactly one consumer thread without locks.
+ *
+ * The producer fills writeBuffer() and calls publish(), the consumer calls fetch() and
+ * reads readBuffer(). Neither side ever waits for the other one. If the producer publishes
+ * faster than the consumer fetches, intermediate versions are skipped.
+ */
+template<typename T>
+class TripleBuffer {
+
+public:
+    TripleBuffer()
+        : m_middle(1)
+        , m_writeIndex(0)
+        , m_readIndex(2)
+    {}
+
+    // ---------------- Producer:
+
+    /**
+     * @brief writeBuffer returns the buffer to be filled by the producer
+     * @return a reference to an object that is not accessed by the consumer
+     */
+    T& writeBuffer() { return m_buffers[m_writeIndex]; }
+
+    /**
+     * @brief publish makes the content of writeBuffer() available to the consumer,
+     * writeBuffer() will return another object afterwards (with outdated content)
+     */
+    void publish() {
+        uint8_t old = m_middle.exchange(uint8_t(m_writeIndex | NEW_DATA_BIT), std::memory_order_acq_rel);
+        m_writeIndex = old & INDEX_MASK;
+    }
+
+    // ---------------- Consumer:
+
+    /**
+     * @brief fetch makes the most recently published object available in readBuffer()
+     * @return true if a new object was published since the last call
+     */
+    bool fetch() {
+        if (!(m_middle.load(std::memory_order_relaxed) & NEW_DATA_BIT)) return false;
+        uint8_t old = m_middle.exchange(m_readIndex, std::memory_order_acq_rel);
+        m_readIndex = old & INDEX_MASK;
+        return true;
+    }
+
+    /**
+     * @brief readBuffer returns the object last fetched by the consumer
+     * @return a reference to an object that is not accessed by the producer
+     */
+    const T& readBuffer() const { return m_buffers[m_readIndex]; }
+
+private:
+    static const uint8_t INDEX_MASK = 0x3;
+    static const uint8_t NEW_DATA_BIT = 0x4;
+
+    T m_buffers[3];
+    std::atomic<uint8_t> m_middle;  //!< index of the buffer between producer and consumer
+    uint8_t m_writeIndex;  //!< only accessed by the producer
+    uint8_t m_readIndex;  //!< only accessed by the consumer
+};
+
+#endif // TRIPLEBUFFER_H
@@ -23,17 +23,21 @@
 #include "core/MainController.h"
 #include "core/Nodes.h"
 #include "core/SmartAttribute.h"
+#include "core/MatrixKernels.h"
 
 #include <QQmlEngine>
 #include <time.h>
 #include <string>
 #include <cstdlib>
 #include <utility>
+#include <algorithm>
 
 namespace BlockBaseConstants {
     const QString fallbackQmlFile = "qrc:/qml/FallbackBlockGui.qml";
 }
 
+BlockBase::SceneMixStatistics BlockBase::s_sceneMixStatistics;
+
 QString getNewUid() {
     return QString::number(time(NULL)).append(QString::number(1000 + std::rand() % 9000));
 }
@@ -54,9 +58,13 @@ BlockBase::BlockBase(MainController* controller, QString uid)
   , m_guiItemCompleted(false)
   , m_controllerFunctionCount(1)
   , m_controllerFunctionSelected(0)
+  , m_guiUpdateIsQueued(false)
   , m_isSceneBlock(false)
   , m_sceneGroup(0)
   , m_lastChangedSceneOrigin(nullptr)
+  , m_stateIsDirty(true)
+  , m_additionalStateIsTracked(false)
+  , m_hasNoAdditionalState(false)
   , m_label(this, "label", "")
 {
 	// Tell QML that this object is owned by C++ and should not be deleted by the JS GC:
@@ -66,6 +74,9 @@ BlockBase::BlockBase(MainController* controller, QString uid)
 	if (m_uid.isEmpty()) {
 		m_uid = getNewUid();
 	}
+
+    // the label is also shown by other views, e.g. the cue list entries of presets:
+    m_label.setNotifiesGuiAlways(true);
 }
 
 BlockBase::~BlockBase() {
@@ -86,6 +97,11 @@ QJsonObject BlockBase::getState() const {
     return state;
 }
 
+bool BlockBase::stateIsDirty() const {
+    // the additional state of blocks that don't track it could have changed anytime:
+    return m_stateIsDirty || !(m_hasNoAdditionalState || m_additionalStateIsTracked);
+}
+
 void BlockBase::setState(const QJsonObject& state) {
     setSceneGroup(state["sceneGroup"].toInt());
     if (state["guiItemHidden"].toBool()) hideGui();
@@ -179,8 +195,10 @@ QQuickItem* BlockBase::getGuiItemChild(QString name) {
 
 NodeBase* BlockBase::createOutputNode(QString guiItemName) {
     int number = m_nodes.size();
-    auto node = new NodeBase(this, number, true);
+    auto node = new NodeBase(this, number, true, m_controller->graphEvaluator());
 	QQmlEngine::setObjectOwnership(node, QQmlEngine::CppOwnership);
+    // the connections are saved by the block of the output node:
+    connect(node, SIGNAL(connectionChanged()), this, SLOT(markStateDirty()));
 	m_nodes[number] = node;
     m_nodesByName[guiItemName] = node;
     return node;
@@ -188,7 +206,7 @@ NodeBase* BlockBase::createOutputNode(QString guiItemName) {
 
 NodeBase* BlockBase::createInputNode(QString guiItemName) {
     int number = m_nodes.size();
-    auto node = new NodeBase(this, number, false);
+    auto node = new NodeBase(this, number, false, m_controller->graphEvaluator());
     QQmlEngine::setObjectOwnership(node, QQmlEngine::CppOwnership);
 	m_nodes[number] = node;
     m_nodesByName[guiItemName] = node;
@@ -249,6 +267,78 @@ void BlockBase::registerAttribute(SmartAttribute* attr) {
     }
 }
 
+void BlockBase::markGuiAttributeDirty(SmartAttribute* attr) {
+    if (!attr) return;
+    // attributes bound outside of the GUI item don't depend on its visibility:
+    const bool notifiesAlways = attr->notifiesGuiAlways();
+    // without a GUI item there is nothing to notify, a new item reads the current values:
+    if (!m_guiItem && !notifiesAlways) return;
+    GuiUpdateBatcher* batcher = m_controller->guiUpdateBatcher();
+    const bool isShown = notifiesAlways || guiItemIsShown();
+    if (!batcher->isBatched() && isShown) {
+        attr->emitGuiValueChanged();
+        batcher->countNotifications(1);
+        return;
+    }
+    if (attr->guiIsDirty()) return;
+    attr->setGuiIsDirty(true);
+    m_dirtyGuiAttributes.append(attr);
+    if (!m_guiUpdateIsQueued && isShown) {
+        m_guiUpdateIsQueued = true;
+        batcher->addBlock(this);
+    }
+}
+
+int BlockBase::flushGuiUpdates() {
+    m_guiUpdateIsQueued = false;
+    const bool isShown = guiItemIsShown();
+    // a QML handler can change an attribute again, it is notified in the next frame:
+    m_notifiedGuiAttributes.swap(m_dirtyGuiAttributes);
+    int count = 0;
+    for (SmartAttribute* attr: m_notifiedGuiAttributes) {
+        if (!attr) continue;
+        if (!isShown && !attr->notifiesGuiAlways()) {
+            if (m_guiItem) {
+                // a hidden or culled item is notified when it is shown again:
+                m_dirtyGuiAttributes.append(attr);
+            } else {
+                attr->setGuiIsDirty(false);
+            }
+            continue;
+        }
+        attr->setGuiIsDirty(false);
+        attr->emitGuiValueChanged();
+        ++count;
+    }
+    m_notifiedGuiAttributes.clear();
+    return count;
+}
+
+void BlockBase::discardGuiUpdates() {
+    // attributes bound outside of the GUI item are still notified:
+    int kept = 0;
+    for (SmartAttribute* attr: m_dirtyGuiAttributes) {
+        if (!attr) continue;
+        if (attr->notifiesGuiAlways()) {
+            m_dirtyGuiAttributes[kept++] = attr;
+        } else {
+            attr->setGuiIsDirty(false);
+        }
+    }
+    m_dirtyGuiAttributes.resize(kept);
+}
+
+void BlockBase::onGuiItemVisibilityChanged() {
+    if (m_guiUpdateIsQueued || m_dirtyGuiAttributes.isEmpty() || !guiItemIsShown()) return;
+    m_guiUpdateIsQueued = true;
+    m_controller->guiUpdateBatcher()->addBlock(this);
+}
+
+bool BlockBase::guiItemIsShown() const {
+    // hideGui() removes the parent item, BlockManager::updateBlockVisibility() hides culled items:
+    return m_guiItem && m_guiItem->parentItem() && m_guiItem->isVisible();
+}
+
 void BlockBase::setGuiItemCode(QString code) {
     QQmlComponent component(m_controller->guiManager()->qmlEngine());
     component.setData(code.toLatin1(), QUrl(getBlockInfo().qmlFile));
@@ -273,6 +363,11 @@ void BlockBase::setGuiItemCode(QString code) {
     // TODO: change hidden mechanism?
     connect(m_guiItem, SIGNAL(parentChanged(QQuickItem*)), this, SIGNAL(guiIsHiddenChanged()));
 
+    // the new item reads the current values, pending notifications are obsolete:
+    discardGuiUpdates();
+    connect(m_guiItem, &QQuickItem::parentChanged, this, &BlockBase::onGuiItemVisibilityChanged);
+    connect(m_guiItem, &QQuickItem::visibleChanged, this, &BlockBase::onGuiItemVisibilityChanged);
+
     onGuiItemCreated();
 }
 
@@ -394,6 +489,11 @@ void BlockBase::createGuiItem() {
     // TODO: change hidden mechanism?
     connect(m_guiItem, SIGNAL(parentChanged(QQuickItem*)), this, SIGNAL(guiIsHiddenChanged()));
 
+    // the new item reads the current values, pending notifications are obsolete:
+    discardGuiUpdates();
+    connect(m_guiItem, &QQuickItem::parentChanged, this, &BlockBase::onGuiItemVisibilityChanged);
+    connect(m_guiItem, &QQuickItem::visibleChanged, this, &BlockBase::onGuiItemVisibilityChanged);
+
     onGuiItemCreated();
 }
 
@@ -486,6 +586,7 @@ void BlockBase::setGuiHeight(double value) {
 
 void BlockBase::hideGui() {
     m_guiShouldBeHidden = true;
+    markStateDirty();
     QQuickItem* item = getGuiItem();
     if (!item) return;
     m_guiItemParent = item->parentItem();
@@ -494,6 +595,7 @@ void BlockBase::hideGui() {
 
 void BlockBase::unhideGui() {
     m_guiShouldBeHidden = false;
+    markStateDirty();
     QQuickItem* item = getGuiItem();
     if (!item) return;
     item->setParentItem(m_guiItemParent);
@@ -516,17 +618,121 @@ void BlockBase::setGuiParentItem(QQuickItem* parent) {
 // ---------------------------- Scenes ----------------------------
 
 void BlockBase::setSceneData(const void* origin, double factor, const HsvMatrix& data) {
-    // TODO: is copy reference to data neccessary?
-    m_sceneValues[origin] = {factor, data};
-    m_lastChangedSceneOrigin = origin;
-    updateFromSceneData();
+    setSceneContribution(origin, factor, data, nullptr, 0.0);
+}
+
+void BlockBase::setSceneFade(const void* origin, double factor, const HsvMatrix& from, const HsvMatrix& to, double pos) {
+    setSceneContribution(origin, factor, from, &to, pos);
 }
 
 void BlockBase::removeSceneData(const void* origin) {
-    m_sceneValues.remove(origin);
+    if (!m_sceneValues.remove(origin)) return;
+    remixSceneData();
+    updateFromSceneData();
+}
+
+void BlockBase::setSceneContribution(const void* origin, double factor, const HsvMatrix& values,
+                                     const HsvMatrix* fadeTarget, double fadePos) {
+    ++s_sceneMixStatistics.updates;
+    const bool fades = fadeTarget && fadePos > 0.0;
+
+    auto it = m_sceneValues.find(origin);
+    const bool isNew = it == m_sceneValues.end();
+    if (isNew) {
+        it = m_sceneValues.insert(origin, SceneContribution(values));
+        ++s_sceneMixStatistics.allocations;  // matrix of the scaled values
+    }
+    SceneContribution& contribution = it.value();
+
+    // the matrices are only compared by reference, presets and cues don't modify them in place:
+    const bool valuesChanged = isNew
+            || !contribution.values.isSharedWith(values)
+            || fades != contribution.fades
+            || (fades && (!contribution.fadeTarget.isSharedWith(*fadeTarget)
+                          || contribution.fadePos != fadePos));
+    if (!valuesChanged && contribution.factor == factor) {
+        ++s_sceneMixStatistics.unchanged;
+        return;
+    }
+    // the scaled values can only grow if the same values are scaled up:
+    const bool canMerge = isNew || (!valuesChanged && factor >= contribution.factor);
+
+    contribution.factor = factor;
+    contribution.values = values;
+    if (fades) {
+        contribution.fadeTarget = *fadeTarget;
+    } else if (contribution.fades) {
+        // release the previous target without allocating an empty matrix:
+        contribution.fadeTarget = values;
+    }
+    contribution.fades = fades;
+    contribution.fadePos = fadePos;
+    updateScaledContribution(contribution);
+
+    if (canMerge && mergeIntoSceneMix(contribution.scaled)) {
+        ++s_sceneMixStatistics.mergedMixes;
+    } else {
+        remixSceneData();
+    }
+    m_lastChangedSceneOrigin = origin;
     updateFromSceneData();
 }
 
+void BlockBase::updateScaledContribution(SceneContribution& contribution) {
+    const HsvMatrix& values = contribution.values;
+    HsvMatrix& scaled = contribution.scaled;
+    if (!scaled.hasSameSizeAs(values)) {
+        scaled.rescale(values.size());
+        ++s_sceneMixStatistics.allocations;
+    }
+    const int count = 3 * values.pixels();
+    std::copy(values.hue(), values.hue() + count, scaled.hue());
+    if (contribution.fades) {
+        // in place, the target is repeated if it is smaller:
+        scaled.fadeTo(contribution.fadeTarget, contribution.fadePos);
+    }
+    MatrixKernels::multiply(scaled.hue(), float(contribution.factor), count);
+}
+
+bool BlockBase::mergeIntoSceneMix(const HsvMatrix& scaled) {
+    if (m_sceneMix.hasSameSizeAs(scaled)) {
+        MatrixKernels::maxInPlace(m_sceneMix.hue(), scaled.hue(), 3 * scaled.pixels());
+        return true;
+    }
+    if (m_sceneMix.isSmallerThan(scaled)) return false;
+
+    // the contribution is smaller and is repeated like in HsvMatrix::at():
+    for (int x = 0; x < m_sceneMix.width(); ++x) {
+        for (int y = 0; y < m_sceneMix.height(); ++y) {
+            HsvReference col = m_sceneMix.at(x, y);
+            const HSV other = scaled.at(x, y);
+            col.h = qMax(col.h, float(other.h));
+            col.s = qMax(col.s, float(other.s));
+            col.v = qMax(col.v, float(other.v));
+        }
+    }
+    return true;
+}
+
+void BlockBase::remixSceneData() {
+    ++s_sceneMixStatistics.fullMixes;
+    int width = 1;
+    int height = 1;
+    for (const SceneContribution& contribution: m_sceneValues) {
+        width = qMax(width, contribution.scaled.width());
+        height = qMax(height, contribution.scaled.height());
+    }
+    if (m_sceneMix.width() != width || m_sceneMix.height() != height) {
+        m_sceneMix = HsvMatrix(width, height);
+        ++s_sceneMixStatistics.allocations;
+    } else {
+        MatrixKernels::fill(m_sceneMix.hue(), 0.0f, 3 * m_sceneMix.pixels());
+    }
+    for (const SceneContribution& contribution: m_sceneValues) {
+        mergeIntoSceneMix(contribution.scaled);
+    }
+}
+
 // ------------------------
 
 QObject* BlockBase::node(QString name) {
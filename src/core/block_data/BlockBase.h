@@ -71,7 +71,7 @@ public:
 	// interface methods (documentation is in interface):
     virtual QJsonObject getState() const override;
     virtual void setState(const QJsonObject& state) override;
-    virtual void getAdditionalState(QJsonObject& /*state*/) const override {}
+    virtual void getAdditionalState(QJsonObject& /*state*/) const override { m_hasNoAdditionalState = true; }
     virtual void setAdditionalState(const QJsonObject& /*state*/) override {}
     virtual QJsonArray getConnections() override;
     virtual NodeBase* getNodeById(int id) override;
@@ -84,7 +84,11 @@ public:
     virtual void setNodeMergeModes(const QJsonObject& state) override;
     virtual bool renderIfNotVisible() const override { return false; }
     virtual void registerAttribute(SmartAttribute* attr) override;
+    virtual void markGuiAttributeDirty(SmartAttribute* attr) override;
+    virtual int flushGuiUpdates() override;
     virtual void setGuiItemCode(QString code) override;
+    virtual bool stateIsDirty() const override;
+    virtual void markStateSaved() override { m_stateIsDirty = false; }
 
     // convenience methods:
 	/**
@@ -126,6 +130,7 @@ signals:
     void guiIsHiddenChanged();
 
 public slots:
+    virtual void markStateDirty() override { m_stateIsDirty = true; }
     virtual QString getUid() const override { return m_uid; }
     virtual void setUid(QString id) override { m_uid = id; }
 	virtual QString getBlockName() const override;
@@ -168,8 +173,13 @@ public slots:
     virtual bool guiShouldBeHidden() const override { return m_guiShouldBeHidden; }
     virtual void setGuiParentItem(QQuickItem* parent) override;
     virtual void onGuiItemCreated() override {}
+    /**
+     * @brief onGuiItemVisibilityChanged queues the pending GUI notifications
+     * when the GUI item becomes visible again
+     */
+    void onGuiItemVisibilityChanged();
     virtual QString getGroup() const override { return m_group; }
-    virtual void setGroup(QString group) override { m_group = group; }
+    virtual void setGroup(QString group) override { m_group = group; markStateDirty(); }
 
     // ---------------------------- Scenes ----------------------------
 
@@ -177,7 +187,7 @@ public slots:
 
     virtual int getSceneGroup() const override { return m_sceneGroup; }
 
-    virtual void setSceneGroup(int value) override { m_sceneGroup = value; }
+    virtual void setSceneGroup(int value) override { m_sceneGroup = value; markStateDirty(); }
 
     virtual void addToBench(const SceneData& /*data*/) override {}
 
@@ -189,10 +199,29 @@ public slots:
 
     virtual void setSceneData(const void* origin, double factor, const HsvMatrix& data) override;
 
+    virtual void setSceneFade(const void* origin, double factor, const HsvMatrix& from, const HsvMatrix& to, double pos) override;
+
     virtual void removeSceneData(const void* origin) override;
 
     virtual void updateFromSceneData() {}
 
+    /**
+     * @brief The SceneMixStatistics struct counts the work done to mix the scene data of all blocks
+     */
+    struct SceneMixStatistics {
+        qint64 updates = 0;  //!< calls of setSceneData() and setSceneFade()
+        qint64 unchanged = 0;  //!< updates that didn't change a contribution
+        qint64 mergedMixes = 0;  //!< updates merged into the existing mix
+        qint64 fullMixes = 0;  //!< updates that required to mix all contributions again
+        qint64 allocations = 0;  //!< matrices allocated for contributions and mixes
+    };
+
+    /**
+     * @brief sceneMixStatistics returns the counters of all blocks since the last reset
+     * @return the counters, can be modified to reset them
+     */
+    static SceneMixStatistics& sceneMixStatistics() { return s_sceneMixStatistics; }
+
     // ------------------------
 
     QObject* node(QString name);
@@ -292,6 +321,54 @@ protected:
      */
     QVector<QPointer<SmartAttribute>> m_persistentAttributes;
 
+    // -------------- GUI Updates ------------------
+
+    /**
+     * @brief guiItemIsShown returns if the GUI item exists and is neither hidden nor culled
+     * @return true if GUI notifications are visible to the user
+     */
+    bool guiItemIsShown() const;
+
+    /**
+     * @brief discardGuiUpdates clears the dirty attributes without notifying the GUI
+     */
+    void discardGuiUpdates();
+
+    /**
+     * @brief m_dirtyGuiAttributes contains the attributes that changed since the GUI was notified
+     */
+    QVector<QPointer<SmartAttribute>> m_dirtyGuiAttributes;
+
+    /**
+     * @brief m_notifiedGuiAttributes are the attributes notified by flushGuiUpdates() (reused)
+     */
+    QVector<QPointer<SmartAttribute>> m_notifiedGuiAttributes;
+
+    /**
+     * @brief m_guiUpdateIsQueued is true if this block is queued in the GuiUpdateBatcher
+     */
+    bool m_guiUpdateIsQueued;
+
+    // -------------- Save State ------------------
+
+    /**
+     * @brief m_stateIsDirty true if the state changed since it was saved the last time
+     */
+    bool m_stateIsDirty;
+
+    /**
+     * @brief m_additionalStateIsTracked has to be set to true by blocks that call markStateDirty()
+     * whenever their additional state changes, otherwise the state of a block with additional
+     * state is serialized on every save
+     */
+    bool m_additionalStateIsTracked;
+
+    /**
+     * @brief m_hasNoAdditionalState is set by the default implementation of getAdditionalState(),
+     * i.e. if the state of this block consists only of attributes
+     */
+    mutable bool m_hasNoAdditionalState;
+
 
     // -------------- Scene Data ------------------
 
@@ -302,10 +379,70 @@ protected:
      */
     int m_sceneGroup;
 
-    QMap<const void*, SceneData> m_sceneValues;
+    /**
+     * @brief The SceneContribution struct caches the scene data of one origin
+     */
+    struct SceneContribution {
+        SceneContribution() = default;
+        /**
+         * @brief SceneContribution creates a contribution that references the values,
+         * only the matrix of the scaled values is allocated
+         * @param values the scene matrix
+         */
+        explicit SceneContribution(const HsvMatrix& values)
+            : values(values), fadeTarget(values), scaled(values.width(), values.height()) {}
+
+        double factor = 0.0;  //!< factor of the contribution
+        HsvMatrix values;  //!< the referenced (implicitly shared) scene matrix
+        HsvMatrix fadeTarget;  //!< matrix the values are faded to (only valid if fades is true)
+        double fadePos = 0.0;  //!< position in the fade to fadeTarget
+        bool fades = false;  //!< true if the contribution is a crossfade of two matrices
+        HsvMatrix scaled;  //!< the (faded) values multiplied with the factor
+    };
+
+    /**
+     * @brief setSceneContribution updates the cached contribution of an origin
+     * and the scene mix, only changed contributions are scaled again
+     * @param fadeTarget matrix to fade to or nullptr if the values are not faded
+     */
+    void setSceneContribution(const void* origin, double factor, const HsvMatrix& values,
+                              const HsvMatrix* fadeTarget, double fadePos);
+
+    /**
+     * @brief updateScaledContribution calculates the scaled matrix of a contribution
+     * @param contribution the contribution to update
+     */
+    void updateScaledContribution(SceneContribution& contribution);
+
+    /**
+     * @brief mergeIntoSceneMix sets each element of the mix to the maximum (HTP) of itself
+     * and a scaled contribution
+     * @param scaled scaled matrix of a contribution, smaller matrices are repeated
+     * @return false if the contribution is larger than the mix and it has to be mixed again
+     */
+    bool mergeIntoSceneMix(const HsvMatrix& scaled);
+
+    /**
+     * @brief remixSceneData calculates the scene mix from the cached scaled contributions
+     */
+    void remixSceneData();
+
+    /**
+     * @brief getSceneMix returns the HTP result of all scene contributions
+     * @param x x position
+     * @param y y position
+     * @return the maximum of each component of the scaled contributions
+     */
+    HSV getSceneMix(int x, int y) const { return m_sceneMix.at(x, y); }
+
+    QMap<const void*, SceneContribution> m_sceneValues;
+
+    HsvMatrix m_sceneMix;  //!< HTP result of all scaled contributions in m_sceneValues
 
     const void* m_lastChangedSceneOrigin;
 
+    static SceneMixStatistics s_sceneMixStatistics;  //!< counters of all blocks
+
     // -------------- Attributes ------------------
 
     /**
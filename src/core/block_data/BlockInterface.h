@@ -234,12 +234,45 @@ public:
      */
     virtual void registerAttribute(SmartAttribute* attr) = 0;
 
+    /**
+     * @brief markGuiAttributeDirty is called by an attribute of this block when its value changed,
+     * the GUI is notified at the end of the frame if the GUI item is visible
+     * @param attr the changed attribute
+     */
+    virtual void markGuiAttributeDirty(SmartAttribute* attr) = 0;
+
+    /**
+     * @brief flushGuiUpdates notifies the GUI about all attributes changed since the last call,
+     * called by the GuiUpdateBatcher
+     * @return number of emitted notifications
+     */
+    virtual int flushGuiUpdates() = 0;
+
     /**
      * @brief setGuiItemCode replaces the GUI item with one generated from the provided QML code
      * @param code QML code
      */
     virtual void setGuiItemCode(QString code) = 0;
 
+    // ------------------------- Save State -------------------------
+
+    /**
+     * @brief markStateDirty marks the last saved state of this block as outdated,
+     * called when an attribute or a connection changed
+     */
+    virtual void markStateDirty() = 0;
+
+    /**
+     * @brief stateIsDirty returns if the state must be serialized again when the project is saved
+     * @return true if getState() could return something else than at the last save
+     */
+    virtual bool stateIsDirty() const = 0;
+
+    /**
+     * @brief markStateSaved is called by the ProjectManager after it serialized the state
+     */
+    virtual void markStateSaved() = 0;
+
 signals:
     /**
      * @brief positionChanged is triggered when the position of the block in the UI changes and
@@ -466,6 +499,17 @@ public slots:
 
     virtual void setSceneData(const void* origin, double factor, const HsvMatrix& data) = 0;
 
+    /**
+     * @brief setSceneFade sets the contribution of an origin to the crossfade of two scene matrices,
+     * the matrices are referenced (implicitly shared) and not copied
+     * @param origin the object that sends the data (i.e. a cue list)
+     * @param factor master factor of the contribution
+     * @param from matrix at the beginning of the fade
+     * @param to matrix at the end of the fade
+     * @param pos position in the fade [0...1]
+     */
+    virtual void setSceneFade(const void* origin, double factor, const HsvMatrix& from, const HsvMatrix& to, double pos) = 0;
+
     virtual void removeSceneData(const void* origin) = 0;
 
 };
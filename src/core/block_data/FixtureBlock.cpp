@@ -3,11 +3,19 @@
 #include "core/MainController.h"
 #include "core/Nodes.h"
 
+#include <QElapsedTimer>
+
+
+bool FixtureBlock::s_chainDistributionEnabled = true;
+
 FixtureBlock::FixtureBlock(MainController *controller, QString uid, int footprint)
     : InOutBlock(controller, uid)
     , m_footprint(footprint)
     , m_address(this, "address", 1, 1, 8193 - m_footprint)
     , m_gamma(this, "gamma", 1.0, 0.1, 10.0)
+    , m_patch(-1)
+    , m_outputEnabled(true)
+    , m_canBeChainMember(true)
 {
     m_isSceneBlock = true;
 
@@ -15,40 +23,42 @@ FixtureBlock::FixtureBlock(MainController *controller, QString uid, int footprin
     connectSlots(m_inputNode, m_outputNode);
 
     connect(&m_address, SIGNAL(valueChanged()), this, SLOT(notifyAboutAddress()));
+    connect(&m_address, SIGNAL(valueChanged()), this, SLOT(updatePatch()));
+    connect(&m_gamma, SIGNAL(valueChanged()), this, SLOT(updatePatch()));
+}
+
+FixtureBlock::~FixtureBlock() {
+    if (m_patch >= 0) m_controller->output()->removePatch(m_patch);
 }
 
 void FixtureBlock::forwardDataToOutput() {
-    // pass through data to output node:
-    if (m_outputNode->isConnected()) {
-        const ColorMatrix& input = m_inputNode->constData();
-        auto rgb = RgbDataModifier(m_outputNode);
-        if (input.width() < rgb.width + 1 || input.height() < rgb.height) {
-            qWarning() << "FixtureBlock forward: data too small";
-            return;
-        }
-        for (int x = 0; x < rgb.width; ++x) {
-            for (int y = 0; y < rgb.height; ++y) {
-                auto color = input.getRgbAt(x + 1, y);
-                rgb.set(x, y, color.r, color.g, color.b);
-            }
-        }
-    }
+    forwardData(m_inputNode, m_outputNode);
 }
 
 void FixtureBlock::forwardData(NodeBase* inputNode, NodeBase* outputNode) {
+    if (!outputNode->isConnected()) return;
+
+    const int link = findLink(inputNode);
+    NodeBase* source = link >= 0 ? m_chainLinks[link].source.data() : nullptr;
+    if (link >= 0 && isChainOutput(outputNode)) {
+        // the following fixtures read their pixel from the chain head,
+        // only the head has to notify them:
+        if (!source) distributeChain(link);
+        return;
+    }
+
     // pass through data to output node:
-    if (outputNode->isConnected()) {
-        const ColorMatrix& input = inputNode->constData();
-        auto rgb = RgbDataModifier(outputNode);
-        if (input.width() < rgb.width + 1 || input.height() < rgb.height) {
-            qWarning() << "FixtureBlock forward: data too small";
-            return;
-        }
-        for (int x = 0; x < rgb.width; ++x) {
-            for (int y = 0; y < rgb.height; ++y) {
-                auto color = input.getRgbAt(x + 1, y);
-                rgb.set(x, y, color.r, color.g, color.b);
-            }
+    const ColorMatrix& input = source ? source->constData() : inputNode->constData();
+    const int offset = source ? m_chainLinks[link].index + 1 : 1;
+    auto rgb = RgbDataModifier(outputNode);
+    if (input.width() < rgb.width + offset || input.height() < rgb.height) {
+        qWarning() << "FixtureBlock forward: data too small";
+        return;
+    }
+    for (int x = 0; x < rgb.width; ++x) {
+        for (int y = 0; y < rgb.height; ++y) {
+            auto color = input.getRgbAt(x + offset, y);
+            rgb.set(x, y, color.r, color.g, color.b);
         }
     }
 }
@@ -67,11 +77,264 @@ void FixtureBlock::onConnectionChanged(NodeBase* inputNode, NodeBase* outputNode
 }
 
 void FixtureBlock::connectSlots(NodeBase* inputNode, NodeBase* outputNode) {
-    connect(inputNode, &NodeBase::connectionChanged, [inputNode, outputNode](){FixtureBlock::onConnectionChanged(inputNode, outputNode);} );
-    connect(outputNode, &NodeBase::connectionChanged, [inputNode, outputNode](){FixtureBlock::onConnectionChanged(inputNode, outputNode);} );
-    connect(outputNode, &NodeBase::requestedSizeChanged, [inputNode, outputNode](){FixtureBlock::onConnectionChanged(inputNode, outputNode);} );
+    const int link = m_chainLinks.size();
+    m_chainLinks.append(ChainLink{inputNode, outputNode, nullptr, 0, QVector<ChainMember>()});
+
+    connect(inputNode, &NodeBase::connectionChanged, this, [this, link](){ onChainConnectionChanged(link); });
+    connect(outputNode, &NodeBase::connectionChanged, this, [this, link](){ onChainConnectionChanged(link); });
+    connect(outputNode, &NodeBase::requestedSizeChanged, this, [this, inputNode, outputNode](){ onConnectionChanged(inputNode, outputNode); });
 }
 
 void FixtureBlock::notifyAboutAddress() {
     m_controller->output()->setNextAddressToUse(m_address + m_footprint);
 }
+
+void FixtureBlock::updatePatch() {
+    if (m_patch < 0) return;
+    m_controller->output()->updatePatch(m_patch, m_address, m_footprint, m_gamma);
+}
+
+void FixtureBlock::setOutputEnabled(bool value) {
+    m_outputEnabled = value;
+    if (!value && m_patch >= 0) {
+        m_controller->output()->removePatch(m_patch);
+        m_patch = -1;
+    }
+}
+
+void FixtureBlock::setChannelValue(int channel, double value) {
+    if (!m_outputEnabled) return;
+    if (m_patch < 0) {
+        // the patch is created when the first value is set,
+        // so that fixtures that don't output anything don't occupy their slots:
+        m_patch = m_controller->output()->addPatch(m_address, m_footprint, m_gamma);
+    }
+    m_controller->output()->setPatchValue(m_patch, channel, value);
+}
+
+RGB FixtureBlock::getInputRgb(NodeBase* inputNode) const {
+    const int link = findLink(inputNode);
+    const NodeBase* source = link >= 0 ? m_chainLinks[link].source.data() : nullptr;
+    if (!source) {
+        return inputNode->constData().getRgbAt(0, 0);
+    }
+    // chain member -> read the own pixel from the input of the chain head:
+    const int index = m_chainLinks[link].index;
+    const ColorMatrix& data = source->constData();
+    if (index >= data.width()) return RGB(0, 0, 0);
+    return data.getRgbAt(index, 0);
+}
+
+int FixtureBlock::findLink(const NodeBase* node) const {
+    for (int i = 0; i < m_chainLinks.size(); ++i) {
+        if (m_chainLinks[i].inputNode == node || m_chainLinks[i].outputNode == node) return i;
+    }
+    return -1;
+}
+
+FixtureBlock* FixtureBlock::getLinkOwner(NodeBase* node, int& link) {
+    if (!node) return nullptr;
+    FixtureBlock* fixture = qobject_cast<FixtureBlock*>(node->getBlock());
+    if (!fixture) return nullptr;
+    link = fixture->findLink(node);
+    return link >= 0 ? fixture : nullptr;
+}
+
+bool FixtureBlock::isChainOutput(NodeBase* outputNode) {
+    if (!s_chainDistributionEnabled || !outputNode->isConnected()) return false;
+    for (NodeBase* node: outputNode->getConnectedNodes()) {
+        int link;
+        FixtureBlock* fixture = getLinkOwner(node, link);
+        if (!fixture || !fixture->m_canBeChainMember) return false;
+        if (fixture->m_chainLinks[link].inputNode != node) return false;
+        // if the input merges data of other nodes, it can't be read from the chain head:
+        if (node->getConnectedNodes().size() != 1) return false;
+    }
+    return true;
+}
+
+void FixtureBlock::onChainConnectionChanged(int link) {
+    ChainLink& own = m_chainLinks[link];
+
+    // find the head of the chain by walking upstream:
+    FixtureBlock* head = this;
+    int headLink = link;
+    if (m_canBeChainMember) {
+        // the length is limited in case there is a cycle while connections are changed:
+        for (int i = 0; i < 10000; ++i) {
+            NodeBase* input = head->m_chainLinks[headLink].inputNode;
+            if (input->getConnectedNodes().size() != 1) break;
+            NodeBase* upstream = input->getConnectedNodes().first();
+            int upstreamLink;
+            FixtureBlock* upstreamFixture = getLinkOwner(upstream, upstreamLink);
+            if (!upstreamFixture || upstreamFixture->m_chainLinks[upstreamLink].outputNode != upstream) break;
+            if (!isChainOutput(upstream)) break;
+            head = upstreamFixture;
+            headLink = upstreamLink;
+        }
+    }
+    head->resolveChains(headLink);
+
+    onConnectionChanged(own.inputNode, own.outputNode);
+    if (own.source) {
+        // this is a member, let the head update the whole chain:
+        head->forwardData(head->m_chainLinks[headLink].inputNode, head->m_chainLinks[headLink].outputNode);
+    }
+}
+
+void FixtureBlock::resolveChains(int link) {
+    // the heads of chains that follow an output that is not a chain output:
+    QVector<ChainMember> heads {{this, link}};
+    for (int h = 0; h < heads.size(); ++h) {
+        if (!heads[h].block) continue;
+        ChainLink& head = heads[h].block->m_chainLinks[heads[h].link];
+        head.source = nullptr;
+        head.index = 0;
+        head.members.clear();
+
+        // breadth-first search through the following fixtures,
+        // inputs of chain members have only one connection, so there are no duplicates:
+        ChainMember current {heads[h].block, heads[h].link};
+        for (int m = -1; m < head.members.size(); ++m) {
+            if (m >= 0) current = head.members[m];
+            if (!current.block) continue;
+            const ChainLink& currentLink = current.block->m_chainLinks[current.link];
+            const bool chained = isChainOutput(currentLink.outputNode);
+            for (NodeBase* node: currentLink.outputNode->getConnectedNodes()) {
+                int nextLink;
+                FixtureBlock* next = getLinkOwner(node, nextLink);
+                if (!next || next->m_chainLinks[nextLink].inputNode != node) continue;
+                if (!chained) {
+                    heads.append({next, nextLink});
+                    continue;
+                }
+                ChainLink& member = next->m_chainLinks[nextLink];
+                member.source = head.inputNode;
+                member.index = currentLink.source ? currentLink.index + 1 : 1;
+                member.members.clear();
+                head.members.append({next, nextLink});
+            }
+        }
+    }
+}
+
+void FixtureBlock::distributeChain(int link) {
+    const ChainLink& head = m_chainLinks[link];
+    for (const ChainMember& member: head.members) {
+        if (!member.block) continue;
+        const ChainLink& memberLink = member.block->m_chainLinks[member.link];
+        // the member may belong to another chain since the connections changed:
+        if (memberLink.source != head.inputNode) continue;
+        // all fixtures calculate their output values from the input and the scene data:
+        member.block->updateFromSceneData();
+        if (!isChainOutput(memberLink.outputNode)) {
+            // the end of the chain is connected to something else -> copy the remaining data:
+            member.block->forwardData(memberLink.inputNode, memberLink.outputNode);
+        }
+    }
+}
+
+QVector<FixtureBlock*> FixtureBlock::createBenchmarkFixtures(MainController* controller, QString type,
+                                                             int count, QString uidPrefix) {
+    // fixtures reserve an address in their constructor, restore the counter afterwards:
+    const int nextAddress = controller->output()->peekUnusedAddress();
+    QVector<FixtureBlock*> fixtures;
+    for (int i = 0; i < count; ++i) {
+        // generated uids collide when hundreds of blocks are created within a second:
+        BlockInterface* block = controller->blockManager()->createBlockInstance(type, uidPrefix + QString::number(i));
+        FixtureBlock* fixture = qobject_cast<FixtureBlock*>(block);
+        if (!fixture) {
+            if (block) controller->blockManager()->deleteBlock(block, /*forced*/ true, /*noRestore*/ true, /*immediate*/ true);
+            break;
+        }
+        fixture->setOutputEnabled(false);
+        fixtures.append(fixture);
+    }
+    controller->output()->setNextAddressToUse(nextAddress);
+    return fixtures;
+}
+
+QVariantMap FixtureBlock::benchmarkChain(MainController* controller) {
+    const int frames = 50;
+    BlockManager* blockManager = controller->blockManager();
+    GraphEvaluator* graph = controller->graphEvaluator();
+    const bool wasEnabled = s_chainDistributionEnabled;
+    QVariantMap result;
+#ifdef QT_NO_DEBUG
+    // ColorMatrix::copyCount() is always 0 in release builds:
+    const bool copiesAreCounted = false;
+#else
+    const bool copiesAreCounted = true;
+#endif
+
+    for (int length: {10, 100, 500}) {
+        // create the chain without GUI items, fed by the output of a slider:
+        BlockInterface* sourceBlock = blockManager->createBlockInstance("Slider", "benchmarkChainSource");
+        if (!sourceBlock) break;
+        NodeBase* sourceOutput = nullptr;
+        for (NodeBase* node: sourceBlock->getNodes()) {
+            if (node->isOutput()) sourceOutput = node;
+        }
+        const QVector<FixtureBlock*> fixtures = createBenchmarkFixtures(controller, "RGB Light", length, "benchmarkChainFixture");
+        if (!sourceOutput || fixtures.size() != length) {
+            qWarning() << "Fixture chain benchmark: blocks could not be created.";
+            blockManager->deleteBlock(sourceBlock, /*forced*/ true, /*noRestore*/ true, /*immediate*/ true);
+            for (FixtureBlock* fixture: fixtures) {
+                blockManager->deleteBlock(fixture, /*forced*/ true, /*noRestore*/ true, /*immediate*/ true);
+            }
+            break;
+        }
+        sourceOutput->connectTo(fixtures.first()->m_inputNode);
+        for (int i = 1; i < length; ++i) {
+            fixtures[i - 1]->m_outputNode->connectTo(fixtures[i]->m_inputNode);
+        }
+
+        for (bool chained: {false, true}) {
+            s_chainDistributionEnabled = chained;
+            fixtures.first()->resolveChains(0);
+            if (graph->isBatched()) graph->evaluate();
+            const quint64 copiesBefore = ColorMatrix::copyCount();
+
+            QElapsedTimer timer;
+            timer.start();
+            for (int frame = 0; frame < frames; ++frame) {
+                {
+                    // a gradient with one pixel per fixture:
+                    auto rgb = RgbDataModifier(sourceOutput);
+                    for (int x = 0; x < rgb.width; ++x) {
+                        for (int y = 0; y < rgb.height; ++y) {
+                            rgb.set(x, y, double(x) / length, double(frame) / frames, 1.0);
+                        }
+                    }
+                }
+                if (graph->isBatched()) graph->evaluate();
+            }
+            const double msPerFrame = double(timer.nsecsElapsed()) / 1e6 / frames;
+            const double copiesPerFrame = double(ColorMatrix::copyCount() - copiesBefore) / frames;
+
+            // the last fixture must see the last pixel of the pattern in both modes:
+            FixtureBlock* last = fixtures.last();
+            const bool correct = qAbs(last->getInputRgb(last->m_inputNode).r - double(length - 1) / length) < 0.0001;
+
+            const QString mode = chained ? "chainView" : "forwardCopy";
+            result[QString("%1_%2Ms").arg(mode).arg(length)] = msPerFrame;
+            if (copiesAreCounted) {
+                qInfo() << "Fixture chain with" << length << "fixtures," << mode << ":" << msPerFrame << "ms and"
+                        << copiesPerFrame << "matrix copies per frame" << (correct ? "" : "(wrong result!)");
+                result[QString("%1_%2Copies").arg(mode).arg(length)] = copiesPerFrame;
+            } else {
+                qInfo() << "Fixture chain with" << length << "fixtures," << mode << ":" << msPerFrame
+                        << "ms per frame (matrix copies are only counted in debug builds)"
+                        << (correct ? "" : "(wrong result!)");
+            }
+        }
+
+        for (FixtureBlock* fixture: fixtures) {
+            blockManager->deleteBlock(fixture, /*forced*/ true, /*noRestore*/ true, /*immediate*/ true);
+        }
+        blockManager->deleteBlock(sourceBlock, /*forced*/ true, /*noRestore*/ true, /*immediate*/ true);
+    }
+
+    s_chainDistributionEnabled = wasEnabled;
+    return result;
+}
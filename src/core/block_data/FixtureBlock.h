@@ -3,30 +3,181 @@
 
 #include "core/block_data/InOutBlock.h"
 
+#include <QVariantMap>
 
+
+/**
+ * @brief The FixtureBlock class is the base class of all fixtures that can be daisy-chained.
+ *
+ * Each pair of input and output nodes forms a link in a chain: the input requests one pixel more
+ * than the output and the fixture uses the first pixel itself.
+ * If the output is only connected to other fixtures, the data is not copied from node to node.
+ * Instead the first fixture of the chain (the head) notifies all following fixtures and each
+ * of them reads its own pixel from the input of the head by its index in the chain.
+ */
 class FixtureBlock : public InOutBlock
 {
     Q_OBJECT
 
 public:
     explicit FixtureBlock(MainController* controller, QString uid, int footprint);
+    ~FixtureBlock() override;
+
+    /**
+     * @brief setChainDistributionEnabled enables or disables the chain view for all fixtures,
+     * if disabled the data is copied from fixture to fixture (default: enabled)
+     * @param value true to enable it
+     */
+    static void setChainDistributionEnabled(bool value) { s_chainDistributionEnabled = value; }
+
+    /**
+     * @brief chainDistributionIsEnabled returns if the chain view is used
+     * @return true if it is used
+     */
+    static bool chainDistributionIsEnabled() { return s_chainDistributionEnabled; }
+
+    /**
+     * @brief benchmarkChain measures the time to distribute a pattern to chains
+     * of 10, 100 and 500 RGB Lights with and without the chain view
+     * @param controller pointer to the MainController
+     * @return durations per frame for each chain length and mode, and the matrix copies
+     * per frame (only in debug builds, where they are counted)
+     */
+    static QVariantMap benchmarkChain(MainController* controller);
+
+    /**
+     * @brief createBenchmarkFixtures creates fixtures with unique uids for benchmarks,
+     * without reserving DMX addresses and with their DMX output disabled
+     * @param controller pointer to the MainController
+     * @param type type name of the fixture block (e.g. "RGB Light")
+     * @param count number of fixtures to create
+     * @param uidPrefix prefix of the uids, followed by the index of the fixture
+     * @return the created fixtures, fewer than count if a block could not be created
+     */
+    static QVector<FixtureBlock*> createBenchmarkFixtures(MainController* controller, QString type,
+                                                          int count, QString uidPrefix);
+
+    /**
+     * @brief setOutputEnabled enables or disables the DMX output of this fixture (default: enabled),
+     * its patch is removed when it is disabled
+     * @param value false to not occupy and change DMX channels
+     */
+    void setOutputEnabled(bool value);
 
 public slots:
 
     void forwardDataToOutput();
 
-    static void forwardData(NodeBase* inputNode, NodeBase* outputNode);
+    void forwardData(NodeBase* inputNode, NodeBase* outputNode);
 
-    static void onConnectionChanged(NodeBase* inputNode, NodeBase* outputNode);
+    void onConnectionChanged(NodeBase* inputNode, NodeBase* outputNode);
 
     void connectSlots(NodeBase* inputNode, NodeBase* outputNode);
 
     void notifyAboutAddress();
 
+    /**
+     * @brief updatePatch passes the address and gamma to the patch of this fixture
+     */
+    void updatePatch();
+
+protected:
+    /**
+     * @brief setChannelValue sets the value of a DMX channel of this fixture,
+     * the gamma curve is applied by the OutputManager
+     * @param channel index of the channel beginning with 0
+     * @param value [0...1]
+     */
+    void setChannelValue(int channel, double value);
+
+    /**
+     * @brief The ChainMember struct references a link of a fixture that is part of a chain
+     */
+    struct ChainMember {
+        QPointer<FixtureBlock> block;  //!< the fixture
+        int link;  //!< index of the link in the fixture
+    };
+
+    /**
+     * @brief The ChainLink struct contains the state of a pair of input and output nodes
+     */
+    struct ChainLink {
+        NodeBase* inputNode;  //!< input node of the pair
+        NodeBase* outputNode;  //!< output node of the pair
+        QPointer<NodeBase> source;  //!< input node of the chain head or nullptr if this is a head
+        int index;  //!< position in the chain, the x position of the own pixel in the source
+        QVector<ChainMember> members;  //!< all following fixtures, only valid for a head
+    };
+
+    /**
+     * @brief getInputRgb returns the color of the own pixel of an input node
+     * (read from the chain head if this fixture is a chain member)
+     * @param inputNode an input node passed to connectSlots()
+     * @return RGB values
+     */
+    RGB getInputRgb(NodeBase* inputNode) const;
+
+    /**
+     * @brief getInputValue returns the value of the own pixel of an input node
+     * @param inputNode an input node passed to connectSlots()
+     * @return value between 0 and 1
+     */
+    double getInputValue(NodeBase* inputNode) const { return getInputRgb(inputNode).max(); }
+
+    /**
+     * @brief findLink returns the index of the link that contains a node
+     * @param node an input or output node of this block
+     * @return index in m_chainLinks or -1 if it is not part of a link
+     */
+    int findLink(const NodeBase* node) const;
+
+    /**
+     * @brief getLinkOwner returns the fixture and link of a node
+     * @param node any node
+     * @param link is set to the index of the link
+     * @return the fixture or nullptr if the node is not part of a fixture link
+     */
+    static FixtureBlock* getLinkOwner(NodeBase* node, int& link);
+
+    /**
+     * @brief isChainOutput checks if all nodes connected to an output are fixture inputs
+     * that are only connected to this output, so that they can read the data through the chain view
+     * @param outputNode output node of a link
+     * @return true if the connected fixtures are chain members
+     */
+    static bool isChainOutput(NodeBase* outputNode);
+
+    /**
+     * @brief onChainConnectionChanged finds the head of the chain containing a link
+     * and updates the chain
+     * @param link index of the link
+     */
+    void onChainConnectionChanged(int link);
+
+    /**
+     * @brief resolveChains updates the members of the chain starting with a head link
+     * and of all chains that follow it
+     * @param link index of the head link
+     */
+    void resolveChains(int link);
+
+    /**
+     * @brief distributeChain notifies all members of a chain about new data
+     * @param link index of the head link
+     */
+    void distributeChain(int link);
+
 protected:
     int m_footprint;
     IntegerAttribute m_address;
     DoubleAttribute m_gamma;
+    int m_patch;  //!< id of the DMX patch of this fixture in the OutputManager
+    bool m_outputEnabled;  //!< false if no patch is created and no DMX values are set
+
+    QVector<ChainLink> m_chainLinks;  //!< node pairs passed to connectSlots()
+    bool m_canBeChainMember;  //!< false if the fixture needs the complete input matrix
+
+    static bool s_chainDistributionEnabled;  //!< true if the chain view is used
 };
 
 #endif // FIXTUREBLOCK_H
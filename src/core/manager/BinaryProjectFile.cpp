@@ -0,0 +1,399 @@
+#include "BinaryProjectFile.h"
+
+#include "core/Matrix.h"
+#include "utils.h"
+
+#include <QDebug>
+#include <QJsonDocument>
+#include <QMap>
+#include <QVector>
+#include <cmath>
+
+
+namespace {
+
+const char FILE_MAGIC[4] = {'L', 'P', 'R', 'B'};
+const quint16 FILE_VERSION = 1;
+
+const int HEADER_SIZE = 16;
+const int SECTION_ENTRY_SIZE = 24;
+
+// an upper bound to reject corrupted section tables early:
+const quint32 MAX_SECTION_COUNT = 256;
+
+// sections and payloads in the blob section are aligned to this:
+const int ALIGNMENT = 8;
+
+constexpr quint32 sectionTag(char a, char b, char c, char d) {
+    return quint32(quint8(a)) | (quint32(quint8(b)) << 8) | (quint32(quint8(c)) << 16) | (quint32(quint8(d)) << 24);
+}
+
+const quint32 PROJECT_SECTION = sectionTag('P', 'R', 'O', 'J');
+const quint32 BLOCKS_SECTION = sectionTag('B', 'L', 'K', 'S');
+const quint32 CONNECTIONS_SECTION = sectionTag('C', 'O', 'N', 'N');
+const quint32 BLOB_SECTION = sectionTag('B', 'L', 'O', 'B');
+
+// keys of a blob reference in a block state:
+const QString BLOB_OFFSET_KEY = "blob";
+const QString BLOB_SIZE_KEY = "size";
+
+inline int aligned(int offset) {
+    return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+template<typename T>
+void appendLittleEndian(QByteArray& out, T value) {
+    uchar bytes[sizeof(T)];
+    qToLittleEndian<T>(value, bytes);
+    out.append(reinterpret_cast<const char*>(bytes), int(sizeof(T)));
+}
+
+template<typename T>
+T readLittleEndian(const char* data) {
+    return qFromLittleEndian<T>(reinterpret_cast<const uchar*>(data));
+}
+
+}  // namespace
+
+
+// ------------------------------- ProjectBlobStore ----------------------------
+
+void ProjectBlobStore::beginWriting() {
+    m_writeBuffer.clear();
+    m_segment.clear();
+    m_writing = true;
+}
+
+QByteArray ProjectBlobStore::endWriting() {
+    if (!m_segment.isEmpty()) {
+        appendSegment(takeSegment());
+    }
+    m_writing = false;
+    QByteArray section;
+    section.swap(m_writeBuffer);
+    return section;
+}
+
+QByteArray ProjectBlobStore::takeSegment() {
+    QByteArray segment;
+    segment.swap(m_segment);
+    return segment;
+}
+
+int ProjectBlobStore::appendSegment(const QByteArray& segment) {
+    const int offset = aligned(m_writeBuffer.size());
+    m_writeBuffer.append(QByteArray(offset - m_writeBuffer.size(), '\0'));
+    m_writeBuffer.append(segment);
+    return offset;
+}
+
+QJsonValue ProjectBlobStore::write(const char* data, int size) {
+    if (!m_writing) return QJsonValue(QJsonValue::Undefined);
+    const int offset = aligned(m_segment.size());
+    m_segment.append(QByteArray(offset - m_segment.size(), '\0'));
+    m_segment.append(data, size);
+    QJsonObject reference;
+    reference[BLOB_OFFSET_KEY] = offset;
+    reference[BLOB_SIZE_KEY] = size;
+    return reference;
+}
+
+bool ProjectBlobStore::isReference(const QJsonValue& value) {
+    if (!value.isObject()) return false;
+    const QJsonObject reference = value.toObject();
+    return reference[BLOB_OFFSET_KEY].isDouble() && reference[BLOB_SIZE_KEY].isDouble();
+}
+
+ProjectBlob ProjectBlobStore::read(const QJsonValue& reference) const {
+    if (!m_readBuffer || !isReference(reference)) return ProjectBlob();
+    const QJsonObject object = reference.toObject();
+    const qint64 offset = m_segmentOffset + qint64(object[BLOB_OFFSET_KEY].toDouble());
+    const qint64 size = qint64(object[BLOB_SIZE_KEY].toDouble());
+    if (offset < 0 || size < 0 || offset + size > m_readBuffer->size()) {
+        qWarning() << "Project file: blob out of bounds.";
+        return ProjectBlob();
+    }
+    return ProjectBlob(m_readBuffer, int(offset), int(size));
+}
+
+
+// ------------------------------- BinaryProjectFile ----------------------------
+
+bool BinaryProjectFile::isBinary(const char* content, qint64 size) {
+    return size >= 4 && std::memcmp(content, FILE_MAGIC, 4) == 0;
+}
+
+QByteArray BinaryProjectFile::write(QJsonObject projectState, const QByteArray& blobSection) {
+    const QByteArray blocks = QJsonDocument(projectState["blocks"].toArray()).toJson(QJsonDocument::Compact);
+    const QByteArray connections = QJsonDocument(projectState["connections"].toArray()).toJson(QJsonDocument::Compact);
+    projectState.remove("blocks");
+    projectState.remove("connections");
+    const QByteArray settings = QJsonDocument(projectState).toJson(QJsonDocument::Compact);
+
+    const QVector<QPair<quint32, const QByteArray*>> sections = {
+        {PROJECT_SECTION, &settings},
+        {BLOCKS_SECTION, &blocks},
+        {CONNECTIONS_SECTION, &connections},
+        {BLOB_SECTION, &blobSection}};
+
+    QByteArray content;
+    content.reserve(HEADER_SIZE + sections.size() * SECTION_ENTRY_SIZE + settings.size() + blocks.size()
+                    + connections.size() + blobSection.size() + sections.size() * ALIGNMENT);
+
+    // header:
+    content.append(FILE_MAGIC, 4);
+    appendLittleEndian<quint16>(content, FILE_VERSION);
+    appendLittleEndian<quint16>(content, HEADER_SIZE);
+    appendLittleEndian<quint32>(content, quint32(sections.size()));
+    appendLittleEndian<quint32>(content, 0);
+
+    // section table:
+    int offset = aligned(HEADER_SIZE + sections.size() * SECTION_ENTRY_SIZE);
+    for (const auto& section: sections) {
+        appendLittleEndian<quint32>(content, section.first);
+        appendLittleEndian<quint32>(content, 0);
+        appendLittleEndian<quint64>(content, quint64(offset));
+        appendLittleEndian<quint64>(content, quint64(section.second->size()));
+        offset = aligned(offset + section.second->size());
+    }
+
+    // sections:
+    for (const auto& section: sections) {
+        content.append(QByteArray(aligned(content.size()) - content.size(), '\0'));
+        content.append(*section.second);
+    }
+    return content;
+}
+
+bool BinaryProjectFile::read(const char* content, qint64 size, QJsonObject& projectState, QJsonArray& blocks,
+                             QJsonArray& connections, QByteArray& blobSection) {
+    if (!isBinary(content, size) || size < HEADER_SIZE) return false;
+    const quint16 version = readLittleEndian<quint16>(content + 4);
+    const quint16 headerSize = readLittleEndian<quint16>(content + 6);
+    const quint32 sectionCount = readLittleEndian<quint32>(content + 8);
+    if (version > FILE_VERSION) {
+        qWarning() << "Project file was created by a newer version of Luminosus.";
+        return false;
+    }
+    if (headerSize < HEADER_SIZE || sectionCount > MAX_SECTION_COUNT
+            || headerSize + qint64(sectionCount) * SECTION_ENTRY_SIZE > size) {
+        qWarning() << "Project file: invalid header.";
+        return false;
+    }
+
+    bool hasProjectSection = false;
+    for (quint32 i = 0; i < sectionCount; ++i) {
+        const char* entry = content + headerSize + i * SECTION_ENTRY_SIZE;
+        const quint32 tag = readLittleEndian<quint32>(entry);
+        const quint64 offset = readLittleEndian<quint64>(entry + 8);
+        const quint64 sectionSize = readLittleEndian<quint64>(entry + 16);
+        if (offset > quint64(size) || sectionSize > quint64(size) - offset) {
+            qWarning() << "Project file: section out of bounds.";
+            return false;
+        }
+        const char* data = content + offset;
+
+        if (tag == BLOB_SECTION) {
+            blobSection = QByteArray(data, int(sectionSize));
+            continue;
+        }
+        if (tag != PROJECT_SECTION && tag != BLOCKS_SECTION && tag != CONNECTIONS_SECTION) {
+            // unknown section of a later version
+            continue;
+        }
+        QJsonParseError error;
+        const QJsonDocument document = QJsonDocument::fromJson(QByteArray::fromRawData(data, int(sectionSize)), &error);
+        if (error.error != QJsonParseError::NoError) {
+            qWarning() << "Project file section could not be parsed:" << error.errorString() << "at" << error.offset;
+            return false;
+        }
+        if (tag == PROJECT_SECTION) {
+            projectState = document.object();
+            hasProjectSection = true;
+        } else if (tag == BLOCKS_SECTION) {
+            blocks = document.array();
+        } else {
+            connections = document.array();
+        }
+    }
+    return hasProjectSection;
+}
+
+
+// ------------------------------- Benchmark ----------------------------
+
+namespace {
+
+// size of the synthetic sample project:
+const int BENCHMARK_BLOCK_COUNT = 800;
+const int BENCHMARK_RECORDER_COUNT = 20;
+const int BENCHMARK_RECORDING_LENGTH = 30000;  // 10 min at 50 FPS
+const int BENCHMARK_PRESET_COUNT = 50;
+const int BENCHMARK_FIXTURES_PER_PRESET = 10;
+const int BENCHMARK_MATRIX_SIZE = 32;
+
+/**
+ * @brief benchmarkProjectState creates the state of a large sample project
+ * @param blobs store to write the payloads to, uses the JSON representation if it is not writing
+ * @return project state
+ */
+QJsonObject benchmarkProjectState(ProjectBlobStore& blobs) {
+    QVector<double> recording(BENCHMARK_RECORDING_LENGTH);
+    for (int i = 0; i < recording.size(); ++i) {
+        recording[i] = 0.5 + 0.5 * std::sin(i * 0.01);
+    }
+    HsvMatrix matrix(BENCHMARK_MATRIX_SIZE, BENCHMARK_MATRIX_SIZE);
+    for (int i = 0; i < matrix.pixels() * 3; ++i) {
+        matrix.hue()[i] = float(i % 100) / 100.0f;
+    }
+
+    QJsonArray blocks;
+    QJsonArray connections;
+    for (int i = 0; i < BENCHMARK_BLOCK_COUNT; ++i) {
+        const QString uid = QString::number(100000 + i);
+        QJsonObject internalState;
+        internalState["value"] = 0.5;
+        internalState["label"] = "Block " + uid;
+        internalState["inverted"] = false;
+
+        QJsonObject state;
+        state["uid"] = uid;
+        state["posX"] = double(i % 40) * 120.0;
+        state["posY"] = double(i / 40) * 80.0;
+        state["group"] = "";
+
+        if (i < BENCHMARK_RECORDER_COUNT) {
+            state["name"] = "Recorder";
+            const QJsonValue reference = blobs.writeArray<double>(recording.constData(), recording.size());
+            internalState["data"] = reference.isUndefined() ? QJsonValue(serialize<QVector<double>>(recording)) : reference;
+        } else if (i < BENCHMARK_RECORDER_COUNT + BENCHMARK_PRESET_COUNT) {
+            state["name"] = "Preset";
+            if (blobs.isWriting()) {
+                QJsonArray sceneData;
+                for (int f = 0; f < BENCHMARK_FIXTURES_PER_PRESET; ++f) {
+                    QJsonObject entry;
+                    entry["uid"] = QString::number(200000 + f);
+                    entry["width"] = matrix.width();
+                    entry["height"] = matrix.height();
+                    entry["data"] = blobs.writeArray<float>(matrix.hue(), matrix.pixels() * 3);
+                    sceneData.append(entry);
+                }
+                internalState["sceneData"] = sceneData;
+            } else {
+                QMap<QString, HsvMatrix> sceneData;
+                for (int f = 0; f < BENCHMARK_FIXTURES_PER_PRESET; ++f) {
+                    sceneData[QString::number(200000 + f)] = matrix;
+                }
+                internalState["sceneData"] = serialize(sceneData);
+            }
+        } else {
+            state["name"] = "Slider";
+        }
+        state["internalState"] = internalState;
+        blocks.append(state);
+
+        if (i > 0) {
+            connections.append(QString::number(100000 + i - 1) + "|1->" + uid + "|0");
+        }
+    }
+
+    QJsonObject projectState;
+    projectState["version"] = 1;
+    projectState["fileName"] = "benchmark";
+    projectState["blocks"] = blocks;
+    projectState["connections"] = connections;
+    return projectState;
+}
+
+/**
+ * @brief decodeBenchmarkPayloads decodes all payloads of the sample project like the blocks would
+ * @param blocks the block states
+ * @param blobs store to read referenced payloads from
+ * @return number of decoded values (to prevent the work from being optimized out)
+ */
+double decodeBenchmarkPayloads(const QJsonArray& blocks, const ProjectBlobStore& blobs) {
+    double valueCount = 0;
+    for (const QJsonValue& blockValue: blocks) {
+        const QJsonObject internalState = blockValue.toObject()["internalState"].toObject();
+        const QJsonValue recording = internalState["data"];
+        if (ProjectBlobStore::isReference(recording)) {
+            const ProjectBlob blob = blobs.read(recording);
+            QVector<double> data(blob.count<double>());
+            valueCount += blob.decode<double>(data.data());
+        } else if (recording.isString()) {
+            valueCount += deserialize<QVector<double>>(recording.toString()).size();
+        }
+
+        const QJsonValue sceneData = internalState["sceneData"];
+        if (sceneData.isArray()) {
+            for (const QJsonValue& entryValue: sceneData.toArray()) {
+                const QJsonObject entry = entryValue.toObject();
+                HsvMatrix matrix(entry["width"].toInt(), entry["height"].toInt());
+                const ProjectBlob blob = blobs.read(entry["data"]);
+                if (blob.count<float>() != matrix.pixels() * 3) continue;
+                valueCount += blob.decode<float>(matrix.hue());
+            }
+        } else if (sceneData.isString()) {
+            const auto matrices = deserialize<QMap<QString, HsvMatrix>>(sceneData.toString());
+            for (const HsvMatrix& matrix: matrices) {
+                valueCount += matrix.pixels() * 3;
+            }
+        }
+    }
+    return valueCount;
+}
+
+}  // namespace
+
+QVariantMap BinaryProjectFile::benchmark() {
+    QVariantMap result;
+    ProjectBlobStore blobs;
+
+    // ------------- JSON:
+    HighResTime::time_point_t start = HighResTime::now();
+    const QByteArray jsonContent = QJsonDocument(benchmarkProjectState(blobs)).toJson();
+    const double jsonSaveTime = HighResTime::getElapsedSecAndUpdate(start);
+
+    const QJsonObject jsonState = QJsonDocument::fromJson(jsonContent).object();
+    const double jsonParseTime = HighResTime::getElapsedSecAndUpdate(start);
+    const double jsonValueCount = decodeBenchmarkPayloads(jsonState["blocks"].toArray(), blobs);
+    const double jsonDecodeTime = HighResTime::getElapsedSecAndUpdate(start);
+
+    // ------------- binary:
+    blobs.beginWriting();
+    QJsonObject binaryState = benchmarkProjectState(blobs);
+    const QByteArray binaryContent = write(binaryState, blobs.endWriting());
+    const double binarySaveTime = HighResTime::getElapsedSecAndUpdate(start);
+
+    QJsonObject projectState;
+    QJsonArray blocks;
+    QJsonArray connections;
+    QByteArray blobSection;
+    const bool valid = read(binaryContent.constData(), binaryContent.size(), projectState, blocks, connections, blobSection);
+    blobs.setReadBuffer(std::make_shared<const QByteArray>(blobSection));
+    const double binaryParseTime = HighResTime::getElapsedSecAndUpdate(start);
+    const double binaryValueCount = decodeBenchmarkPayloads(blocks, blobs);
+    const double binaryDecodeTime = HighResTime::getElapsedSecAndUpdate(start);
+    blobs.setReadBuffer(nullptr);
+
+    if (!valid || jsonValueCount != binaryValueCount) {
+        qWarning() << "Project format benchmark: binary content doesn't match JSON content.";
+    }
+
+    result["blockCount"] = BENCHMARK_BLOCK_COUNT;
+    result["jsonSize"] = jsonContent.size();
+    result["jsonSaveMs"] = jsonSaveTime * 1000;
+    result["jsonParseMs"] = jsonParseTime * 1000;
+    result["jsonDecodeMs"] = jsonDecodeTime * 1000;
+    result["binarySize"] = binaryContent.size();
+    result["binarySaveMs"] = binarySaveTime * 1000;
+    result["binaryParseMs"] = binaryParseTime * 1000;
+    result["binaryDecodeMs"] = binaryDecodeTime * 1000;
+
+    qInfo() << "Project Format Benchmark (" << BENCHMARK_BLOCK_COUNT << "blocks ):";
+    qInfo() << "JSON:   " << jsonContent.size() / 1024 << "KB, save" << jsonSaveTime * 1000 << "ms, parse"
+            << jsonParseTime * 1000 << "ms, decode payloads" << jsonDecodeTime * 1000 << "ms";
+    qInfo() << "Binary: " << binaryContent.size() / 1024 << "KB, save" << binarySaveTime * 1000 << "ms, parse"
+            << binaryParseTime * 1000 << "ms, decode payloads" << binaryDecodeTime * 1000 << "ms";
+    return result;
+}
@@ -0,0 +1,276 @@
+#ifndef BINARYPROJECTFILE_H
+#define BINARYPROJECTFILE_H
+
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QVariantMap>
+#include <QtEndian>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+
+/**
+ * @brief The ProjectBlob class is a view of a raw payload in the blob section of a binary
+ * project file.
+ *
+ * It shares the loaded blob section, so a block can keep it and decode the values
+ * only when they are needed (i.e. when the block is shown).
+ * All values are stored as little-endian arrays.
+ */
+class ProjectBlob {
+
+public:
+    ProjectBlob() : m_offset(0), m_size(0) {}
+
+    ProjectBlob(std::shared_ptr<const QByteArray> buffer, int offset, int size)
+        : m_buffer(buffer)
+        , m_offset(offset)
+        , m_size(size)
+    { }
+
+    /**
+     * @brief isNull returns if this blob doesn't reference any data
+     * @return true if there is no data
+     */
+    bool isNull() const { return !m_buffer; }
+
+    /**
+     * @brief data returns a pointer to the raw bytes
+     * @return pointer to size() bytes or nullptr if the blob is null
+     */
+    const char* data() const { return m_buffer ? m_buffer->constData() + m_offset : nullptr; }
+
+    /**
+     * @brief size returns the number of bytes
+     * @return size in bytes
+     */
+    int size() const { return m_size; }
+
+    /**
+     * @brief count returns the number of values of type T in this blob
+     * @return number of values
+     */
+    template<typename T>
+    int count() const { return m_size / int(sizeof(T)); }
+
+    /**
+     * @brief decode copies the values of this blob to a native array
+     * @param values array with space for at least count<T>() values
+     * @return number of copied values
+     */
+    template<typename T>
+    int decode(T* values) const {
+        const int valueCount = count<T>();
+        if (valueCount <= 0) return 0;
+        copyLittleEndian<T>(data(), reinterpret_cast<char*>(values), valueCount);
+        return valueCount;
+    }
+
+    /**
+     * @brief encode converts a native array to its little-endian representation
+     * @param values pointer to the values
+     * @param count number of values
+     * @return raw bytes
+     */
+    template<typename T>
+    static QByteArray encode(const T* values, int count) {
+        QByteArray bytes(count * int(sizeof(T)), Qt::Uninitialized);
+        if (count > 0) {
+            copyLittleEndian<T>(reinterpret_cast<const char*>(values), bytes.data(), count);
+        }
+        return bytes;
+    }
+
+protected:
+    /**
+     * @brief copyLittleEndian copies values between native and little-endian byte order,
+     * the conversion is the same in both directions
+     */
+    template<typename T>
+    static void copyLittleEndian(const char* source, char* destination, int count) {
+        static_assert(std::is_arithmetic<T>::value, "only arithmetic types can be stored as blobs");
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        std::memcpy(destination, source, std::size_t(count) * sizeof(T));
+#else
+        for (int i = 0; i < count; ++i) {
+            for (std::size_t b = 0; b < sizeof(T); ++b) {
+                destination[i * sizeof(T) + b] = source[i * sizeof(T) + sizeof(T) - 1 - b];
+            }
+        }
+#endif
+    }
+
+protected:
+    std::shared_ptr<const QByteArray> m_buffer;  //!< the complete blob section
+    int m_offset;  //!< offset of the payload in the blob section
+    int m_size;  //!< size of the payload in bytes
+};
+
+
+/**
+ * @brief The ProjectBlobStore class collects the raw payloads of the blocks while a binary
+ * project file is written and resolves them while it is loaded.
+ *
+ * Blocks store the value returned by write() in their state. If no binary file is written
+ * (i.e. a JSON export or a copied block), write() returns an undefined value and the block
+ * uses its inline (JSON) representation instead.
+ *
+ * The payloads of each block form a segment and the references are relative to it,
+ * so the segment of a block whose state didn't change can be reused in the next file.
+ */
+class ProjectBlobStore {
+
+public:
+    ProjectBlobStore() : m_writing(false), m_segmentOffset(0) {}
+
+    // ---------------- Writing:
+
+    /**
+     * @brief beginWriting starts collecting payloads for a binary file
+     */
+    void beginWriting();
+
+    /**
+     * @brief endWriting stops collecting payloads
+     * @return the blob section with all segments added since beginWriting()
+     * (including the current segment if it wasn't taken)
+     */
+    QByteArray endWriting();
+
+    /**
+     * @brief takeSegment returns the payloads written since the last call and starts a new segment
+     * @return the payloads of one block
+     */
+    QByteArray takeSegment();
+
+    /**
+     * @brief appendSegment adds the payloads of one block to the blob section
+     * @param segment payloads returned by takeSegment() (now or for a previous file)
+     * @return offset of the segment in the blob section
+     */
+    int appendSegment(const QByteArray& segment);
+
+    /**
+     * @brief isWriting returns if payloads are currently collected
+     * @return true if a binary file is written
+     */
+    bool isWriting() const { return m_writing; }
+
+    /**
+     * @brief write adds a payload to the current segment
+     * @param data pointer to the raw (little-endian) bytes
+     * @param size number of bytes
+     * @return a reference to store in the block state or an undefined value if
+     * no binary file is written
+     */
+    QJsonValue write(const char* data, int size);
+
+    /**
+     * @brief writeArray encodes an array of values and adds it to the current segment
+     * @param values pointer to the values
+     * @param count number of values
+     * @return see write(const char*, int)
+     */
+    template<typename T>
+    QJsonValue writeArray(const T* values, int count) {
+        if (!m_writing) return QJsonValue(QJsonValue::Undefined);
+        const QByteArray bytes = ProjectBlob::encode<T>(values, count);
+        return write(bytes.constData(), bytes.size());
+    }
+
+    // ---------------- Reading:
+
+    /**
+     * @brief setReadBuffer sets the blob section of the project that is loaded
+     * @param buffer the blob section or nullptr when loading is complete
+     */
+    void setReadBuffer(std::shared_ptr<const QByteArray> buffer) { m_readBuffer = buffer; m_segmentOffset = 0; }
+
+    /**
+     * @brief setSegmentOffset sets the offset of the segment of the block that is restored next
+     * @param offset offset returned by appendSegment() when the file was written
+     */
+    void setSegmentOffset(int offset) { m_segmentOffset = offset; }
+
+    /**
+     * @brief isReference returns if a value of a block state references a blob
+     * @param value a value from a block state
+     * @return true if it is a blob reference
+     */
+    static bool isReference(const QJsonValue& value);
+
+    /**
+     * @brief read resolves a reference created by write()
+     * @param reference a value from a block state
+     * @return the blob or a null blob if the reference is invalid
+     */
+    ProjectBlob read(const QJsonValue& reference) const;
+
+protected:
+    bool m_writing;  //!< true between beginWriting() and endWriting()
+    QByteArray m_writeBuffer;  //!< blob section that is currently written
+    QByteArray m_segment;  //!< payloads of the block that is currently written
+    std::shared_ptr<const QByteArray> m_readBuffer;  //!< blob section of the project that is loaded
+    int m_segmentOffset;  //!< offset of the segment of the block that is currently restored
+};
+
+
+/**
+ * @brief The BinaryProjectFile class reads and writes the binary project format.
+ *
+ * A file consists of a header, a section table and the sections, all little-endian:
+ * - header: magic "LPRB", version (u16), header size (u16), section count (u32), reserved (u32)
+ * - section table: tag (u32), reserved (u32), offset (u64), size (u64) per section
+ * - "PROJ": project settings as compact JSON
+ * - "BLKS": array of block states as compact JSON
+ * - "CONN": array of connections as compact JSON
+ * - "BLOB": raw payloads referenced by the block states, one 8 byte aligned segment per block
+ *   (its offset is stored as "blobOffset" in the block state)
+ *
+ * Unknown sections are ignored, so new sections can be added without a new version.
+ * Files that don't start with the magic are JSON project files.
+ */
+class BinaryProjectFile {
+
+public:
+    /**
+     * @brief isBinary checks if the content of a file is a binary project
+     * @param content the beginning of the file
+     * @param size number of bytes in content
+     * @return true if it is a binary project file
+     */
+    static bool isBinary(const char* content, qint64 size);
+
+    /**
+     * @brief write creates the content of a binary project file
+     * @param projectState the project state including blocks and connections,
+     * as returned by ProjectManager::getCurrentProjectState()
+     * @param blobSection the payloads returned by ProjectBlobStore::endWriting()
+     * @return file content
+     */
+    static QByteArray write(QJsonObject projectState, const QByteArray& blobSection);
+
+    /**
+     * @brief read parses the content of a binary project file
+     * @param content pointer to the file content (i.e. memory-mapped)
+     * @param size size of the content in bytes
+     * @param projectState the project settings without blocks and connections
+     * @param blocks array of block states
+     * @param connections array of connections
+     * @param blobSection a copy of the blob section
+     * @return true if the file is valid
+     */
+    static bool read(const char* content, qint64 size, QJsonObject& projectState, QJsonArray& blocks,
+                     QJsonArray& connections, QByteArray& blobSection);
+
+    /**
+     * @brief benchmark compares saving and loading a large synthetic project
+     * in the JSON and in the binary format
+     * @return sizes and durations of both formats
+     */
+    static QVariantMap benchmark();
+};
+
+#endif // BINARYPROJECTFILE_H
@@ -5,6 +5,7 @@
 #include "core/SmartAttribute.h"
 #include "block_implementations/Luminosus/GroupBlock.h"
 
+#include <QElapsedTimer>
 #include <QQmlEngine>
 #include <QQuickItem>
 #include <QQuickWindow>
@@ -434,6 +435,10 @@ BlockInterface* BlockManager::getBlockByUid(QString uid) {
 }
 
 QJsonObject BlockManager::getBlockState(BlockInterface* block) const {
+    return getBlockState(block, block->getState());
+}
+
+QJsonObject BlockManager::getBlockState(BlockInterface* block, const QJsonObject& internalState) const {
     double dp = m_controller->guiManager()->getGuiScaling();
 	QJsonObject blockState;
 	blockState["name"] = block->getBlockInfo().typeName;
@@ -444,7 +449,7 @@ QJsonObject BlockManager::getBlockState(BlockInterface* block) const {
     blockState["height"] = block->getGuiHeight() / dp;
 	blockState["focused"] = getFocusedBlock() == block;
     blockState["nodeMergeModes"] = block->getNodeMergeModes();
-    blockState["internalState"] = block->getState();
+    blockState["internalState"] = internalState;
     return blockState;
 }
 
@@ -608,6 +613,78 @@ void BlockManager::makeRandomConnection() {
     output->setRgb(0.73, 0.26, 0.63);
 }
 
+QVariantMap BlockManager::benchmarkGraphEvaluation(int blockCount) {
+    const int sourceCount = 10;
+    const int frames = 50;
+    blockCount = qMax(blockCount, sourceCount + 1);
+
+    // create the blocks without GUI items:
+    QVector<BlockInterface*> blocks;
+    QVector<NodeBase*> outputs;
+    QVector<QVector<NodeBase*>> inputs;
+    for (int i = 0; i < blockCount; ++i) {
+        BlockInterface* block = createBlockInstance("Multiply");
+        if (!block) break;
+        blocks.append(block);
+        outputs.append(nullptr);
+        inputs.append(QVector<NodeBase*>());
+        for (NodeBase* node: block->getNodes()) {
+            if (node->isOutput()) {
+                outputs.last() = node;
+            } else {
+                inputs.last().append(node);
+            }
+        }
+    }
+
+    // connect the inputs to blocks with a lower index, so that there are no cycles;
+    // the first input is always connected, the second one only sometimes to get
+    // fan-out and fan-in but not too many paths for the immediate mode:
+    int updateCount = 0;
+    for (int i = sourceCount; i < blocks.size(); ++i) {
+        for (int k = 0; k < inputs[i].size(); ++k) {
+            NodeBase* input = inputs[i][k];
+            connect(input, &NodeBase::dataChanged, input, [&updateCount]() { ++updateCount; });
+            if (k > 0 && qrand() % 4 != 0) continue;
+            outputs[qrand() % i]->connectTo(input);
+        }
+    }
+
+    GraphEvaluator* graph = m_controller->graphEvaluator();
+    const bool wasBatched = graph->isBatched();
+    QVariantMap result;
+    result["blocks"] = blocks.size();
+    for (bool batched: {false, true}) {
+        graph->setBatched(batched);
+        // apply the changes of the connection process:
+        graph->evaluate();
+        updateCount = 0;
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int frame = 0; frame < frames; ++frame) {
+            for (int i = 0; i < sourceCount && i < outputs.size(); ++i) {
+                outputs[i]->setValue(double(qrand()) / RAND_MAX);
+            }
+            if (batched) graph->evaluate();
+        }
+        const double msPerFrame = double(timer.nsecsElapsed()) / 1e6 / frames;
+        const double updatesPerFrame = double(updateCount) / frames;
+
+        const QString mode = batched ? "batched" : "immediate";
+        qInfo() << "Graph evaluation with" << blocks.size() << "blocks," << mode << ":"
+                << msPerFrame << "ms and" << updatesPerFrame << "input updates per frame";
+        result[mode + "Ms"] = msPerFrame;
+        result[mode + "Updates"] = updatesPerFrame;
+    }
+    graph->setBatched(wasBatched);
+
+    for (BlockInterface* block: blocks) {
+        deleteBlock(block, /*forced*/ true, /*noRestore*/ true, /*immediate*/ true);
+    }
+    return result;
+}
+
 BlockInterface* BlockManager::createBlockInstance(QString blockType, QString uid) {
 	// check if block type is available:
 	if (!m_blockList.blockExists(blockType)) {
@@ -9,6 +9,7 @@
 #include <QPointer>
 #include <vector>
 #include <QTimer>
+#include <QVariant>
 #include <QSoundEffect>
 
 
@@ -196,6 +197,14 @@ public slots:
 	 */
 	QJsonObject getBlockState(BlockInterface* block) const;
 
+    /**
+     * @brief getBlockState returns the state of a block with an internal state that was serialized before
+     * @param block pointer to the block
+     * @param internalState result of block->getState()
+     * @return QJsonObject containing the state information
+     */
+    QJsonObject getBlockState(BlockInterface* block, const QJsonObject& internalState) const;
+
     /**
      * @brief getBlocksMidpoint return the geometric middle point of all blocks
      * (used to bring blocks back to viewport)
@@ -248,6 +257,15 @@ public slots:
      */
     void makeRandomConnection();
 
+    /**
+     * @brief benchmarkGraphEvaluation creates a random acyclic graph of blocks (without GUI)
+     * and compares immediate and batched propagation of changes (see GraphEvaluator),
+     * the blocks are deleted afterwards
+     * @param blockCount number of blocks in the graph
+     * @return a map with the time and number of input updates per frame for both modes
+     */
+    QVariantMap benchmarkGraphEvaluation(int blockCount = 500);
+
 signals:
 	/**
 	 * @brief focusChanged emitted when the focused block changed (or the focus was released)
@@ -20,18 +20,51 @@
 
 #include "Engine.h"
 
+#include <cmath>
+
 
 Engine::Engine(QObject* parent, int fps)
 	: QObject(parent)
 	, m_timer(this)
-	, m_fps(fps)
+    , m_fps(fps)
+    , m_period(0)
+    , m_latePolicy(LatePolicy::Skip)
+    , m_lateFrameCount(0)
+    , m_skippedFrameCount(0)
+    , m_maxLateness(0.0)
+    , m_maxTickDuration(0.0)
+    , m_lateFrameCountLastSecond(0)
+    , m_skippedFrameCountLastSecond(0)
+    , m_maxLatenessLastSecond(0.0)
+    , m_maxTickDurationLastSecond(0.0)
 {
-	m_lastFrameTime = HighResTime::now();
+    setFps(fps);
+    m_lastFrameTime = Clock::now();
+    m_nextDeadline = m_lastFrameTime;
+    m_statisticsStart = m_lastFrameTime;
+    // the timer is restarted each frame to fire at the next absolute deadline:
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
 	connect(&m_timer, SIGNAL(timeout()), this, SLOT(tick()));
 }
 
+void Engine::setFps(double fps) {
+    if (fps <= 0) return;
+    m_fps = fps;
+    m_period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+}
+
+void Engine::setLatePolicy(LatePolicy value) {
+    if (value == m_latePolicy) return;
+    m_latePolicy = value;
+    emit latePolicyChanged();
+}
+
 void Engine::start() {
-    m_timer.start(1000 / m_fps);
+    m_lastFrameTime = Clock::now();
+    m_nextDeadline = m_lastFrameTime + m_period;
+    m_statisticsStart = m_lastFrameTime;
+    scheduleNextTick();
 }
 
 void Engine::stop() {
@@ -39,10 +72,60 @@ void Engine::stop() {
 }
 
 void Engine::tick() {
-    // calculate time once last frame:
-    const double timeSinceLastFrame = HighResTime::getElapsedSecAndUpdate(m_lastFrameTime);
+    const Clock::time_point start = Clock::now();
+    if (start < m_nextDeadline) {
+        // timer fired too early:
+        scheduleNextTick();
+        return;
+    }
+    const double lateness = std::chrono::duration<double>(start - m_nextDeadline).count();
+
+    // calculate the real time since last frame (includes skipped frames):
+    const double timeSinceLastFrame = std::chrono::duration<double>(start - m_lastFrameTime).count();
+    m_lastFrameTime = start;
 
 	// call signals in logical order:
 	emit updateBlocks(timeSinceLastFrame);
+    emit evaluateBlockGraph();
 	emit updateOutput(timeSinceLastFrame);
+
+    const Clock::time_point end = Clock::now();
+    m_nextDeadline += m_period;
+    if (end >= m_nextDeadline) {
+        // overrun: the deadline of at least the next frame has already passed
+        ++m_lateFrameCount;
+        const int dueFrames = int((end - m_nextDeadline) / m_period) + 1;
+        // the Skip policy runs only the latest of the due frames,
+        // CatchUp runs all of them one after another (but not too many):
+        const int framesToRun = (m_latePolicy == LatePolicy::CatchUp) ? qMin(dueFrames, EngineConstants::maxCatchUpFrames) : 1;
+        const int framesToSkip = dueFrames - framesToRun;
+        m_nextDeadline += framesToSkip * m_period;
+        m_skippedFrameCount += framesToSkip;
+    }
+
+    updateStatistics(lateness, std::chrono::duration<double>(end - start).count(), end);
+    scheduleNextTick();
+}
+
+void Engine::scheduleNextTick() {
+    const double remainingMs = std::chrono::duration<double, std::milli>(m_nextDeadline - Clock::now()).count();
+    // round up to not wake up before the deadline:
+    m_timer.start(qMax(0, int(std::ceil(remainingMs))));
+}
+
+void Engine::updateStatistics(double lateness, double duration, Clock::time_point now) {
+    m_maxLateness = qMax(m_maxLateness, lateness);
+    m_maxTickDuration = qMax(m_maxTickDuration, duration);
+
+    if (now - m_statisticsStart < std::chrono::seconds(1)) return;
+    m_lateFrameCountLastSecond = m_lateFrameCount;
+    m_skippedFrameCountLastSecond = m_skippedFrameCount;
+    m_maxLatenessLastSecond = m_maxLateness;
+    m_maxTickDurationLastSecond = m_maxTickDuration;
+    m_lateFrameCount = 0;
+    m_skippedFrameCount = 0;
+    m_maxLateness = 0.0;
+    m_maxTickDuration = 0.0;
+    m_statisticsStart = now;
+    emit statisticsChanged();
 }
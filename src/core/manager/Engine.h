@@ -28,18 +28,48 @@
 #include <chrono>
 
 
+namespace EngineConstants {
+
+/**
+ * @brief maxCatchUpFrames is the maximum number of missed frames that are run late
+ * with the CatchUp policy, if more frames are missed they are skipped
+ */
+static const int maxCatchUpFrames = 5;
+
+}
+
+
 /**
  * @brief The Engine class defines an engine that is responsible to trigger all non-GUI actions
  * that have to be done regulary (i.e. block logic and data output).
  * It generates different signals with a specified FPS rate.
  *
  * It is independent from the GUI. Actions that affect the GUI should be triggered by QTimer.
+ *
+ * Frames are scheduled against absolute deadlines of a monotonic clock. The rounding
+ * of the timer to milliseconds therefore doesn't accumulate (i.e. 44 FPS are
+ * really 44 FPS and not 1000 / 22ms = 45.45 FPS) and the frame rate doesn't drift under load.
  */
 class Engine : public QObject
 {
 	Q_OBJECT
 
+    Q_PROPERTY(int lateFrameCount READ getLateFrameCount NOTIFY statisticsChanged)
+    Q_PROPERTY(int skippedFrameCount READ getSkippedFrameCount NOTIFY statisticsChanged)
+    Q_PROPERTY(double maxLateness READ getMaxLateness NOTIFY statisticsChanged)
+    Q_PROPERTY(double maxTickDuration READ getMaxTickDuration NOTIFY statisticsChanged)
+    Q_PROPERTY(bool catchUpLateFrames READ getCatchUpLateFrames WRITE setCatchUpLateFrames NOTIFY latePolicyChanged)
+
 public:
+    /**
+     * @brief The LatePolicy enum defines what happens with frames whose deadline was missed.
+     */
+    enum class LatePolicy {
+        Skip,  //!< missed frames are dropped, the next frame is scheduled for the next deadline
+        CatchUp  //!< missed frames are run immediately one after another (up to maxCatchUpFrames)
+    };
+
+
 	/**
 	 * @brief Engine creates an engine instance
 	 * @param fps the amount of frames per second to generate
@@ -47,12 +77,51 @@ public:
 	 */
     explicit Engine(QObject* parent = 0, int fps = 50);
 
+    /**
+     * @brief setFps changes the amount of frames per second, takes effect with the next frame
+     * @param fps the amount of frames per second to generate
+     */
+    void setFps(double fps);
+    double getFps() const { return m_fps; }
+
+    void setLatePolicy(LatePolicy value);
+    LatePolicy getLatePolicy() const { return m_latePolicy; }
+
+    // LatePolicy as bool for QML and the app state:
+    bool getCatchUpLateFrames() const { return m_latePolicy == LatePolicy::CatchUp; }
+    void setCatchUpLateFrames(bool value) { setLatePolicy(value ? LatePolicy::CatchUp : LatePolicy::Skip); }
+
+    // ---------------- Statistics (reset each second):
+
+    /**
+     * @brief getLateFrameCount returns the number of frames of the last second that
+     * started after the deadline of the following frame (overruns)
+     */
+    int getLateFrameCount() const { return m_lateFrameCountLastSecond; }
+    /**
+     * @brief getSkippedFrameCount returns the number of frames dropped in the last second
+     */
+    int getSkippedFrameCount() const { return m_skippedFrameCountLastSecond; }
+    /**
+     * @brief getMaxLateness returns the maximum delay of a frame start after its deadline in seconds
+     */
+    double getMaxLateness() const { return m_maxLatenessLastSecond; }
+    /**
+     * @brief getMaxTickDuration returns the maximum time a frame took to be processed in seconds
+     */
+    double getMaxTickDuration() const { return m_maxTickDurationLastSecond; }
+
 signals:
 	/**
 	 * @brief updateBlocks is emitted every frame when the block logic should update its values
 	 * @param timeSinceLastFrame is the time in seconds since the last call of this signal
 	 */
     void updateBlocks(double timeSinceLastFrame);
+    /**
+     * @brief evaluateBlockGraph is emitted every frame after updateBlocks to propagate
+     * the changed node data through the block graph (see GraphEvaluator)
+     */
+    void evaluateBlockGraph();
 	/**
 	 * @brief updateOutput is emitted every frame after the blocks have been updated
 	 * and the output (i.e. ArtNet, sACN) should be updated
@@ -60,6 +129,16 @@ signals:
 	 */
     void updateOutput(double timeSinceLastFrame);
 
+    /**
+     * @brief statisticsChanged is emitted once per second when the frame statistics are updated
+     */
+    void statisticsChanged();
+
+    /**
+     * @brief latePolicyChanged is emitted when the LatePolicy changed
+     */
+    void latePolicyChanged();
+
 public slots:
 
 	/**
@@ -80,19 +159,61 @@ private slots:
 	 */
 	void tick();
 
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * @brief scheduleNextTick starts the timer to fire at m_nextDeadline
+     */
+    void scheduleNextTick();
+
+    /**
+     * @brief updateStatistics accounts the lateness and duration of a frame
+     * and publishes the statistics each second
+     * @param lateness time in seconds the frame started after its deadline
+     * @param duration time in seconds the frame took to be processed
+     * @param now time of the end of the frame
+     */
+    void updateStatistics(double lateness, double duration, Clock::time_point now);
+
 private:
 	/**
-	 * @brief m_timer is the timer that triggers the tick() function
+	 * @brief m_timer is the single shot timer that triggers the tick() function
 	 */
 	QTimer m_timer;
 	/**
 	 * @brief m_fps is the amount of frames per second to be generated
 	 */
-	int m_fps;
+    double m_fps;
+    /**
+     * @brief m_period is the duration of one frame
+     */
+    Clock::duration m_period;
+    /**
+     * @brief m_nextDeadline is the absolute time the next frame should be generated
+     */
+    Clock::time_point m_nextDeadline;
 	/**
 	 * @brief m_lastFrameTime is the time of the last generated frame
 	 */
-	HighResTime::time_point_t m_lastFrameTime;
+    Clock::time_point m_lastFrameTime;
+    /**
+     * @brief m_latePolicy defines what happens if deadlines were missed
+     */
+    LatePolicy m_latePolicy;
+
+    // statistics of the current second:
+    Clock::time_point m_statisticsStart;
+    int m_lateFrameCount;
+    int m_skippedFrameCount;
+    double m_maxLateness;
+    double m_maxTickDuration;
+
+    // statistics of the last second:
+    int m_lateFrameCountLastSecond;
+    int m_skippedFrameCountLastSecond;
+    double m_maxLatenessLastSecond;
+    double m_maxTickDurationLastSecond;
 
 };
 
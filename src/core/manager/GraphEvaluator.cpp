@@ -0,0 +1,161 @@
+#include "GraphEvaluator.h"
+
+#include "core/MainController.h"
+#include "core/Nodes.h"
+#include "core/block_data/BlockInterface.h"
+
+#include <QDebug>
+#include <QHash>
+#include <QVarLengthArray>
+#include <algorithm>
+
+
+GraphEvaluator::GraphEvaluator(MainController* controller)
+    : QObject(controller)
+    , m_controller(controller)
+    , m_batched(true)
+    , m_orderIsOutdated(true)
+    , m_isEvaluating(false)
+    , m_currentRank(-1)
+    , m_updatedNodeCount(0)
+{
+    connect(controller->engine(), SIGNAL(evaluateBlockGraph()), this, SLOT(evaluate()));
+}
+
+void GraphEvaluator::addDirtyNode(NodeBase* inputNode) {
+    if (!inputNode) return;
+    if (m_isEvaluating && !m_orderIsOutdated && inputNode->m_evaluationRank > m_currentRank) {
+        // the block of this node follows the current one, update it in this evaluation:
+        pushToHeap(inputNode);
+    } else {
+        // changed outside of an evaluation or by a feedback within this evaluation
+        // -> update it in the next frame:
+        m_dirtyNodes.append(inputNode);
+    }
+}
+
+void GraphEvaluator::setBatched(bool value) {
+    if (value == m_batched) return;
+    if (!value) {
+        // apply the pending changes before switching to immediate mode:
+        evaluate();
+    }
+    m_batched = value;
+    emit batchedChanged();
+}
+
+void GraphEvaluator::evaluate() {
+    if (m_isEvaluating) return;
+    m_updatedNodeCount = 0;
+    if (m_dirtyNodes.isEmpty()) return;
+    if (m_orderIsOutdated) rebuildOrder();
+
+    m_heap.clear();
+    for (NodeBase* node: m_dirtyNodes) {
+        if (!node) continue;
+        m_heap.push_back(DirtyNode {node->m_evaluationRank, node});
+    }
+    m_dirtyNodes.clear();
+    std::make_heap(m_heap.begin(), m_heap.end(), laterRank);
+
+    m_isEvaluating = true;
+    while (!m_heap.empty()) {
+        if (m_orderIsOutdated) {
+            // a block changed connections while it was updated:
+            rebuildOrder();
+            for (DirtyNode& entry: m_heap) {
+                entry.rank = entry.node ? entry.node->m_evaluationRank : -1;
+            }
+            std::make_heap(m_heap.begin(), m_heap.end(), laterRank);
+        }
+
+        // the rank is unique per block, collect all dirty inputs of the next block:
+        m_currentRank = m_heap.front().rank;
+        m_blockInputs.clear();
+        while (!m_heap.empty() && m_heap.front().rank == m_currentRank) {
+            std::pop_heap(m_heap.begin(), m_heap.end(), laterRank);
+            if (m_heap.back().node) m_blockInputs.append(m_heap.back().node);
+            m_heap.pop_back();
+        }
+
+        // merge all inputs first, so that the block sees the final values
+        // when the first dataChanged() signal arrives:
+        QVarLengthArray<bool, 8> changed(m_blockInputs.size());
+        for (int i = 0; i < m_blockInputs.size(); ++i) {
+            NodeBase* node = m_blockInputs[i];
+            node->m_dataIsDirty = false;
+            changed[i] = node->mergeData(node->m_dirtyLtpSource);
+        }
+        for (int i = 0; i < m_blockInputs.size(); ++i) {
+            // (the block may have deleted nodes in a previous slot)
+            if (!changed[i] || !m_blockInputs[i]) continue;
+            emit m_blockInputs[i]->dataChanged();
+            ++m_updatedNodeCount;
+        }
+    }
+    m_isEvaluating = false;
+    m_currentRank = -1;
+}
+
+void GraphEvaluator::rebuildOrder() {
+    const std::vector<QPointer<BlockInterface>>& blocks = m_controller->blockManager()->getCurrentBlocks();
+    const int blockCount = int(blocks.size());
+
+    QHash<BlockInterface*, int> indexOfBlock;
+    indexOfBlock.reserve(blockCount);
+    for (int i = 0; i < blockCount; ++i) {
+        if (!blocks[i]) continue;
+        indexOfBlock[blocks[i]] = i;
+    }
+
+    // edges from each block to the blocks connected to its outputs:
+    QVector<QVector<int>> successors(blockCount);
+    QVector<int> inDegree(blockCount, 0);
+    for (int i = 0; i < blockCount; ++i) {
+        if (!blocks[i]) continue;
+        for (NodeBase* node: blocks[i]->getNodes()) {
+            if (!node || !node->isOutput()) continue;
+            for (NodeBase* inputNode: node->getConnectedNodes()) {
+                if (!inputNode) continue;
+                const int successor = indexOfBlock.value(inputNode->getBlock(), -1);
+                if (successor < 0) continue;
+                successors[i].append(successor);
+                ++inDegree[successor];
+            }
+        }
+    }
+
+    // Kahn's algorithm, the position in the queue is the rank:
+    QVector<int> queue;
+    queue.reserve(blockCount);
+    for (int i = 0; i < blockCount; ++i) {
+        if (inDegree[i] == 0) queue.append(i);
+    }
+    for (int position = 0; position < queue.size(); ++position) {
+        for (int successor: successors[queue[position]]) {
+            if (--inDegree[successor] == 0) queue.append(successor);
+        }
+    }
+    if (queue.size() < blockCount) {
+        // should not happen because NodeBase::connectTo() prevents cycles:
+        qWarning() << "GraphEvaluator: The block graph contains a cycle.";
+        for (int i = 0; i < blockCount; ++i) {
+            if (inDegree[i] > 0) queue.append(i);
+        }
+    }
+
+    for (int rank = 0; rank < queue.size(); ++rank) {
+        BlockInterface* block = blocks[queue[rank]];
+        if (!block) continue;
+        for (NodeBase* node: block->getNodes()) {
+            if (!node || node->isOutput()) continue;
+            node->m_evaluationRank = rank;
+        }
+    }
+    m_orderIsOutdated = false;
+}
+
+void GraphEvaluator::pushToHeap(NodeBase* node) {
+    m_heap.push_back(DirtyNode {node->m_evaluationRank, node});
+    std::push_heap(m_heap.begin(), m_heap.end(), laterRank);
+}
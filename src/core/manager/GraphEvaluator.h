@@ -0,0 +1,126 @@
+#ifndef GRAPHEVALUATOR_H
+#define GRAPHEVALUATOR_H
+
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+
+#include <vector>
+
+// forward declarations to reduce dependencies:
+class MainController;
+class NodeBase;
+
+
+/**
+ * @brief The GraphEvaluator class propagates changed node data through the block graph
+ * once per Engine frame in topological order.
+ *
+ * In batched mode, an output node that was modified only marks its connected input nodes as dirty.
+ * When the Engine emits evaluateBlockGraph() (after updateBlocks() and before updateOutput()),
+ * the dirty input nodes are merged in topological order of their blocks, so that a block
+ * is only processed after all blocks it depends on and each input node is updated at most
+ * once per frame. All dirty inputs of a block are merged before the first of them emits
+ * dataChanged(), so the block sees the final values of this frame.
+ *
+ * The topological order is stored as a rank in each input node. It is only rebuilt
+ * when connections changed (see NodeBase::connectTo() and NodeBase::disconnectFrom()).
+ *
+ * If batched mode is disabled, a modified output node updates its connected inputs
+ * immediately and recursively as before.
+ */
+class GraphEvaluator : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool batched READ isBatched WRITE setBatched NOTIFY batchedChanged)
+
+public:
+    /**
+     * @brief GraphEvaluator creates an instance and connects it to the Engine
+     * @param controller pointer to the MainController
+     */
+    explicit GraphEvaluator(MainController* controller);
+
+    /**
+     * @brief isBatched returns if changes are propagated once per frame
+     * @return true in batched mode, false if changes are propagated immediately
+     */
+    bool isBatched() const { return m_batched; }
+
+    /**
+     * @brief addDirtyNode schedules an input node to be updated in the next evaluation,
+     * called by NodeBase::markDataDirty()
+     * @param inputNode the input node, must not be scheduled already
+     */
+    void addDirtyNode(NodeBase* inputNode);
+
+    /**
+     * @brief invalidateOrder is called when a connection changed to rebuild
+     * the topological order before the next evaluation
+     */
+    void invalidateOrder() { m_orderIsOutdated = true; }
+
+    /**
+     * @brief getUpdatedNodeCount returns the number of input nodes updated in the last evaluation
+     * @return number of input nodes
+     */
+    int getUpdatedNodeCount() const { return m_updatedNodeCount; }
+
+signals:
+    void batchedChanged();
+
+public slots:
+    /**
+     * @brief setBatched enables or disables batched mode, pending changes are evaluated
+     * when it is disabled
+     * @param value true to propagate changes once per frame
+     */
+    void setBatched(bool value);
+
+    /**
+     * @brief evaluate updates all dirty input nodes in topological order,
+     * called once per frame by the Engine
+     */
+    void evaluate();
+
+private:
+    /**
+     * @brief The DirtyNode struct is an entry in the heap of nodes to be updated in this evaluation
+     */
+    struct DirtyNode {
+        int rank;  //!< the topological rank of the block of the node
+        QPointer<NodeBase> node;  //!< the input node
+    };
+
+    /**
+     * @brief laterRank is the comparator for the min-heap of dirty nodes
+     */
+    static bool laterRank(const DirtyNode& lhs, const DirtyNode& rhs) { return lhs.rank > rhs.rank; }
+
+    /**
+     * @brief rebuildOrder calculates the topological rank of all blocks (Kahn's algorithm)
+     * and stores it in their input nodes
+     */
+    void rebuildOrder();
+
+    /**
+     * @brief pushToHeap adds a node to m_heap
+     * @param node an input node
+     */
+    void pushToHeap(NodeBase* node);
+
+protected:
+    MainController* const m_controller;  //!< pointer to the MainController
+    bool m_batched;  //!< true if changes are propagated once per frame
+    bool m_orderIsOutdated;  //!< true if connections changed since the order was built
+    bool m_isEvaluating;  //!< true while evaluate() is running
+    int m_currentRank;  //!< rank of the block being processed in evaluate()
+    int m_updatedNodeCount;  //!< number of input nodes updated in the last evaluation
+
+    QVector<QPointer<NodeBase>> m_dirtyNodes;  //!< nodes to be updated in the next evaluation
+    std::vector<DirtyNode> m_heap;  //!< min-heap by rank of the nodes in the current evaluation
+    QVector<QPointer<NodeBase>> m_blockInputs;  //!< dirty inputs of the current block (reused)
+};
+
+#endif // GRAPHEVALUATOR_H
@@ -0,0 +1,62 @@
+#include "GuiUpdateBatcher.h"
+
+#include "core/MainController.h"
+#include "core/block_data/BlockInterface.h"
+
+
+GuiUpdateBatcher::GuiUpdateBatcher(MainController* controller)
+    : QObject(controller)
+    , m_controller(controller)
+    , m_batched(true)
+    , m_notificationCount(0)
+    , m_flushedBlockCount(0)
+    , m_notificationsPerSecond(0)
+    , m_flushedBlocksPerSecond(0)
+{
+    // updateOutput() is the last signal of a frame, all blocks and the graph are updated then:
+    connect(controller->engine(), SIGNAL(updateOutput(double)), this, SLOT(flush()));
+    connect(controller->engine(), SIGNAL(statisticsChanged()), this, SLOT(publishStatistics()));
+}
+
+void GuiUpdateBatcher::addBlock(BlockInterface* block) {
+    if (!block) return;
+    m_queuedBlocks.append(block);
+}
+
+void GuiUpdateBatcher::setBatched(bool value) {
+    if (value == m_batched) return;
+    if (!value) {
+        // emit the pending notifications before switching to immediate mode:
+        flush();
+    }
+    m_batched = value;
+    emit batchedChanged();
+}
+
+void GuiUpdateBatcher::flush() {
+    if (m_queuedBlocks.isEmpty()) return;
+    // QML handlers can change attributes again, those blocks are queued for the next frame:
+    m_flushingBlocks.swap(m_queuedBlocks);
+    for (BlockInterface* block: m_flushingBlocks) {
+        if (!block) continue;
+        m_notificationCount += block->flushGuiUpdates();
+        ++m_flushedBlockCount;
+    }
+    m_flushingBlocks.clear();
+}
+
+QVariantMap GuiUpdateBatcher::getStatistics() const {
+    QVariantMap result;
+    result["batched"] = m_batched;
+    result["notificationsPerSecond"] = m_notificationsPerSecond;
+    result["flushedBlocksPerSecond"] = m_flushedBlocksPerSecond;
+    return result;
+}
+
+void GuiUpdateBatcher::publishStatistics() {
+    m_notificationsPerSecond = m_notificationCount;
+    m_flushedBlocksPerSecond = m_flushedBlockCount;
+    m_notificationCount = 0;
+    m_flushedBlockCount = 0;
+    emit statisticsChanged();
+}
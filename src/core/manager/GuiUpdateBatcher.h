@@ -0,0 +1,116 @@
+#ifndef GUIUPDATEBATCHER_H
+#define GUIUPDATEBATCHER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QVariantMap>
+#include <QVector>
+
+// forward declarations to reduce dependencies:
+class MainController;
+class BlockInterface;
+
+
+/**
+ * @brief The GuiUpdateBatcher class coalesces the GUI notifications of block attributes
+ * to at most one per attribute and Engine frame.
+ *
+ * An attribute still emits valueChanged() immediately for the logic of its block, but the
+ * properties used by QML are notified by guiValueChanged(). In batched mode, a changed attribute
+ * only marks itself as dirty in its block (see BlockBase::markGuiAttributeDirty()) and the block
+ * is queued here. When the Engine emits updateOutput() at the end of a frame, each queued block
+ * notifies its dirty attributes once.
+ *
+ * Blocks without a GUI item, with a hidden GUI item or whose item was culled by
+ * BlockManager::updateBlockVisibility() are not notified at all. They keep their dirty attributes
+ * and are queued again when their item becomes visible.
+ *
+ * If batched mode is disabled, guiValueChanged() is emitted together with valueChanged().
+ */
+class GuiUpdateBatcher : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool batched READ isBatched WRITE setBatched NOTIFY batchedChanged)
+    Q_PROPERTY(int notificationsPerSecond READ getNotificationsPerSecond NOTIFY statisticsChanged)
+
+public:
+    /**
+     * @brief GuiUpdateBatcher creates an instance and connects it to the Engine
+     * @param controller pointer to the MainController
+     */
+    explicit GuiUpdateBatcher(MainController* controller);
+
+    /**
+     * @brief isBatched returns if GUI notifications are emitted once per frame
+     * @return true in batched mode, false if they are emitted immediately
+     */
+    bool isBatched() const { return m_batched; }
+
+    /**
+     * @brief addBlock schedules a block to notify its dirty attributes at the end of this frame,
+     * called by BlockBase::markGuiAttributeDirty()
+     * @param block the block, must not be scheduled already
+     */
+    void addBlock(BlockInterface* block);
+
+    /**
+     * @brief countNotifications adds GUI notifications that were emitted outside of flush()
+     * @param count number of emitted notifications
+     */
+    void countNotifications(int count) { m_notificationCount += count; }
+
+    /**
+     * @brief getNotificationsPerSecond returns the number of GUI notifications in the last second
+     * @return number of emitted guiValueChanged() signals
+     */
+    int getNotificationsPerSecond() const { return m_notificationsPerSecond; }
+
+signals:
+    void batchedChanged();
+
+    /**
+     * @brief statisticsChanged is emitted once per second when the counters are updated
+     */
+    void statisticsChanged();
+
+public slots:
+    /**
+     * @brief setBatched enables or disables batched mode, pending notifications are emitted
+     * when it is disabled
+     * @param value true to notify the GUI once per frame
+     */
+    void setBatched(bool value);
+
+    /**
+     * @brief flush lets all queued blocks notify their dirty attributes,
+     * called once per frame by the Engine
+     */
+    void flush();
+
+    /**
+     * @brief getStatistics returns the counters of the last second
+     * @return notifications per second and queued blocks
+     */
+    QVariantMap getStatistics() const;
+
+private slots:
+    /**
+     * @brief publishStatistics is called each second by the Engine to update the counters
+     */
+    void publishStatistics();
+
+protected:
+    MainController* const m_controller;  //!< pointer to the MainController
+    bool m_batched;  //!< true if the GUI is notified once per frame
+
+    QVector<QPointer<BlockInterface>> m_queuedBlocks;  //!< blocks to be notified in the next flush()
+    QVector<QPointer<BlockInterface>> m_flushingBlocks;  //!< blocks of the current flush() (reused)
+
+    int m_notificationCount;  //!< notifications emitted in the current second
+    int m_flushedBlockCount;  //!< blocks flushed in the current second
+    int m_notificationsPerSecond;  //!< notifications emitted in the last second
+    int m_flushedBlocksPerSecond;  //!< blocks flushed in the last second
+};
+
+#endif // GUIUPDATEBATCHER_H
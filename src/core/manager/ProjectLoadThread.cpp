@@ -0,0 +1,104 @@
+#include "ProjectLoadThread.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+
+ProjectLoadThread::ProjectLoadThread(const QString& filename, QObject* parent)
+    : QThread(parent)
+    , m_filename(filename)
+    , m_readTime(0.0)
+    , m_decodeTime(0.0)
+{
+
+}
+
+ProjectLoadThread::~ProjectLoadThread() {
+    wait();
+}
+
+void ProjectLoadThread::run() {
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file(m_filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Couldn't open file " + m_filename + ".";
+        return;
+    }
+    // the file is mapped instead of read completely, the blob section of a binary file
+    // is copied once, its payloads are decoded later by the blocks that need them:
+    const qint64 size = file.size();
+    const uchar* mapped = size > 0 ? file.map(0, size) : nullptr;
+    QByteArray content;
+    if (!mapped) {
+        content = file.readAll();
+    }
+    const char* data = mapped ? reinterpret_cast<const char*>(mapped) : content.constData();
+    const qint64 dataSize = mapped ? size : content.size();
+    m_readTime = timer.nsecsElapsed() / 1000000000.0;
+    timer.restart();
+
+    QJsonObject projectState;
+    QJsonArray blocks;
+    QJsonArray connections;
+    if (BinaryProjectFile::isBinary(data, dataSize)) {
+        QByteArray blobSection;
+        if (!BinaryProjectFile::read(data, dataSize, projectState, blocks, connections, blobSection)) {
+            qWarning() << "Binary project file could not be read:" << m_filename;
+            return;
+        }
+        m_blobSection = std::make_shared<const QByteArray>(blobSection);
+    } else {
+        QJsonParseError error;
+        const QJsonDocument document = QJsonDocument::fromJson(QByteArray::fromRawData(data, int(dataSize)), &error);
+        if (error.error != QJsonParseError::NoError) {
+            qWarning() << "Project file could not be parsed:" << error.errorString() << "at" << error.offset;
+            return;
+        }
+        projectState = document.object();
+        blocks = projectState["blocks"].toArray();
+        connections = projectState["connections"].toArray();
+    }
+    // the JSON values are independent of the file content from here on:
+    if (mapped) file.unmap(const_cast<uchar*>(mapped));
+    file.close();
+
+    m_blockStates.reserve(blocks.size());
+    for (const QJsonValue& blockState: blocks) {
+        m_blockStates.append(blockState.toObject());
+    }
+
+    m_connections.reserve(connections.size());
+    for (const QJsonValue& connection: connections) {
+        PendingConnection parsed;
+        if (!parseConnection(connection.toString(), parsed)) {
+            qWarning() << "Invalid connection in project file:" << connection.toString();
+            continue;
+        }
+        m_connections.append(parsed);
+    }
+
+    // the remaining settings are small, they are restored by the ProjectManager:
+    projectState.remove("blocks");
+    projectState.remove("connections");
+    m_projectState = projectState;
+    m_decodeTime = timer.nsecsElapsed() / 1000000000.0;
+}
+
+bool ProjectLoadThread::parseConnection(const QString& connection, PendingConnection& result) {
+    const int arrow = connection.indexOf("->");
+    if (arrow < 0) return false;
+    const int outputSeparator = connection.lastIndexOf('|', arrow);
+    const int inputSeparator = connection.indexOf('|', arrow + 2);
+    if (outputSeparator < 0 || inputSeparator < 0) return false;
+    bool outputOk, inputOk;
+    result.outputBlockUid = connection.left(outputSeparator);
+    result.outputNodeId = connection.midRef(outputSeparator + 1, arrow - outputSeparator - 1).toInt(&outputOk);
+    result.inputBlockUid = connection.mid(arrow + 2, inputSeparator - arrow - 2);
+    result.inputNodeId = connection.midRef(inputSeparator + 1).toInt(&inputOk);
+    return outputOk && inputOk;
+}
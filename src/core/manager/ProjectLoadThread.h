@@ -0,0 +1,110 @@
+#ifndef PROJECTLOADTHREAD_H
+#define PROJECTLOADTHREAD_H
+
+#include "BinaryProjectFile.h"
+
+#include <QJsonObject>
+#include <QThread>
+#include <QVector>
+#include <memory>
+
+
+/**
+ * @brief The PendingConnection struct is a connection between two nodes of a project file
+ * that is already split into its parts ("outBlock|outNode->inBlock|inNode").
+ */
+struct PendingConnection {
+    QString outputBlockUid;  //!< UID of the block with the output node
+    int outputNodeId;  //!< ID of the output node in its block
+    QString inputBlockUid;  //!< UID of the block with the input node
+    int inputNodeId;  //!< ID of the input node in its block
+};
+
+
+/**
+ * @brief The ProjectLoadThread class reads, parses and decodes a project file in the background.
+ *
+ * Only the parts that don't need the GUI thread are done here: reading the file, parsing
+ * the JSON document (or the sections of a binary file), extracting the block states and splitting the connection strings.
+ * The blocks themselves are QObjects that connect to the managers in their constructors,
+ * so they are still created by the ProjectManager on the GUI thread.
+ * The result can be retrieved after the finished() signal was emitted.
+ */
+class ProjectLoadThread : public QThread {
+
+    Q_OBJECT
+
+public:
+    /**
+     * @brief ProjectLoadThread creates the thread, it is not started
+     * @param filename path to the project file
+     * @param parent QObject parent
+     */
+    ProjectLoadThread(const QString& filename, QObject* parent);
+    ~ProjectLoadThread() override;
+
+    /**
+     * @brief isValid returns if the file could be read and contains a project,
+     * must only be called after the thread finished
+     * @return true if valid
+     */
+    bool isValid() const { return !m_projectState.isEmpty(); }
+
+    /**
+     * @brief getProjectState returns the project state without blocks and connections
+     * @return the project settings as a JSON object
+     */
+    const QJsonObject& getProjectState() const { return m_projectState; }
+
+    /**
+     * @brief getBlockStates returns the saved states of all blocks
+     * @return list of block states
+     */
+    const QVector<QJsonObject>& getBlockStates() const { return m_blockStates; }
+
+    /**
+     * @brief getConnections returns all connections of the project
+     * @return list of connections
+     */
+    const QVector<PendingConnection>& getConnections() const { return m_connections; }
+
+    /**
+     * @brief getBlobSection returns the raw payloads of a binary project file
+     * @return the blob section or nullptr for JSON files
+     */
+    std::shared_ptr<const QByteArray> getBlobSection() const { return m_blobSection; }
+
+    /**
+     * @brief getReadTime returns the time it took to read the file
+     * @return duration in seconds
+     */
+    double getReadTime() const { return m_readTime; }
+
+    /**
+     * @brief getDecodeTime returns the time it took to parse and decode the file
+     * @return duration in seconds
+     */
+    double getDecodeTime() const { return m_decodeTime; }
+
+protected:
+    void run() override;
+
+    /**
+     * @brief parseConnection splits a connection string
+     * @param connection string in the format "outBlock|outNode->inBlock|inNode"
+     * @param result the parsed connection
+     * @return true if the string is valid
+     */
+    static bool parseConnection(const QString& connection, PendingConnection& result);
+
+protected:
+    const QString m_filename;  //!< path to the project file
+    QJsonObject m_projectState;  //!< project settings, written by the thread
+    QVector<QJsonObject> m_blockStates;  //!< block states, written by the thread
+    QVector<PendingConnection> m_connections;  //!< connections, written by the thread
+    std::shared_ptr<const QByteArray> m_blobSection;  //!< payloads of a binary file, written by the thread
+    double m_readTime;  //!< time to read the file in s
+    double m_decodeTime;  //!< time to parse and decode the content in s
+};
+
+#endif // PROJECTLOADTHREAD_H
@@ -25,8 +25,12 @@
 #include "core/Nodes.h"
 #include "utils.h"
 
+#include <QDir>
+#include <QFile>
 #include <QFileInfo>
+#include <QJsonDocument>
 #include <QQuickWindow>
+#include <algorithm>
 
 
 // create a shorter alias for the constants namespace:
@@ -39,6 +43,19 @@ ProjectManager::ProjectManager(MainController* controller)
 	, m_controller(controller)
 	, m_currentProjectName("")
 	, m_loadingIsInProgress(false)
+    , m_loadThread(nullptr)
+    , m_loadAnimated(true)
+    , m_loadReadTime(0.0)
+    , m_loadDecodeTime(0.0)
+    , m_loadBlockTime(0.0)
+    , m_loadConnectionTime(0.0)
+    , m_saveThread(nullptr)
+    , m_lastSaveBlockCount(0)
+    , m_lastSaveSerializedCount(0)
+    , m_lastSaveSerializeTime(0.0)
+    , m_lastSaveEncodeTime(0.0)
+    , m_lastSaveWriteTime(0.0)
+    , m_lastSaveBytesWritten(0)
 {
 
 }
@@ -123,7 +140,7 @@ void ProjectManager::deleteProject(QString name) {
 }
 
 void ProjectManager::saveCurrentProject() {
-    saveStateAsProject(m_currentProjectName);
+    saveStateAsProject(m_currentProjectName, /*inBackground*/ true);
 }
 
 QJsonObject ProjectManager::getCurrentProjectState() const {
@@ -155,6 +172,11 @@ QJsonObject ProjectManager::getCurrentProjectState() const {
     }
     projectState["connections"] = connections;
 
+    writeProjectSettingsTo(projectState);
+    return projectState;
+}
+
+void ProjectManager::writeProjectSettingsTo(QJsonObject& projectState) const {
     // save anything else project related:
     QQuickItem* workspace = m_controller->guiManager()->getWorkspaceItem();
     const double dp = m_controller->guiManager()->getGuiScaling();
@@ -165,8 +187,17 @@ QJsonObject ProjectManager::getCurrentProjectState() const {
     projectState["anchors"] = m_controller->anchorManager()->getState();
     projectState["backgroundName"] = m_controller->guiManager()->getBackgroundName();
     projectState["midiMapping"] = m_controller->midiMapping()->getState();
+}
 
-    return projectState;
+QVariantMap ProjectManager::getSaveStatistics() const {
+    QVariantMap statistics;
+    statistics["blocks"] = m_lastSaveBlockCount;
+    statistics["serializedBlocks"] = m_lastSaveSerializedCount;
+    statistics["serializeMs"] = m_lastSaveSerializeTime * 1000;
+    statistics["encodeMs"] = m_lastSaveEncodeTime * 1000;
+    statistics["writeMs"] = m_lastSaveWriteTime * 1000;
+    statistics["bytesWritten"] = m_lastSaveBytesWritten;
+    return statistics;
 }
 
 void ProjectManager::reloadCurrentProject() {
@@ -222,9 +253,18 @@ void ProjectManager::exportCurrentProjectTo(QString filename) const {
         filename.append(PMC::fileEnding);
     }
     qDebug() << "Export project to " << filename;
-    if (!filename.isEmpty()) {
-        m_controller->dao()->exportFile(PMC::subdirectory, m_currentProjectName + PMC::fileEnding, filename);
+    if (filename.isEmpty()) return;
+    // the exported file uses the JSON format with inline payloads
+    // to be readable by other tools and older versions:
+    const QJsonObject projectState = getCurrentProjectState();
+    if (projectState.isEmpty()) return;
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Couldn't write to file " + filename + ": " << file.errorString();
+        return;
     }
+    file.write(QJsonDocument(projectState).toJson());
+    file.close();
 }
 
 QStringList ProjectManager::getFilenameFilters() const {
@@ -349,15 +389,42 @@ QStringList ProjectManager::getCombinations() const {
 
 void ProjectManager::loadProjectState(QString name, bool animated) {
     if (name.isEmpty()) return;
-    // try to load project file:
-	QJsonObject projectState = m_controller->dao()->loadJsonObject(PMC::subdirectory, name + PMC::fileEnding);
-	if (projectState.empty()) {
-		qWarning() << "Project file does not exist or is empty.";
-		return;
-	}
+    if (m_loadThread) return;  // already loading
+    // i.e. when the current project is reloaded directly after it was saved:
+    waitForPendingSave();
+    if (!m_controller->dao()->fileExists(PMC::subdirectory, name + PMC::fileEnding)) {
+        qWarning() << "Project file does not exist or is empty.";
+        return;
+    }
 
-    // project file exists -> start loading:
+    // the current project stays usable (but is not saved) while the file is parsed:
     m_loadingIsInProgress = true;
+    m_loadAnimated = animated;
+    m_loadStart = HighResTime::now();
+
+    const QString filename = m_controller->dao()->getDataDir(PMC::subdirectory) + name + PMC::fileEnding;
+    m_loadThread = new ProjectLoadThread(filename, this);
+    connect(m_loadThread, SIGNAL(finished()), this, SLOT(onProjectStateLoaded()));
+    m_loadThread->start();
+}
+
+void ProjectManager::onProjectStateLoaded() {
+    if (!m_loadThread) return;
+    ProjectLoadThread* thread = m_loadThread;
+    m_loadThread = nullptr;
+    thread->deleteLater();
+
+    if (!thread->isValid()) {
+        qWarning() << "Project file does not exist or is empty.";
+        m_loadingIsInProgress = false;
+        return;
+    }
+    const QJsonObject& projectState = thread->getProjectState();
+    m_loadReadTime = thread->getReadTime();
+    m_loadDecodeTime = thread->getDecodeTime();
+    m_loadBlockTime = 0.0;
+    m_loadConnectionTime = 0.0;
+    m_restoreCostByType.clear();
 
     // reset workspace:
     m_controller->blockManager()->deleteAllBlocks(/*immediate*/ true);  // TODO: reuse blocks with same UID
@@ -374,27 +441,41 @@ void ProjectManager::loadProjectState(QString name, bool animated) {
     // restoring the blocks often takes longer than one frame
     // to revent frames being skipped, the blocks are created in multiple chuncks
 
-    // copy block states to temporary member variable:
-    m_blocksToBeCreated.clear();
-	for (QJsonValueRef blockStateRef: projectState["blocks"].toArray()) {
-        m_blocksToBeCreated.append(blockStateRef.toObject());
-    }
-    // copy connections to be made after blocks have been created to memeber variable:
-    m_connectionsToBeMade = projectState["connections"].toArray();
+    // the block states and connections have already been decoded by the thread:
+    // payloads of a binary file are resolved by the blocks while they are restored:
+    m_blobs.setReadBuffer(thread->getBlobSection());
+    m_blocksToBeCreated = thread->getBlockStates();
+    m_connectionsToBeMade = thread->getConnections();
+    m_restoredBlocksByUid.clear();
+    m_restoredBlocksByUid.reserve(m_blocksToBeCreated.size());
+    m_savedBlockStates.clear();
 
     // create first chunk of blocks in the next frame (in 40ms)
-    QTimer::singleShot(40, [this, animated]() { this->createChunckOfBlocks(animated); } );
+    const bool animated = m_loadAnimated;
+    QTimer::singleShot(40, this, [this, animated]() { this->createChunckOfBlocks(animated); } );
 }
 
 void ProjectManager::createChunckOfBlocks(bool animated) {
-    // this is called with QTimer by loadProjectState() or previous createChunckOfBlocks() call
+    // this is called with QTimer by onProjectStateLoaded() or previous createChunckOfBlocks() call
     // try to create as many blocks as possible in the next 12 ms:
 
     HighResTime::time_point_t start = HighResTime::now();
+    HighResTime::time_point_t blockStart = start;
     BlockManager* blockManager = m_controller->blockManager();
     while (!m_blocksToBeCreated.isEmpty()) {
         QJsonObject blockState = m_blocksToBeCreated.takeLast();
-        blockManager->restoreBlock(blockState, animated);
+        m_blobs.setSegmentOffset(blockState["blobOffset"].toInt());
+        BlockInterface* block = blockManager->restoreBlock(blockState, animated);
+        if (block) {
+            m_restoredBlocksByUid.insert(block->getUid(), block);
+        }
+
+        // profile restore cost by block type:
+        const double duration = HighResTime::getElapsedSecAndUpdate(blockStart);
+        BlockRestoreCost& cost = m_restoreCostByType[blockState["name"].toString()];
+        cost.count += 1;
+        cost.totalTime += duration;
+        m_loadBlockTime += duration;
 
         if (HighResTime::elapsedSecSince(start) * 1000 > 12) {
             // 12ms are over, continue work in next frame:
@@ -407,7 +488,7 @@ void ProjectManager::createChunckOfBlocks(bool animated) {
         QTimer::singleShot(8, this, SLOT(completeProjectLoading()));
     } else {
         // there are still blocks to be created:
-        QTimer::singleShot(8, [this, animated]() { this->createChunckOfBlocks(animated); } );
+        QTimer::singleShot(8, this, [this, animated]() { this->createChunckOfBlocks(animated); } );
     }
 
 }
@@ -415,17 +496,22 @@ void ProjectManager::createChunckOfBlocks(bool animated) {
 void ProjectManager::completeProjectLoading() {
     // this is called after all blocks have been created by createChunckOfBlocks()
     // restore block connections:
-    BlockManager* blockManager = m_controller->blockManager();
-    for (QJsonValueRef connectionRef: m_connectionsToBeMade) {
-        QString connection = connectionRef.toString();
-        QString outputUid = connection.split("->").at(0);
-        QString inputUid = connection.split("->").at(1);
-        NodeBase* outputNode = blockManager->getNodeByUid(outputUid);
-        NodeBase* inputNode = blockManager->getNodeByUid(inputUid);
+    HighResTime::time_point_t start = HighResTime::now();
+    for (const PendingConnection& connection: m_connectionsToBeMade) {
+        BlockInterface* outputBlock = m_restoredBlocksByUid.value(connection.outputBlockUid);
+        BlockInterface* inputBlock = m_restoredBlocksByUid.value(connection.inputBlockUid);
+        if (!outputBlock || !inputBlock) continue;
+        NodeBase* outputNode = outputBlock->getNodeById(connection.outputNodeId);
+        NodeBase* inputNode = inputBlock->getNodeById(connection.inputNodeId);
         if (outputNode && inputNode) {
             outputNode->connectTo(inputNode);
         }
     }
+    m_connectionsToBeMade.clear();
+    m_restoredBlocksByUid.clear();
+    // blocks that didn't decode their payloads yet keep their own reference to it:
+    m_blobs.setReadBuffer(nullptr);
+    m_loadConnectionTime = HighResTime::elapsedSecSince(start);
 
     emit projectLoadingFinished();
 
@@ -438,6 +524,8 @@ void ProjectManager::completeProjectLoading() {
     }
     // update group label at the top:
     emit m_controller->blockManager()->displayedGroupChanged();
+
+    logLoadProfile();
 }
 
 void ProjectManager::releaseLoadingStateAfter(int ms) {
@@ -446,15 +534,90 @@ void ProjectManager::releaseLoadingStateAfter(int ms) {
     QTimer::singleShot(ms, [this]() { this->m_loadingIsInProgress = false; } );
 }
 
-void ProjectManager::saveStateAsProject(QString name) const {
+void ProjectManager::saveStateAsProject(QString name, bool inBackground) {
 	if (name.isEmpty()) return;
 	// saving the state is only allowed if previous loading is completed:
 	if (m_loadingIsInProgress) return;
+    // files are written in the order they were saved:
+    waitForPendingSave();
+
+    HighResTime::time_point_t start = HighResTime::now();
+    QJsonObject projectState;
+    projectState["version"] = ProjectManagerConstants::formatVersion;
+    projectState["fileName"] = m_currentProjectName;
 
-    QJsonObject projectState = getCurrentProjectState();
+    // only the blocks that changed since the last save are serialized again,
+    // large payloads of the blocks are collected in the blob section:
+    m_blobs.beginWriting();
+    QJsonArray blocks;
+    QJsonArray connections;
+    QHash<QString, SavedBlockState> savedBlockStates;
+    int serializedCount = 0;
+    BlockManager* blockManager = m_controller->blockManager();
+    for (BlockInterface* block: blockManager->getCurrentBlocks()) {
+        SavedBlockState saved = m_savedBlockStates.take(block->getUid());
+        if (block->stateIsDirty() || saved.internalState.isEmpty()) {
+            saved.internalState = block->getState();
+            saved.blobSegment = m_blobs.takeSegment();
+            saved.connections = block->getConnections();
+            block->markStateSaved();
+            ++serializedCount;
+        }
+        QJsonObject blockState = blockManager->getBlockState(block, saved.internalState);
+        if (!saved.blobSegment.isEmpty()) {
+            blockState["blobOffset"] = m_blobs.appendSegment(saved.blobSegment);
+        }
+        blocks.append(blockState);
+        for (const QJsonValue& connection: saved.connections) {
+            connections.append(connection);
+        }
+        savedBlockStates.insert(block->getUid(), saved);
+    }
+    // states of deleted blocks are dropped:
+    m_savedBlockStates.swap(savedBlockStates);
+    projectState["blocks"] = blocks;
+    projectState["connections"] = connections;
+    writeProjectSettingsTo(projectState);
+    const QByteArray blobSection = m_blobs.endWriting();
+
+    m_lastSaveBlockCount = blocks.size();
+    m_lastSaveSerializedCount = serializedCount;
+    m_lastSaveSerializeTime = HighResTime::elapsedSecSince(start);
+
+	// encode and write file in the background:
+    QDir().mkpath(m_controller->dao()->getDataDir(PMC::subdirectory));
+    const QString filename = m_controller->dao()->getDataDir(PMC::subdirectory) + name + PMC::fileEnding;
+    m_saveThread = new ProjectSaveThread(filename, projectState, blobSection, this);
+    connect(m_saveThread, SIGNAL(finished()), this, SLOT(onProjectSaved()));
+    m_saveThread->start();
+    if (!inBackground) {
+        waitForPendingSave();
+    }
+}
+
+void ProjectManager::waitForPendingSave() {
+    if (!m_saveThread) return;
+    m_saveThread->wait();
+    onProjectSaved();
+}
 
-	// write file to file system:
-	m_controller->dao()->saveFile(PMC::subdirectory, name + PMC::fileEnding, projectState);
+void ProjectManager::onProjectSaved() {
+    // the finished() signal of a thread that was already handled by waitForPendingSave()
+    // may arrive after the next save started:
+    if (sender() && sender() != m_saveThread) return;
+    if (!m_saveThread) return;
+    ProjectSaveThread* thread = m_saveThread;
+    m_saveThread = nullptr;
+    thread->deleteLater();
+
+    if (!thread->wasSuccessful()) {
+        // write everything again next time:
+        m_savedBlockStates.clear();
+        return;
+    }
+    m_lastSaveEncodeTime = thread->getEncodeTime();
+    m_lastSaveWriteTime = thread->getWriteTime();
+    m_lastSaveBytesWritten = thread->getBytesWritten();
 }
 
 QString ProjectManager::correctCaseIfPossible(QString name) const {
@@ -467,3 +630,24 @@ QString ProjectManager::correctCaseIfPossible(QString name) const {
 	return name;
 
 }
+
+void ProjectManager::logLoadProfile() const {
+    int blockCount = 0;
+    for (const BlockRestoreCost& cost: m_restoreCostByType) {
+        blockCount += cost.count;
+    }
+    qInfo() << "Project" << m_currentProjectName << "loaded in" << HighResTime::elapsedSecSince(m_loadStart) << "s:"
+            << "read" << m_loadReadTime << "s, parse" << m_loadDecodeTime << "s (background),"
+            << blockCount << "blocks" << m_loadBlockTime << "s, connections" << m_loadConnectionTime << "s";
+
+    // block types sorted by total restore cost:
+    QVector<QString> blockTypes = m_restoreCostByType.keys().toVector();
+    std::sort(blockTypes.begin(), blockTypes.end(), [this](const QString& a, const QString& b) {
+        return m_restoreCostByType[a].totalTime > m_restoreCostByType[b].totalTime;
+    });
+    for (int i = 0; i < blockTypes.size() && i < PMC::profiledBlockTypeCount; ++i) {
+        const BlockRestoreCost& cost = m_restoreCostByType[blockTypes[i]];
+        qInfo() << "  " << blockTypes[i] << ":" << cost.count << "x," << cost.totalTime * 1000 << "ms total,"
+                << cost.totalTime * 1000 / cost.count << "ms each";
+    }
+}
@@ -21,14 +21,23 @@
 #ifndef PROJECTMANAGER_H
 #define PROJECTMANAGER_H
 
+#include "BinaryProjectFile.h"
+#include "ProjectLoadThread.h"
+#include "ProjectSaveThread.h"
+#include "utils.h"
+
 #include <QObject>
 #include <QVector>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QTimer>
+#include <QHash>
+#include <QPointer>
+#include <QVariantMap>
 
 // forward declaration to prevent dependency loop
 class MainController;
+class BlockInterface;
 
 /**
  * @brief The ProjectManagerConstants namespace contains all constants used in ProjectManager.
@@ -58,8 +67,31 @@ namespace ProjectManagerConstants {
 	 * @brief defaultProjectName is the name of the default project (i.e. that is created on first start)
 	 */
 	static const QString defaultProjectName = "default";
+    /**
+     * @brief profiledBlockTypeCount is the number of block types with the highest restore cost
+     * that are logged after a project has been loaded
+     */
+    static const int profiledBlockTypeCount = 10;
 }
 
+/**
+ * @brief The BlockRestoreCost struct sums up the time it took to restore blocks of one type.
+ */
+struct BlockRestoreCost {
+    int count;  //!< number of restored blocks
+    double totalTime;  //!< sum of the restore durations in s
+};
+
+/**
+ * @brief The SavedBlockState struct is the serialized state of a block when the project was
+ * saved the last time, it is reused as long as the state of the block is not dirty.
+ */
+struct SavedBlockState {
+    QJsonObject internalState;  //!< result of BlockInterface::getState()
+    QJsonArray connections;  //!< result of BlockInterface::getConnections()
+    QByteArray blobSegment;  //!< payloads referenced by internalState
+};
+
 /**
  * @brief The ProjectManager class is responsible for loading and saving projects.
  */
@@ -80,6 +112,13 @@ public:
 
     friend class MidiMappingManager;  // TODO: why is this required?
 
+    /**
+     * @brief blobs returns the store of the raw payloads of the binary project format,
+     * used by blocks with large data in getAdditionalState() and setAdditionalState()
+     * @return the blob store
+     */
+    ProjectBlobStore* blobs() { return &m_blobs; }
+
 signals:
 	/**
 	 * @brief projectChanged emitted when the currently loaded project changed
@@ -144,6 +183,12 @@ public slots:
      */
     QJsonObject getCurrentProjectState() const;
 
+    /**
+     * @brief getSaveStatistics returns the durations and the size of the last save
+     * @return statistics as a QVariantMap
+     */
+    QVariantMap getSaveStatistics() const;
+
     /**
      * @brief reloadCurrentProject reloads the current project from file without saving it before that
      */
@@ -163,7 +208,7 @@ public slots:
 	QStringList getProjectList() const;
 
     /**
-     * @brief importProjectFile imports a JSON project file from the filesystem to the app data dir
+     * @brief importProjectFile imports a project file (binary or JSON) from the filesystem to the app data dir
      * @param filename path to the file
      * @param load true to instantly load the imported file (default = true)
      * @param overwrite true to overwrite projects with the same name (default = true)
@@ -206,13 +251,20 @@ public slots:
 private slots:
 	/**
 	 * @brief loadProjectState loads a project from a file (internal, use setCurrentProject() instead)
-     * Never call this with a signal from a block involved! (It deletes blocks immediately and
-     * pending signals from blocks will lead to a crash.)
+	 * the file is read and parsed in a ProjectLoadThread, onProjectStateLoaded() continues afterwards
 	 * @param name of the project (filename without fileending)
 	 * @param animated true to animate the loading of the blocks
 	 */
 	void loadProjectState(QString name, bool animated = true);
 
+    /**
+     * @brief onProjectStateLoaded called when the ProjectLoadThread finished, replaces the current
+     * blocks and starts to create the blocks of the loaded project
+     * Never call this with a signal from a block involved! (It deletes blocks immediately and
+     * pending signals from blocks will lead to a crash.)
+     */
+    void onProjectStateLoaded();
+
     /**
      * @brief createChunckOfBlocks creates as much blocks from m_blocksToBeCreated as possible
      * in 12ms, the remaining blocks are created in the next chunk
@@ -225,6 +277,11 @@ private slots:
      */
     void completeProjectLoading();
 
+    /**
+     * @brief onProjectSaved called when the ProjectSaveThread finished, updates the save statistics
+     */
+    void onProjectSaved();
+
 	/**
 	 * @brief setLoadingStateFor activates the "loading state" for a given number of milliseconds
 	 *  - the "loading state" prevents other projects from being saved or loaded
@@ -236,9 +293,29 @@ private:
 	/**
 	 * @brief saveStateAsProject saves the current state in a project file
 	 * (internal, use saveCurrentProject() instead)
+     * Only the blocks with a dirty state are serialized again, the file is written by a ProjectSaveThread.
 	 * @param name of the project (filename without fileending)
+     * @param inBackground true to return before the file is written (i.e. for autosave),
+     * otherwise the file exists when this function returns
 	 */
-	void saveStateAsProject(QString name) const;
+    void saveStateAsProject(QString name, bool inBackground = false);
+
+    /**
+     * @brief writeProjectSettingsTo writes everything project related except blocks and connections
+     * @param projectState JSON object to write to
+     */
+    void writeProjectSettingsTo(QJsonObject& projectState) const;
+
+    /**
+     * @brief waitForPendingSave blocks until a file that is written in the background is complete
+     */
+    void waitForPendingSave();
+
+    /**
+     * @brief logLoadProfile logs the durations of the loading steps and
+     * the block types with the highest restore cost
+     */
+    void logLoadProfile() const;
 
 	/**
 	 * @brief correctCaseIfPossible tries to find an existing project with the same letters as
@@ -276,7 +353,55 @@ protected:
      * @brief m_connectionsToBeMade list of connections to be made as soon as all blocks in
      * m_blocksToBeCreated have been created
      */
-    QJsonArray m_connectionsToBeMade;
+    QVector<PendingConnection> m_connectionsToBeMade;
+
+    /**
+     * @brief m_restoredBlocksByUid index of the blocks created while loading a project,
+     * used to resolve m_connectionsToBeMade
+     */
+    QHash<QString, QPointer<BlockInterface>> m_restoredBlocksByUid;
+
+    /**
+     * @brief m_loadThread reads and parses the project file that is currently loaded
+     */
+    QPointer<ProjectLoadThread> m_loadThread;
+
+    /**
+     * @brief m_blobs collects the payloads while a project is saved and resolves them while
+     * it is loaded
+     */
+    ProjectBlobStore m_blobs;
+
+    /**
+     * @brief m_saveThread writes the project file in the background
+     */
+    QPointer<ProjectSaveThread> m_saveThread;
+
+    /**
+     * @brief m_savedBlockStates the serialized states of the blocks at the last save by UID
+     */
+    QHash<QString, SavedBlockState> m_savedBlockStates;
+
+    // ------------- save statistics:
+    int m_lastSaveBlockCount;  //!< number of blocks in the last saved project
+    int m_lastSaveSerializedCount;  //!< number of blocks that were serialized again
+    double m_lastSaveSerializeTime;  //!< time to collect the state on the GUI thread in s
+    double m_lastSaveEncodeTime;  //!< time to create the file content in the background in s
+    double m_lastSaveWriteTime;  //!< time to write and sync the file in the background in s
+    qint64 m_lastSaveBytesWritten;  //!< size of the last saved file
+
+    /**
+     * @brief m_loadAnimated true if the creation of the blocks that are currently loaded should be animated
+     */
+    bool m_loadAnimated;
+
+    // ------------- load profile:
+    HighResTime::time_point_t m_loadStart;  //!< time when loadProjectState() was called
+    double m_loadReadTime;  //!< time to read the file in the background in s
+    double m_loadDecodeTime;  //!< time to parse the file in the background in s
+    double m_loadBlockTime;  //!< sum of the time to restore blocks in s
+    double m_loadConnectionTime;  //!< time to restore the connections in s
+    QHash<QString, BlockRestoreCost> m_restoreCostByType;  //!< restore cost of each block type
 
 };
 
@@ -0,0 +1,51 @@
+#include "ProjectSaveThread.h"
+
+#include "BinaryProjectFile.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QSaveFile>
+
+
+ProjectSaveThread::ProjectSaveThread(const QString& filename, const QJsonObject& projectState,
+                                     const QByteArray& blobSection, QObject* parent)
+    : QThread(parent)
+    , m_filename(filename)
+    , m_projectState(projectState)
+    , m_blobSection(blobSection)
+    , m_success(false)
+    , m_bytesWritten(0)
+    , m_encodeTime(0.0)
+    , m_writeTime(0.0)
+{
+
+}
+
+ProjectSaveThread::~ProjectSaveThread() {
+    wait();
+}
+
+void ProjectSaveThread::run() {
+    QElapsedTimer timer;
+    timer.start();
+
+    const QByteArray content = BinaryProjectFile::write(m_projectState, m_blobSection);
+    m_encodeTime = timer.nsecsElapsed() / 1000000000.0;
+    timer.restart();
+
+    // QSaveFile writes to a temporary file, commit() syncs it to disk
+    // and atomically replaces the project file with it:
+    QSaveFile file(m_filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Couldn't write to file " + m_filename + ": " << file.errorString();
+        return;
+    }
+    file.write(content);
+    if (!file.commit()) {
+        qWarning() << "Couldn't save project file " + m_filename + ": " << file.errorString();
+        return;
+    }
+    m_writeTime = timer.nsecsElapsed() / 1000000000.0;
+    m_bytesWritten = content.size();
+    m_success = true;
+}
@@ -0,0 +1,78 @@
+#ifndef PROJECTSAVETHREAD_H
+#define PROJECTSAVETHREAD_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QThread>
+
+
+/**
+ * @brief The ProjectSaveThread class encodes and writes a project file in the background.
+ *
+ * The project state is collected by the ProjectManager on the GUI thread, this thread creates
+ * the binary file content, writes it to a temporary file, flushes it to disk and renames it
+ * to the project file. This way the project file is always complete, even if the app crashes
+ * while saving.
+ * The result can be retrieved after the finished() signal was emitted.
+ */
+class ProjectSaveThread : public QThread {
+
+    Q_OBJECT
+
+public:
+    /**
+     * @brief ProjectSaveThread creates the thread, it is not started
+     * @param filename path to the project file
+     * @param projectState the project state including blocks and connections
+     * @param blobSection payloads referenced by the block states
+     * @param parent QObject parent
+     */
+    ProjectSaveThread(const QString& filename, const QJsonObject& projectState,
+                      const QByteArray& blobSection, QObject* parent);
+    ~ProjectSaveThread() override;
+
+    /**
+     * @brief getFilename returns the path of the file that is written
+     * @return path to the project file
+     */
+    const QString& getFilename() const { return m_filename; }
+
+    /**
+     * @brief wasSuccessful returns if the file was written completely,
+     * must only be called after the thread finished
+     * @return true if successful
+     */
+    bool wasSuccessful() const { return m_success; }
+
+    /**
+     * @brief getBytesWritten returns the size of the written file
+     * @return size in bytes
+     */
+    qint64 getBytesWritten() const { return m_bytesWritten; }
+
+    /**
+     * @brief getEncodeTime returns the time it took to create the file content
+     * @return duration in seconds
+     */
+    double getEncodeTime() const { return m_encodeTime; }
+
+    /**
+     * @brief getWriteTime returns the time it took to write, flush and rename the file
+     * @return duration in seconds
+     */
+    double getWriteTime() const { return m_writeTime; }
+
+protected:
+    void run() override;
+
+protected:
+    const QString m_filename;  //!< path to the project file
+    const QJsonObject m_projectState;  //!< state to write
+    const QByteArray m_blobSection;  //!< payloads to write
+    bool m_success;  //!< true if the file was written, written by the thread
+    qint64 m_bytesWritten;  //!< size of the file, written by the thread
+    double m_encodeTime;  //!< time to create the file content in s
+    double m_writeTime;  //!< time to write the file in s
+};
+
+#endif // PROJECTSAVETHREAD_H
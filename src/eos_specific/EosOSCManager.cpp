@@ -21,8 +21,9 @@ EosOSCManager::EosOSCManager(MainController* controller)
 {
     connect(m_controller->lightingConsole(), SIGNAL(isConnectedChanged()),
             this, SLOT(onConnectionChanged()));
-    connect(m_controller->lightingConsole(), SIGNAL(messageReceived(OSCMessage)),
-            this, SLOT(onIncomingMessage(OSCMessage)));
+    auto handler = [this](const OSCMessageView& view) { onIncomingMessageView(view); };
+    m_controller->lightingConsole()->dispatcher()->addHandler("/eos/out/**", this, handler);
+    m_controller->lightingConsole()->dispatcher()->addHandler("/eos/fader/**", this, handler);
 
     m_startTime = HighResTime::now();
     m_latencyTimeout.setSingleShot(true);
@@ -45,6 +46,12 @@ void EosOSCManager::OSCDiscoveryClientClient_Found(const OSCDiscoveryClient::sDi
     emit discoveredConsolesChanged();
 }
 
+void EosOSCManager::onIncomingMessageView(const OSCMessageView& view) {
+    // the dispatcher only passes messages starting with /eos/out/ or /eos/fader/:
+    if (m_controller->lightingConsole()->getCurrentType() != OscConnectionType::Eos) return;
+    onIncomingMessage(view.toMessage());
+}
+
 void EosOSCManager::onIncomingMessage(const OSCMessage& msg) {
     if (m_controller->lightingConsole()->getCurrentType() != OscConnectionType::Eos) return;
     // all Eos message start with /eos/out/ except fader feedback messages:
@@ -3,6 +3,7 @@
 
 #include "eos_specific/EosOSCMessage.h"
 #include "osc/OSCMessage.h"
+#include "osc/OSCMessageView.h"
 #include "EosCue.h"
 #include "OSCDiscovery.h"
 #include "utils.h"
@@ -114,6 +115,13 @@ public slots:
      */
     void onIncomingMessage(const OSCMessage& msg);
 
+    /**
+     * @brief onIncomingMessageView converts an Eos message received by the dispatcher
+     * to an OSCMessage and passes it to onIncomingMessage()
+     * @param view the OSC message view
+     */
+    void onIncomingMessageView(const OSCMessageView& view);
+
     /**
      * @brief onIncomingEosMessage checks if an incoming Eos OSC message contains general information
      * @param msg the Eos OSC message
@@ -9,15 +9,15 @@ HogOSCManager::HogOSCManager(MainController* controller)
 {
     connect(m_controller->lightingConsole(), SIGNAL(isConnectedChanged()),
             this, SLOT(onConnectionChanged()));
-    connect(m_controller->lightingConsole(), SIGNAL(messageReceived(OSCMessage)),
-            this, SLOT(onIncomingMessage(OSCMessage)));
+    m_controller->lightingConsole()->dispatcher()->addHandler("/hog/status/time/**", this,
+            [this](const OSCMessageView& view) { onIncomingMessage(view); });
 
     m_connectionTimeout.setSingleShot(true);
     m_connectionTimeout.setInterval(HogOSCManagerConstants::connectionTimeout);
     connect(&m_connectionTimeout, SIGNAL(timeout()), this, SLOT(onConnectionTimeout()));
 }
 
-void HogOSCManager::onIncomingMessage(const OSCMessage& msg) {
+void HogOSCManager::onIncomingMessage(const OSCMessageView& msg) {
     if (m_controller->lightingConsole()->getCurrentType() != OscConnectionType::Hog4) return;
     if (msg.pathStartsWith("/hog/status/time")) {
         if (!m_isConnected) {
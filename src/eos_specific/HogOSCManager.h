@@ -1,7 +1,7 @@
 #ifndef HOGOSCMANAGER_H
 #define HOGOSCMANAGER_H
 
-#include "osc/OSCMessage.h"
+#include "osc/OSCMessageView.h"
 #include "utils.h"
 
 #include <QObject>
@@ -46,7 +46,7 @@ public slots:
      * @brief onIncomingMessage check if an incoming OSC message is an Hog OSC message
      * @param msg the OSC message
      */
-    void onIncomingMessage(const OSCMessage& msg);
+    void onIncomingMessage(const OSCMessageView& msg);
 
     /**
      * @brief onConnectionChanged requests initial information when a connection was established
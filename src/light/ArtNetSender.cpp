@@ -7,6 +7,7 @@
 
 
 const int ARTNET_PORT = 6454;
+const int ARTNET_MAX_PORT_ADDRESS = 0x7fff;
 
 inline uint8_t lowByte(uint16_t value) {
     return uint8_t(value & 0xff);
@@ -16,96 +17,116 @@ inline uint8_t highByte(uint16_t value) {
     return uint8_t(value >> 8);
 }
 
+// the 15 bit Port-Address consists of net (7 bit), subnet (4 bit) and universe (4 bit),
+// universes beyond 15 continue in the next subnet:
+inline int getPortAddress(int net, int subnet, int universe) {
+    return (net << 8 | subnet << 4) + universe;
+}
+
 
 ArtNetSubnetSender::ArtNetSubnetSender(int net, int subnet)
-    : m_sequenceNumber(0)
+    : m_net(0)
+    , m_subnet(0)
+    , m_port(ARTNET_PORT)
 {
-    preparePackets(net, subnet);
+    setNetAndSubnet(net, subnet);
+    // at least the universes of one subnet are always prepared:
+    setUniverseCount(16);
 }
 
 void ArtNetSubnetSender::setNetAndSubnet(int net, int subnet) {
-    preparePackets(net, subnet);
+    m_net = limit(0, net, 127);
+    m_subnet = limit(0, subnet, 15);
+    for (int universe = 0; universe < m_preparedPackets.size(); ++universe) {
+        preparePacket(universe);
+    }
+}
+
+void ArtNetSubnetSender::setUniverseCount(int count) {
+    count = qMax(0, count);
+    const int oldCount = m_preparedPackets.size();
+    if (count == oldCount) return;
+    m_preparedPackets.resize(count);
+    m_sequenceNumbers.resize(count);
+
+    // only build the packets of the new universes:
+    for (int universe = oldCount; universe < count; ++universe) {
+        preparePacket(universe);
+    }
 }
 
 void ArtNetSubnetSender::sendUniverseBroadcast(int universe, const QVector<uint8_t>& data) {
-    Q_ASSERT_X(universe <= 15, "ArtNetSubnetSender::sendUniverse", "Universe number too large");
+    Q_ASSERT_X(universe < m_preparedPackets.size(), "ArtNetSubnetSender::sendUniverse", "Universe number too large");
     Q_ASSERT_X(universe >= 0, "ArtNetSubnetSender::sendUniverse", "Universe number too small");
     Q_ASSERT_X(data.size() == 512, "ArtNetSubnetSender::sendUniverse", "data has not length 512");
+    if (getPortAddress(m_net, m_subnet, universe) > ARTNET_MAX_PORT_ADDRESS) return;
 
-    QVector<uint8_t>& universePacket = m_preparedPackets[universe];
-
-    // fill raw DMX data in prepared packet:
-    std::copy(data.begin(), data.end(), universePacket.begin() + 18);
-    // set sequence number:
-    universePacket[12] = m_sequenceNumber;
-    m_sequenceNumber = (m_sequenceNumber + 1) % 256;
+    const QVector<uint8_t>& universePacket = fillPacket(universe, data);
 
     // send prepared packet with filled in data via UDP socket:
     const char* packet = reinterpret_cast<const char*>(universePacket.constData());
-    m_udpSocket.writeDatagram(packet, 18+512, QHostAddress::Broadcast, ARTNET_PORT);
+    m_udpSocket.writeDatagram(packet, 18+512, QHostAddress::Broadcast, m_port);
 }
 
 void ArtNetSubnetSender::sendUniverseUnicast(int universe, const QVector<uint8_t>& data, const QVector<QHostAddress>& addresses) {
-    Q_ASSERT_X(universe <= 15, "ArtNetSubnetSender::sendUniverse", "Universe number too large");
+    Q_ASSERT_X(universe < m_preparedPackets.size(), "ArtNetSubnetSender::sendUniverse", "Universe number too large");
     Q_ASSERT_X(universe >= 0, "ArtNetSubnetSender::sendUniverse", "Universe number too small");
     Q_ASSERT_X(data.size() == 512, "ArtNetSubnetSender::sendUniverse", "data has not length 512");
+    if (getPortAddress(m_net, m_subnet, universe) > ARTNET_MAX_PORT_ADDRESS) return;
 
-    QVector<uint8_t>& universePacket = m_preparedPackets[universe];
-
-    // fill raw DMX data in prepared packet:
-    std::copy(data.begin(), data.end(), universePacket.begin() + 18);
-    // set sequence number:
-    universePacket[12] = m_sequenceNumber;
-    m_sequenceNumber = (m_sequenceNumber + 1) % 256;
+    const QVector<uint8_t>& universePacket = fillPacket(universe, data);
 
     // send prepared packet with filled in data via UDP socket:
     const char* packet = reinterpret_cast<const char*>(universePacket.constData());
 
     for (const QHostAddress& address: addresses) {
-        m_udpSocket.writeDatagram(packet, 18+512, address, ARTNET_PORT);
+        m_udpSocket.writeDatagram(packet, 18+512, address, m_port);
     }
 }
 
-void ArtNetSubnetSender::preparePackets(int net, int subnet) {
-    net = limit(0, net, 127);
-    subnet = limit(0, subnet, 15);
-
-    // each subnet has 16 universes:
-    m_preparedPackets.resize(16);
-
-    // iterate over all these universes:
-    for (int universe = 0; universe < 16; ++universe) {
-        QVector<uint8_t>& universePacket = m_preparedPackets[universe];
-        // the packet for each universe has a length of 18 + 512 bytes:
-        universePacket.resize(530);
-
-        uint16_t address = uint16_t(net << 8 | subnet << 4 | universe);
-
-        // packet starts with specific string:
-        universePacket[0] = 'A';
-        universePacket[1] = 'r';
-        universePacket[2] = 't';
-        universePacket[3] = '-';
-        universePacket[4] = 'N';
-        universePacket[5] = 'e';
-        universePacket[6] = 't';
-        universePacket[7] = 0;
-        // OPCODE for ArtDMX packet
-        universePacket[8] = 0x00; // OpCode Low Byte as per spec
-        universePacket[9] = 0x50; // OpCode High Byte as per spec
-        // VERSION
-        universePacket[10] = 0; // ver High
-        universePacket[11] = 14; // ver Low
-        // universePacket[12] is sequence number
-        // PHYSICAL PORT
-        universePacket[13] = 1;
-        // ADDRESS
-        universePacket[14] = lowByte(address); // address low byte first
-        universePacket[15] = highByte(address); // address high byte
-        // DMX LENGTH
-        universePacket[16] = highByte(512); // HI Byte
-        universePacket[17] = lowByte(512); // LOW Byte
-
-        // the rest of the message (18-530) is the raw DMX data and is filled later
-    }
+const QVector<uint8_t>& ArtNetSubnetSender::fillPacket(int universe, const QVector<uint8_t>& data) {
+    QVector<uint8_t>& universePacket = m_preparedPackets[universe];
+
+    // fill raw DMX data in prepared packet:
+    std::copy(data.begin(), data.end(), universePacket.begin() + 18);
+    // set sequence number (0 disables sequencing, so it is skipped):
+    uint8_t& sequenceNumber = m_sequenceNumbers[universe];
+    sequenceNumber = uint8_t(sequenceNumber % 255 + 1);
+    universePacket[12] = sequenceNumber;
+    return universePacket;
+}
+
+void ArtNetSubnetSender::preparePacket(int universe) {
+    QVector<uint8_t>& universePacket = m_preparedPackets[universe];
+    // the packet for each universe has a length of 18 + 512 bytes:
+    universePacket.resize(530);
+
+    uint16_t address = uint16_t(qMin(getPortAddress(m_net, m_subnet, universe), ARTNET_MAX_PORT_ADDRESS));
+
+    // packet starts with specific string:
+    universePacket[0] = 'A';
+    universePacket[1] = 'r';
+    universePacket[2] = 't';
+    universePacket[3] = '-';
+    universePacket[4] = 'N';
+    universePacket[5] = 'e';
+    universePacket[6] = 't';
+    universePacket[7] = 0;
+    // OPCODE for ArtDMX packet
+    universePacket[8] = 0x00; // OpCode Low Byte as per spec
+    universePacket[9] = 0x50; // OpCode High Byte as per spec
+    // VERSION
+    universePacket[10] = 0; // ver High
+    universePacket[11] = 14; // ver Low
+    // universePacket[12] is sequence number
+    // PHYSICAL PORT
+    universePacket[13] = 1;
+    // ADDRESS
+    universePacket[14] = lowByte(address); // address low byte first
+    universePacket[15] = highByte(address); // address high byte
+    // DMX LENGTH
+    universePacket[16] = highByte(512); // HI Byte
+    universePacket[17] = lowByte(512); // LOW Byte
+
+    // the rest of the message (18-530) is the raw DMX data and is filled later
 }
@@ -7,6 +7,12 @@
 #include <QObject>
 
 
+/**
+ * @brief The ArtNetSubnetSender class sends ArtDmx packets for consecutive universes beginning
+ * at the first universe of the given net and subnet.
+ *
+ * Universes beyond the 16th continue in the following subnets (and nets).
+ */
 class ArtNetSubnetSender
 {
 
@@ -15,18 +21,41 @@ public:
 
     void setNetAndSubnet(int net, int subnet);
 
+    /**
+     * @brief setUniverseCount prepares the packets for the given number of consecutive universes
+     * (existing packets are kept, only the new ones are built)
+     * @param count number of universes beginning with the first universe of the subnet
+     */
+    void setUniverseCount(int count);
+
+    int getUniverseCount() const { return m_preparedPackets.size(); }
+
+    /**
+     * @brief setPort changes the UDP destination port (i.e. to send to a local receiver)
+     * @param port UDP port, default is the Art-Net port 6454
+     */
+    void setPort(quint16 port) { m_port = port; }
+
     void sendUniverseBroadcast(int universe, const QVector<uint8_t>& data);
 
     void sendUniverseUnicast(int universe, const QVector<uint8_t>& data, const QVector<QHostAddress>& addresses);
 
 private:
-    void preparePackets(int net, int subnet);
+    void preparePacket(int universe);
+
+    /**
+     * @brief fillPacket writes the DMX data and the sequence number into the prepared packet
+     * @return the packet ready to be sent
+     */
+    const QVector<uint8_t>& fillPacket(int universe, const QVector<uint8_t>& data);
 
 protected:
-    uint8_t m_sequenceNumber;
+    QVector<uint8_t> m_sequenceNumbers;
     QVector<QVector<uint8_t>> m_preparedPackets;
     QUdpSocket m_udpSocket;
+    int m_net;
+    int m_subnet;
+    quint16 m_port;
 };
 
 #endif // ARTNETSENDER_H
-
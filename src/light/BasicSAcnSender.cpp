@@ -7,6 +7,7 @@
 
 
 const int SACN_PORT = 5568;
+const int SACN_MAX_UNIVERSE = 63999;
 
 inline uint8_t lowByte(uint16_t value) {
     return uint8_t(value & 0xff);
@@ -29,16 +30,16 @@ inline QByteArray lengthAsLow12(int i) {
 
 
 SAcnSender::SAcnSender(int startUniverse, int priority)
-    : m_sequenceNumber(0)
-    , m_startUniverse(startUniverse)
+    : m_startUniverse(startUniverse)
     , m_priority(priority)
+    , m_port(SACN_PORT)
     , m_uuid(QUuid::createUuid())
 {
     preparePackets();
 }
 
 void SAcnSender::setStartUniverse(int startUniverse) {
-    m_startUniverse = limit(1, startUniverse, 63999 - 16);
+    m_startUniverse = limit(1, startUniverse, SACN_MAX_UNIVERSE);
     preparePackets();
 }
 
@@ -47,122 +48,140 @@ void SAcnSender::setPriority(int priority) {
     preparePackets();
 }
 
+void SAcnSender::setUniverseCount(int count) {
+    count = qMax(0, count);
+    const int oldCount = m_preparedPackets.size();
+    if (count == oldCount) return;
+    m_preparedPackets.resize(count);
+    m_multicastAddresses.resize(count);
+    // each universe has its own sequence number (E1.31 6.7.2):
+    m_sequenceNumbers.resize(count);
+
+    // only build the packets of the new universes:
+    for (int universe = oldCount; universe < count; ++universe) {
+        preparePacket(universe);
+    }
+}
+
 void SAcnSender::sendUniverseMulticast(int universe, const QVector<uint8_t>& data) {
-    Q_ASSERT_X(universe <= 15, "SAcnSender::sendUniverse", "Universe number too large");
+    Q_ASSERT_X(universe < m_preparedPackets.size(), "SAcnSender::sendUniverse", "Universe number too large");
     Q_ASSERT_X(universe >= 0, "SAcnSender::sendUniverse", "Universe number too small");
     Q_ASSERT_X(data.size() == 512, "SAcnSender::sendUniverse", "data has not length 512");
+    if (m_startUniverse + universe > SACN_MAX_UNIVERSE) return;
 
-    QVector<uint8_t>& universePacket = m_preparedPackets[universe];
-
-    // fill raw DMX data in prepared packet:
-    std::copy(data.begin(), data.end(), universePacket.end() - 512);
-    // set sequence number:
-    universePacket[111] = m_sequenceNumber;
-    m_sequenceNumber = (m_sequenceNumber + 1) % 256;
+    const QVector<uint8_t>& universePacket = fillPacket(universe, data);
 
     // send prepared packet with filled in data via UDP socket:
     const char* packet = reinterpret_cast<const char*>(universePacket.constData());
 
-    m_udpSocket.writeDatagram(packet, universePacket.size(), m_multicastAddresses[universe], SACN_PORT);
+    m_udpSocket.writeDatagram(packet, universePacket.size(), m_multicastAddresses[universe], m_port);
 }
 
 void SAcnSender::sendUniverseUnicast(int universe, const QVector<uint8_t>& data, const QVector<QHostAddress>& addresses) {
-    Q_ASSERT_X(universe <= 15, "SAcnSender::sendUniverse", "Universe number too large");
+    Q_ASSERT_X(universe < m_preparedPackets.size(), "SAcnSender::sendUniverse", "Universe number too large");
     Q_ASSERT_X(universe >= 0, "SAcnSender::sendUniverse", "Universe number too small");
     Q_ASSERT_X(data.size() == 512, "SAcnSender::sendUniverse", "data has not length 512");
+    if (m_startUniverse + universe > SACN_MAX_UNIVERSE) return;
 
-    QVector<uint8_t>& universePacket = m_preparedPackets[universe];
-
-    // fill raw DMX data in prepared packet:
-    std::copy(data.begin(), data.end(), universePacket.end() - 512);
-    // set sequence number:
-    universePacket[111] = m_sequenceNumber;
-    m_sequenceNumber = (m_sequenceNumber + 1) % 256;
+    const QVector<uint8_t>& universePacket = fillPacket(universe, data);
 
     // send prepared packet with filled in data via UDP socket:
     const char* packet = reinterpret_cast<const char*>(universePacket.constData());
 
     for (const QHostAddress& address: addresses) {
-        m_udpSocket.writeDatagram(packet, universePacket.size(), address, SACN_PORT);
+        m_udpSocket.writeDatagram(packet, universePacket.size(), address, m_port);
     }
 }
 
 void SAcnSender::preparePackets() {
-    // Luminosus is limited to 16 consecutive universes:
-    m_preparedPackets.resize(16);
-    m_multicastAddresses.resize(16);
+    // rebuild the packets of all universes (i.e. because priority or start universe changed):
+    for (int universe = 0; universe < m_preparedPackets.size(); ++universe) {
+        preparePacket(universe);
+    }
+}
+
+const QVector<uint8_t>& SAcnSender::fillPacket(int universe, const QVector<uint8_t>& data) {
+    QVector<uint8_t>& universePacket = m_preparedPackets[universe];
 
+    // fill raw DMX data in prepared packet:
+    std::copy(data.begin(), data.end(), universePacket.end() - 512);
+    // set sequence number:
+    uint8_t& sequenceNumber = m_sequenceNumbers[universe];
+    universePacket[111] = sequenceNumber;
+    sequenceNumber = uint8_t(sequenceNumber + 1);
+    return universePacket;
+}
+
+void SAcnSender::preparePacket(int universe) {
     const int dataLengthPerPacket = 512;
+    const int universeNumber = qMin(m_startUniverse + universe, SACN_MAX_UNIVERSE);
+
+    QVector<uint8_t>& universePacket = m_preparedPackets[universe];
 
-    // iterate over all these universes:
-    for (int universe = 0; universe < 16; ++universe) {
-        QVector<uint8_t>& universePacket = m_preparedPackets[universe];
-
-        // DMP Layer:
-        QByteArray dmpLayer;
-        // packet length
-        dmpLayer.append(lengthAsLow12(10 + 1 + dataLengthPerPacket));
-        // vector
-        dmpLayer.append(0x02);
-        // address type and data type
-        dmpLayer.append(0xa1);
-        // start code
-        dmpLayer.append("\x00\x00", 2);
-        // increment value
-        dmpLayer.append("\x00\x01", 2);
-        // value count
-        dmpLayer.append(intTo16Bit(1 + dataLengthPerPacket));
-        // DMX 512 start code
-        dmpLayer.append(char(0x00));
-        // DMX 512 data
-        // filled in later...
-        dmpLayer.append(dataLengthPerPacket, char(0x00));
-
-        // Framing Layer:
-        QByteArray framingLayer;
-        // packet length
-        framingLayer.append(lengthAsLow12(77 + dmpLayer.size()));
-        // vector
-        framingLayer.append("\x00\x00\x00\x02", 4);
-        // name (64 bytes)
-        QByteArray name = QString("Luminosus").toLatin1();
-        framingLayer.append(name);
-        framingLayer.append(64 - name.size(), 0x00);
-        // priority
-        framingLayer.append(int8_t(m_priority));
-        // reserved by spec
-        framingLayer.append("\x00\x00", 2);
-        // sequence
-        framingLayer.append(char(0x01));
-        // options
-        framingLayer.append(char(0x00));
-        // universe
-        framingLayer.append(intTo16Bit(m_startUniverse + universe));
-        framingLayer.append(dmpLayer);
-
-
-        // Root Layer:
-        QByteArray rootLayer;
-        rootLayer.append("\x00\x10\x00\x00", 4);
-        rootLayer.append("ASC-E1.17\x00\x00\x00", 12);
-        // pdu size starts after byte 16 - there are 38 bytes of data in root layer
-        // so size is 38 - 16 + framing layer
-        rootLayer.append(lengthAsLow12(38 - 16 + framingLayer.size()));
-        rootLayer.append("\x00\x00\x00\x04", 4);
-        rootLayer.append(m_uuid.toRfc4122());
-        rootLayer.append(framingLayer);
-
-        if (rootLayer.size() != 638) {
-            qCritical() << "sACN packet has wrong size, maybe a data type problem";
-            qCritical() << "Packet size:" << rootLayer.size();
-        }
-
-        universePacket.resize(rootLayer.size());
-        std::copy(rootLayer.begin(), rootLayer.end(), universePacket.begin());
-
-        // Multicast IP for this universe:
-        QString ip = QString("239.255.%1.%2").arg(highByte(m_startUniverse + universe)).arg(lowByte(m_startUniverse + universe));
-        QHostAddress addr(ip);
-        m_multicastAddresses[universe] = addr;
+    // DMP Layer:
+    QByteArray dmpLayer;
+    // packet length
+    dmpLayer.append(lengthAsLow12(10 + 1 + dataLengthPerPacket));
+    // vector
+    dmpLayer.append(0x02);
+    // address type and data type
+    dmpLayer.append(0xa1);
+    // start code
+    dmpLayer.append("\x00\x00", 2);
+    // increment value
+    dmpLayer.append("\x00\x01", 2);
+    // value count
+    dmpLayer.append(intTo16Bit(1 + dataLengthPerPacket));
+    // DMX 512 start code
+    dmpLayer.append(char(0x00));
+    // DMX 512 data
+    // filled in later...
+    dmpLayer.append(dataLengthPerPacket, char(0x00));
+
+    // Framing Layer:
+    QByteArray framingLayer;
+    // packet length
+    framingLayer.append(lengthAsLow12(77 + dmpLayer.size()));
+    // vector
+    framingLayer.append("\x00\x00\x00\x02", 4);
+    // name (64 bytes)
+    QByteArray name = QString("Luminosus").toLatin1();
+    framingLayer.append(name);
+    framingLayer.append(64 - name.size(), 0x00);
+    // priority
+    framingLayer.append(int8_t(m_priority));
+    // reserved by spec
+    framingLayer.append("\x00\x00", 2);
+    // sequence
+    framingLayer.append(char(0x01));
+    // options
+    framingLayer.append(char(0x00));
+    // universe
+    framingLayer.append(intTo16Bit(universeNumber));
+    framingLayer.append(dmpLayer);
+
+
+    // Root Layer:
+    QByteArray rootLayer;
+    rootLayer.append("\x00\x10\x00\x00", 4);
+    rootLayer.append("ASC-E1.17\x00\x00\x00", 12);
+    // pdu size starts after byte 16 - there are 38 bytes of data in root layer
+    // so size is 38 - 16 + framing layer
+    rootLayer.append(lengthAsLow12(38 - 16 + framingLayer.size()));
+    rootLayer.append("\x00\x00\x00\x04", 4);
+    rootLayer.append(m_uuid.toRfc4122());
+    rootLayer.append(framingLayer);
+
+    if (rootLayer.size() != 638) {
+        qCritical() << "sACN packet has wrong size, maybe a data type problem";
+        qCritical() << "Packet size:" << rootLayer.size();
     }
+
+    universePacket.resize(rootLayer.size());
+    std::copy(rootLayer.begin(), rootLayer.end(), universePacket.begin());
+
+    // Multicast IP for this universe:
+    QString ip = QString("239.255.%1.%2").arg(highByte(universeNumber)).arg(lowByte(universeNumber));
+    QHostAddress addr(ip);
+    m_multicastAddresses[universe] = addr;
 }
@@ -18,6 +18,21 @@ public:
 
     void setPriority(int priority);
 
+    /**
+     * @brief setUniverseCount prepares the packets for the given number of consecutive universes
+     * (existing packets are kept, only the new ones are built)
+     * @param count number of universes beginning with the start universe
+     */
+    void setUniverseCount(int count);
+
+    int getUniverseCount() const { return m_preparedPackets.size(); }
+
+    /**
+     * @brief setPort changes the UDP destination port (i.e. to send to a local receiver)
+     * @param port UDP port, default is the sACN port 5568
+     */
+    void setPort(quint16 port) { m_port = port; }
+
     void sendUniverseMulticast(int universe, const QVector<uint8_t>& data);
 
     void sendUniverseUnicast(int universe, const QVector<uint8_t>& data, const QVector<QHostAddress>& addresses);
@@ -25,13 +40,22 @@ public:
 private:
     void preparePackets();
 
+    void preparePacket(int universe);
+
+    /**
+     * @brief fillPacket writes the DMX data and the sequence number into the prepared packet
+     * @return the packet ready to be sent
+     */
+    const QVector<uint8_t>& fillPacket(int universe, const QVector<uint8_t>& data);
+
 protected:
-    uint8_t m_sequenceNumber;
+    QVector<uint8_t> m_sequenceNumbers;
     QVector<QVector<uint8_t>> m_preparedPackets;
     QVector<QHostAddress> m_multicastAddresses;
     QUdpSocket m_udpSocket;
     int m_startUniverse;
     int m_priority;
+    quint16 m_port;
     QUuid m_uuid;
 };
 
@@ -0,0 +1,369 @@
+#include "DmxRenderer.h"
+
+#include "OutputManager.h"
+#include "core/SimdOps.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+namespace {
+
+/**
+ * @brief curveSteps is the number of intervals of the gamma lookup tables,
+ * values between the points are interpolated linearly
+ */
+const int curveSteps = 4096;
+
+/**
+ * @brief maxCurveCount is the max. number of different gamma curves (index is stored as uint8_t)
+ */
+const int maxCurveCount = 256;
+
+/**
+ * @brief maxSlotCount is the number of slots of all universes that can be output
+ */
+const int maxSlotCount = OutputManagerConstants::maxUniverseCount * 512;
+
+// ------------------------ Kernels ---------------------
+// The templates process as many values as possible with the given instruction set
+// and return the number of processed values, the rest is done with ScalarOps.
+
+template<typename Ops>
+int clampKernel(const float* values, float* result, int count) {
+    const typename Ops::V zero = Ops::set1(0.0f);
+    const typename Ops::V one = Ops::set1(1.0f);
+    int i = 0;
+    for (; i + Ops::width <= count; i += Ops::width) {
+        // max() returns zero for NaN values:
+        Ops::store(result + i, Ops::min(Ops::max(Ops::load(values + i), zero), one));
+    }
+    return i;
+}
+
+template<typename Ops>
+int quantizeKernel(const float* values, float* bits, int count) {
+    const typename Ops::V zero = Ops::set1(0.0f);
+    const typename Ops::V one = Ops::set1(1.0f);
+    const typename Ops::V scale = Ops::set1(65535.0f);
+    const typename Ops::V half = Ops::set1(0.5f);
+    int i = 0;
+    for (; i + Ops::width <= count; i += Ops::width) {
+        const typename Ops::V v = Ops::min(Ops::max(Ops::load(values + i), zero), one);
+        Ops::store(bits + i, Ops::floatToBits(Ops::add(Ops::mul(v, scale), half)));
+    }
+    return i;
+}
+
+/**
+ * @brief applyCurve replaces values between 0 and 1 by the interpolated values of a lookup table
+ */
+void applyCurve(float* values, const float* table, int count) {
+    for (int i = 0; i < count; ++i) {
+        const float x = values[i] * curveSteps;
+        const int k = std::min(int(x), curveSteps - 1);
+        const float fraction = x - k;
+        values[i] = table[k] + (table[k + 1] - table[k]) * fraction;
+    }
+}
+
+}  // namespace
+
+
+DmxRenderer::DmxRenderer()
+    : m_slotMapIsDirty(false)
+    , m_renderBuffer(512 + 1)
+    , m_quantizeBuffer(512 + 1)
+{
+    // the first curve is linear and doesn't need a table:
+    m_curves.append(GammaCurve{1.0, 0, QVector<float>()});
+}
+
+// ---------------- Patch:
+
+int DmxRenderer::addPatch(int address, int channelCount, double gamma, bool sixteenBit) {
+    int id;
+    if (!m_freePatches.isEmpty()) {
+        id = m_freePatches.takeLast();
+    } else {
+        id = m_patches.size();
+        m_patches.append(Patch{0, 0, 0, false});
+    }
+    if (!setPatch(m_patches[id], address, channelCount, gamma, sixteenBit)) {
+        qWarning() << "DMX patch out of range:" << address << channelCount;
+    }
+    return id;
+}
+
+void DmxRenderer::updatePatch(int patch, int address, int channelCount, double gamma, bool sixteenBit) {
+    if (patch < 0 || patch >= m_patches.size()) return;
+    Patch& p = m_patches[patch];
+
+    // remember the values to move them to the new address:
+    QVector<float> values(p.channelCount);
+    for (int channel = 0; channel < p.channelCount; ++channel) {
+        values[channel] = m_values[p.firstSlot + (p.sixteenBit ? 2 * channel : channel)];
+    }
+    releaseCurve(p.curve);
+    p.channelCount = 0;
+    p.curve = 0;
+
+    if (!setPatch(p, address, channelCount, gamma, sixteenBit)) {
+        qWarning() << "DMX patch out of range:" << address << channelCount;
+        m_slotMapIsDirty = true;
+        return;
+    }
+    // all universes are rendered again because the slot map changed:
+    for (int channel = 0; channel < qMin(values.size(), p.channelCount); ++channel) {
+        m_values[p.firstSlot + (p.sixteenBit ? 2 * channel : channel)] = values[channel];
+    }
+}
+
+void DmxRenderer::removePatch(int patch) {
+    if (patch < 0 || patch >= m_patches.size() || m_patches[patch].channelCount <= 0) return;
+    Patch& p = m_patches[patch];
+    releaseCurve(p.curve);
+    p = Patch{0, 0, 0, false};
+    m_freePatches.append(patch);
+    m_slotMapIsDirty = true;
+}
+
+bool DmxRenderer::setPatch(Patch& patch, int address, int channelCount, double gamma, bool sixteenBit) {
+    const int slotCount = sixteenBit ? 2 * channelCount : channelCount;
+    if (address < 1 || channelCount <= 0 || address - 1 + slotCount > maxSlotCount) return false;
+
+    patch.firstSlot = address - 1;
+    patch.channelCount = channelCount;
+    patch.curve = acquireCurve(gamma);
+    patch.sixteenBit = sixteenBit;
+
+    // grow the staging buffer to complete universes:
+    const int universeCount = (patch.firstSlot + slotCount + 511) / 512;
+    if (universeCount > m_universeNeedsRender.size()) {
+        m_values.resize(universeCount * 512);
+        m_slotModes.resize(universeCount * 512);
+        m_slotCurves.resize(universeCount * 512);
+        m_curveRuns.resize(universeCount);
+        m_universeNeedsRender.resize(universeCount);
+    }
+    m_slotMapIsDirty = true;
+    return true;
+}
+
+int DmxRenderer::acquireCurve(double gamma) {
+    if (qFuzzyCompare(gamma, 1.0)) return 0;
+
+    int unused = -1;
+    int nearest = 0;
+    for (int i = 1; i < m_curves.size(); ++i) {
+        GammaCurve& curve = m_curves[i];
+        if (curve.users > 0 && qFuzzyCompare(curve.gamma, gamma)) {
+            ++curve.users;
+            return i;
+        }
+        if (curve.users <= 0 && unused < 0) unused = i;
+        if (qAbs(curve.gamma - gamma) < qAbs(m_curves[nearest].gamma - gamma)) nearest = i;
+    }
+    if (unused < 0 && m_curves.size() >= maxCurveCount) {
+        // all curves are in use, the most similar one is good enough:
+        ++m_curves[nearest].users;
+        return nearest;
+    }
+    if (unused < 0) {
+        unused = m_curves.size();
+        m_curves.append(GammaCurve{1.0, 0, QVector<float>()});
+    }
+
+    GammaCurve& curve = m_curves[unused];
+    curve.gamma = gamma;
+    curve.users = 1;
+    curve.table.resize(curveSteps + 1);
+    for (int k = 0; k <= curveSteps; ++k) {
+        curve.table[k] = float(std::pow(double(k) / curveSteps, gamma));
+    }
+    return unused;
+}
+
+void DmxRenderer::releaseCurve(int curve) {
+    if (curve <= 0 || curve >= m_curves.size()) return;
+    --m_curves[curve].users;
+}
+
+void DmxRenderer::updateSlotMap() {
+    std::fill(m_slotModes.begin(), m_slotModes.end(), uint8_t(Unpatched));
+    std::fill(m_slotCurves.begin(), m_slotCurves.end(), uint8_t(0));
+
+    // later patches overwrite earlier ones if they overlap:
+    for (const Patch& patch: m_patches) {
+        for (int channel = 0; channel < patch.channelCount; ++channel) {
+            const int slot = patch.firstSlot + (patch.sixteenBit ? 2 * channel : channel);
+            m_slotModes[slot] = Coarse;
+            m_slotCurves[slot] = uint8_t(patch.curve);
+            if (patch.sixteenBit) {
+                m_slotModes[slot + 1] = Fine;
+                m_slotCurves[slot + 1] = 0;
+            }
+        }
+    }
+
+    // find the ranges of slots that use the same curve:
+    for (int universe = 0; universe < m_curveRuns.size(); ++universe) {
+        QVector<CurveRun>& runs = m_curveRuns[universe];
+        runs.clear();
+        const uint8_t* curves = m_slotCurves.constData() + universe * 512;
+        for (int slot = 0; slot < 512; ++slot) {
+            if (curves[slot] == 0) continue;
+            if (!runs.isEmpty() && runs.last().curve == curves[slot]
+                    && runs.last().start + runs.last().count == slot) {
+                ++runs.last().count;
+            } else {
+                runs.append(CurveRun{slot, 1, curves[slot]});
+            }
+        }
+    }
+
+    // the slots of all universes may have changed:
+    m_universeNeedsRender.fill(true);
+    m_slotMapIsDirty = false;
+}
+
+// ---------------- Rendering:
+
+void DmxRenderer::render(QVector<QVector<uint8_t>>& universes, QVector<bool>& universeChanged) {
+    if (m_slotMapIsDirty) updateSlotMap();
+
+    const int universeCount = qMin(m_universeNeedsRender.size(), qMin(universes.size(), universeChanged.size()));
+    for (int universe = 0; universe < universeCount; ++universe) {
+        if (!m_universeNeedsRender[universe]) continue;
+        m_universeNeedsRender[universe] = false;
+
+        // the last slot of the previous universe is included,
+        // it may be the coarse slot of a fine slot in this universe:
+        const int lead = universe > 0 ? 1 : 0;
+        const int firstSlot = universe * 512 - lead;
+        const int count = 512 + lead;
+        float* values = m_renderBuffer.data();
+        float* bits = m_quantizeBuffer.data();
+
+        // clamp to [0, 1] -> apply gamma curves -> quantize to 16 bit:
+        const int clamped = clampKernel<SimdOps>(m_values.constData() + firstSlot, values, count);
+        clampKernel<ScalarOps>(m_values.constData() + firstSlot + clamped, values + clamped, count - clamped);
+        if (lead && m_slotCurves[firstSlot] != 0) {
+            applyCurve(values, m_curves[m_slotCurves[firstSlot]].table.constData(), 1);
+        }
+        for (const CurveRun& run: m_curveRuns[universe]) {
+            applyCurve(values + lead + run.start, m_curves[run.curve].table.constData(), run.count);
+        }
+        const int quantized = quantizeKernel<SimdOps>(values, bits, count);
+        quantizeKernel<ScalarOps>(values + quantized, bits + quantized, count - quantized);
+
+        // write the coarse and fine bytes:
+        const uint8_t* modes = m_slotModes.constData() + universe * 512;
+        uint8_t* slots = universes[universe].data();
+        bool changed = false;
+        for (int slot = 0; slot < 512; ++slot) {
+            if (modes[slot] == Unpatched) continue;
+            int32_t value;
+            if (modes[slot] == Fine) {
+                if (slot + lead == 0) continue;
+                std::memcpy(&value, bits + slot + lead - 1, sizeof(value));
+                value &= 0xFF;
+            } else {
+                std::memcpy(&value, bits + slot + lead, sizeof(value));
+                value >>= 8;
+            }
+            if (slots[slot] == uint8_t(value)) continue;
+            slots[slot] = uint8_t(value);
+            changed = true;
+        }
+        if (changed) universeChanged[universe] = true;
+    }
+}
+
+// ----------------- Benchmark:
+
+QVariantMap DmxRenderer::benchmark(int channelCount) {
+    const int frames = 100;
+    const int fixtureCount = channelCount / 3;
+    const double gamma = 2.2;
+    const int universeCount = (fixtureCount * 3 + 511) / 512;
+    QVariantMap result;
+    result["channels"] = fixtureCount * 3;
+    result["universes"] = universeCount;
+
+    // test values that change every frame:
+    auto valueAt = [](int channel, int frame) {
+        return double((channel * 7 + frame * 3) % 1000) / 999.0;
+    };
+
+    // --- per channel with pow() like OutputManager::setChannel() did:
+    QVector<QVector<uint8_t>> legacyUniverses(universeCount, QVector<uint8_t>(512, 0));
+    QVector<bool> legacyDirty(universeCount, false);
+    auto setChannel = [&](int address, double value) {
+        if (address > OutputManagerConstants::maxUniverseCount * 512 || address < 1) return;
+        --address;
+        const int universe = address / 512;
+        if (universe >= legacyUniverses.size()) return;
+        uint8_t& slot = legacyUniverses[universe][address % 512];
+        const uint8_t newValue = uint8_t(limit(0.0, value, 1.0) * 255);
+        if (slot == newValue) return;
+        slot = newValue;
+        legacyDirty[universe] = true;
+    };
+    QElapsedTimer timer;
+    timer.start();
+    for (int frame = 0; frame < frames; ++frame) {
+        for (int fixture = 0; fixture < fixtureCount; ++fixture) {
+            for (int channel = 0; channel < 3; ++channel) {
+                const int index = fixture * 3 + channel;
+                setChannel(index + 1, std::pow(valueAt(index, frame), gamma));
+            }
+        }
+    }
+    const double legacyMs = double(timer.nsecsElapsed()) / 1e6 / frames;
+
+    // --- patches with 8 and 16 bit channels:
+    for (bool sixteenBit: {false, true}) {
+        const int slotsPerChannel = sixteenBit ? 2 : 1;
+        const int patchedUniverses = (fixtureCount * 3 * slotsPerChannel + 511) / 512;
+        DmxRenderer renderer;
+        QVector<int> patches(fixtureCount);
+        for (int fixture = 0; fixture < fixtureCount; ++fixture) {
+            patches[fixture] = renderer.addPatch(fixture * 3 * slotsPerChannel + 1, 3, gamma, sixteenBit);
+        }
+        QVector<QVector<uint8_t>> universes(patchedUniverses, QVector<uint8_t>(512, 0));
+        QVector<bool> dirty(patchedUniverses, false);
+
+        timer.restart();
+        for (int frame = 0; frame < frames; ++frame) {
+            for (int fixture = 0; fixture < fixtureCount; ++fixture) {
+                for (int channel = 0; channel < 3; ++channel) {
+                    renderer.setValue(patches[fixture], channel, float(valueAt(fixture * 3 + channel, frame)));
+                }
+            }
+            renderer.render(universes, dirty);
+        }
+        const double ms = double(timer.nsecsElapsed()) / 1e6 / frames;
+
+        // compare the coarse values of the last frame:
+        int maxDifference = 0;
+        for (int index = 0; index < fixtureCount * 3; ++index) {
+            const int slot = index * slotsPerChannel;
+            const int legacy = legacyUniverses[index / 512][index % 512];
+            const int rendered = universes[slot / 512][slot % 512];
+            maxDifference = qMax(maxDifference, qAbs(legacy - rendered));
+        }
+
+        const QString mode = sixteenBit ? "patch16Bit" : "patch8Bit";
+        result[mode + "Ms"] = ms;
+        result[mode + "MaxDifference"] = maxDifference;
+        qInfo() << "DMX render" << fixtureCount * 3 << "channels," << mode << ":" << ms << "ms per frame"
+                << "(setChannel:" << legacyMs << "ms), max. difference:" << maxDifference
+                << "instruction set:" << SimdOps::name();
+    }
+    result["setChannelMs"] = legacyMs;
+    return result;
+}
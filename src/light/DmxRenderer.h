@@ -0,0 +1,176 @@
+#ifndef DMXRENDERER_H
+#define DMXRENDERER_H
+
+#include <QVariantMap>
+#include <QVector>
+
+#include <cstdint>
+
+
+/**
+ * @brief The DmxRenderer class converts the normalized channel values of patched fixtures
+ * to DMX slots once per frame.
+ *
+ * A fixture registers a patch (address, number of channels, gamma and resolution) once and then
+ * only writes values between 0 and 1 to a flat staging buffer. Once per frame render() applies
+ * the gamma curves with lookup tables and quantizes the values of all changed universes
+ * to 8 or 16 bit (coarse and fine slot) in one pass per universe.
+ */
+class DmxRenderer {
+
+public:
+    DmxRenderer();
+
+    // ---------------- Patch:
+
+    /**
+     * @brief addPatch registers the channels of a fixture
+     * @param address DMX address of the first channel beginning with 1
+     * @param channelCount number of channels
+     * @param gamma exponent of the gamma curve applied to all channels
+     * @param sixteenBit true if each channel uses a coarse and a fine slot
+     * @return id of the patch
+     */
+    int addPatch(int address, int channelCount, double gamma, bool sixteenBit = false);
+
+    /**
+     * @brief updatePatch changes a patch, the current values are moved to the new address
+     * @param patch id returned by addPatch()
+     * @param address see addPatch()
+     * @param channelCount see addPatch()
+     * @param gamma see addPatch()
+     * @param sixteenBit see addPatch()
+     */
+    void updatePatch(int patch, int address, int channelCount, double gamma, bool sixteenBit = false);
+
+    /**
+     * @brief removePatch unregisters a patch, its slots keep their last values
+     * @param patch id returned by addPatch()
+     */
+    void removePatch(int patch);
+
+    /**
+     * @brief getPatchCount returns the number of registered patches
+     * @return number of patches
+     */
+    int getPatchCount() const { return m_patches.size() - m_freePatches.size(); }
+
+    /**
+     * @brief getUniverseCount returns the number of universes that contain patched slots
+     * @return number of universes
+     */
+    int getUniverseCount() const { return m_universeNeedsRender.size(); }
+
+    // ---------------- Values:
+
+    /**
+     * @brief setValue sets the value of a patched channel for the next frame
+     * @param patch id returned by addPatch()
+     * @param channel index of the channel in the patch
+     * @param value [0...1] (the gamma curve is applied by render())
+     */
+    void setValue(int patch, int channel, float value) {
+        if (patch < 0 || patch >= m_patches.size()) return;
+        const Patch& p = m_patches[patch];
+        if (channel < 0 || channel >= p.channelCount) return;
+        const int slot = p.firstSlot + (p.sixteenBit ? 2 * channel : channel);
+        float& staged = m_values[slot];
+        if (staged == value) return;
+        staged = value;
+        m_universeNeedsRender[slot / 512] = true;
+        // the fine slot may be in the next universe:
+        if (p.sixteenBit) m_universeNeedsRender[(slot + 1) / 512] = true;
+    }
+
+    /**
+     * @brief render writes the patched slots of all universes whose values changed
+     * @param universes DMX data, must contain at least getUniverseCount() universes with 512 slots
+     * @param universeChanged is set to true for each universe whose data changed
+     */
+    void render(QVector<QVector<uint8_t>>& universes, QVector<bool>& universeChanged);
+
+    /**
+     * @brief benchmark compares setting each channel with OutputManager::setChannel()
+     * (pow() per channel) with the patch and render stage
+     * @param channelCount number of channels (RGB fixtures with three channels each)
+     * @return durations per frame and the max. difference of the results
+     */
+    static QVariantMap benchmark(int channelCount = 10000);
+
+protected:
+    /**
+     * @brief The Patch struct describes the channels of a fixture
+     */
+    struct Patch {
+        int firstSlot;  //!< index of the first slot in the staging buffer (address - 1)
+        int channelCount;  //!< number of channels, 0 if the patch id is unused
+        int curve;  //!< index of the gamma curve
+        bool sixteenBit;  //!< true if each channel uses a coarse and a fine slot
+    };
+
+    /**
+     * @brief The GammaCurve struct contains the lookup table of a gamma curve
+     */
+    struct GammaCurve {
+        double gamma;  //!< exponent of the curve
+        int users;  //!< number of patches using this curve
+        QVector<float> table;  //!< values of the curve at equidistant points from 0 to 1
+    };
+
+    /**
+     * @brief The CurveRun struct is a range of consecutive slots in a universe using the same curve
+     */
+    struct CurveRun {
+        int start;  //!< first slot in the universe
+        int count;  //!< number of slots
+        int curve;  //!< index of the gamma curve
+    };
+
+    /**
+     * @brief The SlotMode enum describes how a slot is written by render()
+     */
+    enum SlotMode : uint8_t {
+        Unpatched = 0,  //!< the slot is not written
+        Coarse,  //!< 8 bit channel or the coarse slot of a 16 bit channel
+        Fine  //!< the fine slot of a 16 bit channel (value is in the previous slot)
+    };
+
+    /**
+     * @brief setPatch sets the values of a patch and updates the slot size
+     * @return false if the address is out of range
+     */
+    bool setPatch(Patch& patch, int address, int channelCount, double gamma, bool sixteenBit);
+
+    /**
+     * @brief acquireCurve returns the index of the curve for a gamma value and increments its users
+     * @param gamma exponent of the curve
+     * @return index of the curve, 0 is linear and has no table
+     */
+    int acquireCurve(double gamma);
+
+    /**
+     * @brief releaseCurve decrements the users of a curve
+     * @param curve index of the curve
+     */
+    void releaseCurve(int curve);
+
+    /**
+     * @brief updateSlotMap rebuilds the slot modes and curve runs from the patches
+     */
+    void updateSlotMap();
+
+protected:
+    QVector<Patch> m_patches;  //!< all patches, index is the patch id
+    QVector<int> m_freePatches;  //!< unused patch ids
+    QVector<GammaCurve> m_curves;  //!< gamma curves, the first one is linear
+    QVector<float> m_values;  //!< staging buffer with one normalized value per slot
+    QVector<uint8_t> m_slotModes;  //!< SlotMode per slot
+    QVector<uint8_t> m_slotCurves;  //!< curve index per slot
+    QVector<QVector<CurveRun>> m_curveRuns;  //!< non-linear curve runs per universe
+    QVector<bool> m_universeNeedsRender;  //!< true if a value in the universe changed
+    bool m_slotMapIsDirty;  //!< true if a patch changed since the last render()
+    QVector<float> m_renderBuffer;  //!< values of one universe while it is rendered
+    QVector<float> m_quantizeBuffer;  //!< quantized values of one universe (as int32 bits)
+};
+
+#endif // DMXRENDERER_H
@@ -24,6 +24,8 @@
 
 #include "core/MainController.h"
 
+#include <QUdpSocket>
+
 
 OutputManager::OutputManager(MainController* controller)
     : QObject(controller)
@@ -34,18 +36,27 @@ OutputManager::OutputManager(MainController* controller)
     , m_artnetNet(0)
     , m_artnetSubnet(0)
     , m_broadcastArtnet(false)
-    , m_artnet(m_artnetNet, m_artnetSubnet)
     //, m_artnetDiscoveryManager()
-    , m_sAcnSender(m_sAcnStartUniverse, 100)
-    , m_universes(16, QVector<uint8_t>(512, 0))
+    , m_outputThread(this)
+    , m_statisticsTimer(this)
+    , m_renderer()
+    , m_universes()
     , m_usedAddressCount(0)
     , m_nextAddressToUse(1)
 {
-    for (int i=0; i<16; ++i) {
-        m_universeDirty[i] = false;
-    }
     connect(controller->engine(), SIGNAL(updateOutput(double)), this, SLOT(triggerOutput()));
     //connect(&m_artnetDiscoveryManager, SIGNAL(discoveredNodesChanged()), this, SIGNAL(discoveredNodesChanged()));
+
+    updateOutputSettings();
+    m_outputThread.start(QThread::TimeCriticalPriority);
+
+    connect(&m_statisticsTimer, SIGNAL(timeout()), this, SIGNAL(statisticsChanged()));
+    m_statisticsTimer.start(1000);
+}
+
+OutputManager::~OutputManager() {
+    m_outputThread.requestStop();
+    m_outputThread.wait();
 }
 
 QJsonObject OutputManager::getState() const {
@@ -74,35 +85,44 @@ void OutputManager::setState(const QJsonObject& state) {
 }
 
 void OutputManager::setChannel(int address, double value) {
-    if (address > 8192 || address < 1) return;
+    if (address > OutputManagerConstants::maxUniverseCount * 512 || address < 1) return;
     --address; // DMX channel 1 is index 0 in array
-    unsigned int universe = static_cast<unsigned int>(address) / 512; // integer division
-    m_universes[universe][static_cast<unsigned int>(address % 512)] = uint8_t(value * 255);
+    int universe = address / 512; // integer division
+    if (universe >= m_universes.size()) {
+        setUniverseCount(universe + 1);
+    }
+    uint8_t& slot = m_universes[universe][address % 512];
+    const uint8_t newValue = uint8_t(limit(0.0, value, 1.0) * 255);
+    if (slot == newValue) return;
+    slot = newValue;
     m_universeDirty[universe] = true;
 }
 
 void OutputManager::triggerOutput() {
-    for (int universe = 0; universe < 16; ++universe) {
-        if (m_universeDirty[universe]) {
-            if (m_artnetEnabled) {
-                if (m_broadcastArtnet) {
-                    //m_artnet.sendUniverseBroadcast(universe, m_universes[universe]);
-                } else {
-                    //m_artnet.sendUniverseUnicast(universe, m_universes[universe], m_artnetDiscoveryManager.getUnicastAddresses());
-                }
-            }
-            if (m_sAcnEnabled) {
-                //m_sAcnSender.sendUniverseMulticast(universe, m_universes[universe]);
-            }
-            m_universeDirty[universe] = false;
-        }
+    if (m_renderer.getUniverseCount() > m_universes.size()) {
+        setUniverseCount(m_renderer.getUniverseCount());
     }
+    m_renderer.render(m_universes, m_universeDirty);
+
+    if (!contains(m_universeDirty, true)) return;
+
+    // copy all universes because the frame to write may contain the data of an older frame:
+    DmxFrame& frame = m_outputThread.frameToWrite();
+    frame.universes.resize(m_universes.size());
+    for (int universe = 0; universe < m_universes.size(); ++universe) {
+        const QVector<uint8_t>& data = m_universes[universe];
+        QVector<uint8_t>& frameData = frame.universes[universe];
+        frameData.resize(data.size());
+        std::copy(data.begin(), data.end(), frameData.begin());
+    }
+    m_outputThread.publishFrame();
+    m_universeDirty.fill(false);
 }
 
 int OutputManager::getUnusedAddress(int footprint) {
     int address = m_nextAddressToUse + m_usedAddressCount;
-    if (address > 8192) {
-        address %= 8192;
+    if (address > OutputManagerConstants::maxUniverseCount * 512) {
+        address %= OutputManagerConstants::maxUniverseCount * 512;
     }
     m_usedAddressCount += footprint;
     return address;
@@ -114,26 +134,26 @@ void OutputManager::setNextAddressToUse(int address) {
 }
 
 void OutputManager::setSAcnStartUniverse(int value) {
-    m_sAcnStartUniverse = limit(1, value, 63999 - 16);
-    m_sAcnSender.setStartUniverse(m_sAcnStartUniverse);
+    m_sAcnStartUniverse = limit(1, value, 63999);
+    updateOutputSettings();
     emit sAcnStartUniverseChanged();
 }
 
 void OutputManager::setSAcnPriority(int value) {
     m_sAcnPriority = limit(1, value, 200);
-    m_sAcnSender.setPriority(m_sAcnPriority);
+    updateOutputSettings();
     emit sAcnPriorityChanged();
 }
 
 void OutputManager::setArtnetNet(int value) {
     m_artnetNet = limit(0, value, 127);
-    m_artnet.setNetAndSubnet(m_artnetNet, m_artnetSubnet);
+    updateOutputSettings();
     emit artnetNetChanged();
 }
 
 void OutputManager::setArtnetSubnet(int value) {
     m_artnetSubnet = limit(0, value, 15);
-    m_artnet.setNetAndSubnet(m_artnetNet, m_artnetSubnet);
+    updateOutputSettings();
     emit artnetSubnetChanged();
 }
 
@@ -153,3 +173,95 @@ QVariantList OutputManager::getDiscoveredLuminosusInstances() {
 //    return instances;
     return QVariantList();
 }
+
+QVariantList OutputManager::benchmarkOutput() {
+    QVariantList results;
+    for (int universeCount: {16, 64, 256}) {
+        results.append(benchmarkOutput(universeCount, 200));
+    }
+    return results;
+}
+
+void OutputManager::setUniverseCount(int count) {
+    count = limit(0, count, OutputManagerConstants::maxUniverseCount);
+    m_universes.resize(count);
+    for (QVector<uint8_t>& universe: m_universes) {
+        // new universes are empty and have to be initialized:
+        if (universe.size() != 512) universe.fill(0, 512);
+    }
+    m_universeDirty.resize(count);
+}
+
+void OutputManager::updateOutputSettings() {
+    OutputSettings settings;
+    settings.sAcnEnabled = m_sAcnEnabled;
+    settings.artnetEnabled = m_artnetEnabled;
+    settings.broadcastArtnet = m_broadcastArtnet;
+    settings.sAcnStartUniverse = m_sAcnStartUniverse;
+    settings.sAcnPriority = m_sAcnPriority;
+    settings.artnetNet = m_artnetNet;
+    settings.artnetSubnet = m_artnetSubnet;
+    m_outputThread.setSettings(settings);
+}
+
+QVariantMap OutputManager::benchmarkOutput(int universeCount, int frames) {
+    // the receiver on the loopback interface drains the packets like a real node would do:
+    QUdpSocket receiver;
+    if (!receiver.bind(QHostAddress::LocalHost, 0)) {
+        qWarning() << "Output benchmark: could not bind loopback receiver.";
+        return QVariantMap();
+    }
+    const QVector<QHostAddress> addresses = { QHostAddress::LocalHost };
+    QByteArray receiveBuffer(1024, 0);
+    int packetsReceived = 0;
+    auto drainReceiver = [&]() {
+        while (receiver.hasPendingDatagrams()) {
+            receiver.readDatagram(receiveBuffer.data(), receiveBuffer.size());
+            ++packetsReceived;
+        }
+    };
+
+    SAcnSender sAcnSender(1, 100);
+    sAcnSender.setUniverseCount(universeCount);
+    sAcnSender.setPort(receiver.localPort());
+    ArtNetSubnetSender artnet(0, 0);
+    artnet.setUniverseCount(universeCount);
+    artnet.setPort(receiver.localPort());
+
+    QVector<QVector<uint8_t>> universes(universeCount, QVector<uint8_t>(512, 0));
+    double sAcnSeconds = 0.0;
+    double artnetSeconds = 0.0;
+
+    for (int frame = 0; frame < frames; ++frame) {
+        // build a frame where every slot changes:
+        HighResTime::time_point_t start = HighResTime::now();
+        for (QVector<uint8_t>& universe: universes) {
+            std::fill(universe.begin(), universe.end(), uint8_t(frame));
+        }
+        for (int universe = 0; universe < universeCount; ++universe) {
+            sAcnSender.sendUniverseUnicast(universe, universes[universe], addresses);
+        }
+        sAcnSeconds += HighResTime::elapsedSecSince(start);
+        drainReceiver();
+
+        start = HighResTime::now();
+        for (int universe = 0; universe < universeCount; ++universe) {
+            artnet.sendUniverseUnicast(universe, universes[universe], addresses);
+        }
+        artnetSeconds += HighResTime::elapsedSecSince(start);
+        drainReceiver();
+    }
+
+    QVariantMap result;
+    result["universes"] = universeCount;
+    result["frames"] = frames;
+    result["sAcnMsPerFrame"] = sAcnSeconds * 1000 / frames;
+    result["artnetMsPerFrame"] = artnetSeconds * 1000 / frames;
+    result["packetsSent"] = universeCount * frames * 2;
+    result["packetsReceived"] = packetsReceived;
+    qInfo() << "Output benchmark:" << universeCount << "universes,"
+            << "sACN:" << result["sAcnMsPerFrame"].toDouble() << "ms/frame,"
+            << "Art-Net:" << result["artnetMsPerFrame"].toDouble() << "ms/frame,"
+            << "received:" << packetsReceived << "/" << universeCount * frames * 2;
+    return result;
+}
@@ -22,6 +22,7 @@
 #define OUTPUTMANAGER_H
 
 #include <QObject>
+#include <QTimer>
 #include <QVector>
 
 #include <cstdint>
@@ -29,12 +30,37 @@
 #include "ArtNetDiscoveryManager.h"
 #include "ArtNetSender.h"
 #include "BasicSAcnSender.h"
+#include "DmxRenderer.h"
+#include "OutputThread.h"
 #include "utils.h"
 
 // forward declaration:
 class MainController;
 
 
+namespace OutputManagerConstants {
+    /**
+     * @brief maxUniverseCount is the maximum number of consecutive universes that can be output
+     */
+    static const int maxUniverseCount = 512;
+    /**
+     * @brief repeatsAfterChange is the number of times a universe is sent again after
+     * its last change before the rate is reduced to the keep-alive interval (E1.31 6.6.1)
+     */
+    static const int repeatsAfterChange = 3;
+    /**
+     * @brief keepAliveInterval is the interval in seconds unchanged universes are refreshed with
+     * (E1.31 6.6.1 requires 0.8s - 1s, Art-Net at least every 4s)
+     */
+    static const double keepAliveInterval = 0.8;
+    /**
+     * @brief outputThreadFps is the rate the OutputThread sends frames with
+     * (44Hz is the maximum refresh rate of a full DMX512 universe)
+     */
+    static const double outputThreadFps = 44.0;
+}
+
+
 class OutputManager : public QObject
 {
 	Q_OBJECT
@@ -50,8 +76,15 @@ class OutputManager : public QObject
     Q_PROPERTY(QVariantList discoveredNodes READ getDiscoveredNodes NOTIFY discoveredNodesChanged)
     Q_PROPERTY(QVariantList luminosusInstances READ getDiscoveredLuminosusInstances NOTIFY discoveredNodesChanged)
 
+    Q_PROPERTY(double latencyAvg READ getLatencyAvg NOTIFY statisticsChanged)
+    Q_PROPERTY(double latencyMax READ getLatencyMax NOTIFY statisticsChanged)
+    Q_PROPERTY(double jitterAvg READ getJitterAvg NOTIFY statisticsChanged)
+    Q_PROPERTY(double jitterMax READ getJitterMax NOTIFY statisticsChanged)
+    Q_PROPERTY(int overrunCount READ getOverrunCount NOTIFY statisticsChanged)
+
 public:
     OutputManager(MainController* controller);
+    ~OutputManager();
 
     /**
      * @brief getState returns the settings of this manager to persist them
@@ -74,19 +107,41 @@ signals:
     void artnetSubnetChanged();
     void broadcastArtnetChanged();
     void discoveredNodesChanged();
+    void statisticsChanged();
 
 
 public slots:
+    /**
+     * @brief setChannel sets the value of a DMX channel, the universe storage grows when necessary
+     * @param address DMX address beginning with 1 (513 is the first channel of the second universe)
+     * @param value [0...1]
+     */
     void setChannel(int address, double value);
+    /**
+     * @brief triggerOutput renders the patched channels and publishes the current DMX data
+     * to the OutputThread if it changed, called by the Engine each frame
+     */
     void triggerOutput();
     int getUnusedAddress(int footprint);
     void setNextAddressToUse(int address);
+    /**
+     * @brief peekUnusedAddress returns the address the next getUnusedAddress() call would return
+     * without reserving it, it can be restored with setNextAddressToUse()
+     * @return DMX address beginning with 1
+     */
+    int peekUnusedAddress() const { return m_nextAddressToUse + m_usedAddressCount; }
+
+    /**
+     * @brief getUniverseCount returns the number of universes that are currently output
+     * @return number of universes
+     */
+    int getUniverseCount() const { return m_universes.size(); }
 
     bool getSAcnEnabled() const { return m_sAcnEnabled; }
-    void setSAcnEnabled(bool value) { m_sAcnEnabled = value; emit sAcnEnabledChanged(); }
+    void setSAcnEnabled(bool value) { m_sAcnEnabled = value; updateOutputSettings(); emit sAcnEnabledChanged(); }
 
     bool getArtnetEnabled() const { return m_artnetEnabled; }
-    void setArtnetEnabled(bool value) { m_artnetEnabled = value; emit artnetEnabledChanged(); }
+    void setArtnetEnabled(bool value) { m_artnetEnabled = value; updateOutputSettings(); emit artnetEnabledChanged(); }
 
     int getSAcnStartUniverse() const { return m_sAcnStartUniverse; }
     void setSAcnStartUniverse(int value);
@@ -101,11 +156,80 @@ public slots:
     void setArtnetSubnet(int value);
 
     bool getBroadcastArtnet() const { return m_broadcastArtnet; }
-    void setBroadcastArtnet(bool value) { m_broadcastArtnet = value; emit broadcastArtnetChanged(); }
+    void setBroadcastArtnet(bool value) { m_broadcastArtnet = value; updateOutputSettings(); emit broadcastArtnetChanged(); }
 
     QVariantList getDiscoveredNodes();
     QVariantList getDiscoveredLuminosusInstances();
 
+    // ----------------- Patch (see DmxRenderer):
+
+    /**
+     * @brief addPatch registers the channels of a fixture, their values are set with setPatchValue()
+     * @param address DMX address of the first channel beginning with 1
+     * @param channelCount number of channels
+     * @param gamma exponent of the gamma curve applied to all channels
+     * @param sixteenBit true if each channel uses a coarse and a fine slot
+     * @return id of the patch
+     */
+    int addPatch(int address, int channelCount, double gamma, bool sixteenBit = false) {
+        return m_renderer.addPatch(address, channelCount, gamma, sixteenBit);
+    }
+    void updatePatch(int patch, int address, int channelCount, double gamma, bool sixteenBit = false) {
+        m_renderer.updatePatch(patch, address, channelCount, gamma, sixteenBit);
+    }
+    void removePatch(int patch) { m_renderer.removePatch(patch); }
+
+    /**
+     * @brief setPatchValue sets the value of a patched channel, it is output in the next frame
+     * @param patch id returned by addPatch()
+     * @param channel index of the channel in the patch
+     * @param value [0...1] without gamma correction
+     */
+    void setPatchValue(int patch, int channel, double value) { m_renderer.setValue(patch, channel, float(value)); }
+
+    // ----------------- Statistics of the OutputThread (of the last second):
+
+    /**
+     * @brief getLatencyAvg returns the average time between publishing a frame and sending it
+     * @return latency in ms
+     */
+    double getLatencyAvg() const { return m_outputThread.getLatencyAvg() * 1000; }
+    double getLatencyMax() const { return m_outputThread.getLatencyMax() * 1000; }
+    /**
+     * @brief getJitterAvg returns the average delay of the send time after the scheduled deadline
+     * @return jitter in ms
+     */
+    double getJitterAvg() const { return m_outputThread.getJitterAvg() * 1000; }
+    double getJitterMax() const { return m_outputThread.getJitterMax() * 1000; }
+    /**
+     * @brief getOverrunCount returns the number of frames the OutputThread could not send in time
+     * @return number of skipped frames since start
+     */
+    int getOverrunCount() const { return m_outputThread.getOverrunCount(); }
+
+    // ----------------- Benchmarks:
+
+    /**
+     * @brief benchmarkOutput measures the time to build and send a frame with 16, 64 and 256
+     * universes via sACN and Art-Net to a receiver on the loopback interface
+     * @return a list of results (one map per universe count)
+     */
+    QVariantList benchmarkOutput();
+
+private:
+    /**
+     * @brief setUniverseCount changes the number of universes that are output
+     * @param count new number of universes
+     */
+    void setUniverseCount(int count);
+
+    /**
+     * @brief updateOutputSettings passes the current protocol settings to the OutputThread
+     */
+    void updateOutputSettings();
+
+    QVariantMap benchmarkOutput(int universeCount, int frames);
+
 protected:
     bool m_sAcnEnabled;
     bool m_artnetEnabled;
@@ -115,11 +239,12 @@ protected:
     int m_artnetSubnet;
     bool m_broadcastArtnet;
 
-    ArtNetSubnetSender m_artnet;
     //ArtNetDiscoveryManager m_artnetDiscoveryManager;
-    SAcnSender m_sAcnSender;
+    OutputThread m_outputThread;  //!< sends the published frames
+    QTimer m_statisticsTimer;  //!< triggers statisticsChanged()
+    DmxRenderer m_renderer;  //!< patch table and render stage of the fixtures
     QVector<QVector<uint8_t>> m_universes;
-    bool m_universeDirty[16];
+    QVector<bool> m_universeDirty;  //!< true if universe changed since it was last published
     int m_usedAddressCount;
     int m_nextAddressToUse;
 };
@@ -0,0 +1,179 @@
+#include "OutputThread.h"
+
+#include "ArtNetSender.h"
+#include "BasicSAcnSender.h"
+#include "OutputManager.h"
+
+#include <QMutexLocker>
+#include <algorithm>
+#include <thread>
+
+#if defined(Q_OS_LINUX)
+#include <time.h>
+#include <cerrno>
+#endif
+
+
+OutputThread::OutputThread(QObject* parent)
+    : QThread(parent)
+    , m_settingsVersion(0)
+    , m_stopRequested(false)
+    , m_framePeriodNs(int64_t(1e9 / OutputManagerConstants::outputThreadFps))
+    , m_latencyAvg(0.0)
+    , m_latencyMax(0.0)
+    , m_jitterAvg(0.0)
+    , m_jitterMax(0.0)
+    , m_overrunCount(0)
+{
+
+}
+
+OutputThread::~OutputThread() {
+    requestStop();
+    wait();
+}
+
+void OutputThread::publishFrame() {
+    m_frames.writeBuffer().publishTime = Clock::now();
+    m_frames.publish();
+}
+
+void OutputThread::setSettings(const OutputSettings& settings) {
+    QMutexLocker locker(&m_settingsMutex);
+    m_settings = settings;
+    ++m_settingsVersion;
+}
+
+void OutputThread::run() {
+    // the senders are created here to live in this thread:
+    SAcnSender sAcnSender;
+    ArtNetSubnetSender artnet(0, 0);
+    OutputSettings settings;
+    int appliedSettingsVersion = -1;
+
+    // keep-alive state per universe:
+    QVector<QVector<uint8_t>> lastSentData;
+    QVector<int> repeatsLeft;
+    QVector<Clock::time_point> lastSendTime;
+    const auto keepAliveInterval = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(OutputManagerConstants::keepAliveInterval));
+
+    // statistics of the current one second period:
+    double latencySum = 0.0;
+    double latencyMax = 0.0;
+    int latencyCount = 0;
+    double jitterSum = 0.0;
+    double jitterMax = 0.0;
+    int jitterCount = 0;
+    Clock::time_point statisticsStart = Clock::now();
+
+    Clock::time_point deadline = Clock::now();
+    while (!m_stopRequested) {
+        const Clock::duration period = std::chrono::nanoseconds(m_framePeriodNs);
+        deadline += period;
+        sleepUntil(deadline);
+        const Clock::time_point wakeTime = Clock::now();
+
+        // send jitter is the delay between the deadline and the actual wake up:
+        const double jitter = std::chrono::duration<double>(wakeTime - deadline).count();
+        jitterSum += jitter;
+        jitterMax = std::max(jitterMax, jitter);
+        ++jitterCount;
+        if (wakeTime - deadline > period) {
+            // too late for at least one tick, skip the missed ones instead of sending them in a burst:
+            deadline = wakeTime;
+            ++m_overrunCount;
+        }
+
+        // apply changed settings:
+        bool forceRefresh = false;
+        if (m_settingsVersion != appliedSettingsVersion) {
+            QMutexLocker locker(&m_settingsMutex);
+            settings = m_settings;
+            appliedSettingsVersion = m_settingsVersion;
+            locker.unlock();
+            sAcnSender.setStartUniverse(settings.sAcnStartUniverse);
+            sAcnSender.setPriority(settings.sAcnPriority);
+            artnet.setNetAndSubnet(settings.artnetNet, settings.artnetSubnet);
+            forceRefresh = true;
+        }
+
+        const bool newFrame = m_frames.fetch();
+        const DmxFrame& frame = m_frames.readBuffer();
+        const int universeCount = frame.universes.size();
+        if (universeCount > lastSentData.size()) {
+            lastSentData.resize(universeCount);
+            repeatsLeft.resize(universeCount);
+            lastSendTime.resize(universeCount);
+            sAcnSender.setUniverseCount(universeCount);
+            artnet.setUniverseCount(qMax(16, universeCount));
+        }
+
+        bool changedDataSent = false;
+        for (int universe = 0; universe < universeCount; ++universe) {
+            const QVector<uint8_t>& data = frame.universes[universe];
+            QVector<uint8_t>& lastData = lastSentData[universe];
+            const bool changed = lastData.size() != data.size()
+                    || (newFrame && !std::equal(data.begin(), data.end(), lastData.begin()));
+
+            // keep-alive policy: changed universes are sent immediately and repeated a few
+            // times, unchanged universes are refreshed only each keepAliveInterval:
+            if (changed || forceRefresh) {
+                repeatsLeft[universe] = OutputManagerConstants::repeatsAfterChange;
+            } else if (repeatsLeft[universe] > 0) {
+                --repeatsLeft[universe];
+            } else if (wakeTime - lastSendTime[universe] < keepAliveInterval) {
+                continue;
+            }
+
+            if (settings.artnetEnabled) {
+                if (settings.broadcastArtnet) {
+                    artnet.sendUniverseBroadcast(universe, data);
+                } else {
+                    // unicast requires the ArtNetDiscoveryManager that is currently disabled
+                }
+            }
+            if (settings.sAcnEnabled) {
+                sAcnSender.sendUniverseMulticast(universe, data);
+            }
+            if (changed) {
+                lastData.resize(data.size());
+                std::copy(data.begin(), data.end(), lastData.begin());
+                changedDataSent = true;
+            }
+            lastSendTime[universe] = wakeTime;
+        }
+
+        // frame-to-wire latency is measured from publishing a frame to sending its changes:
+        if (changedDataSent && (settings.sAcnEnabled || settings.artnetEnabled)) {
+            const double latency = std::chrono::duration<double>(Clock::now() - frame.publishTime).count();
+            latencySum += latency;
+            latencyMax = std::max(latencyMax, latency);
+            ++latencyCount;
+        }
+
+        // publish statistics each second:
+        if (wakeTime - statisticsStart >= std::chrono::seconds(1)) {
+            m_latencyAvg = latencyCount ? latencySum / latencyCount : 0.0;
+            m_latencyMax = latencyMax;
+            m_jitterAvg = jitterCount ? jitterSum / jitterCount : 0.0;
+            m_jitterMax = jitterMax;
+            latencySum = latencyMax = jitterSum = jitterMax = 0.0;
+            latencyCount = jitterCount = 0;
+            statisticsStart = wakeTime;
+        }
+    }
+}
+
+void OutputThread::sleepUntil(Clock::time_point deadline) {
+#if defined(Q_OS_LINUX)
+    // steady_clock is based on CLOCK_MONOTONIC, absolute deadlines don't accumulate drift:
+    const auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch());
+    timespec ts;
+    ts.tv_sec = time_t(sinceEpoch.count() / 1000000000);
+    ts.tv_nsec = long(sinceEpoch.count() % 1000000000);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+#else
+    std::this_thread::sleep_until(deadline);
+#endif
+}
@@ -0,0 +1,115 @@
+#ifndef OUTPUTTHREAD_H
+#define OUTPUTTHREAD_H
+
+#include "core/TripleBuffer.h"
+
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+
+/**
+ * @brief The DmxFrame struct contains the DMX data of all universes of one engine frame.
+ */
+struct DmxFrame {
+    QVector<QVector<uint8_t>> universes;
+    std::chrono::steady_clock::time_point publishTime;
+};
+
+/**
+ * @brief The OutputSettings struct contains the protocol settings used by the OutputThread.
+ */
+struct OutputSettings {
+    bool sAcnEnabled = false;
+    bool artnetEnabled = false;
+    bool broadcastArtnet = false;
+    int sAcnStartUniverse = 1;
+    int sAcnPriority = 100;
+    int artnetNet = 0;
+    int artnetSubnet = 0;
+};
+
+
+/**
+ * @brief The OutputThread class sends the DMX frames published by the OutputManager
+ * at a fixed rate, independent from the Engine and the GUI thread.
+ *
+ * Frames are passed through a lock-free TripleBuffer, so a stalled engine tick only means
+ * that the last frame is sent again. The thread wakes up at absolute deadlines
+ * and measures the frame-to-wire latency and the send jitter.
+ */
+class OutputThread : public QThread {
+
+    Q_OBJECT
+
+public:
+    explicit OutputThread(QObject* parent = nullptr);
+    ~OutputThread() override;
+
+    // ---------------- called from the engine (GUI) thread:
+
+    /**
+     * @brief frameToWrite returns the frame to be filled before calling publishFrame()
+     * @return a frame object that is not accessed by the output thread
+     */
+    DmxFrame& frameToWrite() { return m_frames.writeBuffer(); }
+
+    /**
+     * @brief publishFrame passes the content of frameToWrite() to the output thread
+     */
+    void publishFrame();
+
+    /**
+     * @brief setSettings changes the protocol settings, applied with the next sent frame
+     * @param settings new settings
+     */
+    void setSettings(const OutputSettings& settings);
+
+    /**
+     * @brief requestStop stops the thread after the current frame
+     */
+    void requestStop() { m_stopRequested = true; }
+
+    // ---------------- statistics of the last second (thread-safe):
+
+    double getLatencyAvg() const { return m_latencyAvg.load(); }
+    double getLatencyMax() const { return m_latencyMax.load(); }
+    double getJitterAvg() const { return m_jitterAvg.load(); }
+    double getJitterMax() const { return m_jitterMax.load(); }
+    int getOverrunCount() const { return m_overrunCount.load(); }
+
+protected:
+    void run() override;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * @brief sleepUntil blocks until the absolute deadline is reached
+     * @param deadline point in time of the steady / monotonic clock
+     */
+    static void sleepUntil(Clock::time_point deadline);
+
+protected:
+    TripleBuffer<DmxFrame> m_frames;
+
+    QMutex m_settingsMutex;  //!< protects m_settings
+    OutputSettings m_settings;
+    std::atomic<int> m_settingsVersion;  //!< incremented each time the settings change
+
+    std::atomic<bool> m_stopRequested;
+    const int64_t m_framePeriodNs;  //!< send period, fixed to OutputManagerConstants::outputThreadFps
+
+    // statistics in seconds:
+    std::atomic<double> m_latencyAvg;
+    std::atomic<double> m_latencyMax;
+    std::atomic<double> m_jitterAvg;
+    std::atomic<double> m_jitterMax;
+    std::atomic<int> m_overrunCount;  //!< number of ticks that were too late and skipped
+};
+
+#endif // OUTPUTTHREAD_H
@@ -32,12 +32,19 @@ RESOURCES += qml.qrc \
     tutorial.qrc
 
 SOURCES += main.cpp \
+    audio/AudioAnalysisCache.cpp \
+    audio/AudioAnalysisThread.cpp \
+    audio/AudioCaptureDevice.cpp \
     audio/AudioEngine.cpp \
     audio/AudioInputAnalyzer.cpp \
+    audio/AudioKernels.cpp \
     audio/AudioPlayerQt.cpp \
     audio/AudioWaveform.cpp \
     audio/QWaveDecoder.cpp \
     audio/SpeechInputAnalyzer.cpp \
+    audio/WavFileReader.cpp \
+    audio/WaveformAnalysisThread.cpp \
+    audio/WaveformPyramid.cpp \
     block_implementations/Audio/AudioLevelBlock.cpp \
     block_implementations/Audio/AudioPlaybackBlock.cpp \
     block_implementations/Audio/AudioStreamingBlock.cpp \
@@ -132,8 +139,10 @@ SOURCES += main.cpp \
     block_implementations/X32/X32OscMonitorBlock.cpp \
     block_implementations/X32/XAirAuxBlock.cpp \
     core/Cue.cpp \
+    core/CueTimeline.cpp \
     core/MainController.cpp \
     core/Matrix.cpp \
+    core/MatrixKernels.cpp \
     core/NodeData.cpp \
     core/Nodes.cpp \
     core/SmartAttribute.cpp \
@@ -145,13 +154,18 @@ SOURCES += main.cpp \
     core/block_data/OneInputBlock.cpp \
     core/block_data/OneOutputBlock.cpp \
     core/manager/AnchorManager.cpp \
+    core/manager/BinaryProjectFile.cpp \
     core/manager/BlockManager.cpp \
     core/manager/Engine.cpp \
+    core/manager/GraphEvaluator.cpp \
     core/manager/FileSystemManager.cpp \
     core/manager/GuiManager.cpp \
+    core/manager/GuiUpdateBatcher.cpp \
     core/manager/HandoffManager.cpp \
     core/manager/LogManager.cpp \
+    core/manager/ProjectLoadThread.cpp \
     core/manager/ProjectManager.cpp \
+    core/manager/ProjectSaveThread.cpp \
     core/manager/UpdateManager.cpp \
     eos_specific/EosActiveChannelsManager.cpp \
     eos_specific/EosCue.cpp \
@@ -161,11 +175,16 @@ SOURCES += main.cpp \
     eos_specific/EosOSCMessage.cpp \
     light/ArtNetDiscoveryManager.cpp \
     light/ArtNetSender.cpp \
+    light/DmxRenderer.cpp \
     light/OutputManager.cpp \
+    light/OutputThread.cpp \
+    midi/MidiInputQueue.cpp \
     midi/MidiManager.cpp \
     midi/MidiMappingManager.cpp \
     osc/GlobalOscCommands.cpp \
+    osc/OSCAddressDispatcher.cpp \
     osc/OSCMessage.cpp \
+    osc/OSCMessageView.cpp \
     osc/OSCNetworkManager.cpp \
     osc/OSCParser.cpp \
     other/PowermateListener.cpp \
@@ -189,6 +208,7 @@ SOURCES += main.cpp \
     block_implementations/Logic/PresentationRemoteBlock.cpp \
     block_implementations/Eos/EosSpeedMasterBlock.cpp \
     sacn/sacnlistener.cpp \
+    sacn/sacnreceiver.cpp \
     sacn/sacnsender.cpp \
     sacn/sacnsocket.cpp \
     sacn/sacnuniverselistmodel.cpp \
@@ -208,12 +228,19 @@ SOURCES += main.cpp \
     eos_specific/OSCDiscovery.cpp
 
 HEADERS += \
+    audio/AudioAnalysisCache.h \
+    audio/AudioAnalysisThread.h \
+    audio/AudioCaptureDevice.h \
     audio/AudioEngine.h \
     audio/AudioInputAnalyzer.h \
+    audio/AudioKernels.h \
     audio/AudioPlayerQt.h \
     audio/AudioWaveform.h \
     audio/QWaveDecoder.h \
     audio/SpeechInputAnalyzer.h \
+    audio/WavFileReader.h \
+    audio/WaveformAnalysisThread.h \
+    audio/WaveformPyramid.h \
     block_implementations/Audio/AudioLevelBlock.h \
     block_implementations/Audio/AudioPlaybackBlock.h \
     block_implementations/Audio/AudioStreamingBlock.h \
@@ -309,12 +336,17 @@ HEADERS += \
     block_implementations/X32/X32OscMonitorBlock.h \
     block_implementations/X32/XAirAuxBlock.h \
     core/Cue.h \
+    core/CueTimeline.h \
     core/MainController.h \
     core/Matrix.h \
+    core/MatrixKernels.h \
     core/NodeData.h \
     core/Nodes.h \
     core/QCircularBuffer.h \
+    core/SimdOps.h \
     core/SmartAttribute.h \
+    core/SpscRingBuffer.h \
+    core/TripleBuffer.h \
     core/block_data/BlockBase.h \
     core/block_data/BlockInterface.h \
     core/block_data/BlockList.h \
@@ -324,13 +356,18 @@ HEADERS += \
     core/block_data/OneOutputBlock.h \
     core/block_data/SceneBlockInterface.h \
     core/manager/AnchorManager.h \
+    core/manager/BinaryProjectFile.h \
     core/manager/BlockManager.h \
     core/manager/Engine.h \
+    core/manager/GraphEvaluator.h \
     core/manager/FileSystemManager.h \
     core/manager/GuiManager.h \
+    core/manager/GuiUpdateBatcher.h \
     core/manager/HandoffManager.h \
     core/manager/LogManager.h \
+    core/manager/ProjectLoadThread.h \
     core/manager/ProjectManager.h \
+    core/manager/ProjectSaveThread.h \
     core/manager/UpdateManager.h \
     eos_specific/EosActiveChannelsManager.h \
     eos_specific/EosCue.h \
@@ -360,11 +397,16 @@ HEADERS += \
     ffft/def.h \
     light/ArtNetDiscoveryManager.h \
     light/ArtNetSender.h \
+    light/DmxRenderer.h \
     light/OutputManager.h \
+    light/OutputThread.h \
+    midi/MidiInputQueue.h \
     midi/MidiManager.h \
     midi/MidiMappingManager.h \
     osc/GlobalOscCommands.h \
+    osc/OSCAddressDispatcher.h \
     osc/OSCMessage.h \
+    osc/OSCMessageView.h \
     osc/OSCNetworkManager.h \
     osc/OSCParser.h \
     other/PowermateListener.h \
@@ -390,6 +432,7 @@ HEADERS += \
     block_implementations/Logic/PresentationRemoteBlock.h \
     block_implementations/Eos/EosSpeedMasterBlock.h \
     sacn/sacnlistener.h \
+    sacn/sacnreceiver.h \
     sacn/sacnsender.h \
     sacn/sacnsocket.h \
     sacn/sacnuniverselistmodel.h \
@@ -0,0 +1,83 @@
+#include "MidiInputQueue.h"
+
+#include <cstring>
+
+
+MidiInputQueue::MidiInputQueue()
+    : m_events(EVENT_CAPACITY)
+    , m_changedSlots(SLOT_COUNT)
+    , m_pushedCount(0)
+    , m_droppedCount(0)
+{
+    for (std::atomic<quint32>& value: m_latestValues) {
+        value.store(EMPTY_SLOT, std::memory_order_relaxed);
+    }
+}
+
+void MidiInputQueue::push(const MidiEvent& event) {
+    m_pushedCount.fetch_add(1, std::memory_order_relaxed);
+
+    const int slot = slotFor(event);
+    if (slot < 0) {
+        if (m_events.push(&event, 1) == 0) {
+            m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    const float value = float(event.value);
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    // only the transition from empty to a value announces the slot,
+    // so it is at most once in m_changedSlots and that can never overflow:
+    if (m_latestValues[std::size_t(slot)].exchange(bits, std::memory_order_release) == EMPTY_SLOT) {
+        const quint16 index = quint16(slot);
+        m_changedSlots.push(&index, 1);
+    }
+}
+
+std::size_t MidiInputQueue::drain(std::vector<MidiEvent>& out) {
+    const std::size_t pushed = m_pushedCount.exchange(0, std::memory_order_relaxed);
+
+    // lossless events:
+    const std::size_t eventCount = m_events.available();
+    const std::size_t offset = out.size();
+    out.resize(offset + eventCount);
+    m_events.pop(out.data() + offset, eventCount);
+
+    // coalesced events:
+    quint16 slot;
+    while (m_changedSlots.pop(&slot, 1)) {
+        const quint32 bits = m_latestValues[slot].exchange(EMPTY_SLOT, std::memory_order_acquire);
+        if (bits == EMPTY_SLOT) continue;
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        out.push_back(eventForSlot(slot, value));
+    }
+    return pushed;
+}
+
+int MidiInputQueue::slotFor(const MidiEvent& event) {
+    if (event.channel < 1 || event.channel > 16) return -1;
+    if (event.type == MidiConstants::CONTROL_CHANGE && event.target >= 0 && event.target < 128) {
+        return (event.channel - 1) * 128 + event.target;
+    } else if (event.type == MidiConstants::PITCH_BEND) {
+        return CONTROLLER_SLOT_COUNT + event.channel - 1;
+    }
+    return -1;
+}
+
+MidiEvent MidiInputQueue::eventForSlot(int slot, float value) {
+    int type, channel, target;
+    if (slot < CONTROLLER_SLOT_COUNT) {
+        type = MidiConstants::CONTROL_CHANGE;
+        channel = slot / 128 + 1;
+        target = slot % 128;
+    } else {
+        type = MidiConstants::PITCH_BEND;
+        channel = slot - CONTROLLER_SLOT_COUNT + 1;
+        target = 0;
+    }
+    const quint32 key = MidiConstants::packKey(MidiConstants::ANY_PORT, quint8(type), quint8(channel), quint8(target));
+    return MidiEvent {key, double(value), type, channel, target, false};
+}
@@ -0,0 +1,96 @@
+#ifndef MIDIINPUTQUEUE_H
+#define MIDIINPUTQUEUE_H
+
+#include "MidiManager.h"
+#include "core/SpscRingBuffer.h"
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+
+/**
+ * @brief The MidiInputQueue class passes the events of one Midi input port from the
+ * RtMidi thread to the GUI thread without locks.
+ *
+ * Control Change and Pitch Bend messages are coalesced: there is a "latest value" mailbox
+ * for each controller and channel, so a fader that sends hundreds of messages per second
+ * results in at most one event per drain() call. All other messages (i.e. Notes and
+ * Program Changes) are passed losslessly and in order through a ring buffer.
+ *
+ * The order between both kinds is intentionally not kept within one drain() call: the
+ * coalesced values are delivered after all lossless events of that frame, even if a
+ * controller moved before a Note On. A coalesced value has no single arrival time, and
+ * delivering the latest controller values last leaves the controls at their newest state.
+ * Events of different frames (Engine ticks) stay in order.
+ *
+ * push() must only be called by one thread (the RtMidi callback of the port),
+ * drain() only by one other thread (the GUI thread, once per Engine tick).
+ */
+class MidiInputQueue {
+
+public:
+    // capacity of the queue for lossless events, more than enough for one frame:
+    static const std::size_t EVENT_CAPACITY = 4096;
+
+    MidiInputQueue();
+
+    // ---------------- Producer:
+
+    /**
+     * @brief push adds an event to the queue or updates the mailbox of its controller
+     * @param event the received event
+     */
+    void push(const MidiEvent& event);
+
+    // ---------------- Consumer:
+
+    /**
+     * @brief drain appends all queued events to out, first the lossless events in the order
+     * they were received, then the latest value of each controller that changed
+     * (also if it changed before one of the lossless events, see class description)
+     * @param out vector to append the events to
+     * @return number of events pushed since the last call to drain() (including coalesced
+     * and dropped ones)
+     */
+    std::size_t drain(std::vector<MidiEvent>& out);
+
+    /**
+     * @brief takeDroppedCount returns the number of lossless events that were dropped because
+     * the queue was full and resets it
+     * @return number of events
+     */
+    std::size_t takeDroppedCount() { return m_droppedCount.exchange(0, std::memory_order_relaxed); }
+
+private:
+    // mailbox slots: one for each controller in each channel, one for Pitch Bend in each channel
+    static const int CONTROLLER_SLOT_COUNT = 16 * 128;
+    static const int SLOT_COUNT = CONTROLLER_SLOT_COUNT + 16;
+
+    // value of an empty mailbox (a NaN bit pattern that is never stored otherwise):
+    static const quint32 EMPTY_SLOT = 0xFFFFFFFF;
+
+    /**
+     * @brief slotFor returns the mailbox slot of a coalescable event
+     * @param event a Midi event
+     * @return slot index or -1 if the event must not be coalesced
+     */
+    static int slotFor(const MidiEvent& event);
+
+    /**
+     * @brief eventForSlot recreates an event from a mailbox slot
+     * @param slot index of the slot
+     * @param value value from the slot
+     * @return the event
+     */
+    static MidiEvent eventForSlot(int slot, float value);
+
+protected:
+    SpscRingBuffer<MidiEvent> m_events;  //!< lossless events
+    std::array<std::atomic<quint32>, SLOT_COUNT> m_latestValues;  //!< float bits of the latest value or EMPTY_SLOT
+    SpscRingBuffer<quint16> m_changedSlots;  //!< slots that changed from empty to a value, each at most once
+    std::atomic<std::size_t> m_pushedCount;  //!< events pushed since the last drain()
+    std::atomic<std::size_t> m_droppedCount;  //!< lossless events dropped since the last takeDroppedCount()
+};
+
+#endif // MIDIINPUTQUEUE_H
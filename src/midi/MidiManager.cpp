@@ -19,13 +19,15 @@
 // THE SOFTWARE.
 
 #include "MidiManager.h"
+
+#include "MidiInputQueue.h"
 #include "core/MainController.h"
 
 
 MidiEvent MidiEvent::FromRawMessage(QString /*portName*/, std::vector<unsigned char>* message) {
 	if (message->size() < 2) {
 		// data is too short, return empty event:
-		return MidiEvent {"", 0, 0, 0, 0, false};
+		return MidiEvent {0, 0, 0, 0, 0, false};
 	}
 
 	// split message in type, channel, target and value:
@@ -41,6 +43,11 @@ MidiEvent MidiEvent::FromRawMessage(QString /*portName*/, std::vector<unsigned c
 	if (type == MidiConstants::PROGRAM_CHANGE) {
 		// Program Change doesn't have value, use program number as value:
 		value = 1.0;
+	} else if (type == MidiConstants::PITCH_BEND) {
+		if (message->size() < 3) return MidiEvent {0, 0, 0, 0, 0, false};
+		// 14 bit value, LSB first, there is no target:
+		value = ((message->at(2) << 7) | message->at(1)) / 16383.;
+		target = 0;
 	} else if (type == MidiConstants::NOTE_OFF) {
 		// convert note_off to note_on with value 0:
 		type = MidiConstants::NOTE_ON;
@@ -51,17 +58,30 @@ MidiEvent MidiEvent::FromRawMessage(QString /*portName*/, std::vector<unsigned c
 		value = message->at(2) / 127.;
 	}
 
-    // create inputId from status and target:
+    // create key from status and target:
+    // -> don't include port because it changes by the count of connected devices
+    const quint32 key = MidiConstants::packKey(MidiConstants::ANY_PORT, quint8(type), quint8(channel), quint8(target));
 
+	MidiEvent event{key, value, type, channel, target, convertedFromNoteOff};
+	return event;
+}
+
+QString MidiEvent::inputIdFromKey(quint32 key) {
     QString inputId = "%1%2%3";
-    inputId = inputId.arg(type, 3, 10, QChar('0'));
-    inputId = inputId.arg(channel, 3, 10, QChar('0'));
-    inputId = inputId.arg(target, 3, 10, QChar('0'));
-    //inputId = inputId.arg(portName);
-    // -> don't include port name because it changes by the count of connected devices
+    inputId = inputId.arg(MidiConstants::keyType(key), 3, 10, QChar('0'));
+    inputId = inputId.arg(MidiConstants::keyChannel(key), 3, 10, QChar('0'));
+    inputId = inputId.arg(MidiConstants::keyTarget(key), 3, 10, QChar('0'));
+    return inputId;
+}
 
-	MidiEvent event{inputId, value, type, channel, target, convertedFromNoteOff};
-	return event;
+quint32 MidiEvent::keyFromInputId(const QString& inputId) {
+    if (inputId.size() != 9) return 0;
+    bool typeOk, channelOk, targetOk;
+    const int type = inputId.midRef(0, 3).toInt(&typeOk);
+    const int channel = inputId.midRef(3, 3).toInt(&channelOk);
+    const int target = inputId.midRef(6, 3).toInt(&targetOk);
+    if (!typeOk || !channelOk || !targetOk || type > 255 || channel > 255 || target > 255) return 0;
+    return MidiConstants::packKey(MidiConstants::ANY_PORT, quint8(type), quint8(channel), quint8(target));
 }
 
 // The following code will only be used when the RtMidi library is available on the platform.
@@ -74,6 +94,7 @@ MidiEvent MidiEvent::FromRawMessage(QString /*portName*/, std::vector<unsigned c
 
 MidiInputDevice::MidiInputDevice(uint portNumber, QObject *parent)
 	: QObject(parent)
+	, m_queue(new MidiInputQueue())
 {
 	m_portNumber = portNumber;
 
@@ -91,6 +112,7 @@ MidiInputDevice::MidiInputDevice(uint portNumber, QObject *parent)
 
 MidiInputDevice::MidiInputDevice(QObject* parent)
 	: QObject(parent)
+	, m_queue(new MidiInputQueue())
 {
     m_portNumber = 0;
 
@@ -107,6 +129,7 @@ MidiInputDevice::MidiInputDevice(QObject* parent)
 }
 
 MidiInputDevice::~MidiInputDevice() {
+	// stops the RtMidi thread before the queue is deleted:
 	delete m_input;
 	m_input = nullptr;
 }
@@ -121,7 +144,8 @@ void MidiInputDevice::staticMidiCallback(double, std::vector<unsigned char>* mes
 
 void MidiInputDevice::rawMidiCallback(std::vector<unsigned char> *message) {
 	MidiEvent event = MidiEvent::FromRawMessage(m_portName, message);
-    emit eventReceived(event);
+    if (!event.key) return;  // invalid message
+    m_queue->push(event);
 }
 
 
@@ -142,6 +166,9 @@ MidiManager::MidiManager(MainController *controller)
     , m_autoRefresh(false)
     , m_hiddenInputPorts(0)
     , m_hiddenOutputPorts(0)
+    , m_receivedEventCount(0)
+    , m_appliedEventCount(0)
+    , m_droppedEventCount(0)
 {
     // prepare log changed signal:
     m_logChangedSignalDelay.setSingleShot(true);
@@ -149,6 +176,8 @@ MidiManager::MidiManager(MainController *controller)
     connect(&m_logChangedSignalDelay, SIGNAL(timeout()), this, SIGNAL(logChanged()));
     connect(this, SIGNAL(autoRefreshChanged()), this, SLOT(switchAutoRefresh()));
     connect(&m_autoRefreshTimer, SIGNAL(timeout()), this, SLOT(refreshDevices()));
+    // received events are handled once per frame before the blocks are updated:
+    connect(controller->engine(), SIGNAL(updateBlocks(double)), this, SLOT(drainInputQueues()));
 
     // prepare Port Blacklist:
     m_portNameBlacklist << "Microsoft GS Wavetable Synth"
@@ -189,7 +218,6 @@ void MidiManager::initializeInputs() {
 	// create virtual input port:
 	MidiInputDevice* virtualInput = new MidiInputDevice(this);
 	m_inputs.push_back(virtualInput);
-	connect(virtualInput, SIGNAL(eventReceived(MidiEvent)), this, SLOT(onExternalEvent(MidiEvent)));
     m_hiddenInputPorts++;
 #endif  // Q_OS_WIN
 
@@ -257,7 +285,7 @@ void MidiManager::refreshInputs() {
     for (auto idx = toDelete.size() - 1; idx >=0; idx--) {
         unsigned int i = toDelete[idx];
             if (m_inputs.size() > i + m_hiddenInputPorts) {
-                disconnect(m_inputs[i + m_hiddenInputPorts], SIGNAL(eventReceived(MidiEvent)), this, SLOT(onExternalEvent(MidiEvent)));
+                drainInputQueues();  // don't lose the last events of the port
                 delete m_inputs[i + m_hiddenInputPorts];
                 m_inputs.erase(m_inputs.begin() + i  + m_hiddenInputPorts);
                 m_inputPortNames.remove((int) i);
@@ -274,7 +302,6 @@ void MidiManager::refreshInputs() {
         MidiInputDevice* input = new MidiInputDevice(portIdx[i], this);
         m_inputs.push_back(input);
         m_inputPortNames.push_back(portName);
-        connect(input, SIGNAL(eventReceived(MidiEvent)), this, SLOT(onExternalEvent(MidiEvent)));
         newInput = true;
     }
     if (newInput)
@@ -504,14 +531,20 @@ QString MidiManager::getFeedbackAddress(unsigned char type, unsigned char channe
     return QString(address.toBase64());
 }
 
-void MidiManager::sendFeedback(QString addressString, double value) {
-    QByteArray address = QByteArray::fromBase64(addressString.toLatin1());
+quint32 MidiManager::getFeedbackKey(const QString& addressString) {
+    const QByteArray address = QByteArray::fromBase64(addressString.toLatin1());
+    if (address.size() < 3) return 0;
+    return MidiConstants::packKey(MidiConstants::ANY_PORT, quint8(address[0]), quint8(address[1]), quint8(address[2]));
+}
 
-    unsigned char type = address[0];
-    unsigned char channel = address[1];
-    unsigned char target = address[2];
+void MidiManager::sendFeedback(QString addressString, double value) {
+    const quint32 key = getFeedbackKey(addressString);
+    if (!key) return;
+    sendFeedback(key, value);
+}
 
-    sendChannelVoiceMessage(type, channel, target, value);
+void MidiManager::sendFeedback(quint32 key, double value) {
+    sendChannelVoiceMessage(MidiConstants::keyType(key), MidiConstants::keyChannel(key), MidiConstants::keyTarget(key), value);
 }
 
 void MidiManager::onExternalEvent(MidiEvent event) {
@@ -530,6 +563,27 @@ void MidiManager::onExternalEvent(MidiEvent event) {
              event.channel, event.target, event.value);
 }
 
+void MidiManager::drainInputQueues() {
+#ifdef RT_MIDI_AVAILABLE
+    m_drainedEvents.clear();
+    for (const QPointer<MidiInputDevice>& input: m_inputs) {
+        if (!input) continue;
+        m_receivedEventCount += input->getQueue().drain(m_drainedEvents);
+        m_droppedEventCount += input->getQueue().takeDroppedCount();
+    }
+    for (const MidiEvent& event: m_drainedEvents) {
+        onExternalEvent(event);
+    }
+    m_appliedEventCount += m_drainedEvents.size();
+#endif  // RT_MIDI_AVAILABLE
+}
 
-
-
+QVariantMap MidiManager::getInputStatistics() const {
+    QVariantMap result;
+    result["received"] = m_receivedEventCount;
+    result["applied"] = m_appliedEventCount;
+    // events that are neither applied nor dropped were superseded by a newer value of the same controller:
+    result["coalesced"] = m_receivedEventCount - m_appliedEventCount - m_droppedEventCount;
+    result["dropped"] = m_droppedEventCount;
+    return result;
+}
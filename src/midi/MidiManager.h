@@ -28,13 +28,16 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QTimer>
+#include <QVariantMap>
 
 #include <vector>
 #include <map>
 #include <functional>
+#include <memory>
 
 // forward declaration to reduce dependencies
 class MainController;
+class MidiInputQueue;
 
 
 /**
@@ -43,9 +46,10 @@ class MainController;
  */
 struct MidiEvent {
     /**
-     * @brief inputId is the unique identifier of this event source (i.e. the MIDI channel and note)
+     * @brief key is the unique identifier of this event source (i.e. the MIDI channel and note)
+     * packed in 32 bit, see MidiConstants::packKey()
      */
-    QString inputId;
+    quint32 key;
 
     /**
      * @brief value of the input event between 0 and 1
@@ -80,6 +84,20 @@ struct MidiEvent {
      * @return a new Midi Event object
      */
     static MidiEvent FromRawMessage(QString /*portname*/, std::vector<unsigned char>* message);
+
+    /**
+     * @brief inputIdFromKey converts a key to the string form that is used in project files
+     * @param key a packed key
+     * @return the input ID (i.e. "011001064" for Control Change 64 on channel 1)
+     */
+    static QString inputIdFromKey(quint32 key);
+
+    /**
+     * @brief keyFromInputId converts the string form used in project files to a packed key
+     * @param inputId an input ID created by inputIdFromKey()
+     * @return the packed key or 0 if the input ID is invalid
+     */
+    static quint32 keyFromInputId(const QString& inputId);
 };
 
 
@@ -107,6 +125,33 @@ namespace MidiConstants {
 	 * @brief PROGRAM_CHANGE is the Midi code for a Program Change message
 	 */
 	static const unsigned char PROGRAM_CHANGE = 0b1100;
+	/**
+	 * @brief PITCH_BEND is the Midi code for a Pitch Bend message
+	 */
+	static const unsigned char PITCH_BEND = 0b1110;
+
+    /**
+     * @brief ANY_PORT is the port number in keys that match events of all ports
+     * (port numbers change with the count of connected devices, so mappings don't include them)
+     */
+    static const quint8 ANY_PORT = 0;
+
+    /**
+     * @brief packKey packs the address of a Midi message in a 32 bit integer
+     * to be used as a key in routing tables
+     * @param port port number or ANY_PORT
+     * @param type Midi message type (see above)
+     * @param channel Midi channel [1-16]
+     * @param target first argument of the message [0-127]
+     * @return packed key
+     */
+    inline quint32 packKey(quint8 port, quint8 type, quint8 channel, quint8 target) {
+        return (quint32(port) << 24) | (quint32(type) << 16) | (quint32(channel) << 8) | quint32(target);
+    }
+    inline quint8 keyPort(quint32 key) { return quint8(key >> 24); }
+    inline quint8 keyType(quint32 key) { return quint8(key >> 16); }
+    inline quint8 keyChannel(quint32 key) { return quint8(key >> 8); }
+    inline quint8 keyTarget(quint32 key) { return quint8(key); }
 
     typedef std::function<void(MidiEvent)> NextEventCallback;
 }
@@ -125,7 +170,8 @@ namespace MidiConstants {
 
 /**
  * @brief The MidiInputDevice class represents a single Midi input device.
- * It stores the name of the port and converts the raw messages to ExternalInputEvents.
+ * It stores the name of the port and converts the raw messages to MidiEvents.
+ * The events are passed to the GUI thread through a MidiInputQueue.
  */
 class MidiInputDevice : public QObject {
 
@@ -153,8 +199,8 @@ public:
 	static void staticMidiCallback(double, std::vector<unsigned char> *message, void *instance);
 
 	/**
-	 * @brief rawMidiCallback converts a raw Midi message to an ExternalInputEvent struct
-	 * and emits the eventReceived signal
+	 * @brief rawMidiCallback converts a raw Midi message to a MidiEvent struct
+	 * and pushes it to the queue, called in the RtMidi thread
 	 * @param message is the raw Midi data
 	 */
     void rawMidiCallback(std::vector<unsigned char>* message);
@@ -165,12 +211,11 @@ public:
      */
     QString getPortName() const { return m_portName; }
 
-signals:
-	/**
-	 * @brief eventReceived will be emitted when a Midi event has been received
-	 * @param event is the event that has been received (with a normalized value)
-	 */
-	void eventReceived(MidiEvent event);
+    /**
+     * @brief getQueue returns the queue of received events, to be drained in the GUI thread
+     * @return the queue of this device
+     */
+    MidiInputQueue& getQueue() { return *m_queue; }
 
 protected:
 
@@ -188,6 +233,11 @@ protected:
 	 * @brief m_portName is the human readable name of the Midi port
 	 */
 	QString m_portName;
+
+	/**
+	 * @brief m_queue passes the received events to the GUI thread
+	 */
+	std::unique_ptr<MidiInputQueue> m_queue;
 };
 
 #endif // RT_MIDI_AVAILABLE
@@ -214,9 +264,6 @@ public:
 	static void staticMidiCallback(double, std::vector<unsigned char> * /*message*/, void */*userData*/) {}
 
 	void rawMidiCallback(std::vector<unsigned char>* /*message*/) {}
-
-signals:
-    void eventReceived(MidiEvent event);
 };
 
 #endif // not RT_MIDI_AVAILABLE
@@ -362,16 +409,55 @@ public slots:
 	 */
 	void sendChannelVoiceMessage(unsigned char type, unsigned char channel, unsigned char target);
 
+    /**
+     * @brief getFeedbackAddress returns the string form of a feedback target
+     * that is used in project files
+     * @param type Midi code for message type (see MidiConstants)
+     * @param channel midi output channel
+     * @param target first argument of the message
+     * @return the address as Base64 string
+     */
     QString getFeedbackAddress(unsigned char type, unsigned char channel, unsigned char target) const;
 
+    /**
+     * @brief getFeedbackKey converts a feedback address to a packed key
+     * @param addressString an address returned by getFeedbackAddress()
+     * @return packed key (see MidiConstants::packKey()) or 0 if the address is invalid
+     */
+    static quint32 getFeedbackKey(const QString& addressString);
+
+    /**
+     * @brief sendFeedback sends a value to a feedback target
+     * @param addressString an address returned by getFeedbackAddress()
+     * @param value the value [0...1]
+     */
     void sendFeedback(QString addressString, double value);
 
+    /**
+     * @brief sendFeedback sends a value to a feedback target without decoding an address
+     * @param key packed key returned by getFeedbackKey()
+     * @param value the value [0...1]
+     */
+    void sendFeedback(quint32 key, double value);
+
     /**
      * @brief onExternalEvent handles an incoming input event and calls associated callbacks
      * @param event the incoming input event
      */
     void onExternalEvent(MidiEvent event);
 
+    /**
+     * @brief drainInputQueues handles the events received since the last frame,
+     * called once per Engine tick
+     */
+    void drainInputQueues();
+
+    /**
+     * @brief getInputStatistics returns the number of received and applied events
+     * @return a map with "received", "applied", "coalesced" and "dropped" counts
+     */
+    QVariantMap getInputStatistics() const;
+
 	/**
 	 * @brief getToneNames returns a list of the names of tones in an octave
 	 * @return a list of tone names
@@ -555,6 +641,15 @@ protected:
 
     QTimer m_autoRefreshTimer;
 
+    /**
+     * @brief m_drainedEvents is reused by drainInputQueues() to avoid allocations
+     */
+    std::vector<MidiEvent> m_drainedEvents;
+
+    quint64 m_receivedEventCount;  //!< number of events received by all inputs
+    quint64 m_appliedEventCount;  //!< number of events handled by onExternalEvent()
+    quint64 m_droppedEventCount;  //!< number of lossless events dropped because a queue was full
+
 };
 
 #endif // MIDIMANAGER_H
@@ -13,6 +13,7 @@ MidiMappingManager::MidiMappingManager(MainController* controller)
     , m_connectFeedback(false)
     , m_releaseNextControl(false)
     , m_feedbackEnabled(true)
+    , m_routesOutdated(true)
 {
     if (!m_midi) {
         qCritical() << "Could not get MidiManager instance.";
@@ -23,16 +24,49 @@ MidiMappingManager::MidiMappingManager(MainController* controller)
 }
 
 QJsonObject MidiMappingManager::getState() const {
+    // the keys are stored in their string form to stay compatible with existing project files:
+    QMap<QString, QVector<QString>> midiToControl;
+    for (auto it = m_midiToControlMapping.constBegin(); it != m_midiToControlMapping.constEnd(); ++it) {
+        midiToControl[MidiEvent::inputIdFromKey(it.key())] = it.value();
+    }
+    QMap<QString, QVector<QString>> controlToFeedback;
+    for (auto it = m_controlToFeedbackMapping.constBegin(); it != m_controlToFeedbackMapping.constEnd(); ++it) {
+        QVector<QString>& addresses = controlToFeedback[it.key()];
+        for (quint32 key: it.value()) {
+            addresses.append(m_midi->getFeedbackAddress(MidiConstants::keyType(key), MidiConstants::keyChannel(key), MidiConstants::keyTarget(key)));
+        }
+    }
+
     QJsonObject state;
-    state["midiToControl"] = serialize(m_midiToControlMapping);
-    state["controlToFeedback"] = serialize(m_controlToFeedbackMapping);
+    state["midiToControl"] = serialize(midiToControl);
+    state["controlToFeedback"] = serialize(controlToFeedback);
     state["feedbackEnabled"] = getFeedbackEnabled();
     return state;
 }
 
 void MidiMappingManager::setState(const QJsonObject& state) {
-    m_midiToControlMapping = deserialize<QMap<QString, QVector<QString>>>(state["midiToControl"].toString());
-    m_controlToFeedbackMapping = deserialize<QMap<QString, QVector<QString>>>(state["controlToFeedback"].toString());
+    m_midiToControlMapping.clear();
+    const auto midiToControl = deserialize<QMap<QString, QVector<QString>>>(state["midiToControl"].toString());
+    for (auto it = midiToControl.constBegin(); it != midiToControl.constEnd(); ++it) {
+        const quint32 key = MidiEvent::keyFromInputId(it.key());
+        if (!key) {
+            qWarning() << "MidiMappingManager: invalid input ID in mapping:" << it.key();
+            continue;
+        }
+        m_midiToControlMapping[key] = it.value();
+    }
+
+    m_controlToFeedbackMapping.clear();
+    const auto controlToFeedback = deserialize<QMap<QString, QVector<QString>>>(state["controlToFeedback"].toString());
+    for (auto it = controlToFeedback.constBegin(); it != controlToFeedback.constEnd(); ++it) {
+        QVector<quint32>& keys = m_controlToFeedbackMapping[it.key()];
+        for (const QString& address: it.value()) {
+            const quint32 key = MidiManager::getFeedbackKey(address);
+            if (key) keys.append(key);
+        }
+    }
+    m_routesOutdated = true;
+
     if (!m_controlToFeedbackMapping.isEmpty()) {
         setFeedbackEnabled(state["feedbackEnabled"].toBool());
     }
@@ -79,6 +113,7 @@ void MidiMappingManager::registerGuiControl(QQuickItem* item, QString controlUid
     if (!item) return;
     if (controlUid.isEmpty()) return;
     m_registeredControls[controlUid] = item;
+    m_routesOutdated = true;
 }
 
 void MidiMappingManager::unregisterGuiControl(QString controlUid) {
@@ -97,11 +132,11 @@ void MidiMappingManager::unregisterGuiControl(QString controlUid) {
 //        releaseMapping(controlUid);
 //    }
     m_registeredControls.remove(controlUid);
+    m_routesOutdated = true;
 }
 
 QQuickItem* MidiMappingManager::getControlFromUid(QString controlUid) const {
-    if (!m_registeredControls.contains(controlUid)) return nullptr;
-    return m_registeredControls[controlUid];
+    return m_registeredControls.value(controlUid);
 }
 
 void MidiMappingManager::guiControlHasBeenTouched(QString controllerUid) {
@@ -120,16 +155,17 @@ void MidiMappingManager::guiControlHasBeenTouched(QString controllerUid) {
 
 void MidiMappingManager::sendFeedback(QString uid, double value) const {
     if (!m_feedbackEnabled) return;
-    if (m_controlToFeedbackMapping.contains(uid)) {
-        for (QString feedbackAddress: m_controlToFeedbackMapping[uid]) {
-            m_midi->sendFeedback(feedbackAddress, value);
-        }
+    const auto it = m_controlToFeedbackMapping.constFind(uid);
+    if (it == m_controlToFeedbackMapping.constEnd()) return;
+    for (quint32 key: it.value()) {
+        m_midi->sendFeedback(key, value);
     }
 }
 
 void MidiMappingManager::clearMapping() {
     m_midiToControlMapping.clear();
     m_controlToFeedbackMapping.clear();
+    m_routesOutdated = true;
 }
 
 // ---------------------- private -------------------------
@@ -142,13 +178,16 @@ void MidiMappingManager::mapWaitingControlToMidi(const MidiEvent& event) {
 
 void MidiMappingManager::mapControlToMidi(QString controlUid, const MidiEvent& event) {
     // append control uid to list if not already existing:
-    if (!m_midiToControlMapping[event.inputId].contains(controlUid)) {
-        m_midiToControlMapping[event.inputId].append(controlUid);
+    QVector<QString>& controlUids = m_midiToControlMapping[event.key];
+    if (!controlUids.contains(controlUid)) {
+        controlUids.append(controlUid);
+        m_routesOutdated = true;
     }
     if (m_connectFeedback) {
-        const QString feedbackAddress = m_midi->getFeedbackAddress(event.type, event.channel, event.target);
-        if (!m_controlToFeedbackMapping[controlUid].contains(feedbackAddress)) {
-            m_controlToFeedbackMapping[controlUid].append(feedbackAddress);
+        // the feedback target has the same type, channel and target as the event:
+        QVector<quint32>& feedbackKeys = m_controlToFeedbackMapping[controlUid];
+        if (!feedbackKeys.contains(event.key)) {
+            feedbackKeys.append(event.key);
         }
     }
 }
@@ -158,24 +197,39 @@ void MidiMappingManager::releaseMapping(QString controlUid) {
         controlList.removeAll(controlUid);
     }
     m_controlToFeedbackMapping.remove(controlUid);
+    m_routesOutdated = true;
 }
 
 void MidiMappingManager::releaseMapping(const MidiEvent& event) {
-    m_midiToControlMapping.remove(event.inputId);
-    const QString feedbackAddress = m_midi->getFeedbackAddress(event.type, event.channel, event.target);
-    for (auto& feedbackAddressList: m_controlToFeedbackMapping) {
-        feedbackAddressList.removeAll(feedbackAddress);
+    m_midiToControlMapping.remove(event.key);
+    for (auto& feedbackKeys: m_controlToFeedbackMapping) {
+        feedbackKeys.removeAll(event.key);
     }
+    m_routesOutdated = true;
 }
 
-void MidiMappingManager::onExternalEvent(const MidiEvent& event) const {
+void MidiMappingManager::onExternalEvent(const MidiEvent& event) {
+    if (m_routesOutdated) updateRoutes();
+
     // set "externalInput" property on controls that are mapped to this input:
-    if (m_midiToControlMapping.contains(event.inputId)) {
-        for (QString controlUid: m_midiToControlMapping[event.inputId]) {
+    const auto it = m_routes.constFind(event.key);
+    if (it == m_routes.constEnd()) return;
+    for (const QPointer<QQuickItem>& control: it.value()) {
+        // check if control still exists:
+        if (!control) continue;
+        control->setProperty("externalInput", event.value);
+    }
+}
+
+void MidiMappingManager::updateRoutes() {
+    m_routes.clear();
+    for (auto it = m_midiToControlMapping.constBegin(); it != m_midiToControlMapping.constEnd(); ++it) {
+        QVector<QPointer<QQuickItem>> controls;
+        for (const QString& controlUid: it.value()) {
             QQuickItem* control = getControlFromUid(controlUid);
-            // check if control still exists:
-            if (!control) continue;
-            control->setProperty("externalInput", event.value);
+            if (control) controls.append(control);
         }
+        if (!controls.isEmpty()) m_routes[it.key()] = controls;
     }
+    m_routesOutdated = false;
 }
@@ -5,7 +5,7 @@
 #include <QJsonObject>
 #include <QQuickItem>
 #include <QPointer>
-#include <QMap>
+#include <QHash>
 
 #include "MidiManager.h"
 
@@ -156,7 +156,13 @@ private slots:
      * @brief onExternalEvent handles an incoming input event and checks if controls are connected
      * @param event the incoming input event
      */
-    void onExternalEvent(const MidiEvent& event) const;
+    void onExternalEvent(const MidiEvent& event);
+
+private:
+    /**
+     * @brief updateRoutes rebuilds m_routes from m_midiToControlMapping and m_registeredControls
+     */
+    void updateRoutes();
 
 protected:
 
@@ -193,17 +199,30 @@ protected:
     /**
      * @brief m_registeredControls map of control UIDs and pointer to the control items
      */
-    QMap<QString, QPointer<QQuickItem>>  m_registeredControls;
+    QHash<QString, QPointer<QQuickItem>>  m_registeredControls;
+
+    /**
+     * @brief m_midiToControlMapping the mapping of Midi event keys to controlUids
+     * (the keys are converted to input ID strings only in getState() and setState())
+     */
+    QHash<quint32, QVector<QString>> m_midiToControlMapping;
+
+    /**
+     * @brief m_controlToFeedbackMapping the mapping of controlUids to feedback keys
+     * (the keys are converted to address strings only in getState() and setState())
+     */
+    QHash<QString, QVector<quint32>> m_controlToFeedbackMapping;
 
     /**
-     * @brief m_midiToControlMapping the mapping of Midi events to controlUids
+     * @brief m_routes the controls of m_midiToControlMapping resolved to the registered items,
+     * rebuilt when the mapping or the registered controls change
      */
-    QMap<QString, QVector<QString>> m_midiToControlMapping;
+    QHash<quint32, QVector<QPointer<QQuickItem>>> m_routes;
 
     /**
-     * @brief m_controlToFeedbackMapping the mapping of controlUids to feedback addresses
+     * @brief m_routesOutdated true if m_routes has to be rebuilt before it is used
      */
-    QMap<QString, QVector<QString>> m_controlToFeedbackMapping;
+    bool m_routesOutdated;
 };
 
 #endif // MIDIMAPPINGMANAGER_H
@@ -26,10 +26,11 @@ GlobalOscCommands::GlobalOscCommands(MainController* controller)
 	: QObject(controller)
 	, m_controller(controller)
 {
-	connect(m_controller->customOsc(), SIGNAL(messageReceived(OSCMessage)),
-			this, SLOT(handleMessage(OSCMessage)));
-    connect(m_controller->lightingConsole(), SIGNAL(messageReceived(OSCMessage)),
-            this, SLOT(handleMessage(OSCMessage)));
+	// all global commands start with /lumi/, other messages are not passed to this object:
+	const QString pattern = GlobalOscCommandsConstants::pathPrefix + "**";
+	auto handler = [this](const OSCMessageView& view) { handleMessage(view.toMessage()); };
+	m_controller->customOsc()->dispatcher()->addHandler(pattern, this, handler);
+	m_controller->lightingConsole()->dispatcher()->addHandler(pattern, this, handler);
 }
 
 void GlobalOscCommands::handleMessage(OSCMessage msg) {
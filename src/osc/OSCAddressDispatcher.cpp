@@ -0,0 +1,349 @@
+#include "OSCAddressDispatcher.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QVarLengthArray>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+
+namespace {
+
+/**
+ * @brief matchFrom matches the rest of a pattern part with the rest of a path part
+ */
+bool matchFrom(const char* p, const char* pEnd, const char* s, const char* sEnd) {
+    while (p < pEnd) {
+        switch (*p) {
+        case '*': {
+            while (p < pEnd && *p == '*') ++p;
+            if (p == pEnd) return true;
+            for (const char* rest = s; rest <= sEnd; ++rest) {
+                if (matchFrom(p, pEnd, rest, sEnd)) return true;
+            }
+            return false;
+        }
+        case '?':
+            if (s == sEnd) return false;
+            ++p;
+            ++s;
+            break;
+        case '[': {
+            const char* close = static_cast<const char*>(std::memchr(p + 1, ']', size_t(pEnd - p - 1)));
+            if (!close) {
+                // no closing bracket, compare as normal character:
+                if (s == sEnd || *s != '[') return false;
+                ++p;
+                ++s;
+                break;
+            }
+            if (s == sEnd) return false;
+            const char* c = p + 1;
+            const bool negate = c < close && *c == '!';
+            if (negate) ++c;
+            bool found = false;
+            for (; c < close; ++c) {
+                if (c + 2 < close && c[1] == '-') {
+                    if (*s >= c[0] && *s <= c[2]) found = true;
+                    c += 2;
+                } else if (*s == *c) {
+                    found = true;
+                }
+            }
+            if (found == negate) return false;
+            p = close + 1;
+            ++s;
+            break;
+        }
+        case '{': {
+            const char* close = static_cast<const char*>(std::memchr(p + 1, '}', size_t(pEnd - p - 1)));
+            if (!close) {
+                if (s == sEnd || *s != '{') return false;
+                ++p;
+                ++s;
+                break;
+            }
+            // try each alternative followed by the rest of the pattern:
+            const char* alternative = p + 1;
+            while (alternative <= close) {
+                const char* comma = static_cast<const char*>(std::memchr(alternative, ',', size_t(close - alternative)));
+                const char* alternativeEnd = comma ? comma : close;
+                const int length = int(alternativeEnd - alternative);
+                if (sEnd - s >= length && std::memcmp(alternative, s, size_t(length)) == 0
+                        && matchFrom(close + 1, pEnd, s + length, sEnd)) {
+                    return true;
+                }
+                alternative = alternativeEnd + 1;
+            }
+            return false;
+        }
+        default:
+            if (s == sEnd || *s != *p) return false;
+            ++p;
+            ++s;
+            break;
+        }
+    }
+    return s == sEnd;
+}
+
+}  // namespace
+
+
+OSCAddressDispatcher::OSCAddressDispatcher(QObject* parent)
+    : QObject(parent)
+    , m_nextHandlerId(0)
+    , m_nodes(1)
+    , m_trieOutdated(false)
+{
+
+}
+
+int OSCAddressDispatcher::addHandler(const QString& pattern, QObject* receiver, Handler handler, bool literal) {
+    if (!pattern.startsWith("/") || !handler) {
+        qWarning() << "OSCAddressDispatcher: Invalid pattern:" << pattern;
+        return -1;
+    }
+    const int id = m_nextHandlerId++;
+    m_handlers[id] = HandlerEntry {pattern.toLatin1(), receiver, handler, literal};
+    if (receiver) {
+        connect(receiver, SIGNAL(destroyed(QObject*)), this, SLOT(onReceiverDestroyed(QObject*)),
+                Qt::UniqueConnection);
+    }
+    m_trieOutdated = true;
+    return id;
+}
+
+void OSCAddressDispatcher::removeHandler(int id) {
+    if (m_handlers.remove(id)) {
+        m_trieOutdated = true;
+    }
+}
+
+void OSCAddressDispatcher::removeHandlers(QObject* receiver) {
+    auto it = m_handlers.begin();
+    while (it != m_handlers.end()) {
+        if (it->receiver == receiver) {
+            it = m_handlers.erase(it);
+            m_trieOutdated = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+int OSCAddressDispatcher::dispatch(const OSCMessageView& view) {
+    if (!view.isValid() || m_handlers.isEmpty()) return 0;
+    if (m_trieOutdated) rebuildTrie();
+
+    // split the path into parts without copying it:
+    const QLatin1String path = view.path();
+    m_pathParts.clear();
+    int start = 1;
+    for (int i = 1; i <= path.size(); ++i) {
+        if (i == path.size() || path.data()[i] == '/') {
+            m_pathParts.append(QLatin1String(path.data() + start, i - start));
+            start = i + 1;
+        }
+    }
+
+    m_matchedIds.clear();
+    collectMatches(0, 0);
+    if (m_matchedIds.isEmpty()) return 0;
+
+    // a handler can match more than once with "**" parts, call it only once:
+    std::sort(m_matchedIds.begin(), m_matchedIds.end());
+    m_matchedIds.erase(std::unique(m_matchedIds.begin(), m_matchedIds.end()), m_matchedIds.end());
+
+    // handlers may add or remove handlers, so the ids are copied and looked up again:
+    const QVarLengthArray<int, 32> matchedIds(m_matchedIds.begin(), m_matchedIds.end());
+    int calledHandlers = 0;
+    for (int id: matchedIds) {
+        auto it = m_handlers.constFind(id);
+        if (it == m_handlers.constEnd()) continue;
+        const Handler handler = it->handler;
+        handler(view);
+        ++calledHandlers;
+    }
+    return calledHandlers;
+}
+
+bool OSCAddressDispatcher::matchPart(QLatin1String pattern, QLatin1String part) {
+    return matchFrom(pattern.data(), pattern.data() + pattern.size(), part.data(), part.data() + part.size());
+}
+
+void OSCAddressDispatcher::rebuildTrie() {
+    m_nodes.clear();
+    m_nodes.resize(1);
+    for (auto it = m_handlers.constBegin(); it != m_handlers.constEnd(); ++it) {
+        insertPattern(it->pattern, it.key(), it->literal);
+    }
+    m_trieOutdated = false;
+}
+
+void OSCAddressDispatcher::insertPattern(const QByteArray& pattern, int handlerId, bool literal) {
+    int nodeIndex = 0;
+    // skip the leading slash:
+    for (const QByteArray& part: pattern.mid(1).split('/')) {
+        int childIndex = -1;
+        if (part == "**" && !literal) {
+            childIndex = m_nodes[nodeIndex].anyPartsChild;
+            if (childIndex < 0) {
+                childIndex = int(m_nodes.size());
+                m_nodes[nodeIndex].anyPartsChild = childIndex;
+                m_nodes.emplace_back();
+            }
+        } else if (!literal && containsWildcard(part)) {
+            for (const QPair<QByteArray, int>& child: m_nodes[nodeIndex].patternChildren) {
+                if (child.first == part) childIndex = child.second;
+            }
+            if (childIndex < 0) {
+                childIndex = int(m_nodes.size());
+                m_nodes[nodeIndex].patternChildren.append(qMakePair(part, childIndex));
+                m_nodes.emplace_back();
+            }
+        } else {
+            childIndex = m_nodes[nodeIndex].literalChildren.value(part, -1);
+            if (childIndex < 0) {
+                childIndex = int(m_nodes.size());
+                m_nodes[nodeIndex].literalChildren[part] = childIndex;
+                m_nodes.emplace_back();
+            }
+        }
+        // (m_nodes may have been reallocated, so nodes are always accessed by index)
+        nodeIndex = childIndex;
+    }
+    m_nodes[nodeIndex].handlerIds.append(handlerId);
+}
+
+void OSCAddressDispatcher::collectMatches(int nodeIndex, int partIndex) {
+    const Node& node = m_nodes[nodeIndex];
+
+    // "**" matches any number of the remaining parts:
+    if (node.anyPartsChild >= 0) {
+        for (int i = partIndex; i <= m_pathParts.size(); ++i) {
+            collectMatches(node.anyPartsChild, i);
+        }
+    }
+
+    if (partIndex == m_pathParts.size()) {
+        m_matchedIds.append(node.handlerIds);
+        return;
+    }
+
+    const QLatin1String part = m_pathParts[partIndex];
+    if (!node.literalChildren.isEmpty()) {
+        // fromRawData() doesn't copy the part:
+        const int childIndex = node.literalChildren.value(QByteArray::fromRawData(part.data(), part.size()), -1);
+        if (childIndex >= 0) collectMatches(childIndex, partIndex + 1);
+    }
+    for (const QPair<QByteArray, int>& child: node.patternChildren) {
+        if (matchPart(QLatin1String(child.first), part)) {
+            collectMatches(child.second, partIndex + 1);
+        }
+    }
+}
+
+bool OSCAddressDispatcher::containsWildcard(const QByteArray& part) {
+    for (char c: part) {
+        if (c == '*' || c == '?' || c == '[' || c == '{') return true;
+    }
+    return false;
+}
+
+// ----------------- Benchmarks:
+
+namespace {
+
+/**
+ * @brief createFloatMessage creates a raw OSC message with a single float argument
+ */
+QByteArray createFloatMessage(const QByteArray& path, float value) {
+    QByteArray data = path;
+    data.append('\0');
+    while (data.size() % 4) data.append('\0');
+    data.append(",f\0\0", 4);
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    char argument[4];
+    qToBigEndian(bits, reinterpret_cast<uchar*>(argument));
+    data.append(argument, 4);
+    return data;
+}
+
+}  // namespace
+
+QVariantList OSCAddressDispatcher::benchmark() {
+    const int rounds = 5;
+
+    // half of the traffic is for the handlers, the other half is typical Eos feedback:
+    QVector<QByteArray> messages;
+    for (int i = 0; i < 1000; ++i) {
+        if (i % 2) {
+            messages.append(createFloatMessage("/custom/fader/" + QByteArray::number(qrand() % 500), 0.5f));
+        } else {
+            messages.append(createFloatMessage("/eos/out/active/chan/" + QByteArray::number(i), 0.5f));
+        }
+    }
+
+    QVariantList results;
+    for (int handlerCount: {10, 50, 200}) {
+        // like OscInBlocks listening to different faders:
+        QVector<QString> paths;
+        for (int i = 0; i < handlerCount; ++i) {
+            paths.append("/custom/fader/" + QString::number(i));
+        }
+
+        // signal fan-out: every handler gets every message and compares the path itself
+        // (emitting a signal would add its own overhead to this):
+        int fanOutMatches = 0;
+        QVector<std::function<void(const OSCMessage&)>> fanOutHandlers;
+        for (int i = 0; i < handlerCount; ++i) {
+            const QString path = paths[i];
+            fanOutHandlers.append([path, &fanOutMatches](const OSCMessage& msg) {
+                if (msg.pathString() == path) ++fanOutMatches;
+            });
+        }
+        QElapsedTimer timer;
+        timer.start();
+        for (int round = 0; round < rounds; ++round) {
+            for (const QByteArray& data: messages) {
+                const OSCMessage msg = OSCMessageView(data.constData(), data.size()).toMessage();
+                for (const auto& handler: fanOutHandlers) {
+                    handler(msg);
+                }
+            }
+        }
+        const double fanOutNs = double(timer.nsecsElapsed()) / (rounds * messages.size());
+
+        // trie dispatch:
+        int dispatchMatches = 0;
+        OSCAddressDispatcher dispatcher;
+        for (int i = 0; i < handlerCount; ++i) {
+            dispatcher.addHandler(paths[i], nullptr, [&dispatchMatches](const OSCMessageView&) {
+                ++dispatchMatches;
+            });
+        }
+        timer.restart();
+        for (int round = 0; round < rounds; ++round) {
+            for (const QByteArray& data: messages) {
+                dispatcher.dispatch(OSCMessageView(data.constData(), data.size()));
+            }
+        }
+        const double dispatchNs = double(timer.nsecsElapsed()) / (rounds * messages.size());
+
+        if (fanOutMatches != dispatchMatches) {
+            qWarning() << "OSC dispatch benchmark:" << dispatchMatches << "matches instead of" << fanOutMatches;
+        }
+
+        qInfo() << "OSC dispatch with" << handlerCount << "handlers: fan-out" << fanOutNs
+                << "ns/msg, trie" << dispatchNs << "ns/msg";
+        QVariantMap result;
+        result["handlers"] = handlerCount;
+        result["fanOutNs"] = fanOutNs;
+        result["dispatchNs"] = dispatchNs;
+        results.append(result);
+    }
+    return results;
+}
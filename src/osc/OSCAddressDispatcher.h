@@ -0,0 +1,146 @@
+#ifndef OSCADDRESSDISPATCHER_H
+#define OSCADDRESSDISPATCHER_H
+
+#include "OSCMessageView.h"
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+#include <QVariant>
+
+#include <functional>
+#include <vector>
+
+
+/**
+ * @brief The OSCAddressDispatcher class routes incoming OSC messages to handlers
+ * that registered an address pattern.
+ *
+ * The patterns are compiled to a trie over the path parts. Parts without wildcards are
+ * looked up in a hash, so a message is only compared with the patterns that can match it
+ * instead of calling every handler and letting each compare the path.
+ *
+ * Supported wildcards within a part of a pattern (as in OSC 1.0):
+ * '*' any sequence, '?' any character, '[a-z]' / '[!a-z]' character ranges and
+ * '{foo,bar}' alternatives. In addition a part "**" matches any number of parts (including none),
+ * i.e. "/eos/out/**" receives all messages starting with "/eos/out/".
+ *
+ * Handlers are removed automatically when their receiver is destroyed.
+ */
+class OSCAddressDispatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<void(const OSCMessageView&)> Handler;
+
+    explicit OSCAddressDispatcher(QObject* parent = nullptr);
+
+    /**
+     * @brief addHandler registers a handler for messages matching a pattern
+     * @param pattern OSC address pattern, must start with a slash
+     * @param receiver the object the handler belongs to, the handler is removed when it is destroyed
+     * @param handler function to call with a matching message
+     * @param literal true if the pattern is a path without wildcards that has to match exactly
+     * (e.g. a path entered by the user, where '*' or '{' are not meant as wildcards)
+     * @return id of the handler to be used with removeHandler() or -1 if the pattern is invalid
+     */
+    int addHandler(const QString& pattern, QObject* receiver, Handler handler, bool literal = false);
+
+    /**
+     * @brief removeHandler unregisters a single handler, does nothing if it doesn't exist
+     * @param id returned by addHandler()
+     */
+    void removeHandler(int id);
+
+    /**
+     * @brief removeHandlers unregisters all handlers of a receiver
+     * @param receiver object that was passed to addHandler()
+     */
+    void removeHandlers(QObject* receiver);
+
+    /**
+     * @brief dispatch calls all handlers with a pattern that matches the path of a message
+     * @param view the incoming message
+     * @return the number of handlers called
+     */
+    int dispatch(const OSCMessageView& view);
+
+    /**
+     * @brief handlerCount returns the number of registered handlers
+     * @return number of handlers
+     */
+    int handlerCount() const { return m_handlers.size(); }
+
+    /**
+     * @brief matchPart checks if a single part of a path matches a part of a pattern
+     * @param pattern part of a pattern, can contain the wildcards described above (but not "**")
+     * @param part part of a path
+     * @return true if it matches
+     */
+    static bool matchPart(QLatin1String pattern, QLatin1String part);
+
+    /**
+     * @brief benchmark compares dispatching with the trie to calling every handler
+     * that compares the path itself (as it is done when connecting to messageReceived)
+     * @return a list of maps with the results for different numbers of handlers
+     */
+    static QVariantList benchmark();
+
+private slots:
+    void onReceiverDestroyed(QObject* receiver) { removeHandlers(receiver); }
+
+private:
+    /**
+     * @brief The Node struct is a node of the pattern trie, one for each distinct pattern prefix
+     */
+    struct Node {
+        QHash<QByteArray, int> literalChildren;  //!< child node index by part without wildcards
+        QVector<QPair<QByteArray, int>> patternChildren;  //!< child node index by part with wildcards
+        int anyPartsChild = -1;  //!< child node index for a "**" part or -1
+        QVector<int> handlerIds;  //!< handlers whose pattern ends at this node
+    };
+
+    struct HandlerEntry {
+        QByteArray pattern;
+        QObject* receiver;
+        Handler handler;
+        bool literal;  //!< true if all parts of the pattern are compared literally
+    };
+
+    /**
+     * @brief rebuildTrie compiles the patterns of all handlers to the trie
+     */
+    void rebuildTrie();
+
+    /**
+     * @brief insertPattern adds a pattern to the trie
+     * @param pattern the pattern
+     * @param handlerId id of the handler
+     * @param literal true to insert all parts as literal parts
+     */
+    void insertPattern(const QByteArray& pattern, int handlerId, bool literal);
+
+    /**
+     * @brief collectMatches adds the handlers of all nodes matching the remaining path parts
+     * to m_matchedIds
+     * @param nodeIndex index of the current node
+     * @param partIndex index of the next path part in m_pathParts
+     */
+    void collectMatches(int nodeIndex, int partIndex);
+
+    static bool containsWildcard(const QByteArray& part);
+
+protected:
+    QHash<int, HandlerEntry> m_handlers;  //!< registered handlers by id
+    int m_nextHandlerId;  //!< id of the next handler to be added
+    std::vector<Node> m_nodes;  //!< trie nodes, the first one is the root
+    bool m_trieOutdated;  //!< true if handlers changed since the trie was built
+
+    // reused for each dispatch to not allocate memory:
+    QVector<QLatin1String> m_pathParts;  //!< parts of the path of the current message
+    QVector<int> m_matchedIds;  //!< ids of the handlers matching the current message
+};
+
+#endif // OSCADDRESSDISPATCHER_H
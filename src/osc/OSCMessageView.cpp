@@ -0,0 +1,277 @@
+#include "OSCMessageView.h"
+
+#include <QByteArray>
+#include <QtEndian>
+#include <cstring>
+
+
+namespace {
+
+// OSC strings and blobs are padded to a multiple of 4 bytes:
+inline int align4(int value) { return (value + 3) & ~3; }
+
+inline qint32 readInt32(const char* data) {
+    return qint32(qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(data)));
+}
+
+inline qint64 readInt64(const char* data) {
+    return qint64(qFromBigEndian<quint64>(reinterpret_cast<const uchar*>(data)));
+}
+
+inline float readFloat32(const char* data) {
+    quint32 bits = qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(data));
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline double readFloat64(const char* data) {
+    quint64 bits = qFromBigEndian<quint64>(reinterpret_cast<const uchar*>(data));
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+}  // namespace
+
+
+OSCMessageView::OSCMessageView()
+    : m_data(nullptr)
+    , m_size(0)
+    , m_isValid(false)
+    , m_pathLength(0)
+    , m_typeTagOffset(-1)
+    , m_argumentCount(0)
+{
+
+}
+
+OSCMessageView::OSCMessageView(const char* data, int size)
+    : m_data(data)
+    , m_size(size)
+    , m_isValid(false)
+    , m_pathLength(0)
+    , m_typeTagOffset(-1)
+    , m_argumentCount(0)
+{
+    if (!data || size <= 0) return;
+
+    // The path of an OSC message is a string from the beginning to the first null character:
+    const char* pathEnd = static_cast<const char*>(std::memchr(data, 0, size_t(size)));
+    if (!pathEnd) return;
+    m_pathLength = int(pathEnd - data);
+    m_isValid = m_pathLength > 0 && data[0] == '/';
+
+    // the type tag string starts with a comma after the padded path:
+    const int typeTagStart = align4(m_pathLength + 1);
+    if (typeTagStart >= size || data[typeTagStart] != ',') return;
+    const char* typeTagEnd = static_cast<const char*>(std::memchr(data + typeTagStart, 0, size_t(size - typeTagStart)));
+    if (!typeTagEnd) return;
+    m_typeTagOffset = typeTagStart + 1;
+
+    // find the positions of the arguments, stop at the first unsupported or incomplete one:
+    const int typeTagCount = int(typeTagEnd - data) - m_typeTagOffset;
+    int offset = align4(int(typeTagEnd - data) + 1);
+    for (int i=0; i<typeTagCount; ++i) {
+        const int argSize = argumentSize(data[m_typeTagOffset + i], offset);
+        if (argSize < 0) break;
+        if (i < maxIndexedArguments) m_argumentOffsets[i] = offset;
+        offset += argSize;
+        ++m_argumentCount;
+    }
+}
+
+bool OSCMessageView::pathStartsWith(QLatin1String value) const {
+    if (value.size() > m_pathLength) return false;
+    return std::memcmp(m_data, value.data(), size_t(value.size())) == 0;
+}
+
+int OSCMessageView::pathPartCount() const {
+    if (!m_isValid) return 0;
+    // the number of parts equals the number of slashes, because the path starts with one:
+    int count = 0;
+    for (int i=0; i<m_pathLength; ++i) {
+        if (m_data[i] == '/') ++count;
+    }
+    return count;
+}
+
+QLatin1String OSCMessageView::pathPart(int index) const {
+    if (index < 0) {
+        index = pathPartCount() + index;
+        if (index < 0) return QLatin1String();
+    }
+    if (!m_isValid) return QLatin1String();
+
+    // skip the leading slash and the previous parts:
+    int start = 1;
+    for (int part=0; part<index; ++part) {
+        const char* slash = static_cast<const char*>(std::memchr(m_data + start, '/', size_t(m_pathLength - start)));
+        if (!slash) return QLatin1String();
+        start = int(slash - m_data) + 1;
+    }
+    const char* end = static_cast<const char*>(std::memchr(m_data + start, '/', size_t(m_pathLength - start)));
+    const int length = end ? int(end - m_data) - start : m_pathLength - start;
+    return QLatin1String(m_data + start, length);
+}
+
+char OSCMessageView::argumentType(int index) const {
+    if (index < 0 || index >= m_argumentCount) return 0;
+    return m_data[m_typeTagOffset + index];
+}
+
+bool OSCMessageView::isNumber(int index) const {
+    switch (argumentType(index)) {
+    case 'i':
+    case 'h':
+    case 'f':
+    case 'd':
+        return true;
+    default:
+        return false;
+    }
+}
+
+int OSCMessageView::toInt(int index, int defaultValue) const {
+    switch (argumentType(index)) {
+    case 'i':
+        return readInt32(m_data + argumentOffset(index));
+    case 'h':
+        return int(readInt64(m_data + argumentOffset(index)));
+    case 'f':
+        return int(readFloat32(m_data + argumentOffset(index)));
+    case 'd':
+        return int(readFloat64(m_data + argumentOffset(index)));
+    case 'T':
+        return 1;
+    case 'F':
+        return 0;
+    default:
+        return defaultValue;
+    }
+}
+
+double OSCMessageView::toDouble(int index, double defaultValue) const {
+    switch (argumentType(index)) {
+    case 'i':
+        return readInt32(m_data + argumentOffset(index));
+    case 'h':
+        return double(readInt64(m_data + argumentOffset(index)));
+    case 'f':
+        return double(readFloat32(m_data + argumentOffset(index)));
+    case 'd':
+        return readFloat64(m_data + argumentOffset(index));
+    case 'T':
+        return 1.0;
+    case 'F':
+        return 0.0;
+    default:
+        return defaultValue;
+    }
+}
+
+QLatin1String OSCMessageView::toLatin1String(int index) const {
+    const char type = argumentType(index);
+    if (type != 's' && type != 'S') return QLatin1String();
+    const int offset = argumentOffset(index);
+    return QLatin1String(m_data + offset, int(qstrnlen(m_data + offset, uint(m_size - offset))));
+}
+
+QString OSCMessageView::toString(int index) const {
+    const QLatin1String string = toLatin1String(index);
+    return QString::fromUtf8(string.data(), string.size());
+}
+
+bool OSCMessageView::isTrue() const {
+    if (m_argumentCount == 0) return true;
+    switch (argumentType(0)) {
+    case 'f':
+    case 'd':
+        return toDouble(0) > 0.99;
+    case 'i':
+    case 'h':
+        return toInt(0) == 1;
+    case 'T':
+        return true;
+    default:
+        return false;
+    }
+}
+
+double OSCMessageView::value() const {
+    if (m_argumentCount == 0) return 0.0;
+    switch (argumentType(0)) {
+    case 'f':
+    case 'd':
+        return toDouble(0);
+    case 'i':
+    case 'h':
+        return double(toInt(0));
+    case 's':
+    case 'S':
+        return toLatin1String(0).size() ? 1.0 : 0.0;
+    default:
+        return 0.0;
+    }
+}
+
+OSCMessage OSCMessageView::toMessage(bool convertNumberStrings) const {
+    if (!m_data) return OSCMessage();
+    return OSCMessage(QByteArray::fromRawData(m_data, m_size), convertNumberStrings);
+}
+
+int OSCMessageView::argumentOffset(int index) const {
+    if (index < maxIndexedArguments) return m_argumentOffsets[index];
+    // walk from the last stored offset:
+    int offset = m_argumentOffsets[maxIndexedArguments - 1];
+    for (int i=maxIndexedArguments-1; i<index; ++i) {
+        offset += argumentSize(m_data[m_typeTagOffset + i], offset);
+    }
+    return offset;
+}
+
+int OSCMessageView::argumentSize(char type, int offset) const {
+    int size = 0;
+    switch (type) {
+    case 'i':  // int32
+    case 'f':  // float32
+    case 'c':  // char
+    case 'r':  // RGBA
+    case 'm':  // MIDI
+        size = 4;
+        break;
+    case 'h':  // int64
+    case 'd':  // float64
+    case 't':  // time tag
+        size = 8;
+        break;
+    case 'T':  // true
+    case 'F':  // false
+    case 'N':  // null
+    case 'I':  // infinity
+        size = 0;
+        break;
+    case 's':  // string
+    case 'S': {  // symbol
+        if (offset >= m_size) return -1;
+        const char* end = static_cast<const char*>(std::memchr(m_data + offset, 0, size_t(m_size - offset)));
+        if (!end) return -1;
+        // the padding of a string at the end of a message is sometimes missing:
+        size = qMin(align4(int(end - (m_data + offset)) + 1), m_size - offset);
+        break;
+    }
+    case 'b': {  // blob with int32 size prefix
+        if (offset + 4 > m_size) return -1;
+        const qint32 blobSize = readInt32(m_data + offset);
+        // the size is untrusted, check it against the remaining bytes before aligning it
+        // (in 64 bit), so that neither align4() nor offset + size can overflow:
+        if (blobSize < 0 || qint64(blobSize) > qint64(m_size) - offset - 4) return -1;
+        size = int(4 + ((qint64(blobSize) + 3) & ~qint64(3)));
+        break;
+    }
+    default:
+        return -1;
+    }
+    if (offset + size > m_size) return -1;
+    return size;
+}
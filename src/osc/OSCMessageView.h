@@ -0,0 +1,186 @@
+#ifndef OSCMESSAGEVIEW_H
+#define OSCMESSAGEVIEW_H
+
+#include "OSCMessage.h"
+
+#include <QtGlobal>
+#include <QLatin1String>
+#include <QString>
+
+
+/**
+ * @brief The OSCMessageView class is a non-owning view of a raw OSC message.
+ *
+ * In contrast to OSCMessage it doesn't copy, split or convert anything when created.
+ * The path is returned as a byte span and split only when a part is requested,
+ * the arguments are decoded only when accessed with the typed getters.
+ * The raw data must outlive the view, so it should only be used while a message is dispatched.
+ *
+ * Use toMessage() to get an OSCMessage that can be stored.
+ */
+class OSCMessageView
+{
+
+public:
+    /**
+     * @brief OSCMessageView creates an invalid, empty view
+     */
+    OSCMessageView();
+
+    /**
+     * @brief OSCMessageView creates a view of raw OSC data
+     * @param data raw OSC packet data (without frame), must outlive this view
+     * @param size size of the data in bytes
+     */
+    OSCMessageView(const char* data, int size);
+
+    /**
+     * @brief isValid returns if the message is valid and not emtpy
+     * @return true if valid and not empty
+     */
+    bool isValid() const { return m_isValid; }
+
+    /**
+     * @brief data returns the raw OSC data
+     * @return pointer to the data this view refers to
+     */
+    const char* data() const { return m_data; }
+    int size() const { return m_size; }
+
+    // ------------------------- Path ---------------------------
+
+    /**
+     * @brief path returns the path as a byte span (without copying it)
+     * @return the path, only valid as long as the raw data exists
+     */
+    QLatin1String path() const { return QLatin1String(m_data, m_pathLength); }
+
+    /**
+     * @brief pathStartsWith returns true if the path starts with a given string
+     * @param value string to check
+     * @return true if the path starts with a given string
+     */
+    bool pathStartsWith(QLatin1String value) const;
+    bool pathStartsWith(const char* value) const { return pathStartsWith(QLatin1String(value)); }
+
+    /**
+     * @brief pathPartCount returns the number of parts of the path
+     * @return number of parts separated by slashes
+     */
+    int pathPartCount() const;
+
+    /**
+     * @brief pathPart returns a specific part of the path (same as OSCMessage::pathPart())
+     * @param index of the part to be returned, negative to count from the end
+     * @return part of the path as a byte span, empty if it doesn't exist
+     */
+    QLatin1String pathPart(int index) const;
+
+    // ----------------------- Arguments -------------------------
+
+    /**
+     * @brief argumentCount returns the number of (supported) arguments
+     * @return number of arguments
+     */
+    int argumentCount() const { return m_argumentCount; }
+
+    /**
+     * @brief argumentType returns the OSC type tag of an argument (i.e. 'i', 'f' or 's')
+     * @param index of the argument
+     * @return the type tag character or 0 if the argument doesn't exist
+     */
+    char argumentType(int index) const;
+
+    /**
+     * @brief isNumber returns true if an argument is an integer or floating point number
+     * @param index of the argument
+     * @return true if it is a number
+     */
+    bool isNumber(int index) const;
+
+    /**
+     * @brief toInt returns the value of a numeric or boolean argument as an integer
+     * @param index of the argument
+     * @param defaultValue the value to return if it is not numeric or doesn't exist
+     * @return the value of the argument
+     */
+    int toInt(int index, int defaultValue = 0) const;
+
+    /**
+     * @brief toDouble returns the value of a numeric or boolean argument as a double
+     * @param index of the argument
+     * @param defaultValue the value to return if it is not numeric or doesn't exist
+     * @return the value of the argument
+     */
+    double toDouble(int index, double defaultValue = 0.0) const;
+
+    /**
+     * @brief toLatin1String returns a string argument as a byte span (without copying it)
+     * @param index of the argument
+     * @return the string, empty if it is not a string or doesn't exist
+     */
+    QLatin1String toLatin1String(int index) const;
+
+    /**
+     * @brief toString returns a copy of a string argument
+     * @param index of the argument
+     * @return the string, empty if it is not a string or doesn't exist
+     */
+    QString toString(int index) const;
+
+    /**
+     * @brief isTrue returns if the arguments probably mean true or "do that"
+     * (same as OSCMessage::isTrue())
+     * @return true if there are no arguments or if the first argument is true or 1
+     */
+    bool isTrue() const;
+
+    /**
+     * @brief value converts the first argument to a single number (same as OSCMessage::value())
+     * @return the value of the first argument if it exists and is a number, otherwise return 0.0
+     */
+    double value() const;
+
+    // ---------------------- Materialize ------------------------
+
+    /**
+     * @brief toMessage creates an OSCMessage that doesn't depend on the raw data anymore
+     * @param convertNumberStrings true to convert strings containing only digits to numbers
+     * @return the message
+     */
+    OSCMessage toMessage(bool convertNumberStrings = false) const;
+
+private:
+    /**
+     * @brief argumentOffset returns the position of the data of an argument in m_data
+     * @param index of the argument, must be less than m_argumentCount
+     * @return offset in bytes
+     */
+    int argumentOffset(int index) const;
+
+    /**
+     * @brief argumentSize returns the size of the data of an argument
+     * @param type the type tag of the argument
+     * @param offset the offset of the argument data
+     * @return the size in bytes (including padding) or -1 if the type is not supported or
+     * the data is incomplete
+     */
+    int argumentSize(char type, int offset) const;
+
+    /**
+     * @brief maxIndexedArguments is the number of argument offsets that are stored,
+     * the offsets of following arguments are calculated when accessed
+     */
+    static const int maxIndexedArguments = 16;
+
+protected:
+    const char* m_data;  //!< raw data, not owned
+    int m_size;  //!< size of m_data in bytes
+    bool m_isValid;  //!< true if the path is null-terminated and starts with a slash
+    int m_pathLength;  //!< length of the path without null-termination
+    int m_typeTagOffset;  //!< position of the first type tag (after the comma), -1 if none
+    int m_argumentCount;  //!< number of arguments
+    int m_argumentOffsets[maxIndexedArguments];  //!< positions of the first arguments in m_data
+};
+
+#endif // OSCMESSAGEVIEW_H
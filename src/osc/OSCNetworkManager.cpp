@@ -1,5 +1,11 @@
 #include "OSCNetworkManager.h"
 
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMetaMethod>
+#include <QtEndian>
+#include <cstring>
+
 #include <QTime>
 #include <QUuid>
 
@@ -453,17 +459,17 @@ void OSCNetworkManager::enableLogging(bool incoming, bool outgoing)
 void OSCNetworkManager::readIncomingUdpDatagrams()
 {
 	while (m_udpSocket.hasPendingDatagrams()) {
-		// prepare empty variables to be written in:
-		QByteArray datagram;
-        datagram.resize(int(m_udpSocket.pendingDatagramSize()));
+        // the buffer is reused and only grows if a datagram is larger than all before:
+        const int pendingSize = int(m_udpSocket.pendingDatagramSize());
+        if (m_datagramBuffer.size() < pendingSize) m_datagramBuffer.resize(pendingSize);
 		QHostAddress sender;
 		quint16 senderPort;
 
 		// get data from socket:
-		m_udpSocket.readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
+        const qint64 size = m_udpSocket.readDatagram(m_datagramBuffer.data(), m_datagramBuffer.size(), &sender, &senderPort);
 
 		// process data:
-		processIncomingRawData(datagram);
+        if (size > 0) processIncomingRawData(m_datagramBuffer.constData(), int(size));
 	}
 }
 
@@ -510,53 +516,187 @@ void OSCNetworkManager::readIncomingTcpStream()
 			return;
 		}
 
-		processIncomingRawData(packet);
+		processIncomingRawData(packet.constData(), packet.size());
         ++packetCount;
 	}
 }
 
-void OSCNetworkManager::processIncomingRawData(QByteArray msgData)
+void OSCNetworkManager::processIncomingRawData(const char* data, int size)
 {
+    if (size <= 0) return;
 	// check if the data is a single message or a bundle of messages:
-	if (msgData[0] == '/') {
+	if (data[0] == '/') {
 		// it starts with a "/" -> it is a single message:
-		processIncomingRawMessage(msgData);
-	} else if (msgData.startsWith("#bundle")) {
+		processIncomingRawMessage(data, size);
+	} else if (size >= 16 && std::memcmp(data, "#bundle", 7) == 0) {
 		// it starts with "#bundle" -> it is a bundle
-		// remove "#bundle" string (8 bytes) and unused timetag (8 bytes):
-		msgData.remove(0, 16);
-		// try to get all messages in the bundle:
-		while (msgData.size()) {
-			// each message starts with the length of the message as int32
-			// this is the same as a TCP 1.0 packet, so the function for that can be used:
-			QByteArray message = popPacketLengthFramedPacketFromStreamData(msgData);
-			// process the message:
-            processIncomingRawData(message);
+		// skip "#bundle" string (8 bytes) and unused timetag (8 bytes):
+		int offset = 16;
+		// each message starts with the length of the message as int32:
+		while (offset + 4 <= size) {
+			const qint32 length = qFromBigEndian<qint32>(reinterpret_cast<const uchar*>(data + offset));
+			offset += 4;
+			if (length <= 0 || length > size - offset) {
+				addToLog(false, "[Invalid] Bundle element length out of range.");
+				break;
+			}
+			// process the message without copying it:
+			processIncomingRawData(data + offset, length);
+			offset += length;
 		}
 	} else {
 		// invalid data
-		addToLog(false, "[Invalid] Raw: " + QString::fromLatin1(msgData.data(), msgData.size()));
+		addToLog(false, "[Invalid] Raw: " + QString::fromLatin1(data, size));
 	}
 }
 
-void OSCNetworkManager::processIncomingRawMessage(QByteArray msgData)
+void OSCNetworkManager::processIncomingRawMessage(const char* data, int size)
 {
-	// build an OSC message from the data:
-	OSCMessage msg(msgData);
+	// create a view of the data, this doesn't copy or convert anything:
+	const OSCMessageView view(data, size);
 
 	// Log if logging of incoming messages is enabled:
-	if (msg.isValid()) {
-		addToLog(false, msg.pathString() + msg.getArgumentsAsDebugString());
-	} else {
-		addToLog(false, "[Invalid] Raw: " + QString::fromLatin1(msgData.data(), msgData.size()));
+	if (m_logIncomingMsg) {
+		if (view.isValid()) {
+			OSCMessage msg = view.toMessage();
+			addToLog(false, msg.pathString() + msg.getArgumentsAsDebugString());
+		} else {
+			addToLog(false, "[Invalid] Raw: " + QString::fromLatin1(data, size));
+		}
+	}
+
+	if (!view.isValid()) return;
+
+	// emit message received signals,
+	// the OSCMessage is only created if someone is connected to the signal:
+	if (m_isEnabled) {
+		m_dispatcher.dispatch(view);
+		if (isSignalConnected(QMetaMethod::fromSignal(&OSCNetworkManager::messageReceived))) {
+			emit messageReceived(view.toMessage());
+		}
+	} else if (isSignalConnected(QMetaMethod::fromSignal(&OSCNetworkManager::messageReceivedWhileDisabled))) {
+		emit messageReceivedWhileDisabled(view.toMessage());
 	}
+}
+
+// ----------------- Benchmarks:
 
-	// emit message received signal:
-	if (msg.isValid()) {
-        if (m_isEnabled) {
-            emit messageReceived(msg);
+namespace {
+
+/**
+ * @brief createOscPacket creates a raw OSC message with the given path and arguments
+ */
+QByteArray createOscPacket(const std::string& path, const QVariantList& arguments) {
+    OSCPacketWriter writer(path);
+    for (const QVariant& arg: arguments) {
+        if (arg.type() == QVariant::String) {
+            writer.AddString(arg.toString().toStdString());
+        } else if (arg.type() == QVariant::Int) {
+            writer.AddInt32(arg.toInt());
         } else {
-            emit messageReceivedWhileDisabled(msg);
+            writer.AddFloat32(float(arg.toDouble()));
         }
-	}
+    }
+    size_t size = 0;
+    char* buffer = writer.Create(size);
+    QByteArray packet(buffer, int(size));
+    delete[] buffer;
+    return packet;
+}
+
+/**
+ * @brief createEosSession returns the messages of a typical busy Eos session
+ * (a cue running while channels are selected and the command line changes)
+ */
+QVector<QByteArray> createEosSession() {
+    QVector<QByteArray> templates;
+    templates << createOscPacket("/eos/out/active/cue/1/5", {0.42});
+    templates << createOscPacket("/eos/out/active/cue/text", {"1/5 Scene Five 3.0 42%"});
+    templates << createOscPacket("/eos/out/active/chan", {"101 [100] Front Wash"});
+    templates << createOscPacket("/eos/out/cmd", {"LIVE: Cue 1 / 5 : Chan 101 Thru 120 @ Full #"});
+    templates << createOscPacket("/eos/out/wheel/1", {"Intens [100]", 1, 100.0});
+    templates << createOscPacket("/eos/out/wheel/2", {"Pan [-42.5]", 2, -42.5});
+    templates << createOscPacket("/eos/out/softkey/1", {"Color"});
+    templates << createOscPacket("/eos/out/pending/cue/1/6", {});
+    templates << createOscPacket("/eos/out/user", {1});
+    templates << createOscPacket("/eos/out/ping", {});
+    templates << createOscPacket("/eos/fader/1/2", {0.75});
+    templates << createOscPacket("/eos/out/get/cue/1/6/0/list/0/21",
+                                 {0, "7A6F3C2E-1B4D-4C8A-9E2F-5D6C7B8A9F01", "Scene Six", 3000, 3000, 3000,
+                                  3000, 0, 0, 0, 0, 0, 0, 0, 0, "", "", "", "", 0, 0});
+    templates << createOscPacket("/hog/status/time", {"12:00:00"});
+
+    // most messages during a running cue are progress and wheel updates:
+    const QVector<int> weights = {8, 4, 2, 2, 6, 6, 1, 1, 1, 1, 4, 1, 1};
+    QVector<QByteArray> session;
+    for (int repeat=0; repeat<250; ++repeat) {
+        for (int i=0; i<templates.size(); ++i) {
+            for (int w=0; w<weights[i]; ++w) session.append(templates[i]);
+        }
+    }
+    return session;
+}
+
+/**
+ * @brief readCapturedSession reads length-framed OSC packets from a file
+ */
+QVector<QByteArray> readCapturedSession(QString filename) {
+    QVector<QByteArray> session;
+    QFile file(filename);
+    if (filename.isEmpty() || !file.open(QIODevice::ReadOnly)) return session;
+    const QByteArray data = file.readAll();
+    int offset = 0;
+    while (offset + 4 <= data.size()) {
+        const qint32 length = qFromBigEndian<qint32>(reinterpret_cast<const uchar*>(data.constData() + offset));
+        offset += 4;
+        if (length <= 0 || length > data.size() - offset) break;
+        session.append(data.mid(offset, length));
+        offset += length;
+    }
+    return session;
+}
+
+}  // namespace
+
+QVariantMap OSCNetworkManager::benchmarkParsing(QString captureFile) {
+    QVector<QByteArray> session = readCapturedSession(captureFile);
+    if (session.isEmpty()) session = createEosSession();
+
+    const int rounds = 10;
+    int eosMessages = 0;
+    double sum = 0.0;
+
+    // previous way: copy to a QByteArray per datagram and create an OSCMessage:
+    QElapsedTimer timer;
+    timer.start();
+    for (int round=0; round<rounds; ++round) {
+        for (const QByteArray& packet: session) {
+            const OSCMessage msg(QByteArray(packet.constData(), packet.size()));
+            if (msg.pathStartsWith("/eos/out/") || msg.pathStartsWith("/eos/fader/")) {
+                ++eosMessages;
+                sum += msg.value();
+            }
+        }
+    }
+    const double messageNs = double(timer.nsecsElapsed()) / (rounds * session.size());
+
+    timer.restart();
+    for (int round=0; round<rounds; ++round) {
+        for (const QByteArray& packet: session) {
+            const OSCMessageView view(packet.constData(), packet.size());
+            if (view.pathStartsWith(QLatin1String("/eos/out/")) || view.pathStartsWith(QLatin1String("/eos/fader/"))) {
+                ++eosMessages;
+                sum += view.value();
+            }
+        }
+    }
+    const double viewNs = double(timer.nsecsElapsed()) / (rounds * session.size());
+
+    qInfo() << "OSC parsing of" << session.size() << "messages: OSCMessage" << messageNs
+            << "ns/msg, OSCMessageView" << viewNs << "ns/msg" << "(" << eosMessages << sum << ")";
+    QVariantMap result;
+    result["messages"] = session.size();
+    result["messageNs"] = messageNs;
+    result["viewNs"] = viewNs;
+    return result;
 }
@@ -2,7 +2,9 @@
 #define OSCNETWORKMANAGER_H
 
 #include "OSCParser.h"
+#include "OSCAddressDispatcher.h"
 #include "OSCMessage.h"
+#include "OSCMessageView.h"
 #include "utils.h"
 
 #include <QObject>
@@ -81,6 +83,13 @@ public:
     // declare EosOSCManager as friend to be able to call for example reconnect():
     friend class EosOSCManager;
 
+    /**
+     * @brief dispatcher returns the dispatcher that routes incoming messages
+     * to the handlers registered for their address
+     * @return the dispatcher of this manager
+     */
+    OSCAddressDispatcher* dispatcher() { return &m_dispatcher; }
+
 
 public slots:
 
@@ -235,12 +244,24 @@ public slots:
 	 */
     void setState(const QJsonObject& state);
 
+    // ----------------- Benchmarks:
+
+    /**
+     * @brief benchmarkParsing compares the parse throughput of OSCMessage and OSCMessageView
+     * (with a check of the Eos path prefix like in the EosOSCManager)
+     * @param captureFile file with recorded OSC packets (each prefixed by its length as int32,
+     * like in a TCP 1.0 stream), a typical Eos session is generated if empty or not readable
+     * @return a map with the results (messages, messageNs, viewNs)
+     */
+    QVariantMap benchmarkParsing(QString captureFile = "");
+
 signals:
 
 	// ------------------- Receive Message --------------------
 
 	/**
 	 * @brief messageReceived emitted when an OSC messages has been received
+	 * (the message is only created if this signal is connected)
 	 * @param msg the received message
 	 */
 	void messageReceived(OSCMessage msg);
@@ -347,15 +368,17 @@ private slots:
 
 	/**
 	 * @brief processIncomingRawData processes incoming raw data and checks if it is an OSC bundle
-	 * @param msgData raw OSC packet data (bundle or message)
+	 * @param data raw OSC packet data (bundle or message)
+	 * @param size size of the data in bytes
 	 */
-	void processIncomingRawData(QByteArray msgData);
+	void processIncomingRawData(const char* data, int size);
 
 	/**
 	 * @brief processIncomingRawMessage processes incoming single raw OSC messages
-	 * @param msgData raw OSC message data (not a bundle)
+	 * @param data raw OSC message data (not a bundle)
+	 * @param size size of the data in bytes
 	 */
-	void processIncomingRawMessage(QByteArray msgData);
+	void processIncomingRawMessage(const char* data, int size);
 
 private:
     QStringList m_availableTypes;
@@ -415,6 +438,14 @@ private:
 	 * (from TCP stream)
 	 */
 	QByteArray				m_incompleteStreamData;
+    /**
+     * @brief m_datagramBuffer is reused for each incoming UDP datagram
+     */
+    QByteArray				m_datagramBuffer;
+    /**
+     * @brief m_dispatcher routes incoming messages to the handlers registered for their address
+     */
+    OSCAddressDispatcher	m_dispatcher;
 
     /**
      * @brief m_logChangedSignalDelay is a timer to delay the emission of the logChanged signal
@@ -23,8 +23,8 @@ X32Manager::X32Manager(MainController* controller)
             this, SLOT(requestConsoleInfo()));
     connect(m_controller->audioConsole(), SIGNAL(isConnectedChanged()),
             this, SLOT(requestConsoleInfo()));
-    connect(m_controller->audioConsole(), SIGNAL(messageReceived(OSCMessage)),
-            this, SLOT(onIncomingMessage(OSCMessage)));
+    m_controller->audioConsole()->dispatcher()->addHandler("/info", this,
+            [this](const OSCMessageView& view) { onIncomingMessage(view.toMessage()); });
 }
 
 X32Manager::~X32Manager() {
@@ -8,7 +8,7 @@ import "../../CustomControls"
 BlockBase {
 	id: root
 	width: 180*dp
-    height: 210*dp
+    height: 690*dp
 
 	StretchColumn {
 		anchors.fill: parent
@@ -37,6 +37,90 @@ BlockBase {
                 onClick: controller.blockManager().stopRandomConnectionTest()
             }
         }
+        BlockRow {
+            ButtonSideLine {
+                text: "Output Benchmark"
+                onClick: controller.output().benchmarkOutput()
+            }
+        }
+        BlockRow {
+            ButtonSideLine {
+                text: "sACN Merge Benchmark"
+                onClick: block.benchmarkSAcnMerge()
+            }
+        }
+        BlockRow {
+            ButtonSideLine {
+                text: "Log Statistics"
+                onClick: block.logStatistics()
+            }
+        }
+        BlockRow {
+            ButtonSideLine {
+                text: "Reset Statistics"
+                onClick: block.resetStatistics()
+            }
+        }
+        BlockRow {
+            ButtonSideLine {
+                text: "OSC Parse Benchmark"
+                onClick: controller.lightingConsole().benchmarkParsing("")
+            }
+        }
+        BlockRow {
+            ButtonSideLine {
+                text: "OSC Dispatch Benchmark"
+                onClick: block.benchmarkOscDispatch()
+            }
+        }
+        BlockRow {
+            ButtonSideLine {
+                text: "Matrix Kernel Benchmark"
+                onClick: block.benchmarkMatrixKernels()
+            }
+        }
+        BlockRow {
+            ButtonSideLine {
+                text: "Graph Eval. Benchmark"
+                onClick: block.benchmarkGraphEvaluation()
+            }
+        }
+        BlockRow {
+            ButtonSideLine {
+                text: "Audio Onset Latency"
+                onClick: block.measureAudioOnsetLatency()
+            }
+        }
+        BlockRow {
+            ButtonSideLine {
+                text: "Audio Analysis Benchmark"
+                onClick: block.benchmarkAudioAnalysis()
+            }
+        }
+        BlockRow {
+            ButtonSideLine {
+                text: "Project Format Benchmark"
+                onClick: block.logProjectFormatBenchmark()
+            }
+        }
+        BlockRow {
+            ButtonSideLine {
+                text: "Fixture Chain Benchmark"
+                onClick: block.benchmarkFixtureChain()
+            }
+        }
+        BlockRow {
+            ButtonSideLine {
+                text: "DMX Render Benchmark"
+                onClick: block.benchmarkDmxRender()
+            }
+        }
+        BlockRow {
+            ButtonSideLine {
+                text: "Cue Timeline Benchmark"
+                onClick: block.benchmarkCueTimeline()
+            }
+        }
 
         BlockRow {
             leftMargin: 8*dp
@@ -66,6 +150,34 @@ BlockBase {
             }
         }
 
+        BlockRow {
+            leftMargin: 8*dp
+            rightMargin: 8*dp
+            StretchText {
+                text: "Late Frames / s:"
+            }
+            StretchText {
+                implicitWidth: 0  // do not stretch
+                width: 30*dp
+                text: controller.engine().lateFrameCount
+                hAlign: Text.AlignRight
+            }
+        }
+
+        BlockRow {
+            leftMargin: 8*dp
+            rightMargin: 8*dp
+            StretchText {
+                text: "GUI Updates / s:"
+            }
+            StretchText {
+                implicitWidth: 0  // do not stretch
+                width: 50*dp
+                text: controller.guiUpdateBatcher().notificationsPerSecond
+                hAlign: Text.AlignRight
+            }
+        }
+
         DragArea {
 			text: "Debug"
 		}
@@ -35,7 +35,7 @@ StretchColumn {
             width: 55*dp
             value: controller.output().sAcnStartUniverse
             minimumValue: 1
-            maximumValue: 63999 - 16
+            maximumValue: 63999
             onValueChanged: {
                 if (value !== controller.output().sAcnStartUniverse) {
                     controller.output().sAcnStartUniverse = value
@@ -126,6 +126,60 @@ StretchColumn {
             }
         }
     }
+    BlockRow {
+        StretchText {
+            text: "Batched sACN Input:"
+        }
+        CheckBox {
+            width: 30*dp
+            active: controller.sAcnBatchedReception
+            onActiveChanged: {
+                if (active !== controller.sAcnBatchedReception) {
+                    controller.sAcnBatchedReception = active
+                }
+            }
+        }
+    }
+    BlockRow {
+        StretchText {
+            text: "Run Late Frames:"
+        }
+        CheckBox {
+            width: 30*dp
+            active: controller.engine().catchUpLateFrames
+            onActiveChanged: {
+                if (active !== controller.engine().catchUpLateFrames) {
+                    controller.engine().catchUpLateFrames = active
+                }
+            }
+        }
+    }
+    BlockRow {
+        visible: controller.output().sAcnEnabled || controller.output().artnetEnabled
+        StretchText {
+            text: "Latency (avg / max):"
+            color: "#aaa"
+        }
+        Text {
+            width: 90*dp
+            text: controller.output().latencyAvg.toFixed(1) + " / " + controller.output().latencyMax.toFixed(1) + " ms"
+            horizontalAlignment: Text.AlignRight
+            color: "#aaa"
+        }
+    }
+    BlockRow {
+        visible: controller.output().sAcnEnabled || controller.output().artnetEnabled
+        StretchText {
+            text: "Jitter (avg / max):"
+            color: "#aaa"
+        }
+        Text {
+            width: 90*dp
+            text: controller.output().jitterAvg.toFixed(1) + " / " + controller.output().jitterMax.toFixed(1) + " ms"
+            horizontalAlignment: Text.AlignRight
+            color: "#aaa"
+        }
+    }
     BlockRow {
         StretchText {
             text: "Discovered Nodes:"
@@ -24,6 +24,9 @@
 #include <QPoint>
 #include <QSharedPointer>
 #include <QWeakPointer>
+#include <QVariantMap>
+#include <algorithm>
+#include <limits>
 
 
 //The amount of ms to wait before a source is considered offline or
@@ -36,21 +39,28 @@
 //The time during which to sample
 #define SAMPLE_TIME 1500
 
-sACNListener::sACNListener(int universe, QObject *parent) : QObject(parent),
+sACNListener::sACNListener(int universe, QObject *parent, bool ownSockets) : QObject(parent),
     m_universe(universe),
     m_ssHLL(1000),
     m_isSampling(true),
-    m_mergesPerSecond(0)
+    m_initalSampleTimer(nullptr),
+    m_mergeTimer(nullptr),
+    m_mergeAll(false),
+    m_mergesPerSecond(0),
+    m_mergeCounter(0),
+    m_ownSockets(ownSockets),
+    m_packetCounter(0),
+    m_packetsPerSecond(0),
+    m_processingNs(0),
+    m_cpuUsage(0.0)
 {
-    m_merged_levels.reserve(512);
-    for(int i=0; i<512; i++)
-        m_merged_levels << sACNMergedAddress();
+    m_merged_levels.resize(512);
 }
 
 sACNListener::~sACNListener()
 {
-    m_initalSampleTimer->deleteLater();
-    m_mergeTimer->deleteLater();
+    if (m_initalSampleTimer) m_initalSampleTimer->deleteLater();
+    if (m_mergeTimer) m_mergeTimer->deleteLater();
     qDeleteAll(m_sockets);
     qDebug() << "sACNListener" << QThread::currentThreadId() << ": stopping";
 }
@@ -62,22 +72,25 @@ void sACNListener::startReception()
     // Clear the levels array
     memset(&m_last_levels, -1, 512);
 
-    // Listen multicast
-    m_sockets.push_back(new sACNRxSocket());
-    if (m_sockets.back()->bindMulticast(m_universe)) {
-        connect(m_sockets.back(), SIGNAL(readyRead()), this, SLOT(readPendingDatagrams()), Qt::DirectConnection);
-    } else {
-       // Failed to bind,
-       m_sockets.pop_back();
-    }
+    // Without own sockets the datagrams are passed in by the sACNReceiver
+    if (m_ownSockets) {
+        // Listen multicast
+        m_sockets.push_back(new sACNRxSocket());
+        if (m_sockets.back()->bindMulticast(m_universe)) {
+            connect(m_sockets.back(), SIGNAL(readyRead()), this, SLOT(readPendingDatagrams()), Qt::DirectConnection);
+        } else {
+           // Failed to bind,
+           m_sockets.pop_back();
+        }
 
-    // Listen unicast
-    m_sockets.push_back(new sACNRxSocket());
-    if (m_sockets.back()->bindUnicast()) {
-        connect(m_sockets.back(), SIGNAL(readyRead()), this, SLOT(readPendingDatagrams()), Qt::DirectConnection);
-    } else {
-       // Failed to bind
-       m_sockets.pop_back();
+        // Listen unicast
+        m_sockets.push_back(new sACNRxSocket());
+        if (m_sockets.back()->bindUnicast()) {
+            connect(m_sockets.back(), SIGNAL(readyRead()), this, SLOT(readPendingDatagrams()), Qt::DirectConnection);
+        } else {
+           // Failed to bind
+           m_sockets.pop_back();
+        }
     }
 
     // Start intial sampling
@@ -145,16 +158,18 @@ void sACNListener::readPendingDatagrams()
     {
         while(m_socket->hasPendingDatagrams())
         {
-            QByteArray data;
-            data.resize(m_socket->pendingDatagramSize());
             QHostAddress sender;
             quint16 senderPort;
 
-            m_socket->readDatagram(data.data(), data.size(),
+            // Read into the reused buffer instead of allocating a QByteArray per datagram
+            qint64 length = m_socket->readDatagram(reinterpret_cast<char*>(m_receiveBuffer), sizeof(m_receiveBuffer),
                                     &sender, &senderPort);
+            if(length <= 0)
+                continue;
 
             processDatagram(
-                        data,
+                        m_receiveBuffer,
+                        int(length),
                         m_socket->localAddress(),
                         sender);
         }
@@ -163,6 +178,29 @@ void sACNListener::readPendingDatagrams()
 
 void sACNListener::processDatagram(QByteArray data, QHostAddress receiver, QHostAddress sender)
 {
+    processDatagram(reinterpret_cast<uint1*>(data.data()), data.length(), receiver, sender);
+}
+
+namespace {
+
+/**
+ * Adds the time until it goes out of scope to a counter, used for the CPU usage diagnostic.
+ */
+struct ScopedProcessingTime
+{
+    explicit ScopedProcessingTime(qint64 &total) : m_total(total) { m_timer.start(); }
+    ~ScopedProcessingTime() { m_total += m_timer.nsecsElapsed(); }
+    qint64 &m_total;
+    QElapsedTimer m_timer;
+};
+
+}  // namespace
+
+void sACNListener::processDatagram(uint1 *data, int length, const QHostAddress &receiver, const QHostAddress &sender)
+{
+    ScopedProcessingTime processingTime(m_processingNs);
+    m_packetCounter++;
+
     // Process packet
     CID source_cid;
     uint1 start_code;
@@ -179,9 +217,9 @@ void sACNListener::processDatagram(QByteArray data, QHostAddress receiver, QHost
     uint2 reserved = 0;
     uint1 options = 0;
     bool preview = false;
-    uint1 *pbuf = reinterpret_cast<uint1*>(data.data());
+    uint1 *pbuf = data;
 
-    if(!ValidateStreamHeader(pbuf, data.length(), source_cid, source_name, priority,
+    if(!ValidateStreamHeader(pbuf, length, source_cid, source_name, priority,
             start_code, reserved, sequence, options, universe, slot_count, pdata))
     {
         // Recieved a packet but not valid. Log and discard
@@ -203,9 +241,9 @@ void sACNListener::processDatagram(QByteArray data, QHostAddress receiver, QHost
             return;
         } else {
             // Unicast, send to releivent listener!
-            const QHash<int, QWeakPointer<sACNListener> > listenerList = sACNManager::getInstance()->getListenerList();
-            if (listenerList.contains(universe))
-                listenerList[universe].data()->processDatagram(data, receiver, sender);
+            QSharedPointer<sACNListener> listener = sACNManager::getInstance()->findListener(universe);
+            if (listener)
+                listener->processDatagram(data, length, receiver, sender);
             return;
         }
     }
@@ -494,23 +532,45 @@ void sACNListener::processDatagram(QByteArray data, QHostAddress receiver, QHost
     }
 }
 
-void sACNListener::performMerge()
+/**
+ * Merges one source into the flat merge tables of all 512 addresses.
+ * A source wins an address if it has a higher priority, or the same priority
+ * and a higher level (HTP) than the current winner.
+ * The loop is branchless and works on 16 bit integers so that it is vectorized by the compiler.
+ */
+template<bool perChannelPriority>
+static void mergeSourceHtp(const uint1* levels, const uint1* priorities, qint16 sourcePriority, qint16 sourceIndex,
+                           qint16* __restrict winningPriorities, qint16* __restrict winningLevels,
+                           qint16* __restrict winningSources)
 {
-    //array of addresses to merge. to prevent duplicates and because you can have
-    //an odd collection of addresses, addresses[n] would be 'n' for the value in question
-    // and -1 if not required
-    int addresses_to_merge[512];
-    int number_of_addresses_to_merge = 0;
-
-    memset(addresses_to_merge, -1, sizeof(int) * 512);
+    for(int i=0; i<512; i++)
+    {
+        const qint16 priority = perChannelPriority ? qint16(priorities[i]) : sourcePriority;
+        const qint16 level = levels[i];
+        const qint16 winningPriority = winningPriorities[i];
+        const qint16 winningLevel = winningLevels[i];
+        // A per-channel priority of 0 means that the source doesn't send this address
+        const qint16 eligible = perChannelPriority ? qint16(priority > 0) : qint16(1);
+        const qint16 wins = eligible & (qint16(priority > winningPriority)
+                                        | (qint16(priority == winningPriority) & qint16(level > winningLevel)));
+        // Select with a bitmask instead of a branch, all bits are set if this source wins
+        const qint16 mask = qint16(-wins);
+        winningPriorities[i] = qint16((priority & mask) | (winningPriority & ~mask));
+        winningLevels[i] = qint16((level & mask) | (winningLevel & ~mask));
+        winningSources[i] = qint16((sourceIndex & mask) | (winningSources[i] & ~mask));
+    }
+}
 
+void sACNListener::performMerge()
+{
+    ScopedProcessingTime processingTime(m_processingNs);
     {
         QMutexLocker locker(&m_monitoredChannelsMutex);
         foreach(int chan, m_monitoredChannels)
         {
             QPointF data;
             data.setX(m_elapsedTime.nsecsElapsed()/1000000.0);
-            data.setY(mergedLevels().at(chan).level);
+            data.setY(m_merged_levels.at(chan).level);
             emit dataReady(chan, data);
         }
     }
@@ -519,150 +579,276 @@ void sACNListener::performMerge()
     {
         m_mergesPerSecond = m_mergeCounter;
         m_mergeCounter = 0;
+        m_packetsPerSecond = m_packetCounter;
+        m_packetCounter = 0;
+        m_cpuUsage = double(m_processingNs) / m_mergesPerSecondTimer.nsecsElapsed();
+        m_processingNs = 0;
         m_mergesPerSecondTimer.restart();
     }
 
     m_mergeCounter++;
 
+    // Step one : check if any source changed
+    // Merging all addresses with the vectorized pass is cheaper than collecting the changed ones
+    bool changed = m_mergeAll;
+    m_mergeAll = false;
+    for(std::vector<sACNSource *>::iterator it = m_sources.begin(); it != m_sources.end(); ++it)
+    {
+        sACNSource *ps = *it;
+        if(!ps->src_valid || !ps->source_levels_change)
+            continue; // Inactive source or no change, ignore it
+        changed = true;
+        // Clear the flags
+        memset(ps->dirty_array, 0 , 512);
+        ps->source_levels_change = false;
+    }
 
+    if(!changed) return; // Nothing to do
 
-    // Step one : find any addresses which have changed
-    if(m_mergeAll) // Act like all addresses changed
+    // Step two : find the highest priority and within that the highest level for each address
+    std::fill(m_winningPriorities, m_winningPriorities + 512, -1);
+    std::fill(m_winningLevels, m_winningLevels + 512, -1);
+    std::fill(m_winningSources, m_winningSources + 512, -1);
+
+    // The source indexes are stored as 16 bit integers
+    const int sourceCount = int(qMin(m_sources.size(), std::size_t(std::numeric_limits<qint16>::max())));
+    // Only allocates if the number of sources grows beyond a multiple of 64
+    m_activeSources.resize((sourceCount + 63) / 64);
+    std::fill(m_activeSources.begin(), m_activeSources.end(), 0);
+
+    for(int index=0; index<sourceCount; index++)
     {
-        number_of_addresses_to_merge = 512;
-        for(int i=0; i<512; i++)
+        sACNSource *ps = m_sources[index];
+        if(!ps->src_valid)
+            continue;
+        if(!ps->active.Expired())
+            m_activeSources[index / 64] |= quint64(1) << (index % 64);
+
+        if(ps->doing_per_channel)
+        {
+            mergeSourceHtp<true>(ps->level_array, ps->priority_array, 0, qint16(index),
+                                 m_winningPriorities, m_winningLevels, m_winningSources);
+        }
+        else
         {
-            addresses_to_merge[i] = i;
+            // Sources which are not doing per-channel priority use their source priority for all addresses
+            mergeSourceHtp<false>(ps->level_array, ps->priority_array, qint16(ps->priority), qint16(index),
+                                  m_winningPriorities, m_winningLevels, m_winningSources);
         }
+    }
 
-        m_mergeAll = false;
+    // Step three : update the merged levels
+    sACNMergedAddress *merged = m_merged_levels.data();
+    for(int address=0; address<512; address++)
+    {
+        const int winner = m_winningSources[address];
+        const int level = (winner >= 0) ? m_winningLevels[address] : -1;
+        merged[address].changedSinceLastMerge = (merged[address].level != level);
+        merged[address].level = level;
+        merged[address].winningSource = (winner >= 0) ? m_sources[winner] : nullptr;
     }
-    else
+
+    // Tell people..
+    emit levelsChanged();
+}
+
+QList<sACNSource *> sACNListener::otherSources(int address)
+{
+    QList<sACNSource *> sources;
+    if(address < 0 || address >= 512)
+        return sources;
+    const sACNSource *winner = m_merged_levels.at(address).winningSource;
+    for(std::size_t index=0; index<m_sources.size() && index/64 < m_activeSources.size(); index++)
     {
-        for(std::vector<sACNSource *>::iterator it = m_sources.begin(); it != m_sources.end(); ++it)
-        {
-            sACNSource *ps = *it;
-            if(!ps->src_valid)
-                continue; // Inactive source, ignore it
-            if(!ps->source_levels_change)
-                continue; // We don't need to consider this one, no change
-            for(int i=0; i<512; i++)
-            {
-                if(ps->dirty_array[i])
-                {
-                    addresses_to_merge[i] = i;
-                    number_of_addresses_to_merge++;
-                }
-            }
-            // Clear the flags
-            memset(ps->dirty_array, 0 , 512);
-            ps->source_levels_change = false;
-        }
+        if((m_activeSources[index / 64] & (quint64(1) << (index % 64))) && m_sources[index] != winner)
+            sources << m_sources[index];
     }
+    return sources;
+}
 
-    if(number_of_addresses_to_merge == 0) return; // Nothing to do
+// ----------------- Benchmark:
 
-    // Clear out the sources list for all the affected channels, we'll be refreshing it
+namespace {
 
-    int skipCounter = 0;
-    for(int i=0; i < 512 && i<(number_of_addresses_to_merge + skipCounter); i++)
+/**
+ * The merge result of the previous implementation, only used for comparison in the benchmark.
+ */
+struct LegacyMergedAddress
+{
+    int level = -1;
+    sACNSource *winningSource = nullptr;
+    QSet<sACNSource *> otherSources;
+};
+
+/**
+ * The previous merge implementation that allocates a QMultiMap, QLists and QSets during each merge,
+ * only used for comparison in the benchmark.
+ */
+void legacyMerge(std::vector<sACNSource *>& sources, QList<LegacyMergedAddress>& merged)
+{
+    int addresses_to_merge[512];
+    int number_of_addresses_to_merge = 0;
+    memset(addresses_to_merge, -1, sizeof(int) * 512);
+
+    for(sACNSource *ps : sources)
     {
-        m_merged_levels[i].changedSinceLastMerge = false;
-        if(addresses_to_merge[i] == -1) {
-            ++skipCounter;
+        if(!ps->src_valid || !ps->source_levels_change)
             continue;
+        for(int i=0; i<512; i++)
+        {
+            if(ps->dirty_array[i])
+            {
+                addresses_to_merge[i] = i;
+                number_of_addresses_to_merge++;
+            }
         }
-        sACNMergedAddress *pAddr = &m_merged_levels[addresses_to_merge[i]];
-        pAddr->otherSources.clear();
+        memset(ps->dirty_array, 0 , 512);
+        ps->source_levels_change = false;
     }
+    if(number_of_addresses_to_merge == 0) return;
 
-    // Find the highest priority source for each address we need to work on
+    for(int i=0; i<512; i++)
+    {
+        if(addresses_to_merge[i] != -1) merged[i].otherSources.clear();
+    }
 
     int levels[512];
     memset(&levels, -1, sizeof(levels));
-
     int priorities[512];
     memset(&priorities, -1, sizeof(priorities));
-
     QMultiMap<int, sACNSource*> addressToSourceMap;
 
-	// Find the highest priority for the address
-    for(std::vector<sACNSource *>::iterator it = m_sources.begin(); it != m_sources.end(); ++it)
+    for(sACNSource *ps : sources)
     {
-        sACNSource *ps = *it;
- 
         if(ps->src_valid && !ps->active.Expired() && !ps->doing_per_channel)
-        {
-            // Set the priority array for sources which are not doing per-channel
             memset(ps->priority_array, ps->priority, sizeof(ps->priority_array));
-        }
 
-        skipCounter = 0;
-        for(int i=0; i < 512 && i<(number_of_addresses_to_merge + skipCounter); i++)
+        for(int i=0; i<512; i++)
         {
-            if(addresses_to_merge[i] == -1) {
-               ++skipCounter;
-                continue;
+            const int address = addresses_to_merge[i];
+            if(address == -1) continue;
+            if(ps->src_valid && !(ps->priority_array[address] < priorities[address])
+                    && ((ps->priority_array[address] > 0) || (ps->priority_array[address] == 0 && !ps->doing_per_channel)))
+            {
+                if(ps->priority_array[address] > priorities[address])
+                {
+                    priorities[address] = ps->priority_array[address];
+                    addressToSourceMap.remove(address);
+                }
+                addressToSourceMap.insert(address, ps);
             }
-            sACNMergedAddress *pAddr = &m_merged_levels[addresses_to_merge[i]];
-            int address = addresses_to_merge[i];
-
-			if (
-					ps->src_valid // Valid Source
-					&& !(ps->priority_array[address] < priorities[address]) // Not lesser priority
-					&& ( (ps->priority_array[address] > 0) || (ps->priority_array[address] == 0 && !ps->doing_per_channel) ) // Priority > 0 if DD
-				)
-			{
-				if (ps->priority_array[address] > priorities[address])
-				{
-					// Source of higher priority
-					priorities[address] = ps->priority_array[address];
-					addressToSourceMap.remove(address);
-				}
-				addressToSourceMap.insert(address, ps);
-			}
-
             if(ps->src_valid && !ps->active.Expired())
-                pAddr->otherSources << ps;
+                merged[address].otherSources << ps;
         }
     }
 
-
-
-    // Next, find highest level for the highest prioritized sources
-    skipCounter = 0;
-    for(int i=0; i < 512 && i<(number_of_addresses_to_merge + skipCounter); i++)
+    for(int i=0; i<512; i++)
     {
-        if(addresses_to_merge[i] == -1) {
-            ++skipCounter;
-            continue;
-        }
-        int address = addresses_to_merge[i];
+        const int address = addresses_to_merge[i];
+        if(address == -1) continue;
         QList<sACNSource*> sourceList = addressToSourceMap.values(address);
-
         if(sourceList.count() == 0)
         {
-            m_merged_levels[address].level = -1;
-            m_merged_levels[address].winningSource = nullptr;
-            m_merged_levels[address].otherSources.clear();
+            merged[address].level = -1;
+            merged[address].winningSource = nullptr;
+            merged[address].otherSources.clear();
         }
         foreach(sACNSource *s, sourceList)
         {
             if(s->level_array[address] > levels[address])
             {
                 levels[address] = s->level_array[address];
-                m_merged_levels[address].changedSinceLastMerge = (m_merged_levels[address].level != levels[address]);
-                m_merged_levels[address].level = levels[address];
-                m_merged_levels[address].winningSource = s;
+                merged[address].level = levels[address];
+                merged[address].winningSource = s;
             }
         }
-        // Remove the winning source from the list of others
-        if(m_merged_levels[address].winningSource)
-            m_merged_levels[address].otherSources.remove(m_merged_levels[address].winningSource);
+        if(merged[address].winningSource)
+            merged[address].otherSources.remove(merged[address].winningSource);
     }
+}
 
-
-    // Tell people..
-    emit levelsChanged();
+/**
+ * Changes all levels of one of the sources like a received DMX packet would do.
+ */
+void changeBenchmarkLevels(std::vector<sACNSource *>& sources, int frame)
+{
+    sACNSource *ps = sources[frame % sources.size()];
+    for(int i=0; i<512; i++)
+    {
+        ps->level_array[i] = uint1((i + frame) % 256);
+        ps->dirty_array[i] = true;
+    }
+    ps->source_levels_change = true;
 }
 
+}  // namespace
+
+QVariantList sACNListener::benchmarkMerge()
+{
+    const int merges = 2000;
+    QVariantList results;
+
+    for(int sourceCount : {1, 4, 16})
+    {
+        sACNListener listener(1);
+        listener.m_mergesPerSecondTimer.start();
+        for(int s=0; s<sourceCount; s++)
+        {
+            sACNSource *ps = new sACNSource();
+            ps->src_valid = true;
+            ps->doing_dmx = true;
+            ps->active.SetInterval(WAIT_OFFLINE);
+            // every fourth source sends per-channel priorities:
+            ps->doing_per_channel = (s % 4 == 3);
+            ps->priority = uint1(100 + s % 2);
+            for(int i=0; i<512; i++)
+            {
+                ps->level_array[i] = uint1(qrand() % 256);
+                ps->priority_array[i] = uint1((i + s) % 3 * 50);
+            }
+            listener.m_sources.push_back(ps);
+        }
+
+        QList<LegacyMergedAddress> legacyLevels;
+        for(int i=0; i<512; i++)
+            legacyLevels << LegacyMergedAddress();
+
+        QElapsedTimer timer;
+        timer.start();
+        for(int frame=0; frame<merges; frame++)
+        {
+            changeBenchmarkLevels(listener.m_sources, frame);
+            legacyMerge(listener.m_sources, legacyLevels);
+        }
+        const double legacyUs = timer.nsecsElapsed() / 1000.0 / merges;
+
+        timer.restart();
+        for(int frame=0; frame<merges; frame++)
+        {
+            changeBenchmarkLevels(listener.m_sources, frame);
+            listener.performMerge();
+        }
+        const double mergeUs = timer.nsecsElapsed() / 1000.0 / merges;
+
+        // both implementations have to come to the same result:
+        int mismatches = 0;
+        for(int i=0; i<512; i++)
+        {
+            if(legacyLevels[i].level != listener.m_merged_levels[i].level)
+                ++mismatches;
+        }
+        if(mismatches)
+            qWarning() << "sACN merge benchmark:" << mismatches << "addresses differ from the legacy merge";
+
+        qInfo() << "sACN merge with" << sourceCount << "sources: legacy" << legacyUs << "us, new" << mergeUs << "us";
+        QVariantMap result;
+        result["sources"] = sourceCount;
+        result["legacyUs"] = legacyUs;
+        result["mergeUs"] = mergeUs;
+        results.append(result);
+
+        qDeleteAll(listener.m_sources);
+        listener.m_sources.clear();
+    }
+    return results;
+}
@@ -0,0 +1,239 @@
+#include "sacnreceiver.h"
+
+#include "sacnlistener.h"
+#include "sacnsocket.h"
+#include "streamcommon.h"
+#include "ACNShare/defpack.h"
+#include "ACNShare/ipaddr.h"
+#include <QDebug>
+#include <QThread>
+#include <QSocketNotifier>
+
+#if defined(Q_OS_LINUX)
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+// The receive buffer of the socket in bytes, large enough for bursts of many universes
+#define RECEIVE_BUFFER_SIZE (4 * 1024 * 1024)
+
+sACNReceiver::sACNReceiver(QObject *parent) : QObject(parent),
+    m_packetBuffers(batchSize * maxPacketSize),
+#if defined(Q_OS_LINUX)
+    m_socket(-1),
+    m_notifier(nullptr),
+    m_messages(batchSize),
+    m_iovecs(batchSize),
+    m_senders(batchSize),
+#else
+    m_socket(nullptr),
+#endif
+    m_packetCounter(0),
+    m_readCallCounter(0),
+    m_droppedCounter(0),
+    m_packetsPerSecond(0),
+    m_readCallsPerSecond(0),
+    m_droppedPerSecond(0)
+{
+#if defined(Q_OS_LINUX)
+    // The message headers point to the preallocated buffers and never change:
+    for(int i=0; i<batchSize; i++)
+    {
+        m_iovecs[i].iov_base = packetBuffer(i);
+        m_iovecs[i].iov_len = maxPacketSize;
+        memset(&m_messages[i], 0, sizeof(mmsghdr));
+        m_messages[i].msg_hdr.msg_iov = &m_iovecs[i];
+        m_messages[i].msg_hdr.msg_iovlen = 1;
+        m_messages[i].msg_hdr.msg_name = &m_senders[i];
+    }
+#endif
+}
+
+sACNReceiver::~sACNReceiver()
+{
+#if defined(Q_OS_LINUX)
+    delete m_notifier;
+    if (m_socket >= 0) ::close(m_socket);
+#else
+    delete m_socket;
+#endif
+    qDebug() << "sACNReceiver" << QThread::currentThreadId() << ": stopping";
+}
+
+void sACNReceiver::addListener(int universe, sACNListener *listener)
+{
+    {
+        QMutexLocker locker(&m_listenersMutex);
+        m_listeners[universe] = listener;
+    }
+    QMetaObject::invokeMethod(this, "updateMulticastGroups", Qt::QueuedConnection);
+}
+
+void sACNReceiver::removeListener(int universe)
+{
+    {
+        QMutexLocker locker(&m_listenersMutex);
+        m_listeners.remove(universe);
+    }
+    QMetaObject::invokeMethod(this, "updateMulticastGroups", Qt::QueuedConnection);
+}
+
+void sACNReceiver::startReception()
+{
+    qDebug() << "sACNReceiver" << QThread::currentThreadId() << ": Starting batched reception";
+    m_statisticsTimer.start();
+
+#if defined(Q_OS_LINUX)
+    m_socket = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_socket < 0)
+    {
+        qWarning() << "sACNReceiver: Failed to create RX socket";
+        return;
+    }
+    // Same as QAbstractSocket::ShareAddress | QAbstractSocket::ReuseAddressHint:
+    int reuse = 1;
+    setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    int bufferSize = RECEIVE_BUFFER_SIZE;
+    setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(STREAM_IP_PORT);
+    if (::bind(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        qWarning() << "sACNReceiver: Failed to bind RX socket";
+        ::close(m_socket);
+        m_socket = -1;
+        return;
+    }
+    m_notifier = new QSocketNotifier(m_socket, QSocketNotifier::Read, this);
+    connect(m_notifier, SIGNAL(activated(int)), this, SLOT(readPendingDatagrams()));
+#else
+    m_socket = new sACNRxSocket(this);
+    if (!m_socket->bindUnicast())
+    {
+        qWarning() << "sACNReceiver: Failed to bind RX socket";
+        return;
+    }
+    connect(m_socket, SIGNAL(readyRead()), this, SLOT(readPendingDatagrams()));
+#endif
+
+    updateMulticastGroups();
+}
+
+void sACNReceiver::updateMulticastGroups()
+{
+    QSet<int> universes;
+    {
+        QMutexLocker locker(&m_listenersMutex);
+        universes = QSet<int>::fromList(m_listeners.keys());
+    }
+    foreach (int universe, universes - m_joinedUniverses)
+        setMulticastGroup(universe, true);
+    foreach (int universe, m_joinedUniverses - universes)
+        setMulticastGroup(universe, false);
+    m_joinedUniverses = universes;
+}
+
+void sACNReceiver::setMulticastGroup(int universe, bool join)
+{
+    CIPAddr addr;
+    GetUniverseAddress(universe, addr);
+    QHostAddress group(addr.GetV4Address());
+
+#if defined(Q_OS_LINUX)
+    if (m_socket < 0) return;
+    // Join on the default NIC:
+    ip_mreq request;
+    request.imr_multiaddr.s_addr = htonl(group.toIPv4Address());
+    request.imr_interface.s_addr = htonl(INADDR_ANY);
+    bool ok = setsockopt(m_socket, IPPROTO_IP, join ? IP_ADD_MEMBERSHIP : IP_DROP_MEMBERSHIP,
+                         &request, sizeof(request)) == 0;
+#else
+    if (!m_socket) return;
+    bool ok = join ? m_socket->joinMulticastGroup(group) : m_socket->leaveMulticastGroup(group);
+#endif
+
+    if (!ok)
+        qWarning() << "sACNReceiver: Failed to" << (join ? "join" : "leave") << "multicast group" << group.toString();
+}
+
+void sACNReceiver::readPendingDatagrams()
+{
+    // Listeners can't be removed (and deleted) while datagrams are dispatched to them
+    QMutexLocker locker(&m_listenersMutex);
+
+#if defined(Q_OS_LINUX)
+    forever
+    {
+        // The kernel overwrites the address length of each message
+        for(int i=0; i<batchSize; i++)
+            m_messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+
+        int count = recvmmsg(m_socket, m_messages.data(), batchSize, MSG_DONTWAIT, nullptr);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            break; // Drained (EAGAIN) or error
+
+        m_readCallCounter++;
+        for(int i=0; i<count; i++)
+        {
+            dispatch(packetBuffer(i), int(m_messages[i].msg_len),
+                     QHostAddress(reinterpret_cast<sockaddr*>(&m_senders[i])));
+        }
+        if (count < batchSize)
+            break; // Nothing left
+    }
+#else
+    while (m_socket->hasPendingDatagrams())
+    {
+        QHostAddress sender;
+        qint64 length = m_socket->readDatagram(reinterpret_cast<char*>(packetBuffer(0)), maxPacketSize, &sender);
+        m_readCallCounter++;
+        if (length > 0)
+            dispatch(packetBuffer(0), int(length), sender);
+    }
+#endif
+
+    updateStatistics();
+}
+
+void sACNReceiver::dispatch(uint1 *data, int length, const QHostAddress &sender)
+{
+    m_packetCounter++;
+
+    // Find the universe without validating the whole packet, the listener does that
+    const bool draft = (length >= DRAFT_STREAM_HEADER_SIZE) && UpackB4(data + ROOT_VECTOR_ADDR) == DRAFT_ROOT_VECTOR;
+    if (length < (draft ? DRAFT_STREAM_HEADER_SIZE : STREAM_HEADER_SIZE))
+    {
+        m_droppedCounter++;
+        return;
+    }
+    const int universe = UpackB2(data + (draft ? DRAFT_UNIVERSE_ADDR : UNIVERSE_ADDR));
+
+    sACNListener *listener = m_listeners.value(universe, nullptr);
+    if (!listener)
+    {
+        m_droppedCounter++;
+        return;
+    }
+    listener->processDatagram(data, length, QHostAddress(QHostAddress::AnyIPv4), sender);
+}
+
+void sACNReceiver::updateStatistics()
+{
+    if (!m_statisticsTimer.hasExpired(1000))
+        return;
+    m_packetsPerSecond = m_packetCounter;
+    m_readCallsPerSecond = m_readCallCounter;
+    m_droppedPerSecond = m_droppedCounter;
+    m_packetCounter = 0;
+    m_readCallCounter = 0;
+    m_droppedCounter = 0;
+    m_statisticsTimer.restart();
+}
@@ -0,0 +1,101 @@
+#ifndef SACNRECEIVER_H
+#define SACNRECEIVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QVariant>
+#include <atomic>
+#include <vector>
+#include "ACNShare/deftypes.h"
+
+#if defined(Q_OS_LINUX)
+#include <sys/socket.h>
+#endif
+
+class sACNListener;
+class sACNRxSocket;
+class QSocketNotifier;
+
+/**
+ * @brief The sACNReceiver class receives the sACN datagrams of all listened universes
+ * with a single socket and dispatches them by universe number to the listeners.
+ *
+ * The receiver and all listeners it dispatches to live in the same thread, so a datagram
+ * is passed to the listener directly from the preallocated packet buffers without copying
+ * or queuing it. On Linux up to batchSize datagrams are read with a single recvmmsg() call.
+ */
+class sACNReceiver : public QObject
+{
+    Q_OBJECT
+public:
+    explicit sACNReceiver(QObject *parent = nullptr);
+    virtual ~sACNReceiver();
+
+    /**
+     * @brief addListener registers a listener, thread-safe
+     * The listener has to live in the thread of this receiver.
+     */
+    void addListener(int universe, sACNListener *listener);
+    /**
+     * @brief removeListener unregisters the listener of a universe, thread-safe
+     */
+    void removeListener(int universe);
+
+    // Diagnostic - the number of received datagrams per second
+    unsigned int packetsPerSecond() const { return m_packetsPerSecond; }
+    // Diagnostic - the number of read calls (syscalls) per second
+    unsigned int readCallsPerSecond() const { return m_readCallsPerSecond; }
+    // Diagnostic - the number of datagrams per second without a listener for their universe
+    unsigned int droppedPerSecond() const { return m_droppedPerSecond; }
+
+public slots:
+    void startReception();
+    /**
+     * @brief updateMulticastGroups joins and leaves the multicast groups of the registered universes
+     */
+    void updateMulticastGroups();
+
+private slots:
+    void readPendingDatagrams();
+
+private:
+    uint1 *packetBuffer(int index) { return m_packetBuffers.data() + index * maxPacketSize; }
+    void dispatch(uint1 *data, int length, const QHostAddress &sender);
+    void setMulticastGroup(int universe, bool join);
+    void updateStatistics();
+
+    // Number of datagrams read at once and size of each packet buffer
+    static const int batchSize = 64;
+    static const int maxPacketSize = 1500;
+
+    QMutex m_listenersMutex;  // protects m_listeners
+    QHash<int, sACNListener *> m_listeners;
+    QSet<int> m_joinedUniverses;
+
+    // Preallocated packet buffers, batchSize * maxPacketSize bytes
+    std::vector<uint1> m_packetBuffers;
+
+#if defined(Q_OS_LINUX)
+    int m_socket;
+    QSocketNotifier *m_notifier;
+    std::vector<mmsghdr> m_messages;
+    std::vector<iovec> m_iovecs;
+    std::vector<sockaddr_storage> m_senders;
+#else
+    sACNRxSocket *m_socket;
+#endif
+
+    unsigned int m_packetCounter;
+    unsigned int m_readCallCounter;
+    unsigned int m_droppedCounter;
+    std::atomic<unsigned int> m_packetsPerSecond;
+    std::atomic<unsigned int> m_readCallsPerSecond;
+    std::atomic<unsigned int> m_droppedPerSecond;
+    QElapsedTimer m_statisticsTimer;
+};
+
+#endif // SACNRECEIVER_H
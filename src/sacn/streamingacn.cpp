@@ -38,6 +38,7 @@
 #include "streamingacn.h"
 
 #include "sacnlistener.h"
+#include "sacnreceiver.h"
 
 #include <QCoreApplication>
 #include <QThread>
@@ -80,14 +81,17 @@ sACNManager *sACNManager::getInstance()
     return m_instance;
 }
 
-sACNManager::sACNManager() : QObject()
+sACNManager::sACNManager() : QObject(),
+    m_batchedReception(false),
+    m_receiverThread(nullptr),
+    m_receiver(nullptr)
 {
 
 }
 
 static void strongPointerDelete(sACNListener *obj)
 {
-    obj->deleteLater();
+    // deletes the listener, too
     sACNManager::getInstance()->listenerDelete(obj);
 }
 
@@ -105,18 +109,42 @@ QSharedPointer<sACNListener> sACNManager::getListener(int universe)
     {
         qDebug() << "Creating Listener for universe " << universe;
 
-        // Create thread and move listener to thread
-        QThread *thread = new QThread;
-        thread->setObjectName(QString("Universe %1 RX").arg(universe));
+        sACNListener *listener = nullptr;
+        if(m_batchedReception)
+        {
+            // Create the shared receiver thread on first use
+            if(!m_receiver)
+            {
+                m_receiverThread = new QThread;
+                m_receiverThread->setObjectName("sACN RX");
+                m_receiver = new sACNReceiver;
+                m_receiver->moveToThread(m_receiverThread);
+                connect(m_receiverThread, SIGNAL(started()), m_receiver, SLOT(startReception()));
+                connect(m_receiverThread, SIGNAL(finished()), m_receiver, SLOT(deleteLater()));
+                m_receiverThread->start(QThread::HighPriority);
+            }
 
-        sACNListener *listener = new sACNListener(universe);
-        listener->moveToThread(thread);
-        connect(thread, SIGNAL(started()), listener, SLOT(startReception()));
-        connect(thread, SIGNAL(finished()), listener, SLOT(deleteLater()));
-        connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
-        thread->start(QThread::HighPriority);
+            // The listener lives in the receiver thread and gets the datagrams from the receiver
+            listener = new sACNListener(universe, nullptr, false);
+            listener->moveToThread(m_receiverThread);
+            m_receiver->addListener(universe, listener);
+            QMetaObject::invokeMethod(listener, "startReception", Qt::QueuedConnection);
+        }
+        else
+        {
+            // Create thread and move listener to thread
+            QThread *thread = new QThread;
+            thread->setObjectName(QString("Universe %1 RX").arg(universe));
 
-        m_listenerThreads[universe] = thread;
+            listener = new sACNListener(universe);
+            listener->moveToThread(thread);
+            connect(thread, SIGNAL(started()), listener, SLOT(startReception()));
+            connect(thread, SIGNAL(finished()), listener, SLOT(deleteLater()));
+            connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
+            thread->start(QThread::HighPriority);
+
+            m_listenerThreads[universe] = thread;
+        }
 
         // Create strong pointer to return
         strongPointer = QSharedPointer<sACNListener>(listener, strongPointerDelete);
@@ -148,7 +176,90 @@ void sACNManager::listenerDelete(QObject *obj)
 
     m_objToUniverse.remove(obj);
 
-    m_listenerThreads[universe]->exit();
-    m_listenerThreads[universe]->wait();
-    m_listenerThreads.remove(universe);
+    if(m_listenerThreads.contains(universe))
+    {
+        obj->deleteLater();
+        m_listenerThreads[universe]->exit();
+        m_listenerThreads[universe]->wait();
+        m_listenerThreads.remove(universe);
+    }
+    else if(m_receiver)
+    {
+        // Unregister first, the receiver must not dispatch to the deleted listener
+        m_receiver->removeListener(universe);
+        obj->deleteLater();
+
+        // Stop the shared receiver thread when its last universe is removed
+        if(m_listenerHash.size() == m_listenerThreads.size())
+            stopReceiver();
+    }
+}
+
+sACNManager::~sACNManager()
+{
+    QMutexLocker locker(&sACNManager_mutex);
+    stopReceiver();
+}
+
+void sACNManager::stopReceiver()
+{
+    if(!m_receiverThread)
+        return;
+    // The receiver is deleted when the thread finishes
+    m_receiverThread->quit();
+    if(QThread::currentThread() == m_receiverThread)
+    {
+        // The last listener was released in the receiver thread, it can't wait for itself
+        connect(m_receiverThread, SIGNAL(finished()), m_receiverThread, SLOT(deleteLater()));
+    }
+    else
+    {
+        m_receiverThread->wait();
+        delete m_receiverThread;
+    }
+    m_receiverThread = nullptr;
+    m_receiver = nullptr;
+}
+
+QSharedPointer<sACNListener> sACNManager::findListener(int universe)
+{
+    QMutexLocker locker(&sACNManager_mutex);
+    return m_listenerHash.value(universe).toStrongRef();
+}
+
+QVariantMap sACNManager::getReceiveStatistics()
+{
+    // Copy the list, releasing the last strong pointer below locks the mutex again
+    QHash<int, QWeakPointer<sACNListener> > listenerHash;
+    QVariantMap statistics;
+    statistics["batched"] = m_batchedReception;
+    {
+        QMutexLocker locker(&sACNManager_mutex);
+        listenerHash = m_listenerHash;
+        // The receiver is deleted when its last universe is removed
+        if(m_receiver)
+        {
+            statistics["packetsPerSecond"] = m_receiver->packetsPerSecond();
+            statistics["readCallsPerSecond"] = m_receiver->readCallsPerSecond();
+            statistics["droppedPerSecond"] = m_receiver->droppedPerSecond();
+        }
+    }
+    QVariantList universes;
+    double totalCpuUsage = 0.0;
+    for(auto it = listenerHash.begin(); it != listenerHash.end(); ++it)
+    {
+        QSharedPointer<sACNListener> listener = it.value().toStrongRef();
+        if(!listener)
+            continue;
+        QVariantMap universe;
+        universe["universe"] = it.key();
+        universe["packetsPerSecond"] = listener->packetsPerSecond();
+        universe["mergesPerSecond"] = listener->mergesPerSecond();
+        universe["cpuUsage"] = listener->cpuUsage();
+        totalCpuUsage += listener->cpuUsage();
+        universes.append(universe);
+    }
+    statistics["universes"] = universes;
+    statistics["cpuUsage"] = totalCpuUsage;
+    return statistics;
 }
@@ -29,6 +29,7 @@
 #include <QHostAddress>
 #include <QElapsedTimer>
 #include <QMutex>
+#include <QVariant>
 
 #include "ACNShare/deftypes.h"
 #include "ACNShare/CID.h"
@@ -37,6 +38,8 @@
 // Forward Declarations
 class sACNListener;
 class sACNSentUniverse;
+class sACNReceiver;
+class QThread;
 
 enum StreamingACNProtocolVersion
 {
@@ -99,11 +102,27 @@ public:
     QSharedPointer<sACNListener> getListener(int universe);
 
     const QHash<int, QWeakPointer<sACNListener> > getListenerList() { return m_listenerHash; }
+    // Returns the listener of a universe if it exists, without copying the listener list
+    QSharedPointer<sACNListener> findListener(int universe);
+
+    // In batched mode all universes are received with a single socket in one thread (see sACNReceiver),
+    // otherwise each listener has its own sockets and thread. Applies to listeners created afterwards.
+    void setBatchedReception(bool value) { m_batchedReception = value; }
+    bool isBatchedReception() const { return m_batchedReception; }
+
+    // Diagnostic - packets per second and CPU usage of the receiver and each listener
+    QVariantMap getReceiveStatistics();
 public slots:
     void listenerDelete(QObject *obj = Q_NULLPTR);
 private:
     sACNManager();
+    ~sACNManager();
+    // Stops and deletes the shared receiver thread of the batched mode, the mutex must be locked
+    void stopReceiver();
     QMutex sACNManager_mutex;
+    bool m_batchedReception;
+    QThread *m_receiverThread;
+    sACNReceiver *m_receiver;
     QHash<int, QWeakPointer<sACNListener> > m_listenerHash;
     QHash<int, QThread *> m_listenerThreads;
     QHash<QObject*, int> m_objToUniverse;